@@ -0,0 +1,108 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Action Hash Set
+// ═══════════════════════════════════════════════════════════════════
+// Open-addressing (linear probing) set of XrAction handles. Tables are
+// built once from the arena and never modified after publication —
+// adding actions builds a larger copy that is swapped in atomically,
+// so lookups need no lock. Handles are only ever inserted, so there
+// are no tombstones; 0 (XR_NULL_HANDLE) marks an empty slot. Each
+// handle carries a 32-bit value (the layer stores its InjectTarget).
+// ═══════════════════════════════════════════════════════════════════
+
+#include "layer_arena.h"
+
+#define ACTION_SET_MIN_CAPACITY 16
+
+struct ActionSet {
+    uint32_t    capacity;   // power of two, at least twice `count`
+    uint32_t    shift;      // 64 - log2(capacity)
+    uint32_t    count;
+    uint32_t    reserved;
+    uintptr_t*  slots;
+    uint32_t*   values;     // parallel to slots
+};
+
+// Fibonacci hashing: handles are often pointers or small counters, so
+// multiply to spread the low-entropy bits before taking the top ones.
+static inline uint32_t ActionSetSlot(const ActionSet* set, uintptr_t key)
+{
+    return (uint32_t)(((uint64_t)key * 0x9E3779B97F4A7C15ull) >> set->shift);
+}
+
+// Slot index of `key`, or -1 if absent.
+static inline int32_t ActionSetFind(const ActionSet* set, uintptr_t key)
+{
+    if (!set || key == 0) return -1;
+
+    uint32_t mask = set->capacity - 1;
+    uint32_t i    = ActionSetSlot(set, key);
+    for (;;) {
+        uintptr_t s = set->slots[i];
+        if (s == key) return (int32_t)i;
+        if (s == 0)   return -1;
+        i = (i + 1) & mask;
+    }
+}
+
+static inline bool ActionSetContains(const ActionSet* set, uintptr_t key)
+{
+    return ActionSetFind(set, key) >= 0;
+}
+
+// The value stored with `key`; 0 if absent.
+static inline uint32_t ActionSetValue(const ActionSet* set, uintptr_t key)
+{
+    int32_t i = ActionSetFind(set, key);
+    return i >= 0 ? set->values[i] : 0;
+}
+
+// Inserts into an unpublished set. Returns false if `key` is null,
+// already present, or the set would exceed a 50 % load factor.
+static inline bool ActionSetInsert(ActionSet* set, uintptr_t key, uint32_t value = 0)
+{
+    if (key == 0) return false;
+    if ((set->count + 1) * 2 > set->capacity) return false;
+
+    uint32_t mask = set->capacity - 1;
+    uint32_t i    = ActionSetSlot(set, key);
+    for (;;) {
+        uintptr_t s = set->slots[i];
+        if (s == key) return false;
+        if (s == 0) {
+            set->slots[i]  = key;
+            set->values[i] = value;
+            set->count++;
+            return true;
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+// Allocates an empty set able to hold `minCount` handles, pre-filled
+// with the contents of `src` (which may be NULL). Returns NULL on OOM.
+static inline ActionSet* ActionSetCreate(LayerArena* arena, uint32_t minCount, const ActionSet* src)
+{
+    if (src && src->count > minCount) minCount = src->count;
+
+    uint32_t capacity = ACTION_SET_MIN_CAPACITY;
+    uint32_t log2cap  = 4;
+    while (capacity < minCount * 2) { capacity <<= 1; log2cap++; }
+
+    ActionSet* set = (ActionSet*)LayerArenaAlloc(arena, sizeof(ActionSet));
+    if (!set) return NULL;
+    set->slots  = (uintptr_t*)LayerArenaAlloc(arena, capacity * sizeof(uintptr_t));
+    set->values = (uint32_t*)LayerArenaAlloc(arena, capacity * sizeof(uint32_t));
+    if (!set->slots || !set->values) return NULL;
+
+    set->capacity = capacity;
+    set->shift    = 64 - log2cap;
+    set->count    = 0;
+
+    if (src) {
+        for (uint32_t i = 0; i < src->capacity; i++) {
+            if (src->slots[i]) ActionSetInsert(set, src->slots[i], src->values[i]);
+        }
+    }
+    return set;
+}
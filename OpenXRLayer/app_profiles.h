@@ -0,0 +1,225 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Per-Application Profiles (binary database v1)
+// ═══════════════════════════════════════════════════════════════════
+// Titles differ in where they want locomotion: a thumbstick, a
+// trackpad, a single float action. A profile selects, for one
+// application or engine name, which suggested binding paths get which
+// axes (axis_injection.h targets), a scale per axis and how the value
+// is combined with the runtime's.
+//
+// Profiles are written as JSON and compiled offline by
+// tools/profile_compiler into this flat little-endian format. The layer
+// maps the file read-only at instance creation, validates every offset
+// once (ProfileDbOpen), and from then on only follows offsets: there is
+// no parsing and no allocation, and nothing here runs per frame.
+//
+// The file is looked up as $TREADMILL_PROFILES, else "profiles.bin" in
+// the layer's log directory (layer_platform.h).
+// ═══════════════════════════════════════════════════════════════════
+
+#include "axis_injection.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// ─── Constants ──────────────────────────────────────────────────
+
+#define PROFILE_DB_MAGIC            0x46504D54u     // "TMPF"
+#define PROFILE_DB_VERSION          1
+#define PROFILE_DB_FILE_NAME        "profiles.bin"
+#define PROFILE_DB_ENV              "TREADMILL_PROFILES"
+#define PROFILE_DB_MAX_SIZE         (1u << 20)
+#define PROFILE_MAX_SCALE           10.0f
+
+#define PROFILE_MATCH_APPLICATION   0       // XrApplicationInfo::applicationName
+#define PROFILE_MATCH_ENGINE        1       // XrApplicationInfo::engineName
+
+#define PROFILE_FLAG_BUILTIN        0x1u    // unlisted paths still get the built-in classification
+
+// ─── Layout ─────────────────────────────────────────────────────
+//
+//  header      ProfileDbHeader
+//  profiles    ProfileDbProfile[profileCount], sorted by (nameHash, matchKind)
+//  bindings    ProfileDbBinding[bindingCount], each profile owns a run
+//  strings     NUL-terminated, referenced by offset from the string table start
+//
+// Offsets in the header are from the start of the file; string offsets
+// are from `stringsOffset`. All sections are 4-byte aligned.
+
+struct ProfileDbHeader {
+    uint32_t    magic;
+    uint16_t    version;
+    uint16_t    headerSize;
+    uint32_t    totalSize;
+    uint32_t    profileCount;
+    uint32_t    profilesOffset;
+    uint32_t    bindingCount;
+    uint32_t    bindingsOffset;
+    uint32_t    stringsOffset;
+    uint32_t    stringsSize;
+    uint32_t    reserved;
+};
+
+struct ProfileDbProfile {
+    uint32_t    nameHash;                       // ProfileNameHash(name)
+    uint32_t    name;                           // string offset
+    uint32_t    firstBinding;
+    uint32_t    bindingCount;
+    float       scale[INJECT_AXIS_COUNT];       // applied to each axis before injection
+    uint8_t     matchKind;                      // PROFILE_MATCH_*
+    uint8_t     flags;                          // PROFILE_FLAG_*
+    uint16_t    reserved;
+};
+
+struct ProfileDbBinding {
+    uint32_t    path;                           // string offset, e.g. "/user/hand/left/input/trackpad"
+    InjectTarget vec2f;                         // target if queried as a vector2f action, 0 = none
+    InjectTarget floatValue;                    // target if queried as a float action, 0 = none
+    uint32_t    reserved;
+};
+
+static_assert(sizeof(ProfileDbHeader)  == 40, "ProfileDbHeader is part of the file format");
+static_assert(sizeof(ProfileDbProfile) == 32, "ProfileDbProfile is part of the file format");
+static_assert(sizeof(ProfileDbBinding) == 16, "ProfileDbBinding is part of the file format");
+
+// ─── Names ──────────────────────────────────────────────────────
+// Names match case-insensitively (ASCII), so the hash folds case too.
+
+static inline char ProfileFoldCase(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+// FNV-1a over the case-folded name.
+static inline uint32_t ProfileNameHash(const char* name)
+{
+    uint32_t h = 2166136261u;
+    for (; *name; name++) {
+        h ^= (uint8_t)ProfileFoldCase(*name);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static inline bool ProfileNameEquals(const char* a, const char* b)
+{
+    for (; *a && *b; a++, b++)
+        if (ProfileFoldCase(*a) != ProfileFoldCase(*b)) return false;
+    return *a == *b;
+}
+
+// ─── Database ───────────────────────────────────────────────────
+
+struct ProfileDb {
+    const ProfileDbHeader*  header;             // NULL = no database
+    const ProfileDbProfile* profiles;
+    const ProfileDbBinding* bindings;
+    const char*             strings;
+};
+
+static inline bool ProfileDbStringValid(const ProfileDbHeader* h, const char* strings, uint32_t offset)
+{
+    return offset < h->stringsSize && memchr(strings + offset, 0, h->stringsSize - offset) != NULL;
+}
+
+static inline bool ProfileDbSectionValid(uint32_t offset, uint64_t bytes, uint32_t total)
+{
+    return (offset & 3) == 0 && offset <= total && bytes <= total - offset;
+}
+
+// Validates a mapped file and fills `db`. Every offset and string a
+// lookup can reach is checked here, so the accessors below need no
+// bounds checks. False (and `db` cleared) for anything malformed.
+static inline bool ProfileDbOpen(ProfileDb* db, const void* data, size_t size)
+{
+    memset(db, 0, sizeof(*db));
+    if (!data || size < sizeof(ProfileDbHeader) || size > PROFILE_DB_MAX_SIZE) return false;
+    if (((uintptr_t)data & 3) != 0) return false;
+
+    const ProfileDbHeader* h = (const ProfileDbHeader*)data;
+    if (h->magic != PROFILE_DB_MAGIC || h->version != PROFILE_DB_VERSION) return false;
+    if (h->headerSize != sizeof(ProfileDbHeader) || h->totalSize != size) return false;
+
+    if (!ProfileDbSectionValid(h->profilesOffset, (uint64_t)h->profileCount * sizeof(ProfileDbProfile), h->totalSize) ||
+        !ProfileDbSectionValid(h->bindingsOffset, (uint64_t)h->bindingCount * sizeof(ProfileDbBinding), h->totalSize) ||
+        !ProfileDbSectionValid(h->stringsOffset, h->stringsSize, h->totalSize))
+        return false;
+
+    const uint8_t*          base     = (const uint8_t*)data;
+    const ProfileDbProfile* profiles = (const ProfileDbProfile*)(base + h->profilesOffset);
+    const ProfileDbBinding* bindings = (const ProfileDbBinding*)(base + h->bindingsOffset);
+    const char*             strings  = (const char*)(base + h->stringsOffset);
+
+    for (uint32_t i = 0; i < h->profileCount; i++) {
+        const ProfileDbProfile* p = &profiles[i];
+        if (!ProfileDbStringValid(h, strings, p->name)) return false;
+        if (p->matchKind > PROFILE_MATCH_ENGINE) return false;
+        if (p->firstBinding > h->bindingCount || p->bindingCount > h->bindingCount - p->firstBinding) return false;
+        if (i > 0 && profiles[i - 1].nameHash > p->nameHash) return false;     // binary search needs the order
+        for (int axis = 0; axis < INJECT_AXIS_COUNT; axis++)
+            if (!(p->scale[axis] >= -PROFILE_MAX_SCALE && p->scale[axis] <= PROFILE_MAX_SCALE)) return false;  // NaN too
+    }
+    for (uint32_t i = 0; i < h->bindingCount; i++) {
+        if (!ProfileDbStringValid(h, strings, bindings[i].path)) return false;
+        if (!InjectTargetValid(bindings[i].vec2f) || !InjectTargetValid(bindings[i].floatValue)) return false;
+    }
+
+    db->header   = h;
+    db->profiles = profiles;
+    db->bindings = bindings;
+    db->strings  = strings;
+    return true;
+}
+
+static inline const char* ProfileDbString(const ProfileDb* db, uint32_t offset)
+{
+    return db->strings + offset;
+}
+
+// The profile for `name` under `matchKind`, or NULL.
+static inline const ProfileDbProfile* ProfileDbFind(const ProfileDb* db, const char* name, uint8_t matchKind)
+{
+    if (!db->header || !name || !name[0]) return NULL;
+
+    uint32_t hash = ProfileNameHash(name);
+    uint32_t lo = 0, hi = db->header->profileCount;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (db->profiles[mid].nameHash < hash) lo = mid + 1;
+        else                                   hi = mid;
+    }
+    for (uint32_t i = lo; i < db->header->profileCount && db->profiles[i].nameHash == hash; i++) {
+        const ProfileDbProfile* p = &db->profiles[i];
+        if (p->matchKind == matchKind && ProfileNameEquals(ProfileDbString(db, p->name), name)) return p;
+    }
+    return NULL;
+}
+
+// Application name wins over engine name.
+static inline const ProfileDbProfile* ProfileDbSelect(const ProfileDb* db, const char* application, const char* engine)
+{
+    const ProfileDbProfile* p = ProfileDbFind(db, application, PROFILE_MATCH_APPLICATION);
+    return p ? p : ProfileDbFind(db, engine, PROFILE_MATCH_ENGINE);
+}
+
+// Classifies a suggested binding path under `profile` (NULL = built-in
+// only). A listed path ends the left-stick fallback like a built-in
+// left-thumbstick binding does.
+static inline InjectBinding ProfileClassifyBinding(const ProfileDb* db, const ProfileDbProfile* profile, const char* path)
+{
+    if (!profile) return InjectClassifyBinding(path);
+
+    const ProfileDbBinding* b = db->bindings + profile->firstBinding;
+    for (uint32_t i = 0; i < profile->bindingCount; i++, b++) {
+        if (strcmp(ProfileDbString(db, b->path), path) == 0) {
+            InjectBinding r = { b->vec2f, b->floatValue, true };
+            return r;
+        }
+    }
+
+    if (profile->flags & PROFILE_FLAG_BUILTIN) return InjectClassifyBinding(path);
+    InjectBinding none = { 0, 0, false };
+    return none;
+}
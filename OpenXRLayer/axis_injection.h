@@ -0,0 +1,175 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Axis Injection
+// ═══════════════════════════════════════════════════════════════════
+// Which treadmill axis goes into which action component, and the math
+// that adds it. Three axes come from the companion app:
+//
+//   forward  left thumbstick y     (primary sensor, forward/back)
+//   strafe   left thumbstick x     (primary sensor, sideways)
+//   turn     right thumbstick x    (second sensor)
+//
+// Each tracked action carries one InjectTarget, decided once when its
+// binding is suggested (built in here, or from the app's profile in
+// app_profiles.h); a query then costs one set lookup and at most two
+// adds, whatever the number of axes.
+// ═══════════════════════════════════════════════════════════════════
+
+#include "openxr_defs.h"
+
+#include <stdint.h>
+#include <string.h>
+
+enum InjectAxis {
+    INJECT_AXIS_FORWARD,
+    INJECT_AXIS_STRAFE,
+    INJECT_AXIS_TURN,
+    INJECT_AXIS_COUNT
+};
+
+#define INJECT_AXIS_NONE    (-1)
+
+enum InjectHand {
+    INJECT_HAND_LEFT,
+    INJECT_HAND_RIGHT
+};
+
+// ─── Targets ────────────────────────────────────────────────────
+//
+//  bits 0–3  axis added to x, or to a float action (INJECT_AXIS_* + 1, 0 = none)
+//  bits 4–7  axis added to y (vector2f only)
+//  bit  8    answers to the right hand's subaction path
+//  bit  9    combine by magnitude instead of adding (see InjectCombine)
+//
+// 0 means "not tracked", so every real target is non-zero.
+
+typedef uint32_t InjectTarget;
+
+#define INJECT_TARGET_HAND_RIGHT    0x100u
+#define INJECT_TARGET_COMBINE_MAX   0x200u
+
+static inline InjectTarget InjectTargetMake(int xAxis, int yAxis, int hand)
+{
+    return (InjectTarget)(xAxis + 1)
+         | (InjectTarget)(yAxis + 1) << 4
+         | (hand == INJECT_HAND_RIGHT ? INJECT_TARGET_HAND_RIGHT : 0);
+}
+
+static inline int InjectTargetX(InjectTarget t) { return (int)(t & 0xF) - 1; }
+static inline int InjectTargetY(InjectTarget t) { return (int)(t >> 4 & 0xF) - 1; }
+static inline int InjectTargetHand(InjectTarget t)
+{
+    return (t & INJECT_TARGET_HAND_RIGHT) ? INJECT_HAND_RIGHT : INJECT_HAND_LEFT;
+}
+
+// For targets read from outside the layer (profile files): only known
+// bits, and axes the injection functions can index.
+static inline bool InjectTargetValid(InjectTarget t)
+{
+    return (t & ~(0xFFu | INJECT_TARGET_HAND_RIGHT | INJECT_TARGET_COMBINE_MAX)) == 0
+        && InjectTargetX(t) < INJECT_AXIS_COUNT
+        && InjectTargetY(t) < INJECT_AXIS_COUNT;
+}
+
+// Left stick: strafe on x, forward on y. Also the fallback target for
+// vector2f queries before the game has suggested any bindings.
+static const InjectTarget kInjectLeftStick  = (INJECT_AXIS_STRAFE + 1) | (INJECT_AXIS_FORWARD + 1) << 4;
+static const InjectTarget kInjectRightStick = (INJECT_AXIS_TURN + 1) | INJECT_TARGET_HAND_RIGHT;
+
+// ─── Binding Classification ─────────────────────────────────────
+
+struct InjectBinding {
+    InjectTarget    vec2f;      // target if queried as a vector2f action, 0 = none
+    InjectTarget    floatValue; // target if queried as a float action, 0 = none
+    bool            leftStick;  // any left-thumbstick binding (ends the fallback)
+};
+
+// Classifies a suggested binding path such as
+// "/user/hand/left/input/thumbstick/y".
+static inline InjectBinding InjectClassifyBinding(const char* path)
+{
+    InjectBinding b = { 0, 0, false };
+
+    bool left  = strstr(path, "/user/hand/left")  != NULL;
+    bool right = strstr(path, "/user/hand/right") != NULL;
+    if ((!left && !right) || !strstr(path, "thumbstick")) return b;
+
+    bool x = strstr(path, "thumbstick/x") != NULL;
+    bool y = strstr(path, "thumbstick/y") != NULL;
+
+    if (left) {
+        b.leftStick = true;
+        if (y)      b.floatValue = InjectTargetMake(INJECT_AXIS_FORWARD, INJECT_AXIS_NONE, INJECT_HAND_LEFT);
+        else if (x) b.floatValue = InjectTargetMake(INJECT_AXIS_STRAFE, INJECT_AXIS_NONE, INJECT_HAND_LEFT);
+        else        b.vec2f      = kInjectLeftStick;
+    } else {
+        if (x)      b.floatValue = InjectTargetMake(INJECT_AXIS_TURN, INJECT_AXIS_NONE, INJECT_HAND_RIGHT);
+        else if (!y) b.vec2f      = kInjectRightStick;
+    }
+    return b;
+}
+
+// The exact paths InjectClassifyBinding targets, for resolving to
+// XrPaths up front (path_cache.h).
+static const char* const kInjectBuiltinPaths[] = {
+    "/user/hand/left/input/thumbstick",
+    "/user/hand/left/input/thumbstick/x",
+    "/user/hand/left/input/thumbstick/y",
+    "/user/hand/right/input/thumbstick",
+    "/user/hand/right/input/thumbstick/x",
+    "/user/hand/right/input/thumbstick/y",
+};
+
+// ─── Injection ──────────────────────────────────────────────────
+
+// Whether a query's subaction path (XR_NULL_PATH = any) reaches the target's hand.
+static inline bool InjectSubactionMatches(InjectTarget t, XrPath subaction, XrPath leftHand, XrPath rightHand)
+{
+    if (subaction == XR_NULL_PATH) return true;
+    return subaction == (InjectTargetHand(t) == INJECT_HAND_RIGHT ? rightHand : leftHand);
+}
+
+static inline float InjectAxisValue(const float axes[INJECT_AXIS_COUNT], int axis)
+{
+    return axis == INJECT_AXIS_NONE ? 0.0f : axes[axis];
+}
+
+static inline float InjectClamp(float v)
+{
+    return v > 1.0f ? 1.0f : v < -1.0f ? -1.0f : v;
+}
+
+// Adds the treadmill value to the runtime's and clamps; with
+// INJECT_TARGET_COMBINE_MAX the stronger of the two wins instead, so a
+// title that already maps the stick to full speed is not pushed past it.
+static inline float InjectCombine(float current, float d, InjectTarget t)
+{
+    if (t & INJECT_TARGET_COMBINE_MAX) {
+        float a = current < 0.0f ? -current : current;
+        float b = d < 0.0f ? -d : d;
+        return InjectClamp(b > a ? d : current);
+    }
+    return InjectClamp(current + d);
+}
+
+// Adds the target's axes to a vector2f state. Returns false, leaving
+// the value untouched, if every selected axis is 0.
+static inline bool InjectVector2f(XrVector2f* v, InjectTarget t, const float axes[INJECT_AXIS_COUNT])
+{
+    float dx = InjectAxisValue(axes, InjectTargetX(t));
+    float dy = InjectAxisValue(axes, InjectTargetY(t));
+    if (dx == 0.0f && dy == 0.0f) return false;
+
+    if (dx != 0.0f) v->x = InjectCombine(v->x, dx, t);
+    if (dy != 0.0f) v->y = InjectCombine(v->y, dy, t);
+    return true;
+}
+
+static inline bool InjectFloat(float* v, InjectTarget t, const float axes[INJECT_AXIS_COUNT])
+{
+    float d = InjectAxisValue(axes, InjectTargetX(t));
+    if (d == 0.0f) return false;
+
+    *v = InjectCombine(*v, d, t);
+    return true;
+}
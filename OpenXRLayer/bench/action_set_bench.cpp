@@ -0,0 +1,65 @@
+// ═══════════════════════════════════════════════════════════════════
+// Action lookup: linear scan (pre-hash-set layer) vs ActionSet
+// ═══════════════════════════════════════════════════════════════════
+
+#include "action_set.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace {
+
+uintptr_t Handle(uint32_t i) { return 0x7ff6a0000000ull + (uintptr_t)i * 0x40; }
+
+// The lookup the layer did before ActionSet existed.
+bool LinearContains(const uintptr_t* arr, int count, uintptr_t key)
+{
+    for (int i = 0; i < count; i++) {
+        if (arr[i] == key) return true;
+    }
+    return false;
+}
+
+// Query mix: half the lookups hit a tracked action, half miss — games
+// query many untracked actions (buttons, poses) through the same path.
+std::vector<uintptr_t> Queries(int n)
+{
+    std::vector<uintptr_t> q;
+    for (int i = 0; i < 256; i++) q.push_back(Handle((i % 2) ? (uint32_t)(i % n) + 1 : (uint32_t)(n + i + 1)));
+    return q;
+}
+
+void BM_LinearScan(benchmark::State& state)
+{
+    int n = (int)state.range(0);
+    std::vector<uintptr_t> tracked;
+    for (int i = 1; i <= n; i++) tracked.push_back(Handle(i));
+    std::vector<uintptr_t> q = Queries(n);
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(LinearContains(tracked.data(), n, q[i++ & 255]));
+    }
+}
+
+void BM_ActionSet(benchmark::State& state)
+{
+    int n = (int)state.range(0);
+    LayerArena arena = {};
+    ActionSet* set = ActionSetCreate(&arena, (uint32_t)n, NULL);
+    for (int i = 1; i <= n; i++) ActionSetInsert(set, Handle(i));
+    const ActionSet* published = set;
+    std::vector<uintptr_t> q = Queries(n);
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ActionSetContains(published, q[i++ & 255]));
+    }
+    LayerArenaReset(&arena);
+}
+
+} // namespace
+
+BENCHMARK(BM_LinearScan)->Arg(8)->Arg(64)->Arg(512);
+BENCHMARK(BM_ActionSet)->Arg(8)->Arg(64)->Arg(512);
@@ -0,0 +1,58 @@
+// ═══════════════════════════════════════════════════════════════════
+// Session lookup: HandleMap with 1, 4 and 16 live handles
+// ═══════════════════════════════════════════════════════════════════
+// The map the layer consults on every intercepted session call, sized
+// as in treadmill_layer.cpp. Queries cycle through the live handles so
+// no single slot stays hot; the "churned" variant first creates and
+// destroys a few thousand handles, leaving whatever tombstones survive.
+
+#include "handle_map.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace {
+
+struct Value { int unused; };
+
+typedef HandleMap<Value, 64> SessionMap;
+
+uint64_t Handle(uint32_t i) { return 0x000001a4c2e10000ull + (uint64_t)i * 0x40; }
+
+void Lookups(benchmark::State& state, bool churn)
+{
+    static SessionMap map;
+    static Value values[16];
+    const uint32_t n = (uint32_t)state.range(0);
+
+    uint32_t next = 0;
+    if (churn) {
+        for (; next < 4096; next++) {
+            HandleMapInsert(&map, Handle(next), &values[0]);
+            if (next >= n) HandleMapRemove(&map, Handle(next - n));
+        }
+        for (uint32_t i = next - n; i < next; i++) HandleMapRemove(&map, Handle(i));
+    }
+    std::vector<uint64_t> live;
+    for (uint32_t i = 0; i < n; i++, next++) {
+        HandleMapInsert(&map, Handle(next), &values[i]);
+        live.push_back(Handle(next));
+    }
+
+    uint32_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(HandleMapFind(&map, live[i]));
+        i = i + 1 == n ? 0 : i + 1;
+    }
+
+    for (uint64_t k : live) HandleMapRemove(&map, k);
+}
+
+void BM_HandleMapFind(benchmark::State& state) { Lookups(state, false); }
+void BM_HandleMapFindChurned(benchmark::State& state) { Lookups(state, true); }
+
+} // namespace
+
+BENCHMARK(BM_HandleMapFind)->Arg(1)->Arg(4)->Arg(16);
+BENCHMARK(BM_HandleMapFindChurned)->Arg(1)->Arg(4)->Arg(16);
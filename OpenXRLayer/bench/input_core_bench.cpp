@@ -0,0 +1,123 @@
+// ═══════════════════════════════════════════════════════════════════
+// Input core throughput: 8 kHz raw-event streams
+// ═══════════════════════════════════════════════════════════════════
+// One iteration filters one second of an 8000 Hz mouse, delivered in
+// batches the way the app's processing tick drains them. `streams`
+// filters that many independent devices per iteration, `filter` runs
+// it through each TREADMILL_INPUT_FILTER_*; a `calibrated` step maps
+// its speed through the response curve table. The pow pair shows what
+// the deterministic math costs over libm. Latency and jitter of the
+// filters are measured by harness/filter_replay.cpp, not here.
+
+#include "input_core.h"
+#include "input_core_math.h"
+
+#include <benchmark/benchmark.h>
+
+#include <math.h>
+#include <vector>
+
+namespace {
+
+const int64_t kFrequency = 1000000000;      // ns
+const int     kEventRate = 8000;
+
+// One second of a walking treadmill: ~4 counts per event, timestamps jittered ±10 µs
+std::vector<TreadmillInputEvent> Stream(uint32_t seed)
+{
+    std::vector<TreadmillInputEvent> events(kEventRate);
+    uint32_t rng = seed;
+    int64_t  period = kFrequency / kEventRate;
+    for (int i = 0; i < kEventRate; i++) {
+        rng = rng * 1664525u + 1013904223u;
+        events[i].timestamp = (i + 1) * period + (int64_t)(rng >> 20) % 20000 - 10000;
+        events[i].dx = 0;
+        events[i].dy = -2 - (int32_t)((rng >> 8) % 5);
+    }
+    return events;
+}
+
+// Arg 0: batch length in ms; Arg 1: streams; Arg 2: filter
+void BM_ProcessEvents8kHz(benchmark::State& state)
+{
+    int64_t  batchTicks = state.range(0) * kFrequency / 1000;
+    int      streams    = (int)state.range(1);
+
+    TreadmillInputConfig config;
+    TreadmillInput_DefaultConfig(&config);
+    config.filter = (int32_t)state.range(2);
+
+    std::vector<std::vector<TreadmillInputEvent>> input;
+    for (int s = 0; s < streams; s++) input.push_back(Stream(0x1234u + s));
+    std::vector<TreadmillInputState> states(streams);
+
+    for (auto _ : state) {
+        for (int s = 0; s < streams; s++) {
+            TreadmillInputState* st = &states[s];
+            TreadmillInput_Reset(st, 0);
+            const TreadmillInputEvent* ev = input[s].data();
+            uint32_t i = 0;
+            for (int64_t now = batchTicks; now <= kFrequency; now += batchTicks) {
+                uint32_t n = 0;
+                while (i + n < (uint32_t)kEventRate && ev[i + n].timestamp <= now) n++;
+                benchmark::DoNotOptimize(TreadmillInput_ProcessEvents(st, &config, ev + i, n, now, kFrequency));
+                i += n;
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kEventRate * streams);
+    state.counters["x_realtime"] = benchmark::Counter((double)state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_ProcessEvents8kHz)
+    ->ArgNames({"batch_ms", "streams", "filter"})
+    ->Args({1, 1, 0})->Args({2, 1, 0})->Args({16, 1, 0})
+    ->Args({2, 4, 0})->Args({2, 16, 0})
+    ->Args({2, 1, 1})->Args({16, 1, 1})
+    ->Args({2, 1, 2})->Args({16, 1, 2});
+
+// The app's fixed tick: summed deltas, one step per 2 ms.
+// Arg 0: filter; Arg 1: calibrated
+void BM_Step500Hz(benchmark::State& state)
+{
+    TreadmillInputConfig config;
+    TreadmillInput_DefaultConfig(&config);
+    config.filter = (int32_t)state.range(0);
+    if (state.range(1)) {
+        config.calibration.countsPerMeter = 2000.0;
+        TreadmillInput_BakeCurve(&config.calibration, 2.0, NULL, 0);
+    }
+    TreadmillInputState st;
+    TreadmillInput_Reset(&st, 0);
+
+    double delta = -64.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(TreadmillInput_Step(&st, &config, delta, 0.002));
+        delta = delta == -64.0 ? -60.0 : -64.0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Step500Hz)
+    ->ArgNames({"filter", "calibrated"})
+    ->ArgsProduct({benchmark::CreateDenseRange(0, TREADMILL_INPUT_FILTER_COUNT - 1, 1), {0, 1}});
+
+void BM_PowDeterministic(benchmark::State& state)
+{
+    double e = 0.0078125;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(InputMathPow(0.75, e));
+        e += 1e-9;
+    }
+}
+BENCHMARK(BM_PowDeterministic);
+
+void BM_PowLibm(benchmark::State& state)
+{
+    double e = 0.0078125;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(pow(0.75, e));
+        e += 1e-9;
+    }
+}
+BENCHMARK(BM_PowLibm);
+
+} // namespace
@@ -0,0 +1,388 @@
+// ═══════════════════════════════════════════════════════════════════
+// Layer hot paths, end to end through the built treadmill_layer
+// ═══════════════════════════════════════════════════════════════════
+// The layer is loaded through the mini loader on top of the mock
+// runtime (harness/mock_runtime.h), so every number includes the real
+// dispatch a game sees. "baseline" variants call the mock runtime
+// directly; the difference is what the layer costs.
+//
+// Run with --benchmark_out=FILE --benchmark_out_format=json (or the
+// bench_json target) to record results per commit.
+
+#include "mock_runtime.h"
+#include "layer_platform.h"
+#include "treadmill_shared.h"
+#include "layer_telemetry.h"
+#include "openxr_function_names.h"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const char* const kLayerName = "XR_APILAYER_TREADMILL_driver";
+
+enum : uint32_t {
+    LEFT_STICK,         // tracked vec2f
+    RIGHT_STICK,        // untracked vec2f
+    LEFT_STICK_Y,       // tracked float
+    LEFT_TRIGGER,       // untracked float
+    ACTION_COUNT,
+};
+
+const char* const kBindings[ACTION_COUNT] = {
+    "/user/hand/left/input/thumbstick",
+    "/user/hand/right/input/thumbstick",
+    "/user/hand/left/input/thumbstick/y",
+    "/user/hand/left/input/trigger/value",
+};
+
+// ─── Shared Setup ───────────────────────────────────────────────
+// One layer instance and session for the whole run, created on first
+// use, exactly as in a game.
+
+class BenchLayer {
+public:
+    BenchLayer()
+    {
+        if (!PlatformSharedMemoryCreate(&m_shm, TREADMILL_SHARED_MEM_NAME, sizeof(TreadmillSharedData))) {
+            fprintf(stderr, "layer_bench: cannot create shared memory\n");
+            abort();
+        }
+        data = (TreadmillSharedData*)m_shm.view;
+        TreadmillSharedInit(data, PlatformTimestampFrequency());
+        atexit([] {
+            PlatformSharedMemoryUnlink(TREADMILL_SHARED_MEM_NAME);
+            PlatformSharedMemoryUnlink(TREADMILL_TELEMETRY_MEM_NAME);     // created by the layer
+        });
+
+        std::string error;
+        m_layers.resize(1);
+        if (!MiniLoaderLoadLayer(TREADMILL_LAYER_PATH, kLayerName, &m_layers[0], &error)) {
+            fprintf(stderr, "layer_bench: %s\n", error.c_str());
+            abort();
+        }
+        CreateInstance();
+        MiniLoaderResolveDispatch(MockRuntime::GetInstanceProcAddr, instance, &baseline);
+
+        for (uint32_t i = 0; i < ACTION_COUNT; i++) {
+            MockRuntime::SetActionValue(MockRuntime::MakeAction(i), 0.0f, 0.25f);
+        }
+        SuggestDefaultBindings();
+        Publish(0.5f);
+        Sync(layered, session);
+    }
+
+    void CreateInstance()
+    {
+        PFN_xrGetInstanceProcAddr gipa = NULL;
+        if (XR_FAILED(MiniLoaderCreateInstance(m_layers, &instance, &gipa)) ||
+            !MiniLoaderResolveDispatch(gipa, instance, &layered) ||
+            XR_FAILED(MiniLoaderCreateSession(layered, instance, &session))) {
+            fprintf(stderr, "layer_bench: instance creation failed\n");
+            abort();
+        }
+        layerGipa = gipa;
+    }
+
+    void DestroyInstance()
+    {
+        layered.DestroyInstance(instance);
+        instance = XR_NULL_HANDLE;
+        session  = XR_NULL_HANDLE;
+    }
+
+    void SuggestDefaultBindings()
+    {
+        XrActionSuggestedBinding b[ACTION_COUNT];
+        for (uint32_t i = 0; i < ACTION_COUNT; i++) {
+            b[i].action = MockRuntime::MakeAction(i);
+            layered.StringToPath(instance, kBindings[i], &b[i].binding);
+        }
+        Suggest(b, ACTION_COUNT);
+    }
+
+    void Suggest(const XrActionSuggestedBinding* bindings, uint32_t count)
+    {
+        XrInteractionProfileSuggestedBinding s = {};
+        s.type                   = XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING;
+        s.countSuggestedBindings = count;
+        s.suggestedBindings      = bindings;
+        layered.SuggestInteractionProfileBindings(instance, &s);
+    }
+
+    void Publish(float velocity) { TreadmillSharedWrite(data, velocity, 1, PlatformTimestamp()); }
+
+    static void Sync(const AppDispatch& d, XrSession s)
+    {
+        XrActionsSyncInfo sync = {};
+        sync.type = XR_TYPE_ACTIONS_SYNC_INFO;
+        d.SyncActions(s, &sync);
+    }
+
+    std::vector<LoadedLayer>& Layers() { return m_layers; }
+
+    TreadmillSharedData*        data = nullptr;
+    XrInstance                  instance = XR_NULL_HANDLE;
+    XrSession                   session = XR_NULL_HANDLE;
+    PFN_xrGetInstanceProcAddr   layerGipa = NULL;
+    AppDispatch                 layered = {};
+    AppDispatch                 baseline = {};
+
+private:
+    PlatformSharedMemory        m_shm = {};
+    std::vector<LoadedLayer>    m_layers;
+};
+
+BenchLayer& Layer()
+{
+    static BenchLayer* layer = new BenchLayer();     // lives until exit
+    return *layer;
+}
+
+// ─── Background Producer ────────────────────────────────────────
+// Publishes continuously (no sleep) so readers contend with the writer
+// on the sample's cache line — the worst case for the seqlock.
+
+std::atomic<bool>   g_stopWriter{false};
+std::thread         g_writer;
+
+void StartWriter(const benchmark::State&)
+{
+    BenchLayer& l = Layer();
+    g_stopWriter.store(false);
+    g_writer = std::thread([&l] {
+        float v = 0.0f;
+        while (!g_stopWriter.load(std::memory_order_relaxed)) {
+            l.Publish(v);
+            v = v < 0.9f ? v + 0.001f : 0.0f;
+        }
+    });
+}
+
+void StopWriter(const benchmark::State&)
+{
+    g_stopWriter.store(true);
+    g_writer.join();
+    Layer().Publish(0.5f);
+}
+
+// ─── ReadTreadmillVelocity ──────────────────────────────────────
+// The layer reads shared memory once per xrSyncActions; the sync path
+// is that read plus the runtime call.
+
+void BM_SharedMemoryRead(benchmark::State& state)
+{
+    BenchLayer& l = Layer();
+    for (auto _ : state) {
+        TreadmillSample s;
+        benchmark::DoNotOptimize(TreadmillSharedRead(l.data, &s));
+        benchmark::DoNotOptimize(s);
+    }
+}
+
+void BM_SyncActions(benchmark::State& state)
+{
+    BenchLayer& l = Layer();
+    const AppDispatch& d = state.range(0) ? l.layered : l.baseline;
+    state.SetLabel(state.range(0) ? "layer" : "baseline");
+    for (auto _ : state) BenchLayer::Sync(d, l.session);
+}
+
+// ─── Injection Paths ────────────────────────────────────────────
+
+enum QueryCase { Q_BASELINE, Q_TRACKED, Q_UNTRACKED, Q_OTHER_HAND };
+const char* const kQueryLabels[] = { "baseline", "tracked", "untracked", "right_subaction" };
+
+void BM_GetActionStateVector2f(benchmark::State& state)
+{
+    BenchLayer& l = Layer();
+    QueryCase c = (QueryCase)state.range(0);
+    state.SetLabel(kQueryLabels[c]);
+
+    XrActionStateGetInfo info = { XR_TYPE_ACTION_STATE_GET_INFO, NULL,
+                                  MockRuntime::MakeAction(c == Q_UNTRACKED ? RIGHT_STICK : LEFT_STICK),
+                                  XR_NULL_PATH };
+    if (c == Q_OTHER_HAND) l.layered.StringToPath(l.instance, "/user/hand/right", &info.subactionPath);
+    const AppDispatch& d = c == Q_BASELINE ? l.baseline : l.layered;
+
+    XrActionStateVector2f s = {};
+    s.type = XR_TYPE_ACTION_STATE_VECTOR2F;
+    for (auto _ : state) {
+        d.GetActionStateVector2f(l.session, &info, &s);
+        benchmark::DoNotOptimize(s);
+    }
+}
+
+void BM_GetActionStateFloat(benchmark::State& state)
+{
+    BenchLayer& l = Layer();
+    QueryCase c = (QueryCase)state.range(0);
+    state.SetLabel(kQueryLabels[c]);
+
+    XrActionStateGetInfo info = { XR_TYPE_ACTION_STATE_GET_INFO, NULL,
+                                  MockRuntime::MakeAction(c == Q_UNTRACKED ? LEFT_TRIGGER : LEFT_STICK_Y),
+                                  XR_NULL_PATH };
+    const AppDispatch& d = c == Q_BASELINE ? l.baseline : l.layered;
+
+    XrActionStateFloat s = {};
+    s.type = XR_TYPE_ACTION_STATE_FLOAT;
+    for (auto _ : state) {
+        d.GetActionStateFloat(l.session, &info, &s);
+        benchmark::DoNotOptimize(s);
+    }
+}
+
+// ─── Live Instances ─────────────────────────────────────────────
+// The tracked-stick query when N instances (overlays, recreated
+// instances) are live, round-robin over their sessions so every query
+// looks up a different handle. The session and instance maps are sized
+// for the pool, so the cost should not grow with N.
+
+void BM_LiveInstances(benchmark::State& state)
+{
+    BenchLayer& l = Layer();
+    const int n = (int)state.range(0);
+
+    struct Live {
+        XrInstance  instance;
+        XrSession   session;
+        AppDispatch xr;
+    };
+    std::vector<Live> live(n);
+    live[0] = { l.instance, l.session, l.layered };
+    for (int k = 1; k < n; k++) {
+        PFN_xrGetInstanceProcAddr gipa = NULL;
+        if (XR_FAILED(MiniLoaderCreateInstance(l.Layers(), &live[k].instance, &gipa)) ||
+            !MiniLoaderResolveDispatch(gipa, live[k].instance, &live[k].xr) ||
+            XR_FAILED(MiniLoaderCreateSession(live[k].xr, live[k].instance, &live[k].session))) {
+            state.SkipWithError("instance creation failed");
+            return;
+        }
+        XrActionSuggestedBinding b = { MockRuntime::MakeAction(LEFT_STICK), XR_NULL_PATH };
+        live[k].xr.StringToPath(live[k].instance, kBindings[LEFT_STICK], &b.binding);
+        XrInteractionProfileSuggestedBinding s = {};
+        s.type                   = XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING;
+        s.countSuggestedBindings = 1;
+        s.suggestedBindings      = &b;
+        live[k].xr.SuggestInteractionProfileBindings(live[k].instance, &s);
+        BenchLayer::Sync(live[k].xr, live[k].session);
+    }
+
+    XrActionStateGetInfo info = { XR_TYPE_ACTION_STATE_GET_INFO, NULL,
+                                  MockRuntime::MakeAction(LEFT_STICK), XR_NULL_PATH };
+    XrActionStateVector2f s = {};
+    s.type = XR_TYPE_ACTION_STATE_VECTOR2F;
+    int k = 0;
+    for (auto _ : state) {
+        live[k].xr.GetActionStateVector2f(live[k].session, &info, &s);
+        benchmark::DoNotOptimize(s);
+        k = k + 1 == n ? 0 : k + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    for (int j = 1; j < n; j++) live[j].xr.DestroyInstance(live[j].instance);
+}
+
+// ─── Binding Scan ───────────────────────────────────────────────
+// One xrSuggestInteractionProfileBindings call with N bindings, an
+// eighth of them on the left thumbstick (what a large game suggests per
+// interaction profile). The instance is recreated periodically so the
+// tracked tables don't grow without bound.
+
+void BM_SuggestBindings(benchmark::State& state)
+{
+    BenchLayer& l = Layer();
+    const uint32_t n = (uint32_t)state.range(0);
+    static const char* const kPaths[8] = {
+        "/user/hand/left/input/thumbstick",     "/user/hand/right/input/thumbstick",
+        "/user/hand/left/input/trigger/value",  "/user/hand/right/input/trigger/value",
+        "/user/hand/left/input/squeeze/value",  "/user/hand/right/input/squeeze/value",
+        "/user/hand/left/input/a/click",        "/user/hand/right/input/b/click",
+    };
+
+    std::vector<XrActionSuggestedBinding> bindings(n);
+    for (uint32_t i = 0; i < n; i++) {
+        bindings[i].action = MockRuntime::MakeAction(ACTION_COUNT + i);
+        l.layered.StringToPath(l.instance, kPaths[i % 8], &bindings[i].binding);
+    }
+
+    uint32_t calls = 0;
+    for (auto _ : state) {
+        l.Suggest(bindings.data(), n);
+        if (++calls % 256 == 0) {
+            state.PauseTiming();
+            l.DestroyInstance();
+            l.CreateInstance();
+            state.ResumeTiming();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+
+    l.DestroyInstance();
+    l.CreateInstance();
+    l.SuggestDefaultBindings();
+    BenchLayer::Sync(l.layered, l.session);
+}
+
+// ─── xrGetInstanceProcAddr ──────────────────────────────────────
+// Resolves the full OpenXR 1.0 + common extension list through the
+// layer (intercepts hit the table, the rest fall through to the runtime).
+
+void BM_GetInstanceProcAddr(benchmark::State& state)
+{
+    BenchLayer& l = Layer();
+    PFN_xrGetInstanceProcAddr gipa = state.range(0) ? l.layerGipa : MockRuntime::GetInstanceProcAddr;
+    state.SetLabel(state.range(0) ? "layer" : "baseline");
+
+    const size_t n = sizeof(kOpenXRFunctionNames) / sizeof(kOpenXRFunctionNames[0]);
+    for (auto _ : state) {
+        for (const char* name : kOpenXRFunctionNames) {
+            PFN_xrVoidFunction fn;
+            benchmark::DoNotOptimize(gipa(l.instance, name, &fn));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)n);
+}
+
+// ─── Contention ─────────────────────────────────────────────────
+// N game threads (render, physics, audio…) query the tracked stick
+// while thread 0 also syncs every 16 queries and a producer writes
+// continuously.
+
+void BM_ContendedQueries(benchmark::State& state)
+{
+    BenchLayer& l = Layer();
+    XrActionStateGetInfo info = { XR_TYPE_ACTION_STATE_GET_INFO, NULL,
+                                  MockRuntime::MakeAction(LEFT_STICK), XR_NULL_PATH };
+    XrActionStateVector2f s = {};
+    s.type = XR_TYPE_ACTION_STATE_VECTOR2F;
+
+    bool syncer = state.thread_index() == 0;
+    uint32_t i = 0;
+    for (auto _ : state) {
+        if (syncer && (++i & 15) == 0) BenchLayer::Sync(l.layered, l.session);
+        l.layered.GetActionStateVector2f(l.session, &info, &s);
+        benchmark::DoNotOptimize(s);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK(BM_SharedMemoryRead);
+BENCHMARK(BM_SharedMemoryRead)->Name("BM_SharedMemoryRead/contended")->Setup(StartWriter)->Teardown(StopWriter);
+BENCHMARK(BM_SyncActions)->Arg(0)->Arg(1);
+BENCHMARK(BM_SyncActions)->Name("BM_SyncActions/contended")->Arg(1)->Setup(StartWriter)->Teardown(StopWriter);
+BENCHMARK(BM_GetActionStateVector2f)->DenseRange(Q_BASELINE, Q_OTHER_HAND);
+BENCHMARK(BM_GetActionStateFloat)->DenseRange(Q_BASELINE, Q_UNTRACKED);
+BENCHMARK(BM_LiveInstances)->Arg(1)->Arg(4)->Arg(16);
+BENCHMARK(BM_SuggestBindings)->Arg(8)->Arg(64)->Arg(256);
+BENCHMARK(BM_GetInstanceProcAddr)->Arg(0)->Arg(1);
+BENCHMARK(BM_ContendedQueries)->ThreadRange(1, 16)->UseRealTime()->Setup(StartWriter)->Teardown(StopWriter);
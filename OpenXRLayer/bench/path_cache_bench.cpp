@@ -0,0 +1,185 @@
+// ═══════════════════════════════════════════════════════════════════
+// Binding scan: xrPathToString + classification vs PathCache
+// ═══════════════════════════════════════════════════════════════════
+// One "suggest round" is what an engine sends at startup or on a focus
+// change: the same action map suggested once per interaction profile
+// (Unity's and Unreal's OpenXR plugins enable ten or more). The paths
+// below are the typical SteamVR title's map for each profile.
+//
+// The runtime's xrPathToString is modelled as an uncontended lock plus
+// a copy out of its path table — a lower bound: real runtimes add a
+// cross-module call and sometimes IPC.
+
+#include "path_cache.h"
+
+#include <benchmark/benchmark.h>
+
+#include <mutex>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Per-hand components a typical title binds, by interaction profile
+struct ProfilePaths {
+    const char*                 profile;
+    std::vector<const char*>    components;
+};
+
+const ProfilePaths kProfiles[] = {
+    { "/interaction_profiles/valve/index_controller",
+      { "input/grip/pose", "input/aim/pose", "input/trigger/value", "input/trigger/click", "input/squeeze/value",
+        "input/squeeze/force", "input/thumbstick", "input/thumbstick/click", "input/trackpad", "input/trackpad/force",
+        "input/a/click", "input/b/click", "input/system/click", "output/haptic" } },
+    { "/interaction_profiles/oculus/touch_controller",
+      { "input/grip/pose", "input/aim/pose", "input/trigger/value", "input/trigger/touch", "input/squeeze/value",
+        "input/thumbstick", "input/thumbstick/click", "input/thumbstick/touch", "input/thumbrest/touch",
+        "output/haptic" } },
+    { "/interaction_profiles/htc/vive_controller",
+      { "input/grip/pose", "input/aim/pose", "input/trigger/value", "input/trigger/click", "input/squeeze/click",
+        "input/trackpad", "input/trackpad/click", "input/trackpad/touch", "input/menu/click", "output/haptic" } },
+    { "/interaction_profiles/microsoft/motion_controller",
+      { "input/grip/pose", "input/aim/pose", "input/trigger/value", "input/squeeze/click", "input/thumbstick",
+        "input/thumbstick/click", "input/trackpad", "input/trackpad/click", "input/menu/click", "output/haptic" } },
+    { "/interaction_profiles/hp/mixed_reality_controller",
+      { "input/grip/pose", "input/aim/pose", "input/trigger/value", "input/squeeze/value", "input/thumbstick",
+        "input/thumbstick/click", "input/menu/click", "output/haptic" } },
+    { "/interaction_profiles/htc/vive_cosmos_controller",
+      { "input/grip/pose", "input/aim/pose", "input/trigger/value", "input/squeeze/click", "input/thumbstick",
+        "input/thumbstick/click", "input/thumbstick/touch", "input/shoulder/click", "output/haptic" } },
+    { "/interaction_profiles/htc/vive_focus3_controller",
+      { "input/grip/pose", "input/aim/pose", "input/trigger/value", "input/squeeze/value", "input/thumbstick",
+        "input/thumbstick/click", "input/thumbrest/touch", "output/haptic" } },
+    { "/interaction_profiles/bytedance/pico4_controller",
+      { "input/grip/pose", "input/aim/pose", "input/trigger/value", "input/squeeze/value", "input/thumbstick",
+        "input/thumbstick/click", "input/thumbstick/touch", "output/haptic" } },
+    { "/interaction_profiles/facebook/touch_controller_pro",
+      { "input/grip/pose", "input/aim/pose", "input/trigger/value", "input/squeeze/value", "input/thumbstick",
+        "input/thumbstick/click", "input/stylus_fb/force", "output/haptic" } },
+    { "/interaction_profiles/khr/simple_controller",
+      { "input/grip/pose", "input/aim/pose", "input/select/click", "input/menu/click", "output/haptic" } },
+};
+
+// Just enough of a runtime: an atom table behind a lock
+class PathTable {
+public:
+    XrPath Intern(const std::string& s)
+    {
+        for (size_t i = 0; i < m_paths.size(); i++)
+            if (m_paths[i] == s) return (XrPath)(i + 1);
+        m_paths.push_back(s);
+        return (XrPath)m_paths.size();
+    }
+
+    bool ToString(XrPath path, char* buf, uint32_t capacity)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (path == XR_NULL_PATH || path > m_paths.size()) return false;
+        const std::string& s = m_paths[(size_t)path - 1];
+        if (s.size() + 1 > capacity) return false;
+        memcpy(buf, s.c_str(), s.size() + 1);
+        return true;
+    }
+
+private:
+    std::mutex                  m_lock;
+    std::vector<std::string>    m_paths;
+};
+
+// Every binding of one suggest round, as XrPaths
+struct Round {
+    PathTable           table;
+    std::vector<XrPath> bindings;
+
+    Round()
+    {
+        for (const ProfilePaths& p : kProfiles)
+            for (const char* hand : { "/user/hand/left/", "/user/hand/right/" })
+                for (const char* c : p.components) bindings.push_back(table.Intern(std::string(hand) + c));
+    }
+};
+
+Round& TheRound()
+{
+    static Round r;
+    return r;
+}
+
+// What the layer did before the cache, per binding
+uint32_t ScanUncached(Round& r)
+{
+    uint32_t tracked = 0;
+    for (XrPath path : r.bindings) {
+        char str[256];
+        if (!r.table.ToString(path, str, sizeof(str))) continue;
+        InjectBinding b = InjectClassifyBinding(str);
+        tracked += (b.vec2f || b.floatValue) ? 1 : 0;
+    }
+    return tracked;
+}
+
+// The layer's scan with the cache: strings only for paths not seen yet
+uint32_t ScanCached(Round& r, PathCache* cache)
+{
+    uint32_t tracked = 0;
+    for (XrPath path : r.bindings) {
+        InjectBinding b;
+        if (!PathCacheFind(cache, path, &b)) {
+            char str[256];
+            if (!r.table.ToString(path, str, sizeof(str))) continue;
+            b = InjectClassifyBinding(str);
+            PathCacheInsert(cache, path, b);
+        }
+        tracked += (b.vec2f || b.floatValue) ? 1 : 0;
+    }
+    return tracked;
+}
+
+void Seed(Round& r, PathCache* cache)
+{
+    for (const char* s : kInjectBuiltinPaths)
+        PathCacheInsert(cache, r.table.Intern(s), InjectClassifyBinding(s));
+    cache->seeded = true;
+}
+
+// ─── Benchmarks ─────────────────────────────────────────────────
+
+void BM_SuggestRound_Uncached(benchmark::State& state)
+{
+    Round& r = TheRound();
+    for (auto _ : state) benchmark::DoNotOptimize(ScanUncached(r));
+    state.SetItemsProcessed(state.iterations() * (int64_t)r.bindings.size());
+}
+
+// First round of an instance: seeding plus one string per unseen path
+void BM_SuggestRound_ColdCache(benchmark::State& state)
+{
+    Round& r = TheRound();
+    PathCache cache = {};
+    for (auto _ : state) {
+        PathCacheClear(&cache);
+        Seed(r, &cache);
+        benchmark::DoNotOptimize(ScanCached(r, &cache));
+    }
+    PathCacheClear(&cache);
+    state.SetItemsProcessed(state.iterations() * (int64_t)r.bindings.size());
+}
+
+// Every later round (re-suggest on focus change): integer lookups only
+void BM_SuggestRound_WarmCache(benchmark::State& state)
+{
+    Round& r = TheRound();
+    PathCache cache = {};
+    Seed(r, &cache);
+    ScanCached(r, &cache);
+    for (auto _ : state) benchmark::DoNotOptimize(ScanCached(r, &cache));
+    PathCacheClear(&cache);
+    state.SetItemsProcessed(state.iterations() * (int64_t)r.bindings.size());
+}
+
+} // namespace
+
+BENCHMARK(BM_SuggestRound_Uncached);
+BENCHMARK(BM_SuggestRound_ColdCache);
+BENCHMARK(BM_SuggestRound_WarmCache);
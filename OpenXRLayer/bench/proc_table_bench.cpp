@@ -0,0 +1,47 @@
+// ═══════════════════════════════════════════════════════════════════
+// xrGetInstanceProcAddr lookup: strcmp chain vs compile-time table
+// ═══════════════════════════════════════════════════════════════════
+// Each iteration resolves the full OpenXR 1.0 (+ common extension)
+// name list, as an engine does at startup.
+
+#include "proc_table.h"
+#include "openxr_function_names.h"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+const size_t kNameCount = sizeof(kOpenXRFunctionNames) / sizeof(kOpenXRFunctionNames[0]);
+
+// The lookup the layer did before the table existed.
+int StrcmpChain(const char* name)
+{
+    const size_t n = sizeof(kInterceptNames) / sizeof(kInterceptNames[0]);
+    for (size_t i = 0; i < n; i++) {
+        if (strcmp(name, kInterceptNames[i]) == 0) return (int)i;
+    }
+    return -1;
+}
+
+void BM_ResolveAll_StrcmpChain(benchmark::State& state)
+{
+    for (auto _ : state) {
+        for (const char* name : kOpenXRFunctionNames) benchmark::DoNotOptimize(StrcmpChain(name));
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)kNameCount);
+}
+
+void BM_ResolveAll_ProcTable(benchmark::State& state)
+{
+    for (auto _ : state) {
+        for (const char* name : kOpenXRFunctionNames) {
+            benchmark::DoNotOptimize(ProcTableFind(kInterceptTable, kInterceptNames, name));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)kNameCount);
+}
+
+} // namespace
+
+BENCHMARK(BM_ResolveAll_StrcmpChain);
+BENCHMARK(BM_ResolveAll_ProcTable);
@@ -0,0 +1,89 @@
+// ═══════════════════════════════════════════════════════════════════
+// Tracked action lookup scaling: published snapshot vs reader lock
+// ═══════════════════════════════════════════════════════════════════
+// 1…16 threads query concurrently, as when an engine polls input on the
+// game thread while render/input threads also query. The mutex variant
+// is what a lock around the tables (the old g_cs) costs readers.
+
+#include "tracked_actions.h"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+const uint32_t kTracked = 16;
+
+TrackedActionsState g_state;
+std::mutex          g_mutex;
+std::atomic<bool>   g_stopWriter{false};
+std::thread         g_writer;
+
+uintptr_t Key(uint32_t i) { return 0x7ff6a0000000ull + (uintptr_t)i * 0x40; }
+
+void Populate(const benchmark::State&)
+{
+    TrackedBinding keys[kTracked];
+    for (uint32_t i = 0; i < kTracked; i++) keys[i] = { Key(i), 1 };
+    TrackedActionsPublish(&g_state, keys, kTracked, keys, kTracked, true);
+}
+
+void Release(const benchmark::State&)
+{
+    TrackedActionsReclaimAll(&g_state);
+}
+
+// Republishes every millisecond (a game suggesting bindings mid-session
+// is far rarer; this is the worst case).
+void PopulateWithWriter(const benchmark::State& state)
+{
+    Populate(state);
+    g_stopWriter.store(false);
+    g_writer = std::thread([] {
+        uint32_t n = kTracked;
+        while (!g_stopWriter.load(std::memory_order_relaxed)) {
+            TrackedBinding k = { Key(n++ % 64), 1 };
+            TrackedActionsPublish(&g_state, &k, 1, NULL, 0, true);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+}
+
+void ReleaseWithWriter(const benchmark::State& state)
+{
+    g_stopWriter.store(true);
+    g_writer.join();
+    Release(state);
+}
+
+void BM_SnapshotLookup(benchmark::State& state)
+{
+    uint32_t i = (uint32_t)state.thread_index();
+    for (auto _ : state) {
+        const TrackedActions* t = TrackedActionsAcquire(&g_state);
+        benchmark::DoNotOptimize(TrackedActionsHasVec2f(t, Key(i++ & 31)) || TrackedActionsFallback(t));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_MutexLookup(benchmark::State& state)
+{
+    uint32_t i = (uint32_t)state.thread_index();
+    for (auto _ : state) {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        const TrackedActions* t = g_state.current.load(std::memory_order_relaxed);
+        benchmark::DoNotOptimize(TrackedActionsHasVec2f(t, Key(i++ & 31)) || TrackedActionsFallback(t));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK(BM_SnapshotLookup)->Setup(Populate)->Teardown(Release)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(BM_SnapshotLookup)->Name("BM_SnapshotLookup/with_writer")
+    ->Setup(PopulateWithWriter)->Teardown(ReleaseWithWriter)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(BM_MutexLookup)->Setup(Populate)->Teardown(Release)->ThreadRange(1, 16)->UseRealTime();
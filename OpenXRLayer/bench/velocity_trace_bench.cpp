@@ -0,0 +1,115 @@
+// ═══════════════════════════════════════════════════════════════════
+// Velocity trace: what recording costs and how fast traces decode
+// ═══════════════════════════════════════════════════════════════════
+// The layer's xrSyncActions only pushes one entry into an in-process
+// ring; the watcher encodes. A 1 kHz mouse, a 1 kHz tick and a 144 Hz
+// game make ~2200 records a second, so even the encoder runs a few
+// microseconds per second of play. Decoding bounds how fast the replay
+// can go.
+
+#include "velocity_trace.h"
+#include "shared_ring.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace {
+
+struct FrameEntry {
+    int64_t             timestamp;
+    VelocityTraceFrame  frame;
+};
+
+// The input thread's share: one ring push per frame
+void BM_TraceRecordFrame(benchmark::State& state)
+{
+    static SharedRing<FrameEntry, 1024> ring;
+    SharedRingReset(&ring);
+    FrameEntry e = { 0, { 0.5f, 0.0f, 0.0f, 0, 0 } };
+    for (auto _ : state) {
+        e.timestamp += 6944;
+        e.frame.frame++;
+        SharedRingWrite(&ring, &e, 1);
+    }
+    benchmark::DoNotOptimize(ring.head.load());
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename Payload>
+void EncodeInto(benchmark::State& state, uint8_t type, int64_t step)
+{
+    std::vector<uint8_t> buf(64 * 1024);
+    VelocityTraceEncoder e = {};
+    Payload payload = {};
+    int64_t t = 0;
+    size_t  n = 0;
+    for (auto _ : state) {
+        size_t w = VelocityTraceEncode(&e, buf.data() + n, buf.size() - n, type, 0, t += step, &payload, sizeof(payload));
+        if (!w) {
+            n = 0;      // "flushed"
+            continue;
+        }
+        n += w;
+    }
+    benchmark::DoNotOptimize(buf.data());
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_TraceEncodeFrame(benchmark::State& state) { EncodeInto<VelocityTraceFrame>(state, VELOCITY_TRACE_FRAME, 6944); }
+void BM_TraceEncodeDelta(benchmark::State& state) { EncodeInto<VelocityTraceDelta>(state, VELOCITY_TRACE_DELTA, 1000); }
+void BM_TraceEncodeTick(benchmark::State& state)  { EncodeInto<VelocityTraceTick>(state, VELOCITY_TRACE_TICK, 2000); }
+
+// A second of a typical session: 1000 deltas, 500 ticks, 144 frames
+std::vector<uint8_t> SessionSecond()
+{
+    std::vector<uint8_t> data(sizeof(VelocityTraceFileHeader));
+    VelocityTraceEncoder e;
+    VelocityTraceBegin(&e, data.data(), data.size(), 1000000, 0, VELOCITY_TRACE_SOURCE_APP);
+    uint8_t record[VELOCITY_TRACE_RECORD_MAX];
+    VelocityTraceDelta delta = { 0, -12 };
+    VelocityTraceTick  tick  = {};
+    VelocityTraceFrame frame = {};
+    for (int64_t us = 0; us < 1000000; us += 1000) {
+        size_t n = VelocityTraceEncode(&e, record, sizeof(record), VELOCITY_TRACE_DELTA, 0, us, &delta, sizeof(delta));
+        data.insert(data.end(), record, record + n);
+        if (us % 2000 == 0) {
+            n = VelocityTraceEncode(&e, record, sizeof(record), VELOCITY_TRACE_TICK, 0, us + 1, &tick, sizeof(tick));
+            data.insert(data.end(), record, record + n);
+        }
+        if (us % 7000 == 0) {
+            n = VelocityTraceEncode(&e, record, sizeof(record), VELOCITY_TRACE_FRAME, 0, us + 2, &frame, sizeof(frame));
+            data.insert(data.end(), record, record + n);
+        }
+    }
+    return data;
+}
+
+void BM_TraceDecode(benchmark::State& state)
+{
+    std::vector<uint8_t> data = SessionSecond();
+    size_t records = 0;
+    for (auto _ : state) {
+        VelocityTraceReader r;
+        if (!VelocityTraceOpen(&r, data.data(), data.size())) {
+            state.SkipWithError("SessionSecond is not a trace");
+            return;
+        }
+        VelocityTraceRecord rec = {};
+        size_t n = 0;
+        while (VelocityTraceNext(&r, &rec)) n++;
+        benchmark::DoNotOptimize(rec.timestamp);
+        records = n;
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)records);
+    state.SetBytesProcessed(state.iterations() * (int64_t)data.size());
+    state.counters["bytes_per_second_of_play"] = (double)data.size();
+}
+
+} // namespace
+
+BENCHMARK(BM_TraceRecordFrame);
+BENCHMARK(BM_TraceEncodeFrame);
+BENCHMARK(BM_TraceEncodeDelta);
+BENCHMARK(BM_TraceEncodeTick);
+BENCHMARK(BM_TraceDecode);
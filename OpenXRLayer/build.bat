@@ -9,13 +9,19 @@ REM  Alternatively, use CMake:
 REM    mkdir build && cd build
 REM    cmake .. -G "Visual Studio 17 2022" -A x64
 REM    cmake --build . --config Release
+REM
+REM  "build.bat lean" builds the layer without telemetry counters.
 REM ═══════════════════════════════════════════════════════════════
 
 setlocal
 
 set SRC=%~dp0treadmill_layer.cpp
+set PLATFORM_SRC=%~dp0layer_platform_win32.cpp
+set CORE_SRC=%~dp0input_core.cpp
 set DEF=%~dp0treadmill_layer.def
 set OUT=%~dp0bin
+set LEAN=
+if /I "%~1"=="lean" set LEAN=/DTREADMILL_TELEMETRY=0
 
 if not exist "%OUT%" mkdir "%OUT%"
 
@@ -23,11 +29,11 @@ echo.
 echo Building treadmill_layer.dll ...
 echo.
 
-cl.exe /nologo /LD /O2 /std:c++17 /EHsc /MT ^
+cl.exe /nologo /LD /O2 /fp:precise /std:c++17 /EHsc /MT %LEAN% ^
     /I"%~dp0." ^
-    "%SRC%" ^
+    "%SRC%" "%PLATFORM_SRC%" "%CORE_SRC%" ^
     /Fe:"%OUT%\treadmill_layer.dll" ^
-    /Fo:"%OUT%\treadmill_layer.obj" ^
+    /Fo:"%OUT%\\" ^
     /link /DEF:"%DEF%" /OUT:"%OUT%\treadmill_layer.dll" ^
     kernel32.lib shell32.lib
 
@@ -40,13 +46,55 @@ if %ERRORLEVEL% NEQ 0 (
     exit /b 1
 )
 
+echo.
+echo Building treadmill_input.dll ...
+echo.
+
+REM Input core for the companion app; /fp:precise keeps it bit-exact with Linux
+cl.exe /nologo /LD /O2 /fp:precise /std:c++17 /EHsc /MT /DTREADMILL_INPUT_SHARED ^
+    /I"%~dp0." ^
+    "%CORE_SRC%" ^
+    /Fe:"%OUT%\treadmill_input.dll" ^
+    /Fo:"%OUT%\\" ^
+    /link /OUT:"%OUT%\treadmill_input.dll"
+
+if %ERRORLEVEL% NEQ 0 (
+    echo.
+    echo  BUILD FAILED ^(treadmill_input.dll^).
+    echo.
+    pause
+    exit /b 1
+)
+
+echo.
+echo Building treadmill_profile_compiler.exe ...
+echo.
+
+cl.exe /nologo /O2 /std:c++17 /EHsc /MT ^
+    /I"%~dp0." ^
+    "%~dp0tools\profile_compiler.cpp" ^
+    /Fe:"%OUT%\treadmill_profile_compiler.exe" ^
+    /Fo:"%OUT%\\"
+
+if %ERRORLEVEL% NEQ 0 (
+    echo.
+    echo  BUILD FAILED ^(treadmill_profile_compiler.exe^).
+    echo.
+    pause
+    exit /b 1
+)
+
 echo.
 echo  ✓  Built successfully:  %OUT%\treadmill_layer.dll
+echo  ✓  Built successfully:  %OUT%\treadmill_input.dll
+echo  ✓  Built successfully:  %OUT%\treadmill_profile_compiler.exe
 echo.
 
 REM Clean up intermediate files
-if exist "%OUT%\treadmill_layer.obj" del "%OUT%\treadmill_layer.obj"
+if exist "%OUT%\*.obj" del "%OUT%\*.obj"
 if exist "%OUT%\treadmill_layer.exp" del "%OUT%\treadmill_layer.exp"
 if exist "%OUT%\treadmill_layer.lib" del "%OUT%\treadmill_layer.lib"
+if exist "%OUT%\treadmill_input.exp" del "%OUT%\treadmill_input.exp"
+if exist "%OUT%\treadmill_input.lib" del "%OUT%\treadmill_input.lib"
 
 pause
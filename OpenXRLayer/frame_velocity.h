@@ -0,0 +1,211 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Frame Velocity
+// ═══════════════════════════════════════════════════════════════════
+// What xrSyncActions latches for a frame, computed from the shared
+// block: the forward velocity predicted to the display time, and strafe
+// and turn as published.
+//
+// Velocity mode: every sample the app published since the last frame
+// comes from the velocity ring, so the predictor fits the app's full
+// tick rate rather than one sample per frame.
+//
+// Raw delta mode (TREADMILL_STREAM_RAW_DELTAS): the app streams raw
+// treadmill deltas instead of a pre-filtered velocity. Each frame
+// drains the delta ring and runs the input core over exactly the events
+// since the previous frame, so the velocity is integrated over the
+// game's frame interval rather than resampled from the app's tick.
+// Between events the filter only idles up to RAW_DELTA_IDLE_MS ago:
+// events still in flight from the capture thread must not read as a
+// stop. A calibrated app publishes its counts per meter and response
+// curve too, and the layer's filter maps speed through the same table.
+//
+// Prediction (velocity_predictor.h): samples are extrapolated to the
+// display time of the latest xrWaitFrame. Without a display time (no
+// frame loop, or the runtime can't convert XrTime) the newest sample is
+// used as-is.
+//
+// The caller supplies the block, the clock and the display time, so
+// the layer and the trace replay (harness/trace_replay.cpp) run the
+// same code — the replay on a recorded trace's clock.
+// ═══════════════════════════════════════════════════════════════════
+
+#include "treadmill_shared.h"
+#include "input_core.h"
+#include "velocity_predictor.h"
+
+#define FRAME_VELOCITY_STALE_MS     250     // samples older than this read as 0
+#define RAW_DELTA_IDLE_MS           8       // longer than a 125 Hz mouse's report interval
+#define RAW_DELTA_BATCH             256     // entries copied per ring read (on the stack)
+#define VELOCITY_RING_BATCH         64
+#define PREDICTION_WINDOW_MS        50
+#define PREDICTION_MAX_HORIZON_MS   50
+
+// One reader's state. Single-threaded: the layer's input thread.
+struct FrameVelocity {
+    int64_t                 staleTicks;         // in the writer's clock, set by FrameVelocityAdopt
+    int64_t                 rawIdleTicks;
+    float                   strafe;             // as published; kept when a read fails, like the history
+    float                   turn;
+    int                     streamMode;         // TREADMILL_STREAM_* of the last sample read, -1 = none
+    VelocityHistory         history;
+    SharedRingCursor        velocityCursor;
+    VelocityPredictor       predictor;
+
+    // Raw delta mode; rawActive = cursor and filter are live
+    bool                    rawActive;
+    SharedRingCursor        deltaCursor;
+    TreadmillInputState     rawFilter;
+    TreadmillInputConfig    rawConfig;
+    uint32_t                rawConfigSequence;
+    uint32_t                rawCalibrationSequence;
+};
+
+static_assert(sizeof(TreadmillCalibrationConfig) == sizeof(TreadmillInputCalibration) &&
+              TREADMILL_CURVE_SIZE == TREADMILL_INPUT_CURVE_SIZE, "calibration is copied as is");
+
+// Forgets the samples seen so far, including any not yet read from the ring.
+static inline void FrameVelocityResetHistory(FrameVelocity* f, const TreadmillSharedData* d)
+{
+    VelocityHistoryReset(&f->history);
+    TreadmillVelocityCursorInit(d, &f->velocityCursor);
+}
+
+// Starts over on a (new) writer: `d` must have a valid header.
+static inline void FrameVelocityAdopt(FrameVelocity* f, const TreadmillSharedData* d, int predictMode)
+{
+    int64_t frequency = d->header.timestampFrequency;
+    f->staleTicks   = frequency * FRAME_VELOCITY_STALE_MS / 1000;
+    f->rawIdleTicks = frequency * RAW_DELTA_IDLE_MS / 1000;
+    f->rawActive    = false;
+    f->streamMode   = -1;
+
+    f->predictor.mode            = predictMode;
+    f->predictor.windowTicks     = frequency * PREDICTION_WINDOW_MS / 1000;
+    f->predictor.maxHorizonTicks = frequency * PREDICTION_MAX_HORIZON_MS / 1000;
+    FrameVelocityResetHistory(f, d);
+}
+
+// Picks up a config change from the app; the filter keeps its state.
+static inline void FrameVelocityRefreshRawConfig(FrameVelocity* f, const TreadmillSharedData* d)
+{
+    uint32_t sequence = d->configSequence.load(std::memory_order_acquire);
+    if (sequence == f->rawConfigSequence) return;
+
+    TreadmillFilterConfig config;
+    if (!TreadmillConfigRead(d, &config)) return;
+
+    f->rawConfig.sensitivity     = config.sensitivity;
+    f->rawConfig.deadZone        = config.deadZone;
+    f->rawConfig.smoothing       = config.smoothing;
+    f->rawConfig.maxSpeed        = config.maxSpeed;
+    f->rawConfig.invertDirection = config.invertDirection ? 1 : 0;
+    f->rawConfig.filter          = (int32_t)config.filter;
+    f->rawConfig.adaptivity      = config.adaptivity;
+    f->rawConfigSequence         = sequence;
+}
+
+// Likewise the calibration, which has a seqlock of its own.
+static inline void FrameVelocityRefreshRawCalibration(FrameVelocity* f, const TreadmillSharedData* d)
+{
+    uint32_t sequence = d->calibrationSequence.load(std::memory_order_acquire);
+    if (sequence == f->rawCalibrationSequence) return;
+
+    TreadmillCalibrationConfig calibration;
+    if (!TreadmillCalibrationRead(d, &calibration)) return;
+
+    memcpy(&f->rawConfig.calibration, &calibration, sizeof(calibration));
+    f->rawCalibrationSequence = sequence;
+}
+
+// Filters every delta that arrived since the last call. Returns the
+// filter's velocity and, in *timestamp, the time it has reached.
+static inline float FrameVelocityFilterRawDeltas(FrameVelocity* f, const TreadmillSharedData* d,
+                                                 int64_t now, int64_t* timestamp)
+{
+    int64_t frequency = d->header.timestampFrequency;
+
+    if (!f->rawActive) {
+        TreadmillDeltaCursorInit(d, &f->deltaCursor);
+        TreadmillInput_Reset(&f->rawFilter, now);
+        TreadmillInput_DefaultConfig(&f->rawConfig);
+        f->rawConfigSequence      = 0;
+        f->rawCalibrationSequence = 0;
+        f->rawActive              = true;
+    }
+    FrameVelocityRefreshRawConfig(f, d);
+    FrameVelocityRefreshRawCalibration(f, d);
+
+    TreadmillDelta      deltas[RAW_DELTA_BATCH];
+    TreadmillInputEvent events[RAW_DELTA_BATCH];
+    uint32_t n;
+    do {
+        n = TreadmillDeltaRead(d, &f->deltaCursor, deltas, RAW_DELTA_BATCH);
+        if (!n) break;
+        for (uint32_t i = 0; i < n; i++) {
+            events[i].timestamp = deltas[i].timestamp;
+            events[i].dx        = deltas[i].dx;
+            events[i].dy        = deltas[i].dy;
+        }
+        // Step to the newest event only; the idle step below covers the rest
+        int64_t newest = events[n - 1].timestamp > f->rawFilter.lastTimestamp
+                       ? events[n - 1].timestamp : f->rawFilter.lastTimestamp;
+        TreadmillInput_ProcessEvents(&f->rawFilter, &f->rawConfig, events, n, newest, frequency);
+    } while (n == RAW_DELTA_BATCH);
+
+    TreadmillInput_ProcessEvents(&f->rawFilter, &f->rawConfig, NULL, 0, now - f->rawIdleTicks, frequency);
+
+    *timestamp = f->rawFilter.lastTimestamp;
+    return (float)f->rawFilter.velocity;
+}
+
+// Moves every sample published since the last frame into the history;
+// the history keeps the newest VELOCITY_HISTORY_SIZE.
+static inline void FrameVelocityPushPublished(FrameVelocity* f, const TreadmillSharedData* d)
+{
+    TreadmillVelocitySample samples[VELOCITY_RING_BATCH];
+    uint32_t n;
+    do {
+        n = TreadmillVelocityRead(d, &f->velocityCursor, samples, VELOCITY_RING_BATCH);
+        for (uint32_t i = 0; i < n; i++) VelocityHistoryPush(&f->history, samples[i].timestamp, samples[i].velocity);
+    } while (n == VELOCITY_RING_BATCH);
+}
+
+// Forward velocity at `now`, predicted to `display` (writer clock ticks;
+// 0 = unknown); strafe and turn are left in f->strafe / f->turn.
+static inline float FrameVelocityRead(FrameVelocity* f, const TreadmillSharedData* d, int64_t now, int64_t display)
+{
+    // A read only fails if the writer raced us on every retry — predict
+    // from the history we already have rather than spinning.
+    TreadmillSample sample;
+    if (TreadmillSharedRead(d, &sample)) {
+        if (!sample.active || TreadmillSampleIsStale(&sample, now, f->staleTicks)) {
+            FrameVelocityResetHistory(f, d);
+            f->rawActive = false;
+            f->strafe    = f->turn = 0.0f;
+            return 0.0f;
+        }
+        f->strafe = sample.strafe;
+        f->turn   = sample.turn;
+
+        // The two sources are not comparable sample-for-sample, so a mode switch starts over
+        bool raw = d->streamMode.load(std::memory_order_relaxed) == TREADMILL_STREAM_RAW_DELTAS;
+        f->streamMode = raw ? TREADMILL_STREAM_RAW_DELTAS : TREADMILL_STREAM_VELOCITY;
+        if (raw != f->rawActive) FrameVelocityResetHistory(f, d);
+
+        if (raw) {
+            int64_t timestamp;
+            float velocity = FrameVelocityFilterRawDeltas(f, d, now, &timestamp);
+            VelocityHistoryPush(&f->history, timestamp, velocity);
+        } else {
+            f->rawActive = false;
+            FrameVelocityPushPublished(f, d);
+            VelocityHistoryPush(&f->history, sample.timestamp, sample.velocity);
+        }
+    }
+
+    // A display time that is itself stale means the app stopped calling xrWaitFrame
+    if (!display || now - display > f->staleTicks) return VelocityHistoryNewest(&f->history);
+
+    return VelocityPredict(&f->history, &f->predictor, display);
+}
@@ -0,0 +1,131 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Handle Map
+// ═══════════════════════════════════════════════════════════════════
+// Maps an OpenXR handle (XrInstance, XrSession) to the layer's state
+// for it, so every intercepted call finds its own instance instead of
+// a process-wide one. Lookups are on the xrGetActionState* hot path
+// and take no lock: hash the handle, then compare keys with acquire
+// loads, usually one or two of them.
+//
+// Open addressing with linear probing like action_set.h, over a fixed
+// array of atomics (no allocation, zero-initialisable). Writers —
+// instance and session creation and destruction, which are rare — are
+// serialised by the caller. A removed key leaves a tombstone so probe
+// chains stay intact for concurrent readers; inserts reuse tombstones,
+// and a run of them ending at an empty slot is emptied again.
+//
+// Values are not owned. A reader racing the removal of its own handle
+// (an application bug) gets the old value or NULL, so values must stay
+// valid memory after removal — the layer keeps them in a static pool.
+// ═══════════════════════════════════════════════════════════════════
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+#define HANDLE_MAP_EMPTY        0ull        // XR_NULL_HANDLE is never a key
+#define HANDLE_MAP_TOMBSTONE    (~0ull)
+
+template <typename T, uint32_t N>
+struct HandleMap {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "capacity must be a power of two");
+
+    std::atomic<uint64_t>   keys[N];
+    std::atomic<T*>         values[N];
+    uint32_t                count;          // live keys (writer only)
+};
+
+// Handles are pointers on 64-bit builds and 64-bit integers otherwise.
+template <typename H>
+static inline uint64_t HandleKey(H handle)
+{
+    return (uint64_t)(uintptr_t)handle;
+}
+
+// Fibonacci hashing, as ActionSetSlot: runtimes hand out pointers or
+// small counters, so spread the low-entropy bits before taking the top.
+template <typename T, uint32_t N>
+static inline uint32_t HandleMapSlot(const HandleMap<T, N>*, uint64_t key)
+{
+    return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & (N - 1);
+}
+
+// ─── Readers ────────────────────────────────────────────────────
+
+// The value stored for `key`; NULL if absent. Any thread, lock-free.
+template <typename T, uint32_t N>
+static inline T* HandleMapFind(const HandleMap<T, N>* m, uint64_t key)
+{
+    if (key == HANDLE_MAP_EMPTY || key == HANDLE_MAP_TOMBSTONE) return NULL;
+
+    uint32_t i = HandleMapSlot(m, key);
+    for (uint32_t probes = 0; probes < N; probes++, i = (i + 1) & (N - 1)) {
+        uint64_t k = m->keys[i].load(std::memory_order_acquire);
+        if (k == HANDLE_MAP_EMPTY) return NULL;
+        if (k != key) continue;
+
+        // The key is published after its value; re-check it in case the
+        // slot was removed and reused in between
+        T* value = m->values[i].load(std::memory_order_acquire);
+        return m->keys[i].load(std::memory_order_acquire) == key ? value : NULL;
+    }
+    return NULL;
+}
+
+// ─── Writers (serialised by the caller) ─────────────────────────
+
+// Adds `key`. False if it is null, already present, or the map is at
+// its 50 % load limit.
+template <typename T, uint32_t N>
+static inline bool HandleMapInsert(HandleMap<T, N>* m, uint64_t key, T* value)
+{
+    if (key == HANDLE_MAP_EMPTY || key == HANDLE_MAP_TOMBSTONE) return false;
+    if ((m->count + 1) * 2 > N) return false;
+
+    int32_t  slot = -1;
+    uint32_t i    = HandleMapSlot(m, key);
+    for (uint32_t probes = 0; probes < N; probes++, i = (i + 1) & (N - 1)) {
+        uint64_t k = m->keys[i].load(std::memory_order_relaxed);
+        if (k == key) return false;
+        if (k == HANDLE_MAP_TOMBSTONE && slot < 0) slot = (int32_t)i;
+        if (k == HANDLE_MAP_EMPTY) {
+            if (slot < 0) slot = (int32_t)i;
+            break;
+        }
+    }
+    if (slot < 0) return false;
+
+    m->values[slot].store(value, std::memory_order_relaxed);
+    m->keys[slot].store(key, std::memory_order_release);
+    m->count++;
+    return true;
+}
+
+// Removes `key`; returns its value, or NULL if it was absent.
+template <typename T, uint32_t N>
+static inline T* HandleMapRemove(HandleMap<T, N>* m, uint64_t key)
+{
+    if (key == HANDLE_MAP_EMPTY || key == HANDLE_MAP_TOMBSTONE) return NULL;
+
+    uint32_t i = HandleMapSlot(m, key);
+    for (uint32_t probes = 0; probes < N; probes++, i = (i + 1) & (N - 1)) {
+        uint64_t k = m->keys[i].load(std::memory_order_relaxed);
+        if (k == HANDLE_MAP_EMPTY) return NULL;
+        if (k != key) continue;
+
+        T* value = m->values[i].load(std::memory_order_relaxed);
+        m->keys[i].store(HANDLE_MAP_TOMBSTONE, std::memory_order_release);
+        m->count--;
+
+        // No probe chain runs through tombstones that end at an empty
+        // slot: turn them back into empty slots, last first
+        if (m->keys[(i + 1) & (N - 1)].load(std::memory_order_relaxed) == HANDLE_MAP_EMPTY) {
+            for (uint32_t j = i; m->keys[j].load(std::memory_order_relaxed) == HANDLE_MAP_TOMBSTONE;
+                 j = (j - 1) & (N - 1))
+                m->keys[j].store(HANDLE_MAP_EMPTY, std::memory_order_release);
+        }
+        return value;
+    }
+    return NULL;
+}
@@ -0,0 +1,458 @@
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Filter Replay (EMA vs. One-Euro vs. Kalman)
+// ═══════════════════════════════════════════════════════════════════
+// Runs the same treadmill deltas through each of the input core's
+// filters (TREADMILL_INPUT_FILTER_*) and measures how quickly each one
+// follows a start and a stop and how much it wobbles in between:
+//
+//   rise     ms from the speed reaching 90 % of a walk's plateau to the
+//            filter reaching it
+//   fall     ms from the speed dropping to 10 % of the plateau to the
+//            filter dropping there
+//   jitter   RMS of filter minus speed while walking steadily, in % of
+//            full speed
+//
+// Both are measured along the two paths a velocity takes to a game:
+//
+//   tick  the app's processing loop, once per jittered --tick-hz tick
+//         (InputProcessor.cs): EMA steps over the tick's summed counts,
+//         the adaptive filters take its events with their timestamps
+//   raw   the layer's raw delta mode, TreadmillInput_ProcessEvents per
+//         --rate frame (frame_velocity.h)
+//
+// Without --trace it synthesises walks from rest at a few speeds: a
+// --mouse-hz sensor quantised to whole counts, with surface noise on
+// every report. With --trace it replays the primary sensor's DELTA
+// records (and the forward CONFIG) of app velocity traces
+// (velocity_trace.h). There is no true speed then, so the reference is
+// the counts' own rate over a centred 100 ms window, a smoother no
+// causal filter can match.
+//
+//   treadmill_filter_replay [--trace FILE]... [--mouse-hz HZ] [--tick-hz HZ]
+//                           [--rate HZ] [--seconds S] [--smoothing S]
+//                           [--adaptivity A] [--check]
+//
+// --check exits non-zero unless, on the synthetic walks, One-Euro and
+// Kalman each rise faster than EMA on both paths with no more than
+// JITTER_TOLERANCE times its jitter.
+// ═══════════════════════════════════════════════════════════════════
+
+#include "input_core.h"
+#include "replay_common.h"
+#include "velocity_trace.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#define RAW_DELTA_IDLE_MS   8       // keep in sync with frame_velocity.h
+#define NS_PER_SECOND       1000000000LL
+#define NS_PER_MS           1000000LL
+#define START_LEVEL         0.03    // reference speed that counts as walking
+#define REFERENCE_WINDOW_MS 100     // centred window of the trace reference
+#define JITTER_TOLERANCE    1.10
+
+namespace {
+
+// ─── Options ────────────────────────────────────────────────────
+
+struct Options {
+    std::vector<std::string>    traces;
+    int                         mouseHz     = 1000;
+    int                         tickHz      = 500;
+    int                         rateHz      = 90;
+    double                      seconds     = 8.0;
+    double                      smoothing   = -1.0;     // < 0: the config's
+    double                      adaptivity  = -1.0;
+    bool                        check       = false;
+};
+
+bool ParseOptions(int argc, char** argv, Options* o)
+{
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(a, "--trace") && hasValue)              o->traces.push_back(argv[++i]);
+        else if (!strcmp(a, "--mouse-hz") && hasValue)      o->mouseHz = atoi(argv[++i]);
+        else if (!strcmp(a, "--tick-hz") && hasValue)       o->tickHz = atoi(argv[++i]);
+        else if (!strcmp(a, "--rate") && hasValue)          o->rateHz = atoi(argv[++i]);
+        else if (!strcmp(a, "--seconds") && hasValue)       o->seconds = atof(argv[++i]);
+        else if (!strcmp(a, "--smoothing") && hasValue)     o->smoothing = atof(argv[++i]);
+        else if (!strcmp(a, "--adaptivity") && hasValue)    o->adaptivity = atof(argv[++i]);
+        else if (!strcmp(a, "--check"))                     o->check = true;
+        else return false;
+    }
+    return o->mouseHz > 0 && o->mouseHz <= 8000 && o->tickHz > 0 && o->tickHz <= 1000 &&
+           o->rateHz > 0 && o->rateHz <= 1000 && o->seconds >= 4.0;
+}
+
+const char* const kFilterNames[TREADMILL_INPUT_FILTER_COUNT] = { "ema", "one-euro", "kalman" };
+
+// ─── Input ──────────────────────────────────────────────────────
+
+// What one replay filters: forward deltas, the config they were
+// recorded with, and the speed they stand for (normalised, at `t`)
+struct Session {
+    std::string                         name;
+    std::vector<TreadmillInputEvent>    events;
+    TreadmillInputConfig                config;
+    int64_t                             frequency;
+    int64_t                             begin, end;
+    double                              (*truth)(double t);     // NULL: reference from the counts
+};
+
+// Counts per second at full speed for `c` (velocity 1 = maxSpeed filter units per 16 ms)
+double FullSpeedCounts(const TreadmillInputConfig& c)
+{
+    return 100.0 * (c.maxSpeed / 100.0) / c.sensitivity / TREADMILL_INPUT_REFERENCE_TICK;
+}
+
+struct Walk {
+    const char* name;
+    double      (*speed)(double t);
+};
+
+// From rest at 0.5 s, stopping at 5 s
+const Walk kWalks[] = {
+    { "slow-walk", [](double t) { return t >= 0.5 && t < 5.0 ? 0.20 : 0.0; } },
+    { "walk",      [](double t) { return t >= 0.5 && t < 5.0 ? 0.45 : 0.0; } },
+    { "run",       [](double t) { return t >= 0.5 && t < 5.0 ? 0.85 : 0.0; } },
+};
+
+// Forward reports at `mouseHz`, quantised to whole counts, with ±10 %
+// interval jitter and surface noise of about a count per millisecond
+Session SimulateWalk(const Walk& w, const Options& o, uint32_t seed)
+{
+    Session s;
+    s.name      = w.name;
+    TreadmillInput_DefaultConfig(&s.config);
+    s.frequency = NS_PER_SECOND;
+    s.begin     = 0;
+    s.end       = (int64_t)(o.seconds * NS_PER_SECOND);
+    s.truth     = w.speed;
+
+    Lcg     rng(seed);
+    double  full     = FullSpeedCounts(s.config);
+    double  interval = 1.0 / o.mouseHz;
+    double  noise    = 0.6 * sqrt(interval * 1000.0);
+    double  carry    = 0.0;
+    double  prev     = 0.0;
+    for (double t = interval; t < o.seconds; t += interval) {
+        double report = t + 0.1 * interval * rng.Next();
+        double moved  = w.speed(report) * full * (report - prev);
+        if (moved > 0.0) moved += noise * (rng.Next() + rng.Next());
+        carry += moved;
+        prev = report;
+
+        int32_t counts = (int32_t)floor(carry);
+        if (counts == 0) continue;
+        carry -= counts;
+        s.events.push_back({ (int64_t)llround(report * NS_PER_SECOND), 0, -counts });
+    }
+    return s;
+}
+
+// The primary sensor's deltas of an app trace, with the forward config
+// in force at the first of them
+bool LoadTraceSession(const char* path, Session* s)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "error: cannot open %s\n", path);
+        return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[64 * 1024];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) data.insert(data.end(), chunk, chunk + n);
+    fclose(f);
+
+    VelocityTraceReader reader;
+    if (!VelocityTraceOpen(&reader, data.data(), data.size())) {
+        fprintf(stderr, "error: %s is not a v%d velocity trace\n", path, VELOCITY_TRACE_VERSION);
+        return false;
+    }
+
+    s->name      = path;
+    s->frequency = reader.header.timestampFrequency;
+    s->truth     = NULL;
+    TreadmillInput_DefaultConfig(&s->config);
+
+    bool configured = false;
+    VelocityTraceRecord rec;
+    while (VelocityTraceNext(&reader, &rec)) {
+        if (rec.type == VELOCITY_TRACE_CONFIG && rec.channel == VELOCITY_TRACE_AXIS_FORWARD && !configured) {
+            VelocityTraceConfig c;
+            VelocityTracePayload(&rec, &c);
+            s->config.sensitivity     = c.sensitivity;
+            s->config.deadZone        = c.deadZone;
+            s->config.smoothing       = c.smoothing;
+            s->config.maxSpeed        = c.maxSpeed;
+            s->config.invertDirection = c.invertDirection;
+            if (c.filter != TREADMILL_INPUT_FILTER_EMA) s->config.adaptivity = c.adaptivity;  // else maybe not recorded
+            if (!s->events.empty()) configured = true;
+        } else if (rec.type == VELOCITY_TRACE_DELTA && rec.channel == VELOCITY_TRACE_SENSOR_PRIMARY) {
+            VelocityTraceDelta d;
+            VelocityTracePayload(&rec, &d);
+            if (d.dy) s->events.push_back({ rec.timestamp, d.dx, d.dy });
+            configured = true;
+        }
+    }
+    if (s->events.empty()) {
+        fprintf(stderr, "error: %s has no primary sensor deltas\n", path);
+        return false;
+    }
+    std::stable_sort(s->events.begin(), s->events.end(),
+                     [](const TreadmillInputEvent& a, const TreadmillInputEvent& b) { return a.timestamp < b.timestamp; });
+    s->begin = s->events.front().timestamp - s->frequency / 2;
+    s->end   = s->events.back().timestamp + s->frequency;
+    return true;
+}
+
+// ─── Paths ──────────────────────────────────────────────────────
+
+struct Series {
+    std::vector<int64_t>    t;
+    std::vector<double>     v;
+};
+
+// InputProcessor: each jittered app tick steps EMA over the deltas that
+// arrived, or hands an adaptive filter the events themselves
+Series TickPath(const Session& s, const TreadmillInputConfig& config, const Options& o, uint32_t seed)
+{
+    TreadmillInputState state;
+    TreadmillInput_Reset(&state, s.begin);
+
+    Series  out;
+    Lcg     rng(seed);
+    int64_t period = s.frequency / o.tickHz;
+    int64_t last   = s.begin;
+    size_t  next   = 0;
+    for (int64_t grid = s.begin + period; grid < s.end; grid += period) {
+        int64_t tick  = grid + (int64_t)(rng.Next() * 0.5 * (double)s.frequency / 1000.0);
+        size_t  first = next;
+        double  sum   = 0.0;
+        while (next < s.events.size() && s.events[next].timestamp <= tick) sum += s.events[next++].dy;
+
+        out.t.push_back(tick);
+        if (config.filter == TREADMILL_INPUT_FILTER_EMA)
+            out.v.push_back(TreadmillInput_Step(&state, &config, sum, (double)(tick - last) / (double)s.frequency));
+        else
+            out.v.push_back(TreadmillInput_ProcessEvents(&state, &config, &s.events[first],
+                                                         (uint32_t)(next - first), tick, s.frequency));
+        last = tick;
+    }
+    return out;
+}
+
+// FrameVelocityFilterRawDeltas: each jittered frame filters the events
+// since the last one, idling only up to RAW_DELTA_IDLE_MS ago
+Series RawPath(const Session& s, const TreadmillInputConfig& config, const Options& o, uint32_t seed)
+{
+    TreadmillInputState state;
+    TreadmillInput_Reset(&state, s.begin);
+
+    Series  out;
+    Lcg     rng(seed);
+    int64_t period = s.frequency / o.rateHz;
+    int64_t idle   = s.frequency * RAW_DELTA_IDLE_MS / 1000;
+    size_t  next   = 0;
+    for (int64_t grid = s.begin + period; grid < s.end; grid += period) {
+        int64_t sync  = grid + (int64_t)(rng.Next() * (double)s.frequency / 1000.0);
+        size_t  first = next;
+        while (next < s.events.size() && s.events[next].timestamp <= sync) next++;
+        uint32_t n = (uint32_t)(next - first);
+        if (n) {
+            int64_t newest = std::max(s.events[next - 1].timestamp, state.lastTimestamp);
+            TreadmillInput_ProcessEvents(&state, &config, &s.events[first], n, newest, s.frequency);
+        }
+        TreadmillInput_ProcessEvents(&state, &config, NULL, 0, sync - idle, s.frequency);
+
+        out.t.push_back(sync);
+        out.v.push_back(state.velocity);
+    }
+    return out;
+}
+
+// ─── Metrics ────────────────────────────────────────────────────
+
+// The speed at each of `t`: the truth, or the counts' centred-window rate
+std::vector<double> Reference(const Session& s, const std::vector<int64_t>& t)
+{
+    std::vector<double> ref(t.size());
+    if (s.truth) {
+        for (size_t i = 0; i < t.size(); i++) ref[i] = s.truth((double)(t[i] - s.begin) / (double)s.frequency);
+        return ref;
+    }
+
+    // Prefix sums of counts; direction and normalisation as the core's
+    std::vector<double> sum(s.events.size() + 1, 0.0);
+    for (size_t i = 0; i < s.events.size(); i++) sum[i + 1] = sum[i] + s.events[i].dy;
+    double direction = s.config.invertDirection ? 1.0 : -1.0;
+    int64_t half     = s.frequency * REFERENCE_WINDOW_MS / 2000;
+    auto countBefore = [&](int64_t at) {
+        return (size_t)(std::upper_bound(s.events.begin(), s.events.end(), at,
+                        [](int64_t v, const TreadmillInputEvent& e) { return v < e.timestamp; }) - s.events.begin());
+    };
+    for (size_t i = 0; i < t.size(); i++) {
+        double counts = sum[countBefore(t[i] + half)] - sum[countBefore(t[i] - half)];
+        double rate   = counts * (double)s.frequency / (double)(2 * half);
+        ref[i] = std::min(1.0, std::max(-1.0, direction * rate / FullSpeedCounts(s.config)));
+    }
+    return ref;
+}
+
+struct Metrics {
+    double  riseMs      = 0.0;      // averaged over the walks found
+    double  fallMs      = 0.0;
+    double  jitter      = 0.0;      // % of full speed
+    int     walks       = 0;
+};
+
+// First index from `from` where `pred(i)` holds; `end` if none
+template <typename Pred>
+size_t FirstFrom(size_t from, size_t end, Pred pred)
+{
+    for (size_t i = from; i < end; i++) if (pred(i)) return i;
+    return end;
+}
+
+Metrics Measure(const Series& s, const std::vector<double>& ref, int64_t frequency)
+{
+    Metrics m;
+    size_t  n = ref.size();
+    auto seconds = [&](size_t i) { return (double)s.t[i] / (double)frequency; };
+    auto ms      = [&](size_t a, size_t b) { return (double)(s.t[b] - s.t[a]) * 1000.0 / (double)frequency; };
+
+    double sumSq = 0.0;
+    size_t steady = 0;
+    for (size_t start = FirstFrom(0, n, [&](size_t i) { return fabs(ref[i]) >= START_LEVEL; });
+         start < n;
+         start = FirstFrom(start, n, [&](size_t i) { return fabs(ref[i]) >= START_LEVEL; })) {
+        size_t stop = FirstFrom(start, n, [&](size_t i) { return fabs(ref[i]) < START_LEVEL; });
+
+        // Plateau: 0.4 … 1 s in; walks too short for one are skipped
+        double plateau = 0.0;
+        size_t samples = 0;
+        for (size_t i = start; i < stop && seconds(i) < seconds(start) + 1.0; i++)
+            if (seconds(i) >= seconds(start) + 0.4) { plateau += fabs(ref[i]); samples++; }
+        if (!samples || stop == n) { start = stop; continue; }
+        plateau /= (double)samples;
+
+        size_t refRise = FirstFrom(start, stop, [&](size_t i) { return fabs(ref[i]) >= 0.9 * plateau; });
+        size_t outRise = FirstFrom(start, n,    [&](size_t i) { return fabs(s.v[i]) >= 0.9 * plateau; });
+
+        // Falling from the last time the speed was still half the plateau
+        size_t from = stop;
+        while (from > start && fabs(ref[from - 1]) < 0.5 * plateau) from--;
+        size_t refFall = FirstFrom(from, n, [&](size_t i) { return fabs(ref[i]) <= 0.1 * plateau; });
+        size_t outFall = FirstFrom(from, n, [&](size_t i) { return fabs(s.v[i]) <= 0.1 * plateau; });
+        if (refRise == stop || outRise == n || refFall == n || outFall == n) { start = stop; continue; }
+
+        m.riseMs += outRise > refRise ? ms(refRise, outRise) : -ms(outRise, refRise);
+        m.fallMs += outFall > refFall ? ms(refFall, outFall) : -ms(outFall, refFall);
+        m.walks++;
+
+        // Steady: from 0.5 s after the start to 0.2 s before the stop
+        for (size_t i = start; i < stop; i++) {
+            if (seconds(i) < seconds(start) + 0.5 || seconds(i) > seconds(stop) - 0.2) continue;
+            double d = s.v[i] - ref[i];
+            sumSq += d * d;
+            steady++;
+        }
+        start = stop;
+    }
+    if (m.walks) {
+        m.riseMs /= m.walks;
+        m.fallMs /= m.walks;
+    }
+    m.jitter = steady ? 100.0 * sqrt(sumSq / (double)steady) : 0.0;
+    return m;
+}
+
+// ─── Report ─────────────────────────────────────────────────────
+
+struct Row {
+    Metrics tick, raw;
+};
+
+void Replay(const Session& s, const Options& o, uint32_t seed, Row rows[TREADMILL_INPUT_FILTER_COUNT])
+{
+    printf("\n%s, %zu events\n", s.name.c_str(), s.events.size());
+    printf("  %-9s  %9s %9s %8s  %9s %9s %8s\n", "filter", "tick rise", "fall", "jitter", "raw rise", "fall", "jitter");
+    for (int f = 0; f < TREADMILL_INPUT_FILTER_COUNT; f++) {
+        TreadmillInputConfig config = s.config;
+        config.filter = f;
+        if (o.smoothing >= 0.0)  config.smoothing  = o.smoothing;
+        if (o.adaptivity >= 0.0) config.adaptivity = o.adaptivity;
+
+        Series tick = TickPath(s, config, o, seed);
+        Series raw  = RawPath(s, config, o, seed + 1);
+        Row& r = rows[f];
+        r.tick = Measure(tick, Reference(s, tick.t), s.frequency);
+        r.raw  = Measure(raw, Reference(s, raw.t), s.frequency);
+        if (!r.tick.walks) {
+            printf("  %-9s  no walk from rest found\n", kFilterNames[f]);
+            continue;
+        }
+        printf("  %-9s  %6.1f ms %6.1f ms %7.2f%%  %6.1f ms %6.1f ms %7.2f%%\n", kFilterNames[f],
+               r.tick.riseMs, r.tick.fallMs, r.tick.jitter, r.raw.riseMs, r.raw.fallMs, r.raw.jitter);
+    }
+}
+
+bool Better(const Metrics& adaptive, const Metrics& ema)
+{
+    return adaptive.walks && adaptive.riseMs < ema.riseMs && adaptive.jitter <= ema.jitter * JITTER_TOLERANCE;
+}
+
+} // namespace
+
+// ─── Main ───────────────────────────────────────────────────────
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if (!ParseOptions(argc, argv, &opt)) {
+        fprintf(stderr, "usage: %s [--trace FILE]... [--mouse-hz HZ] [--tick-hz HZ] [--rate HZ] [--seconds S] "
+                        "[--smoothing S] [--adaptivity A] [--check]\n", argv[0]);
+        return 2;
+    }
+
+    printf("treadmill_filter_replay: %d Hz app tick, %d fps; rise/fall in ms behind the speed, "
+           "jitter in %% of full speed\n", opt.tickHz, opt.rateHz);
+
+    Row rows[TREADMILL_INPUT_FILTER_COUNT];
+    uint32_t seed = 0xF11E0001u;
+    if (!opt.traces.empty()) {
+        for (const std::string& path : opt.traces) {
+            Session s;
+            if (!LoadTraceSession(path.c_str(), &s)) return 1;
+            Replay(s, opt, seed, rows);
+            seed += 2;
+        }
+        return 0;
+    }
+
+    bool improved = true;
+    printf("synthetic walks: %d Hz mouse, %.1f s\n", opt.mouseHz, opt.seconds);
+    for (const Walk& w : kWalks) {
+        Session s = SimulateWalk(w, opt, seed++);
+        Replay(s, opt, seed, rows);
+        seed += 2;
+        for (int f = TREADMILL_INPUT_FILTER_ONE_EURO; f < TREADMILL_INPUT_FILTER_COUNT; f++) {
+            if (!Better(rows[f].tick, rows[TREADMILL_INPUT_FILTER_EMA].tick) ||
+                !Better(rows[f].raw, rows[TREADMILL_INPUT_FILTER_EMA].raw))
+                improved = false;
+        }
+    }
+
+    if (opt.check && !improved) {
+        fprintf(stderr, "\nFAIL: an adaptive filter did not rise faster than EMA at comparable jitter\n");
+        return 1;
+    }
+    return 0;
+}
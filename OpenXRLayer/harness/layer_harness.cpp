@@ -0,0 +1,458 @@
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Layer Latency Harness
+// ═══════════════════════════════════════════════════════════════════
+// Loads treadmill_layer through the mini loader on top of the mock
+// runtime, publishes a treadmill velocity into shared memory and runs a
+// synthetic game loop at each requested refresh rate. Every frame makes
+// the same calls twice — straight to the runtime (pass-through
+// baseline) and through the layer — and times each call individually.
+// Reports p50/p99/p999 per call and the overhead the layer adds.
+//
+// Before the game loop it times instance creation the same way:
+// repeated create/destroy cycles straight to the runtime and through
+// the layer, so the difference is what the layer adds to a title's
+// launch.
+//
+//   treadmill_layer_harness [--layer PATH] [--rates 90,120,144]
+//                           [--frames N] [--startup-runs N] [--no-pace]
+//                           [--json FILE] [--check]
+//
+// --check exits non-zero unless the layer injected the velocity and
+// added less than STARTUP_BUDGET_US to creation at p50, so the harness
+// doubles as an end-to-end smoke test in CI.
+// ═══════════════════════════════════════════════════════════════════
+
+#include "mock_runtime.h"
+#include "layer_platform.h"
+#include "treadmill_shared.h"
+#include "layer_telemetry.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef TREADMILL_LAYER_PATH
+#define TREADMILL_LAYER_PATH "treadmill_layer"
+#endif
+
+#define LAYER_NAME          "XR_APILAYER_TREADMILL_driver"
+#define PRODUCER_RATE_HZ    1000
+#define TEST_VELOCITY       0.5f
+#define STARTUP_BUDGET_US   100.0
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// ─── Options ────────────────────────────────────────────────────
+
+struct Options {
+    std::string         layerPath   = TREADMILL_LAYER_PATH;
+    std::vector<int>    rates       = { 90, 120, 144 };
+    int                 frames      = 900;
+    int                 startupRuns = 200;
+    bool                pace        = true;
+    bool                check       = false;
+    std::string         jsonPath;
+};
+
+bool ParseRates(const char* s, std::vector<int>* rates)
+{
+    rates->clear();
+    while (*s) {
+        char* end;
+        long hz = strtol(s, &end, 10);
+        if (end == s || hz <= 0 || hz > 1000) return false;
+        rates->push_back((int)hz);
+        s = *end == ',' ? end + 1 : end;
+        if (*end && *end != ',') return false;
+    }
+    return !rates->empty();
+}
+
+bool ParseOptions(int argc, char** argv, Options* o)
+{
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(a, "--layer") && hasValue)        o->layerPath = argv[++i];
+        else if (!strcmp(a, "--rates") && hasValue)  { if (!ParseRates(argv[++i], &o->rates)) return false; }
+        else if (!strcmp(a, "--frames") && hasValue) o->frames = atoi(argv[++i]);
+        else if (!strcmp(a, "--startup-runs") && hasValue) o->startupRuns = atoi(argv[++i]);
+        else if (!strcmp(a, "--json") && hasValue)   o->jsonPath = argv[++i];
+        else if (!strcmp(a, "--no-pace"))            o->pace = false;
+        else if (!strcmp(a, "--check"))              o->check = true;
+        else return false;
+    }
+    return o->frames > 0 && o->startupRuns > 0;
+}
+
+// ─── Treadmill Producer ─────────────────────────────────────────
+// Stands in for the companion app: publishes a constant velocity at
+// 1 kHz so samples never go stale.
+
+class Producer {
+public:
+    bool Start()
+    {
+        if (!PlatformSharedMemoryCreate(&m_shm, TREADMILL_SHARED_MEM_NAME, sizeof(TreadmillSharedData)))
+            return false;
+        m_data = (TreadmillSharedData*)m_shm.view;
+        TreadmillSharedInit(m_data, PlatformTimestampFrequency());
+        TreadmillSharedWrite(m_data, TEST_VELOCITY, 1, PlatformTimestamp());
+
+        m_thread = std::thread([this] {
+            while (!m_stop.load(std::memory_order_relaxed)) {
+                TreadmillSharedWrite(m_data, TEST_VELOCITY, 1, PlatformTimestamp());
+                std::this_thread::sleep_for(std::chrono::microseconds(1000000 / PRODUCER_RATE_HZ));
+            }
+        });
+        return true;
+    }
+
+    void Stop()
+    {
+        m_stop.store(true);
+        if (m_thread.joinable()) m_thread.join();
+        PlatformSharedMemoryClose(&m_shm);
+        PlatformSharedMemoryUnlink(TREADMILL_SHARED_MEM_NAME);
+        PlatformSharedMemoryUnlink(TREADMILL_TELEMETRY_MEM_NAME);     // created by the layer
+    }
+
+private:
+    PlatformSharedMemory    m_shm = {};
+    TreadmillSharedData*    m_data = nullptr;
+    std::thread             m_thread;
+    std::atomic<bool>       m_stop{false};
+};
+
+// ─── Synthetic Game ─────────────────────────────────────────────
+// A typical locomotion action set: both thumbsticks, triggers and grips.
+
+struct GameAction {
+    const char* binding;
+    bool        vector2f;
+    float       runtimeY;       // what the mock runtime reports
+};
+
+const GameAction kActions[] = {
+    { "/user/hand/left/input/thumbstick",       true,  0.10f },
+    { "/user/hand/right/input/thumbstick",      true,  0.20f },
+    { "/user/hand/left/input/trigger/value",    false, 0.30f },
+    { "/user/hand/right/input/trigger/value",   false, 0.40f },
+    { "/user/hand/left/input/squeeze/value",    false, 0.50f },
+    { "/user/hand/right/input/squeeze/value",   false, 0.60f },
+};
+const uint32_t kActionCount = sizeof(kActions) / sizeof(kActions[0]);
+
+enum CallKind { CALL_SYNC, CALL_VECTOR2F, CALL_FLOAT, CALL_KIND_COUNT };
+const char* const kCallNames[CALL_KIND_COUNT] = {
+    "xrSyncActions", "xrGetActionStateVector2f", "xrGetActionStateFloat",
+};
+
+struct Samples {
+    std::vector<uint32_t> ns[CALL_KIND_COUNT];
+};
+
+template <typename F>
+inline void Timed(std::vector<uint32_t>* out, F&& call)
+{
+    Clock::time_point t0 = Clock::now();
+    call();
+    Clock::time_point t1 = Clock::now();
+    out->push_back((uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+}
+
+// One frame of input: sync, then query every action.
+void RunFrame(const AppDispatch& d, XrSession session, Samples* samples, float* leftStickY)
+{
+    XrActionsSyncInfo sync = {};
+    sync.type = XR_TYPE_ACTIONS_SYNC_INFO;
+    Timed(&samples->ns[CALL_SYNC], [&] { d.SyncActions(session, &sync); });
+
+    for (uint32_t i = 0; i < kActionCount; i++) {
+        XrActionStateGetInfo info = {};
+        info.type   = XR_TYPE_ACTION_STATE_GET_INFO;
+        info.action = MockRuntime::MakeAction(i);
+
+        if (kActions[i].vector2f) {
+            XrActionStateVector2f state = {};
+            state.type = XR_TYPE_ACTION_STATE_VECTOR2F;
+            Timed(&samples->ns[CALL_VECTOR2F], [&] { d.GetActionStateVector2f(session, &info, &state); });
+            if (i == 0) *leftStickY = state.currentState.y;
+        } else {
+            XrActionStateFloat state = {};
+            state.type = XR_TYPE_ACTION_STATE_FLOAT;
+            Timed(&samples->ns[CALL_FLOAT], [&] { d.GetActionStateFloat(session, &info, &state); });
+        }
+    }
+}
+
+// ─── Statistics ─────────────────────────────────────────────────
+
+struct Percentiles {
+    double p50, p99, p999;
+};
+
+Percentiles Compute(std::vector<uint32_t> v)
+{
+    Percentiles p = {};
+    if (v.empty()) return p;
+    std::sort(v.begin(), v.end());
+    auto at = [&](double q) {
+        size_t i = (size_t)ceil(q * (double)v.size());
+        return (double)v[i == 0 ? 0 : std::min(i, v.size()) - 1];
+    };
+    p.p50  = at(0.50);
+    p.p99  = at(0.99);
+    p.p999 = at(0.999);
+    return p;
+}
+
+struct RateResult {
+    int         hz;
+    int         frames;
+    size_t      calls[CALL_KIND_COUNT];
+    Percentiles baseline[CALL_KIND_COUNT];
+    Percentiles layer[CALL_KIND_COUNT];
+};
+
+// ─── Instance Creation ──────────────────────────────────────────
+// xrCreateInstance and xrDestroyInstance through `layers` (empty for
+// the baseline), `runs` times; only creation is timed.
+
+bool TimeCreation(const std::vector<LoadedLayer>& layers, int runs, std::vector<uint32_t>* ns)
+{
+    for (int i = 0; i < runs; i++) {
+        XrInstance                instance = XR_NULL_HANDLE;
+        PFN_xrGetInstanceProcAddr gipa     = NULL;
+
+        Clock::time_point t0 = Clock::now();
+        XrResult r = MiniLoaderCreateInstance(layers, &instance, &gipa);
+        Clock::time_point t1 = Clock::now();
+        if (XR_FAILED(r)) return false;
+        ns->push_back((uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+
+        PFN_xrDestroyInstance destroy = MiniLoaderResolve<PFN_xrDestroyInstance>(gipa, instance, "xrDestroyInstance");
+        if (!destroy) return false;
+        destroy(instance);
+    }
+    return true;
+}
+
+struct StartupResult {
+    int         runs;
+    Percentiles baseline;
+    Percentiles layer;
+};
+
+void PrintStartup(const StartupResult& r)
+{
+    printf("\nxrCreateInstance, %d runs\n", r.runs);
+    printf("  %-26s %7s | %-22s | %-22s | %s\n", "call (us)", "calls",
+           "baseline p50/p99/p999", "layer p50/p99/p999", "overhead p50/p99/p999");
+    printf("  %-26s %7d | %6.1f %6.1f %8.1f | %6.1f %6.1f %8.1f | %6.1f %6.1f %8.1f\n",
+           "xrCreateInstance", r.runs,
+           r.baseline.p50 / 1000, r.baseline.p99 / 1000, r.baseline.p999 / 1000,
+           r.layer.p50 / 1000, r.layer.p99 / 1000, r.layer.p999 / 1000,
+           (r.layer.p50 - r.baseline.p50) / 1000, (r.layer.p99 - r.baseline.p99) / 1000,
+           (r.layer.p999 - r.baseline.p999) / 1000);
+}
+
+void PrintResult(const RateResult& r)
+{
+    printf("\n%d Hz, %d frames\n", r.hz, r.frames);
+    printf("  %-26s %7s | %-22s | %-22s | %s\n", "call (ns)", "calls",
+           "baseline p50/p99/p999", "layer p50/p99/p999", "overhead p50/p99/p999");
+    for (int k = 0; k < CALL_KIND_COUNT; k++) {
+        const Percentiles& b = r.baseline[k];
+        const Percentiles& l = r.layer[k];
+        printf("  %-26s %7zu | %6.0f %6.0f %8.0f | %6.0f %6.0f %8.0f | %6.0f %6.0f %8.0f\n",
+               kCallNames[k], r.calls[k], b.p50, b.p99, b.p999, l.p50, l.p99, l.p999,
+               l.p50 - b.p50, l.p99 - b.p99, l.p999 - b.p999);
+    }
+}
+
+bool WriteJson(const char* path, const Options& o, const StartupResult& startup,
+               const std::vector<RateResult>& results)
+{
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+
+    auto pct = [&](const char* name, const Percentiles& p, const char* tail) {
+        fprintf(f, "        \"%s\": { \"p50\": %.0f, \"p99\": %.0f, \"p999\": %.0f }%s\n",
+                name, p.p50, p.p99, p.p999, tail);
+    };
+
+    fprintf(f, "{\n  \"layer\": \"%s\",\n  \"paced\": %s,\n",
+            o.layerPath.c_str(), o.pace ? "true" : "false");
+
+    Percentiles over = { startup.layer.p50 - startup.baseline.p50,
+                         startup.layer.p99 - startup.baseline.p99,
+                         startup.layer.p999 - startup.baseline.p999 };
+    fprintf(f, "  \"create_instance\": { \"count\": %d,\n", startup.runs);
+    pct("baseline_ns", startup.baseline, ",");
+    pct("layer_ns", startup.layer, ",");
+    pct("overhead_ns", over, "");
+    fprintf(f, "  },\n  \"rates\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const RateResult& r = results[i];
+        fprintf(f, "    { \"hz\": %d, \"frames\": %d, \"calls\": [\n", r.hz, r.frames);
+        for (int k = 0; k < CALL_KIND_COUNT; k++) {
+            Percentiles over = { r.layer[k].p50 - r.baseline[k].p50,
+                                 r.layer[k].p99 - r.baseline[k].p99,
+                                 r.layer[k].p999 - r.baseline[k].p999 };
+            fprintf(f, "      { \"name\": \"%s\", \"count\": %zu,\n", kCallNames[k], r.calls[k]);
+            pct("baseline_ns", r.baseline[k], ",");
+            pct("layer_ns", r.layer[k], ",");
+            pct("overhead_ns", over, "");
+            fprintf(f, "      }%s\n", k + 1 < CALL_KIND_COUNT ? "," : "");
+        }
+        fprintf(f, "    ] }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    return true;
+}
+
+} // namespace
+
+// ─── Main ───────────────────────────────────────────────────────
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if (!ParseOptions(argc, argv, &opt)) {
+        fprintf(stderr, "usage: %s [--layer PATH] [--rates 90,120,144] [--frames N] "
+                        "[--startup-runs N] [--no-pace] [--json FILE] [--check]\n", argv[0]);
+        return 2;
+    }
+
+    Producer producer;
+    if (!producer.Start()) {
+        fprintf(stderr, "error: cannot create shared memory '%s'\n", TREADMILL_SHARED_MEM_NAME);
+        return 1;
+    }
+
+    std::vector<LoadedLayer> layers(1);
+    std::string error;
+    if (!MiniLoaderLoadLayer(opt.layerPath.c_str(), LAYER_NAME, &layers[0], &error)) {
+        fprintf(stderr, "error: %s: %s\n", opt.layerPath.c_str(), error.c_str());
+        producer.Stop();
+        return 1;
+    }
+
+    printf("treadmill_layer_harness: %s\n", opt.layerPath.c_str());
+
+    // Alternating halves, like the frame loop, so neither side always runs warm
+    StartupResult startup = {};
+    std::vector<uint32_t> createBase, createLayer;
+    std::vector<LoadedLayer> none;
+    startup.runs = opt.startupRuns;
+    for (int half = 0; half < 2; half++) {
+        int runs = half ? opt.startupRuns - opt.startupRuns / 2 : opt.startupRuns / 2;
+        if (!TimeCreation(half ? layers : none, runs, half ? &createLayer : &createBase) ||
+            !TimeCreation(half ? none : layers, runs, half ? &createBase : &createLayer)) {
+            fprintf(stderr, "error: create/destroy cycle failed\n");
+            producer.Stop();
+            return 1;
+        }
+    }
+    startup.baseline = Compute(createBase);
+    startup.layer    = Compute(createLayer);
+    PrintStartup(startup);
+
+    XrInstance                  instance = XR_NULL_HANDLE;
+    PFN_xrGetInstanceProcAddr   gipa     = NULL;
+    AppDispatch                 layered  = {};
+    AppDispatch                 baseline = {};
+    XrSession                   session  = XR_NULL_HANDLE;
+    if (XR_FAILED(MiniLoaderCreateInstance(layers, &instance, &gipa)) ||
+        !MiniLoaderResolveDispatch(gipa, instance, &layered) ||
+        XR_FAILED(MiniLoaderCreateSession(layered, instance, &session)) ||
+        !MiniLoaderResolveDispatch(MockRuntime::GetInstanceProcAddr, instance, &baseline)) {
+        fprintf(stderr, "error: instance creation through the layer failed\n");
+        producer.Stop();
+        return 1;
+    }
+
+    // Bindings go through the layer so it can find the left thumbstick
+    std::vector<XrActionSuggestedBinding> bindings;
+    for (uint32_t i = 0; i < kActionCount; i++) {
+        XrActionSuggestedBinding b = {};
+        b.action = MockRuntime::MakeAction(i);
+        layered.StringToPath(instance, kActions[i].binding, &b.binding);
+        bindings.push_back(b);
+        MockRuntime::SetActionValue(b.action, 0.0f, kActions[i].runtimeY);
+    }
+    XrInteractionProfileSuggestedBinding suggested = {};
+    suggested.type                   = XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING;
+    suggested.countSuggestedBindings = (uint32_t)bindings.size();
+    suggested.suggestedBindings      = bindings.data();
+    layered.SuggestInteractionProfileBindings(instance, &suggested);
+
+    std::vector<RateResult> results;
+    float leftStickY = 0.0f;
+    for (int hz : opt.rates) {
+        Samples base, layer;
+        for (int k = 0; k < CALL_KIND_COUNT; k++) {
+            base.ns[k].reserve((size_t)opt.frames * kActionCount);
+            layer.ns[k].reserve((size_t)opt.frames * kActionCount);
+        }
+
+        Clock::duration   period   = std::chrono::nanoseconds(1000000000LL / hz);
+        Clock::time_point deadline = Clock::now();
+        for (int frame = 0; frame < opt.frames; frame++) {
+            // Alternate the order so neither path always runs cache-warm
+            float ignored;
+            if (frame & 1) {
+                RunFrame(baseline, session, &base, &ignored);
+                RunFrame(layered, session, &layer, &leftStickY);
+            } else {
+                RunFrame(layered, session, &layer, &leftStickY);
+                RunFrame(baseline, session, &base, &ignored);
+            }
+
+            if (opt.pace) {
+                deadline += period;
+                std::this_thread::sleep_until(deadline);
+            }
+        }
+
+        RateResult r = {};
+        r.hz     = hz;
+        r.frames = opt.frames;
+        for (int k = 0; k < CALL_KIND_COUNT; k++) {
+            r.calls[k]    = layer.ns[k].size();
+            r.baseline[k] = Compute(base.ns[k]);
+            r.layer[k]    = Compute(layer.ns[k]);
+        }
+        PrintResult(r);
+        results.push_back(r);
+    }
+
+    layered.DestroyInstance(instance);
+    MiniLoaderUnloadLayer(&layers[0]);
+    producer.Stop();
+
+    if (!opt.jsonPath.empty() && !WriteJson(opt.jsonPath.c_str(), opt, startup, results)) {
+        fprintf(stderr, "error: cannot write %s\n", opt.jsonPath.c_str());
+        return 1;
+    }
+
+    float expected = kActions[0].runtimeY + TEST_VELOCITY;
+    bool  injected = fabsf(leftStickY - expected) < 1e-6f;
+    printf("\nleft thumbstick y: runtime %.2f -> layer %.2f (%s)\n",
+           kActions[0].runtimeY, leftStickY, injected ? "injected" : "NOT injected");
+    double added   = (startup.layer.p50 - startup.baseline.p50) / 1000;
+    bool   fast    = added < STARTUP_BUDGET_US;
+    printf("instance creation: +%.1f us at p50 (%s %.0f us)\n", added, fast ? "within" : "OVER", STARTUP_BUDGET_US);
+    return opt.check && !(injected && fast) ? 1 : 0;
+}
@@ -0,0 +1,498 @@
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Mock OpenXR Runtime + Mini Loader
+// ═══════════════════════════════════════════════════════════════════
+
+#include "mock_runtime.h"
+#include "layer_platform.h"
+
+#include <atomic>
+#include <mutex>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#include <time.h>
+#endif
+
+// ─── Mock Runtime ───────────────────────────────────────────────
+
+namespace MockRuntime {
+namespace {
+
+#define MOCK_MAX_ACTIONS    256
+#define MOCK_ACTION_BASE    0x1000
+#define MOCK_ACTION_STRIDE  16
+
+// Handles are base + index * stride, like a runtime's pointers
+#define MOCK_MAX_INSTANCES      64
+#define MOCK_INSTANCE_BASE      0xA11CE000
+#define MOCK_SESSION_BASE       0x5E550000
+#define MOCK_HANDLE_STRIDE      0x40
+
+// XrTime 0 is 1000 s after the host clock's zero, so a layer that skips
+// the conversion predicts to the wrong time and tests notice.
+const XrTime     kXrTimeEpoch           = 1000LL * 1000000000;
+const XrDuration kDisplayPeriod         = 1000000000 / 90;
+
+struct ActionValue {
+    float   x;
+    float   y;
+    bool    active;
+};
+
+struct MockInstance {
+    bool    created;
+    bool    timeExtEnabled;
+    bool    hasSession;
+};
+
+MockInstance                g_instances[MOCK_MAX_INSTANCES];
+std::mutex                  g_instanceLock;     // instance creation and destruction
+bool                        g_timeConversionSupported = true;
+XrDuration                  g_displayLead = 0;
+std::vector<std::string>    g_paths;            // XrPath = index + 1
+ActionValue                 g_values[MOCK_MAX_ACTIONS];
+
+std::atomic<uint64_t>       g_syncCount{0};
+std::atomic<uint64_t>       g_suggestCount{0};
+std::atomic<uint64_t>       g_getFloatCount{0};
+std::atomic<uint64_t>       g_getVector2fCount{0};
+std::atomic<uint64_t>       g_pathToStringCount{0};
+
+XrTime TicksToXrTime(int64_t ticks)
+{
+    int64_t f = PlatformTimestampFrequency();
+    return (ticks / f) * 1000000000 + (ticks % f) * 1000000000 / f + kXrTimeEpoch;
+}
+
+int64_t XrTimeToTicks(XrTime time)
+{
+    int64_t ns = time - kXrTimeEpoch;
+    int64_t f  = PlatformTimestampFrequency();
+    return (ns / 1000000000) * f + (ns % 1000000000) * f / 1000000000;
+}
+
+// Index of a live instance, or -1.
+int InstanceIndex(XrInstance instance)
+{
+    uintptr_t h = (uintptr_t)instance;
+    if (h < MOCK_INSTANCE_BASE || (h - MOCK_INSTANCE_BASE) % MOCK_HANDLE_STRIDE) return -1;
+    uintptr_t i = (h - MOCK_INSTANCE_BASE) / MOCK_HANDLE_STRIDE;
+    return i < MOCK_MAX_INSTANCES && g_instances[i].created ? (int)i : -1;
+}
+
+XrSession SessionHandle(int index)
+{
+    return (XrSession)(uintptr_t)(MOCK_SESSION_BASE + (uintptr_t)index * MOCK_HANDLE_STRIDE);
+}
+
+// Whether `session` is live (its instance's index matches).
+bool SessionValid(XrSession session)
+{
+    uintptr_t h = (uintptr_t)session;
+    if (h < MOCK_SESSION_BASE || (h - MOCK_SESSION_BASE) % MOCK_HANDLE_STRIDE) return false;
+    uintptr_t i = (h - MOCK_SESSION_BASE) / MOCK_HANDLE_STRIDE;
+    return i < MOCK_MAX_INSTANCES && g_instances[i].created && g_instances[i].hasSession;
+}
+
+const ActionValue* FindValue(XrAction action)
+{
+    uintptr_t h = (uintptr_t)action;
+    if (h < MOCK_ACTION_BASE || (h - MOCK_ACTION_BASE) % MOCK_ACTION_STRIDE) return NULL;
+    uintptr_t i = (h - MOCK_ACTION_BASE) / MOCK_ACTION_STRIDE;
+    return i < MOCK_MAX_ACTIONS ? &g_values[i] : NULL;
+}
+
+XrResult XRAPI_CALL Mock_xrDestroyInstance(XrInstance instance)
+{
+    std::lock_guard<std::mutex> lock(g_instanceLock);
+    int i = InstanceIndex(instance);
+    if (i < 0) return XR_ERROR_HANDLE_INVALID;
+    g_instances[i] = {};        // and its session
+    return XR_SUCCESS;
+}
+
+XrResult XRAPI_CALL Mock_xrCreateSession(XrInstance instance, const XrSessionCreateInfo* createInfo,
+                                         XrSession* session)
+{
+    int i = InstanceIndex(instance);
+    if (i < 0) return XR_ERROR_HANDLE_INVALID;
+    (void)createInfo;
+    if (g_instances[i].hasSession) return XR_ERROR_LIMIT_REACHED;
+    g_instances[i].hasSession = true;
+    *session = SessionHandle(i);
+    return XR_SUCCESS;
+}
+
+XrResult XRAPI_CALL Mock_xrDestroySession(XrSession session)
+{
+    if (!SessionValid(session)) return XR_ERROR_HANDLE_INVALID;
+    g_instances[((uintptr_t)session - MOCK_SESSION_BASE) / MOCK_HANDLE_STRIDE].hasSession = false;
+    return XR_SUCCESS;
+}
+
+XrResult XRAPI_CALL Mock_xrStringToPath(XrInstance instance, const char* pathString, XrPath* path)
+{
+    if (InstanceIndex(instance) < 0) return XR_ERROR_HANDLE_INVALID;
+    for (size_t i = 0; i < g_paths.size(); i++) {
+        if (g_paths[i] == pathString) {
+            *path = (XrPath)(i + 1);
+            return XR_SUCCESS;
+        }
+    }
+    g_paths.push_back(pathString);
+    *path = (XrPath)g_paths.size();
+    return XR_SUCCESS;
+}
+
+XrResult XRAPI_CALL Mock_xrPathToString(XrInstance instance, XrPath path,
+                                        uint32_t bufferCapacityInput, uint32_t* bufferCountOutput, char* buffer)
+{
+    if (InstanceIndex(instance) < 0) return XR_ERROR_HANDLE_INVALID;
+    if (path == XR_NULL_PATH || path > g_paths.size()) return XR_ERROR_HANDLE_INVALID;
+    g_pathToStringCount.fetch_add(1, std::memory_order_relaxed);
+
+    const std::string& s = g_paths[(size_t)path - 1];
+    *bufferCountOutput = (uint32_t)s.size() + 1;
+    if (bufferCapacityInput == 0) return XR_SUCCESS;
+    if (bufferCapacityInput < s.size() + 1) return XR_ERROR_HANDLE_INVALID;
+    memcpy(buffer, s.c_str(), s.size() + 1);
+    return XR_SUCCESS;
+}
+
+XrResult XRAPI_CALL Mock_xrSuggestInteractionProfileBindings(
+    XrInstance instance, const XrInteractionProfileSuggestedBinding* suggestedBindings)
+{
+    if (InstanceIndex(instance) < 0) return XR_ERROR_HANDLE_INVALID;
+    (void)suggestedBindings;
+    g_suggestCount.fetch_add(1, std::memory_order_relaxed);
+    return XR_SUCCESS;
+}
+
+XrResult XRAPI_CALL Mock_xrSyncActions(XrSession session, const XrActionsSyncInfo* syncInfo)
+{
+    if (!SessionValid(session)) return XR_ERROR_HANDLE_INVALID;
+    (void)syncInfo;
+    g_syncCount.fetch_add(1, std::memory_order_relaxed);
+    return XR_SUCCESS;
+}
+
+XrResult XRAPI_CALL Mock_xrGetActionStateFloat(XrSession session, const XrActionStateGetInfo* getInfo,
+                                               XrActionStateFloat* state)
+{
+    if (!SessionValid(session)) return XR_ERROR_HANDLE_INVALID;
+    g_getFloatCount.fetch_add(1, std::memory_order_relaxed);
+
+    const ActionValue* v = FindValue(getInfo->action);
+    state->currentState         = v ? v->y : 0.0f;
+    state->changedSinceLastSync = XR_FALSE;
+    state->lastChangeTime       = 0;
+    state->isActive             = v && v->active ? XR_TRUE : XR_FALSE;
+    return XR_SUCCESS;
+}
+
+XrResult XRAPI_CALL Mock_xrGetActionStateVector2f(XrSession session, const XrActionStateGetInfo* getInfo,
+                                                  XrActionStateVector2f* state)
+{
+    if (!SessionValid(session)) return XR_ERROR_HANDLE_INVALID;
+    g_getVector2fCount.fetch_add(1, std::memory_order_relaxed);
+
+    const ActionValue* v = FindValue(getInfo->action);
+    state->currentState.x       = v ? v->x : 0.0f;
+    state->currentState.y       = v ? v->y : 0.0f;
+    state->changedSinceLastSync = XR_FALSE;
+    state->lastChangeTime       = 0;
+    state->isActive             = v && v->active ? XR_TRUE : XR_FALSE;
+    return XR_SUCCESS;
+}
+
+XrResult XRAPI_CALL Mock_xrWaitFrame(XrSession session, const XrFrameWaitInfo* frameWaitInfo,
+                                     XrFrameState* frameState)
+{
+    if (!SessionValid(session)) return XR_ERROR_HANDLE_INVALID;
+    (void)frameWaitInfo;
+    frameState->predictedDisplayTime   = TicksToXrTime(PlatformTimestamp()) + g_displayLead;
+    frameState->predictedDisplayPeriod = kDisplayPeriod;
+    frameState->shouldRender           = XR_TRUE;
+    return XR_SUCCESS;
+}
+
+#ifdef _WIN32
+XrResult XRAPI_CALL Mock_xrConvertTime(XrInstance instance, XrTime time, LARGE_INTEGER* performanceCounter)
+{
+    if (InstanceIndex(instance) < 0) return XR_ERROR_HANDLE_INVALID;
+    performanceCounter->QuadPart = XrTimeToTicks(time);
+    return XR_SUCCESS;
+}
+#else
+XrResult XRAPI_CALL Mock_xrConvertTime(XrInstance instance, XrTime time, struct timespec* timespecTime)
+{
+    if (InstanceIndex(instance) < 0) return XR_ERROR_HANDLE_INVALID;
+    int64_t ns = XrTimeToTicks(time);     // posix ticks are nanoseconds
+    timespecTime->tv_sec  = ns / 1000000000;
+    timespecTime->tv_nsec = ns % 1000000000;
+    return XR_SUCCESS;
+}
+#endif
+
+} // namespace
+
+XrResult XRAPI_CALL GetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function)
+{
+    *function = NULL;
+
+#define MOCK_ENTRY(fn) if (strcmp(name, #fn) == 0) { *function = (PFN_xrVoidFunction)Mock_##fn; return XR_SUCCESS; }
+    MOCK_ENTRY(xrDestroyInstance)
+    MOCK_ENTRY(xrCreateSession)
+    MOCK_ENTRY(xrDestroySession)
+    MOCK_ENTRY(xrStringToPath)
+    MOCK_ENTRY(xrPathToString)
+    MOCK_ENTRY(xrSuggestInteractionProfileBindings)
+    MOCK_ENTRY(xrSyncActions)
+    MOCK_ENTRY(xrGetActionStateFloat)
+    MOCK_ENTRY(xrGetActionStateVector2f)
+    MOCK_ENTRY(xrWaitFrame)
+#undef MOCK_ENTRY
+
+    // Extension entry points only exist on instances that enabled the extension
+    int i = InstanceIndex(instance);
+    if (i >= 0 && g_instances[i].timeExtEnabled && strcmp(name, kPlatformXrTimeConvertFn) == 0) {
+        *function = (PFN_xrVoidFunction)Mock_xrConvertTime;
+        return XR_SUCCESS;
+    }
+
+    if (strcmp(name, "xrGetInstanceProcAddr") == 0) {
+        *function = (PFN_xrVoidFunction)GetInstanceProcAddr;
+        return XR_SUCCESS;
+    }
+    return XR_ERROR_FUNCTION_UNSUPPORTED;
+}
+
+XrResult XRAPI_CALL CreateApiLayerInstance(const XrInstanceCreateInfo* info,
+                                           const XrApiLayerCreateInfo* layerInfo,
+                                           XrInstance* instance)
+{
+    (void)layerInfo;
+    std::lock_guard<std::mutex> lock(g_instanceLock);
+    int slot = 0;
+    while (slot < MOCK_MAX_INSTANCES && g_instances[slot].created) slot++;
+    if (slot == MOCK_MAX_INSTANCES) return XR_ERROR_LIMIT_REACHED;
+
+    bool timeExt = false;
+    for (uint32_t i = 0; i < info->enabledExtensionCount; i++) {
+        if (!g_timeConversionSupported || strcmp(info->enabledExtensionNames[i], kPlatformXrTimeExtension) != 0)
+            return XR_ERROR_EXTENSION_NOT_PRESENT;
+        timeExt = true;
+    }
+
+    g_instances[slot].created        = true;
+    g_instances[slot].timeExtEnabled = timeExt;
+    *instance = (XrInstance)(uintptr_t)(MOCK_INSTANCE_BASE + (uintptr_t)slot * MOCK_HANDLE_STRIDE);
+    return XR_SUCCESS;
+}
+
+void SetActionValue(XrAction action, float x, float y)
+{
+    uintptr_t i = ((uintptr_t)action - MOCK_ACTION_BASE) / MOCK_ACTION_STRIDE;
+    if (i >= MOCK_MAX_ACTIONS) return;
+    g_values[i].x      = x;
+    g_values[i].y      = y;
+    g_values[i].active = true;
+}
+
+void SetDisplayLead(XrDuration lead) { g_displayLead = lead; }
+
+void SetTimeConversionSupported(bool supported) { g_timeConversionSupported = supported; }
+
+XrTime Now() { return TicksToXrTime(PlatformTimestamp()); }
+
+XrAction MakeAction(uint32_t index)
+{
+    return (XrAction)(uintptr_t)(MOCK_ACTION_BASE + (uintptr_t)index * MOCK_ACTION_STRIDE);
+}
+
+Stats GetStats()
+{
+    Stats s;
+    s.syncCount         = g_syncCount.load(std::memory_order_relaxed);
+    s.suggestCount      = g_suggestCount.load(std::memory_order_relaxed);
+    s.getFloatCount     = g_getFloatCount.load(std::memory_order_relaxed);
+    s.getVector2fCount  = g_getVector2fCount.load(std::memory_order_relaxed);
+    s.pathToStringCount = g_pathToStringCount.load(std::memory_order_relaxed);
+    return s;
+}
+
+void Reset()
+{
+    g_paths.clear();
+    memset(g_values, 0, sizeof(g_values));
+    g_timeConversionSupported = true;
+    g_displayLead = 0;
+    g_syncCount.store(0);
+    g_suggestCount.store(0);
+    g_getFloatCount.store(0);
+    g_getVector2fCount.store(0);
+    g_pathToStringCount.store(0);
+}
+
+} // namespace MockRuntime
+
+// ─── Mini Loader ────────────────────────────────────────────────
+
+typedef XrResult(XRAPI_PTR* PFN_xrNegotiateLoaderApiLayerInterface)(
+    const XrNegotiateLoaderInfo* loaderInfo, const char* layerName,
+    XrNegotiateApiLayerRequest* apiLayerRequest);
+
+static void* LoadModule(const char* path, std::string* error)
+{
+#ifdef _WIN32
+    HMODULE m = LoadLibraryA(path);
+    if (!m) *error = "LoadLibrary failed (" + std::to_string(GetLastError()) + ")";
+    return (void*)m;
+#else
+    void* m = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (!m) *error = dlerror();
+    return m;
+#endif
+}
+
+static void* FindSymbol(void* module, const char* name)
+{
+#ifdef _WIN32
+    return (void*)GetProcAddress((HMODULE)module, name);
+#else
+    return dlsym(module, name);
+#endif
+}
+
+static void CloseModule(void* module)
+{
+#ifdef _WIN32
+    FreeLibrary((HMODULE)module);
+#else
+    dlclose(module);
+#endif
+}
+
+bool MiniLoaderLoadLayer(const char* path, const char* layerName, LoadedLayer* layer, std::string* error)
+{
+    void* module = LoadModule(path, error);
+    if (!module) return false;
+
+    PFN_xrNegotiateLoaderApiLayerInterface negotiate =
+        (PFN_xrNegotiateLoaderApiLayerInterface)FindSymbol(module, "xrNegotiateLoaderApiLayerInterface");
+    if (!negotiate) {
+        *error = "xrNegotiateLoaderApiLayerInterface not exported";
+        CloseModule(module);
+        return false;
+    }
+
+    XrNegotiateLoaderInfo info = {};
+    info.structType          = XR_LOADER_INTERFACE_STRUCT_LOADER_INFO;
+    info.structVersion       = 1;
+    info.structSize          = sizeof(info);
+    info.minInterfaceVersion = 1;
+    info.maxInterfaceVersion = 1;
+    info.minApiVersion       = XR_MAKE_VERSION(1, 0, 0);
+    info.maxApiVersion       = XR_MAKE_VERSION(1, 0, 0xFFFFFFFF);
+
+    XrNegotiateApiLayerRequest request = {};
+    request.structType    = XR_LOADER_INTERFACE_STRUCT_API_LAYER_REQUEST;
+    request.structVersion = 1;
+    request.structSize    = sizeof(request);
+
+    XrResult r = negotiate(&info, layerName, &request);
+    if (XR_FAILED(r) || !request.getInstanceProcAddr || !request.createApiLayerInstance) {
+        *error = "negotiation failed (" + std::to_string(r) + ")";
+        CloseModule(module);
+        return false;
+    }
+
+    layer->module                 = module;
+    layer->name                   = layerName;
+    layer->getInstanceProcAddr    = request.getInstanceProcAddr;
+    layer->createApiLayerInstance = request.createApiLayerInstance;
+    return true;
+}
+
+void MiniLoaderUnloadLayer(LoadedLayer* layer)
+{
+    if (layer->module) CloseModule(layer->module);
+    layer->module = NULL;
+}
+
+XrResult MiniLoaderCreateInstance(const std::vector<LoadedLayer>& layers,
+                                  XrInstance* instance, PFN_xrGetInstanceProcAddr* gipa,
+                                  const char* applicationName, const char* engineName)
+{
+    XrInstanceCreateInfo info = {};
+    info.type = XR_TYPE_INSTANCE_CREATE_INFO;
+    strncpy(info.applicationInfo.applicationName, applicationName, sizeof(info.applicationInfo.applicationName) - 1);
+    strncpy(info.applicationInfo.engineName, engineName, sizeof(info.applicationInfo.engineName) - 1);
+    info.applicationInfo.apiVersion = XR_CURRENT_API_VERSION;
+
+    if (layers.empty()) {
+        *gipa = MockRuntime::GetInstanceProcAddr;
+        return MockRuntime::CreateApiLayerInstance(&info, NULL, instance);
+    }
+
+    // nextInfo[i] describes what layer i chains to: layer i+1, or the runtime
+    std::vector<XrApiLayerNextInfo> next(layers.size());
+    for (size_t i = 0; i < layers.size(); i++) {
+        XrApiLayerNextInfo& n = next[i];
+        n.structType    = XR_LOADER_INTERFACE_STRUCT_API_LAYER_NEXT_INFO;
+        n.structVersion = 1;
+        n.structSize    = sizeof(n);
+        if (i + 1 < layers.size()) {
+            strncpy(n.layerName, layers[i + 1].name.c_str(), sizeof(n.layerName) - 1);
+            n.nextGetInstanceProcAddr    = layers[i + 1].getInstanceProcAddr;
+            n.nextCreateApiLayerInstance = layers[i + 1].createApiLayerInstance;
+            n.next                       = &next[i + 1];
+        } else {
+            strncpy(n.layerName, "mock_runtime", sizeof(n.layerName) - 1);
+            n.nextGetInstanceProcAddr    = MockRuntime::GetInstanceProcAddr;
+            n.nextCreateApiLayerInstance = MockRuntime::CreateApiLayerInstance;
+            n.next                       = NULL;
+        }
+    }
+
+    XrApiLayerCreateInfo layerInfo = {};
+    layerInfo.structType    = XR_LOADER_INTERFACE_STRUCT_API_LAYER_CREATE_INFO;
+    layerInfo.structVersion = 1;
+    layerInfo.structSize    = sizeof(layerInfo);
+    layerInfo.nextInfo      = &next[0];
+
+    XrResult r = layers[0].createApiLayerInstance(&info, &layerInfo, instance);
+    if (XR_SUCCEEDED(r)) *gipa = layers[0].getInstanceProcAddr;
+    return r;
+}
+
+bool MiniLoaderResolveDispatch(PFN_xrGetInstanceProcAddr gipa, XrInstance instance, AppDispatch* d)
+{
+    d->DestroyInstance                   = MiniLoaderResolve<PFN_xrDestroyInstance>(gipa, instance, "xrDestroyInstance");
+    d->CreateSession                     = MiniLoaderResolve<PFN_xrCreateSession>(gipa, instance, "xrCreateSession");
+    d->DestroySession                    = MiniLoaderResolve<PFN_xrDestroySession>(gipa, instance, "xrDestroySession");
+    d->StringToPath                      = MiniLoaderResolve<PFN_xrStringToPath>(gipa, instance, "xrStringToPath");
+    d->SuggestInteractionProfileBindings = MiniLoaderResolve<PFN_xrSuggestInteractionProfileBindings>(
+                                               gipa, instance, "xrSuggestInteractionProfileBindings");
+    d->SyncActions                       = MiniLoaderResolve<PFN_xrSyncActions>(gipa, instance, "xrSyncActions");
+    d->GetActionStateFloat               = MiniLoaderResolve<PFN_xrGetActionStateFloat>(gipa, instance, "xrGetActionStateFloat");
+    d->GetActionStateVector2f            = MiniLoaderResolve<PFN_xrGetActionStateVector2f>(
+                                               gipa, instance, "xrGetActionStateVector2f");
+    d->WaitFrame                         = MiniLoaderResolve<PFN_xrWaitFrame>(gipa, instance, "xrWaitFrame");
+
+    return d->DestroyInstance && d->CreateSession && d->DestroySession && d->StringToPath &&
+           d->SuggestInteractionProfileBindings &&
+           d->SyncActions && d->GetActionStateFloat && d->GetActionStateVector2f && d->WaitFrame;
+}
+
+XrResult MiniLoaderCreateSession(const AppDispatch& dispatch, XrInstance instance, XrSession* session)
+{
+    XrSessionCreateInfo info = {};
+    info.type     = XR_TYPE_SESSION_CREATE_INFO;
+    info.systemId = 1;
+    return dispatch.CreateSession(instance, &info, session);
+}
@@ -0,0 +1,117 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Mock OpenXR Runtime + Mini Loader
+// ═══════════════════════════════════════════════════════════════════
+// Just enough of a runtime and loader to drive treadmill_layer without
+// a headset or the Khronos loader:
+//
+//   • MockRuntime — the terminator of the chain. Creates up to 64
+//     instances, each with at most one session. Interns paths, accepts
+//     binding suggestions, counts syncs and answers xrGetActionState*
+//     with fixed per-action values (set by the test) so any change made
+//     by a layer is visible. xrWaitFrame predicts a display time a fixed
+//     lead ahead, in an XrTime base deliberately offset from the host
+//     clock; the platform's KHR time-conversion extension maps it back.
+//   • MiniLoader — loads a layer library, negotiates with it and builds
+//     the XrApiLayerNextInfo chain down to the mock runtime, the way the
+//     real loader does for implicit layers.
+//
+// Instances may be created and destroyed on several threads at once;
+// the rest of creation is not thread-safe, but xrGetActionState* may
+// be called from any thread.
+// ═══════════════════════════════════════════════════════════════════
+
+#include "openxr_defs.h"
+
+#include <string>
+#include <vector>
+
+// ─── Mock Runtime ───────────────────────────────────────────────
+
+namespace MockRuntime {
+
+struct Stats {
+    uint64_t    syncCount;
+    uint64_t    suggestCount;
+    uint64_t    getFloatCount;
+    uint64_t    getVector2fCount;
+    uint64_t    pathToStringCount;
+};
+
+// Terminator entry points (what the last layer chains to)
+XrResult XRAPI_CALL GetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function);
+XrResult XRAPI_CALL CreateApiLayerInstance(const XrInstanceCreateInfo* info,
+                                           const XrApiLayerCreateInfo* layerInfo,
+                                           XrInstance* instance);
+
+// Fixed value the runtime reports for `action` (default: inactive, 0).
+void SetActionValue(XrAction action, float x, float y);
+
+// xrWaitFrame's predictedDisplayTime = now + `lead` (default 0).
+void SetDisplayLead(XrDuration lead);
+
+// Whether kPlatformXrTimeExtension can be enabled (default true). When
+// false, creating an instance that requests it fails with
+// XR_ERROR_EXTENSION_NOT_PRESENT, like a runtime without it.
+void SetTimeConversionSupported(bool supported);
+
+// Current time in the runtime's XrTime base.
+XrTime Now();
+
+// Handles the harness uses in place of xrCreateAction.
+XrAction    MakeAction(uint32_t index);
+
+Stats       GetStats();
+void        Reset();        // forget paths, values and stats
+
+} // namespace MockRuntime
+
+// ─── Mini Loader ────────────────────────────────────────────────
+
+struct LoadedLayer {
+    void*                           module;
+    std::string                     name;
+    PFN_xrGetInstanceProcAddr       getInstanceProcAddr;
+    PFN_xrCreateApiLayerInstance    createApiLayerInstance;
+};
+
+// Loads and negotiates `path` (LoadLibrary / dlopen). On failure returns
+// false and fills `error`.
+bool MiniLoaderLoadLayer(const char* path, const char* layerName, LoadedLayer* layer, std::string* error);
+void MiniLoaderUnloadLayer(LoadedLayer* layer);
+
+// Creates an instance through `layers` (outermost first; may be empty
+// for a pass-through baseline) down to the mock runtime. `gipa` receives
+// the application-facing xrGetInstanceProcAddr. The names go into
+// XrApplicationInfo, which is what profiles match on.
+XrResult MiniLoaderCreateInstance(const std::vector<LoadedLayer>& layers,
+                                  XrInstance* instance, PFN_xrGetInstanceProcAddr* gipa,
+                                  const char* applicationName = "treadmill_layer_harness",
+                                  const char* engineName = "");
+
+// Resolves `name` through `gipa` (NULL if unsupported).
+template <typename PFN>
+static inline PFN MiniLoaderResolve(PFN_xrGetInstanceProcAddr gipa, XrInstance instance, const char* name)
+{
+    PFN_xrVoidFunction fn = NULL;
+    if (XR_FAILED(gipa(instance, name, &fn))) return NULL;
+    return (PFN)fn;
+}
+
+// The dispatch table an application would resolve after xrCreateInstance.
+struct AppDispatch {
+    PFN_xrDestroyInstance                       DestroyInstance;
+    PFN_xrCreateSession                         CreateSession;
+    PFN_xrDestroySession                        DestroySession;
+    PFN_xrStringToPath                          StringToPath;
+    PFN_xrSuggestInteractionProfileBindings     SuggestInteractionProfileBindings;
+    PFN_xrSyncActions                           SyncActions;
+    PFN_xrGetActionStateFloat                   GetActionStateFloat;
+    PFN_xrGetActionStateVector2f                GetActionStateVector2f;
+    PFN_xrWaitFrame                             WaitFrame;
+};
+
+bool MiniLoaderResolveDispatch(PFN_xrGetInstanceProcAddr gipa, XrInstance instance, AppDispatch* dispatch);
+
+// xrCreateSession as an application calls it after picking a system.
+XrResult MiniLoaderCreateSession(const AppDispatch& dispatch, XrInstance instance, XrSession* session);
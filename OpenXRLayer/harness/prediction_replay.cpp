@@ -0,0 +1,316 @@
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Prediction Replay
+// ═══════════════════════════════════════════════════════════════════
+// Replays velocity traces offline through velocity_predictor.h the way
+// the layer sees them. The companion writes samples at its own rate;
+// the game calls xrSyncActions once per frame at --rate Hz and reads
+// every sample published since the last frame; the frame is displayed
+// --lead-ms later. Each mode's
+// prediction is compared with the trace's value at the display time.
+//
+//   treadmill_prediction_replay [--trace FILE]... [--rate HZ] [--lead-ms MS]
+//                               [--writer-hz HZ] [--json FILE] [--check]
+//
+// A trace is CSV "seconds,velocity", one sample per line; '#' lines and
+// a non-numeric header are skipped. Without --trace, built-in synthetic
+// scenarios are generated by simulating the companion's EMA filter at
+// --writer-hz.
+//
+// --check exits non-zero unless linear prediction beats no prediction
+// (RMS error) on every trace.
+// ═══════════════════════════════════════════════════════════════════
+
+#include "replay_common.h"
+#include "velocity_predictor.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#define PREDICTION_WINDOW_MS        50      // keep in sync with frame_velocity.h
+#define PREDICTION_MAX_HORIZON_MS   50
+#define NS_PER_SECOND               1000000000LL
+
+namespace {
+
+// ─── Options ────────────────────────────────────────────────────
+
+struct Options {
+    std::vector<std::string>    traces;
+    int                         rateHz      = 90;
+    double                      leadMs      = 25.0;
+    int                         writerHz    = 500;
+    bool                        check       = false;
+    std::string                 jsonPath;
+};
+
+bool ParseOptions(int argc, char** argv, Options* o)
+{
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(a, "--trace") && hasValue)           o->traces.push_back(argv[++i]);
+        else if (!strcmp(a, "--rate") && hasValue)      o->rateHz = atoi(argv[++i]);
+        else if (!strcmp(a, "--lead-ms") && hasValue)   o->leadMs = atof(argv[++i]);
+        else if (!strcmp(a, "--writer-hz") && hasValue) o->writerHz = atoi(argv[++i]);
+        else if (!strcmp(a, "--json") && hasValue)      o->jsonPath = argv[++i];
+        else if (!strcmp(a, "--check"))                 o->check = true;
+        else return false;
+    }
+    return o->rateHz > 0 && o->rateHz <= 1000 && o->writerHz > 0 && o->leadMs >= 0.0;
+}
+
+// ─── Traces ─────────────────────────────────────────────────────
+
+struct Sample {
+    int64_t     t;      // ns
+    float       v;
+};
+
+struct Trace {
+    std::string         name;
+    std::vector<Sample> samples;    // strictly increasing t
+};
+
+bool LoadTrace(const char* path, Trace* trace)
+{
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+
+    trace->name = path;
+    trace->samples.clear();
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#') continue;
+        double seconds;
+        float  v;
+        if (sscanf(line, "%lf,%f", &seconds, &v) != 2) continue;
+        int64_t t = (int64_t)llround(seconds * NS_PER_SECOND);
+        if (!trace->samples.empty() && t <= trace->samples.back().t) continue;
+        trace->samples.push_back({ t, v });
+    }
+    fclose(f);
+    return trace->samples.size() >= 2;
+}
+
+// Seed of the sensor noise and frame jitter (Lcg, replay_common.h)
+const uint32_t kNoiseSeed = 0x1234567u;
+
+// Simulates InputProcessor: `target(t)` plus sensor noise, through the
+// tick-scaled EMA (smoothing 0.25 per 16 ms), written at `writerHz`.
+template <typename F>
+Trace Synthesize(const char* name, double seconds, int writerHz, float noise, F target)
+{
+    Trace trace;
+    trace.name = name;
+
+    Lcg    rng(kNoiseSeed);
+    double dt     = 1.0 / writerHz;
+    double alpha  = 1.0 - pow(1.0 - 0.25, dt / 0.016);
+    double smooth = 0.0;
+    for (double t = 0.0; t < seconds; t += dt) {
+        double raw = target(t) + noise * (float)rng.Next();
+        smooth += (raw - smooth) * alpha;
+        trace.samples.push_back({ (int64_t)llround(t * NS_PER_SECOND),
+                                  (float)std::max(-1.0, std::min(1.0, smooth)) });
+    }
+    return trace;
+}
+
+std::vector<Trace> SyntheticTraces(int writerHz)
+{
+    const double kPi = 3.14159265358979323846;
+    std::vector<Trace> traces;
+
+    traces.push_back(Synthesize("walk-start-stop", 8.0, writerHz, 0.02f, [](double t) {
+        if (t < 0.5) return 0.0;
+        if (t < 3.5) return 0.5;
+        if (t < 4.5) return 0.0;
+        if (t < 6.5) return 0.8;
+        return 0.0;
+    }));
+    traces.push_back(Synthesize("intervals", 10.0, writerHz, 0.02f, [=](double t) {
+        return 0.5 + 0.3 * sin(2.0 * kPi * 0.4 * t);
+    }));
+    traces.push_back(Synthesize("stride-noise", 10.0, writerHz, 0.08f, [=](double t) {
+        return 0.6 + 0.15 * sin(2.0 * kPi * 1.8 * t);
+    }));
+    return traces;
+}
+
+// Trace value at `t` (linear interpolation, clamped to the ends)
+float TruthAt(const Trace& trace, int64_t t)
+{
+    const std::vector<Sample>& s = trace.samples;
+    if (t <= s.front().t) return s.front().v;
+    if (t >= s.back().t)  return s.back().v;
+    auto it = std::upper_bound(s.begin(), s.end(), t, [](int64_t x, const Sample& a) { return x < a.t; });
+    const Sample& b = *it;
+    const Sample& a = *(it - 1);
+    double f = (double)(t - a.t) / (double)(b.t - a.t);
+    return (float)(a.v + (b.v - a.v) * f);
+}
+
+// ─── Replay ─────────────────────────────────────────────────────
+
+const int   kModes[]      = { PREDICT_OFF, PREDICT_LINEAR, PREDICT_ACCEL };
+const int   kModeCount    = sizeof(kModes) / sizeof(kModes[0]);
+
+struct ErrorStats {
+    double  rms;
+    double  p99;
+    double  max;
+};
+
+struct TraceResult {
+    std::string name;
+    size_t      frames;
+    ErrorStats  modes[kModeCount];
+};
+
+ErrorStats Summarize(std::vector<double>& absErrors)
+{
+    ErrorStats e = {};
+    if (absErrors.empty()) return e;
+
+    double sumSq = 0.0;
+    for (double x : absErrors) sumSq += x * x;
+    std::sort(absErrors.begin(), absErrors.end());
+    size_t i = (size_t)ceil(0.99 * (double)absErrors.size());
+    e.rms = sqrt(sumSq / (double)absErrors.size());
+    e.p99 = absErrors[i == 0 ? 0 : std::min(i, absErrors.size()) - 1];
+    e.max = absErrors.back();
+    return e;
+}
+
+TraceResult Replay(const Trace& trace, const Options& o)
+{
+    TraceResult r = {};
+    r.name = trace.name;
+
+    int64_t period = NS_PER_SECOND / o.rateHz;
+    int64_t lead   = (int64_t)llround(o.leadMs * 1e6);
+    int64_t start  = trace.samples.front().t + 100 * 1000000LL;    // let the history fill
+    int64_t end    = trace.samples.back().t - lead;
+
+    for (int m = 0; m < kModeCount; m++) {
+        VelocityPredictor p;
+        p.mode            = kModes[m];
+        p.windowTicks     = PREDICTION_WINDOW_MS * 1000000LL;
+        p.maxHorizonTicks = PREDICTION_MAX_HORIZON_MS * 1000000LL;
+
+        VelocityHistory h = {};
+        Lcg    jitter(kNoiseSeed);
+        size_t next = 0;
+        std::vector<double> absErrors;
+
+        for (int64_t frame = start; frame < end; frame += period) {
+            // Sync lands up to ±1 ms off the frame grid, like a real game loop
+            int64_t sync = frame + (int64_t)((float)jitter.Next() * 1e6f);
+
+            // Every sample published since the last sync, as the layer reads the velocity ring
+            while (next < trace.samples.size() && trace.samples[next].t <= sync) {
+                VelocityHistoryPush(&h, trace.samples[next].t, trace.samples[next].v);
+                next++;
+            }
+
+            int64_t display = sync + lead;
+            float   error   = VelocityPredict(&h, &p, display) - TruthAt(trace, display);
+            absErrors.push_back(fabs((double)error));
+        }
+
+        r.frames   = absErrors.size();
+        r.modes[m] = Summarize(absErrors);
+    }
+    return r;
+}
+
+void PrintResult(const TraceResult& r)
+{
+    printf("\n%s, %zu frames\n", r.name.c_str(), r.frames);
+    printf("  %-8s %9s %9s %9s\n", "mode", "rms", "p99", "max");
+    for (int m = 0; m < kModeCount; m++) {
+        const ErrorStats& e = r.modes[m];
+        printf("  %-8s %9.5f %9.5f %9.5f\n", VelocityPredictModeName(kModes[m]), e.rms, e.p99, e.max);
+    }
+    double off = r.modes[0].rms;
+    if (off > 0) {
+        printf("  rms vs off: linear %+.1f%%, accel %+.1f%%\n",
+               100.0 * (r.modes[1].rms - off) / off, 100.0 * (r.modes[2].rms - off) / off);
+    }
+}
+
+bool WriteJson(const char* path, const Options& o, const std::vector<TraceResult>& results)
+{
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+
+    fprintf(f, "{\n  \"rate_hz\": %d,\n  \"lead_ms\": %.3f,\n  \"traces\": [\n", o.rateHz, o.leadMs);
+    for (size_t i = 0; i < results.size(); i++) {
+        const TraceResult& r = results[i];
+        fprintf(f, "    { \"name\": \"%s\", \"frames\": %zu, \"modes\": [\n", r.name.c_str(), r.frames);
+        for (int m = 0; m < kModeCount; m++) {
+            const ErrorStats& e = r.modes[m];
+            fprintf(f, "      { \"mode\": \"%s\", \"rms\": %.6f, \"p99\": %.6f, \"max\": %.6f }%s\n",
+                    VelocityPredictModeName(kModes[m]), e.rms, e.p99, e.max, m + 1 < kModeCount ? "," : "");
+        }
+        fprintf(f, "    ] }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    return true;
+}
+
+} // namespace
+
+// ─── Main ───────────────────────────────────────────────────────
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if (!ParseOptions(argc, argv, &opt)) {
+        fprintf(stderr, "usage: %s [--trace FILE]... [--rate HZ] [--lead-ms MS] "
+                        "[--writer-hz HZ] [--json FILE] [--check]\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<Trace> traces;
+    if (opt.traces.empty()) {
+        traces = SyntheticTraces(opt.writerHz);
+    } else {
+        for (const std::string& path : opt.traces) {
+            Trace t;
+            if (!LoadTrace(path.c_str(), &t)) {
+                fprintf(stderr, "error: %s: missing or fewer than two samples\n", path.c_str());
+                return 1;
+            }
+            traces.push_back(t);
+        }
+    }
+
+    printf("treadmill_prediction_replay: %d Hz, display lead %.1f ms\n", opt.rateHz, opt.leadMs);
+
+    std::vector<TraceResult> results;
+    bool improved = true;
+    for (const Trace& t : traces) {
+        TraceResult r = Replay(t, opt);
+        PrintResult(r);
+        results.push_back(r);
+        if (!(r.modes[1].rms < r.modes[0].rms)) improved = false;
+    }
+
+    if (!opt.jsonPath.empty() && !WriteJson(opt.jsonPath.c_str(), opt, results)) {
+        fprintf(stderr, "error: cannot write %s\n", opt.jsonPath.c_str());
+        return 1;
+    }
+
+    if (opt.check && !improved) {
+        fprintf(stderr, "\nFAIL: linear prediction did not beat no prediction on every trace\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,27 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Replay Tool Common
+// ═══════════════════════════════════════════════════════════════════
+// What the offline replays (prediction, stream, trace, filter) share to
+// synthesize input: one deterministic noise source, so a seed produces
+// the same run in every tool and on every platform, and the default
+// config's full-speed count rate.
+// ═══════════════════════════════════════════════════════════════════
+
+#include <stdint.h>
+
+// Deterministic noise: a 32-bit LCG, its top 24 bits mapped to -1 … 1.
+// Exact in float as well as double.
+struct Lcg {
+    uint32_t state;
+    explicit Lcg(uint32_t seed) : state(seed) {}
+    double Next()       // -1 … 1
+    {
+        state = state * 1664525u + 1013904223u;
+        return (double)(state >> 8) / (double)(1u << 23) - 1.0;
+    }
+};
+
+// Counts per second at full speed (velocity 1 with the default config:
+// 100 filter units per 16 ms at sensitivity 2)
+const double kFullSpeedCounts = 100.0 / 2.0 / 0.016;
@@ -0,0 +1,267 @@
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Stream Replay (tick vs. raw delta streaming)
+// ═══════════════════════════════════════════════════════════════════
+// Replays a simulated treadmill mouse through both ways the layer can
+// get its velocity, and measures what the game sees per frame:
+//
+//   tick  the app steps the input core at --tick-hz over the deltas
+//         that arrived since its last tick and publishes one velocity;
+//         xrSyncActions reads the newest one (TREADMILL_STREAM_VELOCITY)
+//   raw   the app streams every delta; xrSyncActions runs the input core
+//         over exactly the events since the previous frame, idling only
+//         up to RAW_DELTA_IDLE_MS ago (TREADMILL_STREAM_RAW_DELTAS)
+//
+// Sampling the app's tick at the game's frame rate aliases: each frame
+// sees whichever tick happened last, and each tick saw however many
+// mouse reports happened to land in it. Prediction is left off so only
+// the sampling differs.
+//
+//   treadmill_stream_replay [--mouse-hz HZ] [--tick-hz HZ] [--rate HZ]...
+//                           [--seconds S] [--check]
+//
+// Frames are jittered ±1 ms, the app tick ±0.5 ms, mouse reports ±10 %
+// of their interval, and each report reaches the ring up to 0.25 ms
+// late. Reported per scenario and frame rate:
+//
+//   jitter   RMS of frame-to-frame velocity change
+//   steady   standard deviation of the velocity at constant speed
+//
+// --check exits non-zero unless raw streaming has lower jitter than the
+// tick path in every scenario at every frame rate.
+// ═══════════════════════════════════════════════════════════════════
+
+#include "input_core.h"
+#include "replay_common.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define RAW_DELTA_IDLE_MS   8       // keep in sync with frame_velocity.h
+#define NS_PER_SECOND       1000000000LL
+#define NS_PER_MS           1000000LL
+
+namespace {
+
+// ─── Options ────────────────────────────────────────────────────
+
+struct Options {
+    int                 mouseHz     = 1000;
+    int                 tickHz      = 500;
+    std::vector<int>    ratesHz;
+    double              seconds     = 10.0;
+    bool                check       = false;
+};
+
+bool ParseOptions(int argc, char** argv, Options* o)
+{
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(a, "--mouse-hz") && hasValue)       o->mouseHz = atoi(argv[++i]);
+        else if (!strcmp(a, "--tick-hz") && hasValue)   o->tickHz = atoi(argv[++i]);
+        else if (!strcmp(a, "--rate") && hasValue)      o->ratesHz.push_back(atoi(argv[++i]));
+        else if (!strcmp(a, "--seconds") && hasValue)   o->seconds = atof(argv[++i]);
+        else if (!strcmp(a, "--check"))                 o->check = true;
+        else return false;
+    }
+    if (o->ratesHz.empty()) o->ratesHz = { 90, 120, 144 };
+    for (int r : o->ratesHz) if (r <= 0 || r > 1000) return false;
+    return o->mouseHz > 0 && o->mouseHz <= 8000 && o->tickHz > 0 && o->tickHz <= 1000 && o->seconds >= 2.0;
+}
+
+// ─── Mouse Simulation ───────────────────────────────────────────
+
+struct Scenario {
+    const char* name;
+    double      (*speed)(double t);     // fraction of full speed
+    double      steadyFrom, steadyTo;   // constant-speed window, seconds
+};
+
+const double kPi = 3.14159265358979323846;
+
+const Scenario kScenarios[] = {
+    { "steady-walk",  [](double t) { return t < 0.5 ? 0.0 : 0.45; },                     2.0, 1e9 },
+    { "slow-walk",    [](double t) { return t < 0.5 ? 0.0 : 0.12; },                     2.0, 1e9 },
+    { "varying-walk", [](double t) { return 0.4 + 0.2 * sin(2.0 * kPi * 0.3 * t); },     0.0, 0.0 },
+};
+
+// Forward mouse reports (negative Y) at `mouseHz`, quantised to whole
+// counts; each event carries the time it reached the ring.
+std::vector<TreadmillInputEvent> SimulateMouse(const Scenario& s, const Options& o, uint32_t seed)
+{
+    std::vector<TreadmillInputEvent> events;
+    Lcg     rng(seed);
+    double  interval = 1.0 / o.mouseHz;
+    double  carry    = 0.0;
+    double  prev     = 0.0;
+
+    for (double t = interval; t < o.seconds; t += interval) {
+        double report = t + 0.1 * interval * rng.Next();
+        carry += s.speed(report) * kFullSpeedCounts * (report - prev);
+        prev = report;
+
+        int32_t counts = (int32_t)floor(carry);
+        if (counts == 0) continue;
+        carry -= counts;
+
+        int64_t delivered = (int64_t)llround((report + 0.000125 * (1.0 + rng.Next())) * NS_PER_SECOND);
+        if (!events.empty() && delivered < events.back().timestamp) delivered = events.back().timestamp;
+        events.push_back({ delivered, 0, -counts });
+    }
+    return events;
+}
+
+// ─── Paths ──────────────────────────────────────────────────────
+
+struct Published {
+    int64_t     t;
+    double      v;
+};
+
+// InputProcessor: one Step per jittered app tick over the deltas that arrived
+std::vector<Published> TickPath(const std::vector<TreadmillInputEvent>& events, const Options& o, uint32_t seed)
+{
+    TreadmillInputConfig config;
+    TreadmillInput_DefaultConfig(&config);
+    TreadmillInputState state;
+    TreadmillInput_Reset(&state, 0);
+
+    std::vector<Published> out;
+    Lcg     rng(seed);
+    int64_t period = NS_PER_SECOND / o.tickHz;
+    int64_t end    = (int64_t)(o.seconds * NS_PER_SECOND);
+    int64_t last   = 0;
+    size_t  next   = 0;
+
+    for (int64_t grid = period; grid < end; grid += period) {
+        int64_t tick = grid + (int64_t)(rng.Next() * 0.5 * NS_PER_MS);
+        double  sum  = 0.0;
+        while (next < events.size() && events[next].timestamp <= tick) sum += events[next++].dy;
+
+        double v = TreadmillInput_Step(&state, &config, sum, (double)(tick - last) / NS_PER_SECOND);
+        out.push_back({ tick, v });
+        last = tick;
+    }
+    return out;
+}
+
+struct FrameSeries {
+    std::vector<int64_t>    t;
+    std::vector<double>     tick;
+    std::vector<double>     raw;
+};
+
+FrameSeries Frames(const std::vector<TreadmillInputEvent>& events, const std::vector<Published>& published,
+                   int rateHz, const Options& o, uint32_t seed)
+{
+    TreadmillInputConfig config;
+    TreadmillInput_DefaultConfig(&config);
+    TreadmillInputState raw;
+    TreadmillInput_Reset(&raw, 0);
+
+    FrameSeries f;
+    Lcg     rng(seed);
+    int64_t period = NS_PER_SECOND / rateHz;
+    int64_t end    = (int64_t)(o.seconds * NS_PER_SECOND);
+    int64_t idle   = RAW_DELTA_IDLE_MS * NS_PER_MS;
+    size_t  nextEvent = 0, nextTick = 0;
+
+    for (int64_t grid = period; grid < end; grid += period) {
+        int64_t sync = grid + (int64_t)(rng.Next() * NS_PER_MS);
+
+        // Velocity streaming: the newest published tick
+        while (nextTick + 1 < published.size() && published[nextTick + 1].t <= sync) nextTick++;
+        double tickV = published[nextTick].t <= sync ? published[nextTick].v : 0.0;
+
+        // Raw streaming: what FilterRawDeltas does with this frame's ring contents
+        size_t first = nextEvent;
+        while (nextEvent < events.size() && events[nextEvent].timestamp <= sync) nextEvent++;
+        uint32_t n = (uint32_t)(nextEvent - first);
+        if (n) {
+            int64_t newest = std::max(events[nextEvent - 1].timestamp, raw.lastTimestamp);
+            TreadmillInput_ProcessEvents(&raw, &config, &events[first], n, newest, NS_PER_SECOND);
+        }
+        TreadmillInput_ProcessEvents(&raw, &config, NULL, 0, sync - idle, NS_PER_SECOND);
+
+        f.t.push_back(sync);
+        f.tick.push_back(tickV);
+        f.raw.push_back(raw.velocity);
+    }
+    return f;
+}
+
+// ─── Metrics ────────────────────────────────────────────────────
+
+struct Metrics {
+    double  jitter;
+    double  steady;     // 0 when the scenario has no steady window
+};
+
+Metrics Measure(const std::vector<int64_t>& t, const std::vector<double>& v, const Scenario& s)
+{
+    Metrics m = {};
+
+    double sumSq = 0.0;
+    for (size_t i = 1; i < v.size(); i++) sumSq += (v[i] - v[i - 1]) * (v[i] - v[i - 1]);
+    m.jitter = v.size() > 1 ? sqrt(sumSq / (double)(v.size() - 1)) : 0.0;
+
+    double sum = 0.0, sum2 = 0.0;
+    size_t n = 0;
+    for (size_t i = 0; i < v.size(); i++) {
+        double sec = (double)t[i] / NS_PER_SECOND;
+        if (sec < s.steadyFrom || sec >= s.steadyTo) continue;
+        sum  += v[i];
+        sum2 += v[i] * v[i];
+        n++;
+    }
+    if (n > 1) {
+        double mean = sum / (double)n;
+        m.steady = sqrt(std::max(0.0, sum2 / (double)n - mean * mean));
+    }
+    return m;
+}
+
+} // namespace
+
+// ─── Main ───────────────────────────────────────────────────────
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if (!ParseOptions(argc, argv, &opt)) {
+        fprintf(stderr, "usage: %s [--mouse-hz HZ] [--tick-hz HZ] [--rate HZ]... [--seconds S] [--check]\n", argv[0]);
+        return 2;
+    }
+
+    printf("treadmill_stream_replay: %d Hz mouse, %d Hz app tick, %.1f s\n", opt.mouseHz, opt.tickHz, opt.seconds);
+
+    bool improved = true;
+    uint32_t seed = 0x5EED0001u;
+    for (const Scenario& s : kScenarios) {
+        std::vector<TreadmillInputEvent> events    = SimulateMouse(s, opt, seed++);
+        std::vector<Published>           published = TickPath(events, opt, seed++);
+
+        printf("\n%s, %zu events\n", s.name, events.size());
+        printf("  %5s  %10s %10s %7s  %10s %10s\n", "fps", "tick jit", "raw jit", "change", "tick std", "raw std");
+        for (int rate : opt.ratesHz) {
+            FrameSeries f   = Frames(events, published, rate, opt, seed++);
+            Metrics     tk  = Measure(f.t, f.tick, s);
+            Metrics     raw = Measure(f.t, f.raw, s);
+            double change   = tk.jitter > 0 ? 100.0 * (raw.jitter - tk.jitter) / tk.jitter : 0.0;
+            printf("  %5d  %10.5f %10.5f %+6.1f%%", rate, tk.jitter, raw.jitter, change);
+            if (s.steadyTo > s.steadyFrom) printf("  %10.5f %10.5f\n", tk.steady, raw.steady);
+            else                           printf("  %10s %10s\n", "-", "-");
+            if (!(raw.jitter < tk.jitter)) improved = false;
+        }
+    }
+
+    if (opt.check && !improved) {
+        fprintf(stderr, "\nFAIL: raw delta streaming did not reduce jitter in every case\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,801 @@
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Velocity Trace Replay
+// ═══════════════════════════════════════════════════════════════════
+// Replays recorded velocity traces (velocity_trace.h) deterministically
+// and faster than real time: the app's half through the input core,
+// the layer's half through the same shared block and frame_velocity.h
+// code xrSyncActions runs, on the trace's own clock.
+//
+//   treadmill_trace_replay --trace FILE... [--rate HZ] [--lead-ms MS]
+//                          [--predict off|linear|accel] [--refilter]
+//                          [--csv FILE] [--json FILE] [--check]
+//   treadmill_trace_replay --synthesize BASE [--seconds S] [--mouse-hz HZ]
+//                          [--tick-hz HZ] [--rate HZ] [--lead-ms MS] [--raw]
+//                          [--filter ema|one-euro|kalman] [--counts-per-meter N]
+//
+// The files — typically the app's and the layer's from one session —
+// are merged by timestamp and must share a clock frequency. Records
+// drive an in-memory shared block:
+//
+//   START        resets the app's filters
+//   CONFIG       sets an axis's filter config; forward is also
+//                published, as the app does for the layer
+//   CALIBRATION  sets an axis's counts per meter and response curve;
+//                forward is also published
+//   STREAM_MODE  switches the block's stream mode
+//   DELTA        raw delta mode: appended to the delta ring
+//   TICK         re-runs the app's filter step on the recorded counts
+//                — an adaptive forward filter on the tick's primary
+//                DELTA records — (compared bit for bit) and publishes
+//                the recorded outputs, or the re-filtered ones with
+//                --refilter
+//   STOP         publishes inactive
+//   FRAME        one xrSyncActions at the recorded time and display
+//                time; the axes are compared with the recorded ones
+//
+// The app publishes at the end of its tick; the trace only has the
+// tick's time, which stands in for it.
+//
+// The replay ends at the axes xrSyncActions latches, profile scale
+// included. It does not replay their injection into the game's
+// XrActionState* (InjectApply's add or max with the game's own value,
+// the clamp, subaction filtering): the trace does not record the
+// game's action states. layer_harness and the end-to-end tests cover
+// that step against the built layer.
+//
+// Without any FRAME records (an app trace alone) frames are generated
+// at --rate Hz, each displayed --lead-ms later. --predict overrides the
+// layer's recorded prediction mode, for trying a trace against another
+// predictor.
+//
+// --synthesize writes BASE-app.tmvt and BASE-layer.tmvt: a simulated
+// walk (start, slow down, stop) as the app would record it, with the
+// layer's frames from this replay; --filter picks the forward filter
+// and --counts-per-meter calibrates it, with a straight response curve
+// up to SYNTH_TOP_SPEED.
+//
+// --check exits non-zero unless the filter steps reproduce bit for
+// bit, recorded frames are reproduced (when neither --predict nor
+// --refilter changed them), two passes agree, and the replay runs
+// faster than real time.
+// ═══════════════════════════════════════════════════════════════════
+
+#include "frame_velocity.h"
+#include "replay_common.h"
+#include "velocity_trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#define NS_PER_SECOND           1000000000LL
+#define NS_PER_MS               1000000LL
+#define FRAME_MATCH_TOLERANCE   1e-4        // stick units; far below anything a player sees
+#define SYNTH_TOP_SPEED         2.0         // m/s; full output of a synthesized calibration
+
+namespace {
+
+// ─── Options ────────────────────────────────────────────────────
+
+struct Options {
+    std::vector<std::string>    traces;
+    int                         rateHz      = 90;
+    double                      leadMs      = 25.0;
+    int                         predictMode = -1;       // -1 = as recorded
+    bool                        refilter    = false;
+    std::string                 csvPath;
+    std::string                 jsonPath;
+    bool                        check       = false;
+
+    std::string                 synthesize;
+    double                      seconds     = 10.0;
+    int                         mouseHz     = 1000;
+    int                         tickHz      = 500;
+    bool                        raw         = false;
+    int                         filter      = -1;       // -1 = the default config's
+    double                      countsPerMeter = 0.0;   // 0 = uncalibrated
+};
+
+int ParseFilter(const char* name)
+{
+    if (!strcmp(name, "ema"))       return TREADMILL_INPUT_FILTER_EMA;
+    if (!strcmp(name, "one-euro"))  return TREADMILL_INPUT_FILTER_ONE_EURO;
+    if (!strcmp(name, "kalman"))    return TREADMILL_INPUT_FILTER_KALMAN;
+    return -1;
+}
+
+bool ParseOptions(int argc, char** argv, Options* o)
+{
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(a, "--trace") && hasValue)              o->traces.push_back(argv[++i]);
+        else if (!strcmp(a, "--rate") && hasValue)          o->rateHz = atoi(argv[++i]);
+        else if (!strcmp(a, "--lead-ms") && hasValue)       o->leadMs = atof(argv[++i]);
+        else if (!strcmp(a, "--predict") && hasValue) {
+            o->predictMode = VelocityPredictParseMode(argv[++i], -2);
+            if (o->predictMode < 0) return false;
+        }
+        else if (!strcmp(a, "--refilter"))                  o->refilter = true;
+        else if (!strcmp(a, "--csv") && hasValue)           o->csvPath = argv[++i];
+        else if (!strcmp(a, "--json") && hasValue)          o->jsonPath = argv[++i];
+        else if (!strcmp(a, "--check"))                     o->check = true;
+        else if (!strcmp(a, "--synthesize") && hasValue)    o->synthesize = argv[++i];
+        else if (!strcmp(a, "--seconds") && hasValue)       o->seconds = atof(argv[++i]);
+        else if (!strcmp(a, "--mouse-hz") && hasValue)      o->mouseHz = atoi(argv[++i]);
+        else if (!strcmp(a, "--tick-hz") && hasValue)       o->tickHz = atoi(argv[++i]);
+        else if (!strcmp(a, "--raw"))                       o->raw = true;
+        else if (!strcmp(a, "--filter") && hasValue) {
+            o->filter = ParseFilter(argv[++i]);
+            if (o->filter < 0) return false;
+        }
+        else if (!strcmp(a, "--counts-per-meter") && hasValue) o->countsPerMeter = atof(argv[++i]);
+        else return false;
+    }
+    if (o->synthesize.empty() == o->traces.empty()) return false;
+    return o->rateHz > 0 && o->rateHz <= 1000 && o->leadMs >= 0.0 && o->leadMs <= 100.0 &&
+           o->mouseHz > 0 && o->mouseHz <= 8000 && o->tickHz > 0 && o->tickHz <= 1000 && o->seconds >= 2.0 &&
+           o->countsPerMeter >= 0.0;
+}
+
+// ─── Traces ─────────────────────────────────────────────────────
+
+struct Event {
+    int64_t     timestamp;
+    uint8_t     type;
+    uint8_t     channel;
+    union {
+        VelocityTraceConfig config;
+        VelocityTraceCalibration calibration;
+        VelocityTraceDelta  delta;
+        VelocityTraceTick   tick;
+        VelocityTraceFrame  frame;
+        VelocityTraceLayer  layer;
+        VelocityTraceLoss   loss;
+    };
+};
+
+struct Trace {
+    int64_t             frequency   = 0;
+    std::vector<Event>  events;         // by timestamp once loaded
+    bool                hasFrames   = false;
+};
+
+Event MakeEvent(int64_t timestamp, uint8_t type, uint8_t channel = 0)
+{
+    Event e;
+    memset(&e, 0, sizeof(e));
+    e.timestamp = timestamp;
+    e.type      = type;
+    e.channel   = channel;
+    return e;
+}
+
+// Appends the file's records to `t`; unknown record types are skipped.
+bool LoadTrace(const char* path, Trace* t)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "error: cannot open %s\n", path);
+        return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[64 * 1024];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) data.insert(data.end(), chunk, chunk + n);
+    fclose(f);
+
+    VelocityTraceReader reader;
+    if (!VelocityTraceOpen(&reader, data.data(), data.size())) {
+        fprintf(stderr, "error: %s is not a v%d velocity trace\n", path, VELOCITY_TRACE_VERSION);
+        return false;
+    }
+    if (t->frequency && t->frequency != reader.header.timestampFrequency) {
+        fprintf(stderr, "error: %s: clock frequency %lld, other traces %lld\n", path,
+                (long long)reader.header.timestampFrequency, (long long)t->frequency);
+        return false;
+    }
+    t->frequency = reader.header.timestampFrequency;
+
+    VelocityTraceRecord rec;
+    while (VelocityTraceNext(&reader, &rec)) {
+        Event e = MakeEvent(rec.timestamp, rec.type, rec.channel);
+        switch (rec.type) {
+        case VELOCITY_TRACE_START:
+        case VELOCITY_TRACE_STOP:
+        case VELOCITY_TRACE_STREAM_MODE:                                    break;
+        case VELOCITY_TRACE_CONFIG: VelocityTracePayload(&rec, &e.config);  break;
+        case VELOCITY_TRACE_CALIBRATION: VelocityTracePayload(&rec, &e.calibration); break;
+        case VELOCITY_TRACE_DELTA:  VelocityTracePayload(&rec, &e.delta);   break;
+        case VELOCITY_TRACE_TICK:   VelocityTracePayload(&rec, &e.tick);    break;
+        case VELOCITY_TRACE_FRAME:  VelocityTracePayload(&rec, &e.frame);   break;
+        case VELOCITY_TRACE_LAYER:  VelocityTracePayload(&rec, &e.layer);   break;
+        case VELOCITY_TRACE_LOSS:   VelocityTracePayload(&rec, &e.loss);    break;
+        default:                                                            continue;
+        }
+        if (rec.type == VELOCITY_TRACE_FRAME) t->hasFrames = true;
+        t->events.push_back(e);
+    }
+    if (VelocityTraceTruncated(&reader))
+        fprintf(stderr, "warning: %s: partial record at offset %zu ignored\n", path, reader.offset);
+    return true;
+}
+
+// Merged order; ties keep file order, so one producer's records stay in sequence.
+void SortTrace(Trace* t)
+{
+    std::stable_sort(t->events.begin(), t->events.end(),
+                     [](const Event& a, const Event& b) { return a.timestamp < b.timestamp; });
+}
+
+bool WriteTrace(const char* path, const std::vector<Event>& events, int64_t frequency, int64_t start, uint32_t source)
+{
+    std::vector<uint8_t>    out(sizeof(VelocityTraceFileHeader));
+    VelocityTraceEncoder    encoder;
+    VelocityTraceBegin(&encoder, out.data(), out.size(), frequency, start, source);
+
+    for (const Event& e : events) {
+        size_t size = 0;
+        switch (e.type) {
+        case VELOCITY_TRACE_CONFIG: size = sizeof(e.config);    break;
+        case VELOCITY_TRACE_CALIBRATION: size = sizeof(e.calibration); break;
+        case VELOCITY_TRACE_DELTA:  size = sizeof(e.delta);     break;
+        case VELOCITY_TRACE_TICK:   size = sizeof(e.tick);      break;
+        case VELOCITY_TRACE_FRAME:  size = sizeof(e.frame);     break;
+        case VELOCITY_TRACE_LAYER:  size = sizeof(e.layer);     break;
+        case VELOCITY_TRACE_LOSS:   size = sizeof(e.loss);      break;
+        }
+        uint8_t record[VELOCITY_TRACE_RECORD_MAX];
+        size_t n = VelocityTraceEncode(&encoder, record, sizeof(record), e.type, e.channel, e.timestamp,
+                                       &e.config, size);
+        out.insert(out.end(), record, record + n);
+    }
+
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    bool ok = fwrite(out.data(), 1, out.size(), f) == out.size();
+    return fclose(f) == 0 && ok;
+}
+
+// ─── Replay ─────────────────────────────────────────────────────
+
+struct FrameOut {
+    int64_t     timestamp;
+    int64_t     display;
+    float       axes[VELOCITY_TRACE_AXIS_COUNT];
+    bool        recorded;
+    float       expected[VELOCITY_TRACE_AXIS_COUNT];
+};
+
+struct ReplayResult {
+    size_t                  ticks           = 0;
+    size_t                  tickMismatches  = 0;
+    size_t                  deltas          = 0;
+    size_t                  framesCompared  = 0;
+    size_t                  frameMismatches = 0;
+    double                  maxFrameError   = 0.0;
+    uint64_t                lost            = 0;
+    double                  jitterRms       = 0.0;  // frame-to-frame change of forward
+    double                  maxDrop         = 0.0;  // largest one-frame fall in forward speed
+    double                  traceSeconds    = 0.0;
+    double                  replaySeconds   = 0.0;
+    uint64_t                hash            = 0;    // of every output, for the determinism check
+    std::vector<FrameOut>   frames;
+};
+
+void Hash(uint64_t* h, const void* data, size_t size)
+{
+    const uint8_t* p = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++) *h = (*h ^ p[i]) * 1099511628211ull;     // FNV-1a
+}
+
+TreadmillInputConfig InputConfig(const VelocityTraceConfig& c, const VelocityTraceCalibration& calibration)
+{
+    TreadmillInputConfig config = { c.sensitivity, c.deadZone, c.smoothing, c.maxSpeed, c.invertDirection,
+                                    c.filter, c.adaptivity, {} };
+    static_assert(sizeof(calibration) == sizeof(config.calibration), "same layout");
+    memcpy(&config.calibration, &calibration, sizeof(calibration));
+    return config;
+}
+
+VelocityTraceConfig TraceConfig(const TreadmillInputConfig& c)
+{
+    VelocityTraceConfig config = { c.sensitivity, c.deadZone, c.smoothing, c.maxSpeed, c.invertDirection, 1,
+                                   c.filter, 0, c.adaptivity };
+    return config;
+}
+
+// InputProcessor.Tick: forward always steps, strafe and turn only when
+// enabled (a disabled axis restarts from a zeroed filter). An adaptive
+// forward filter runs over the tick's `events` instead of its counts.
+struct AppModel {
+    TreadmillInputState     filter[VELOCITY_TRACE_AXIS_COUNT];
+    VelocityTraceConfig     config[VELOCITY_TRACE_AXIS_COUNT];
+    VelocityTraceCalibration calibration[VELOCITY_TRACE_AXIS_COUNT];
+    int64_t                 lastTick;
+
+    void Start(int64_t timestamp)
+    {
+        for (int i = 0; i < VELOCITY_TRACE_AXIS_COUNT; i++) TreadmillInput_Reset(&filter[i], 0);
+        TreadmillInput_Reset(&filter[VELOCITY_TRACE_AXIS_FORWARD], timestamp);
+        lastTick = timestamp;
+    }
+
+    void Step(const VelocityTraceTick& in, const TreadmillInputEvent* events, uint32_t count,
+              int64_t timestamp, int64_t frequency, double out[VELOCITY_TRACE_AXIS_COUNT])
+    {
+        double elapsed = (double)(timestamp - lastTick) / (double)frequency;
+        lastTick = timestamp;
+
+        const double deltas[VELOCITY_TRACE_AXIS_COUNT] = { (double)in.primaryDy, -(double)in.primaryDx, -(double)in.turnDx };
+        for (int i = 0; i < VELOCITY_TRACE_AXIS_COUNT; i++) {
+            if (i != VELOCITY_TRACE_AXIS_FORWARD && !config[i].enabled) {
+                memset(&filter[i], 0, sizeof(filter[i]));
+                out[i] = 0.0;
+                continue;
+            }
+            TreadmillInputConfig c = InputConfig(config[i], calibration[i]);
+            if (i == VELOCITY_TRACE_AXIS_FORWARD && c.filter != TREADMILL_INPUT_FILTER_EMA)
+                out[i] = TreadmillInput_ProcessEvents(&filter[i], &c, events, count, timestamp, frequency);
+            else
+                out[i] = TreadmillInput_Step(&filter[i], &c, deltas[i], elapsed);
+        }
+    }
+};
+
+// Frames at the game's rate over the span of `t`, for an app trace alone.
+void AddFrames(Trace* t, const Options& o)
+{
+    if (t->events.empty()) return;
+    int64_t first  = t->events.front().timestamp;
+    int64_t last   = t->events.back().timestamp;
+    int64_t period = t->frequency / o.rateHz;
+    int64_t lead   = (int64_t)(o.leadMs * (double)t->frequency / 1000.0);
+
+    uint32_t frame = 1;
+    for (int64_t at = first + period; at <= last; at += period) {
+        Event e = MakeEvent(at, VELOCITY_TRACE_FRAME);
+        e.frame.frame   = frame++;
+        e.frame.display = at + lead;
+        e.frame.forward = NAN;          // nothing recorded
+        t->events.push_back(e);
+    }
+    SortTrace(t);
+}
+
+ReplayResult Replay(const Trace& t, const Options& o)
+{
+    ReplayResult r;
+    auto began = std::chrono::steady_clock::now();
+
+    std::unique_ptr<TreadmillSharedData> shared(new TreadmillSharedData());
+    TreadmillSharedData* d = shared.get();
+    TreadmillSharedInit(d, t.frequency);
+
+    AppModel app;
+    memset(&app, 0, sizeof(app));
+    TreadmillInputConfig defaults;
+    TreadmillInput_DefaultConfig(&defaults);
+    app.config[VELOCITY_TRACE_AXIS_FORWARD] = TraceConfig(defaults);
+    app.Start(t.events.empty() ? 0 : t.events.front().timestamp);
+
+    // The primary sensor's events, which ticks take in order
+    std::vector<TreadmillInputEvent> primary;
+    for (const Event& e : t.events) {
+        if (e.type == VELOCITY_TRACE_DELTA && e.channel == VELOCITY_TRACE_SENSOR_PRIMARY)
+            primary.push_back({ e.timestamp, e.delta.dx, e.delta.dy });
+    }
+    size_t nextPrimary = 0;
+
+    FrameVelocity velocity;
+    memset(&velocity, 0, sizeof(velocity));
+    FrameVelocityAdopt(&velocity, d, o.predictMode >= 0 ? o.predictMode : PREDICT_MODE_DEFAULT);
+    float scale[VELOCITY_TRACE_AXIS_COUNT] = { 1.0f, 1.0f, 1.0f };
+
+    uint64_t hash      = 14695981039346656037ull;
+    double   sumSq     = 0.0;
+    bool     compare   = o.predictMode < 0 && !o.refilter;
+
+    for (const Event& e : t.events) {
+        switch (e.type) {
+        case VELOCITY_TRACE_START:
+            app.Start(e.timestamp);
+            break;
+
+        case VELOCITY_TRACE_CONFIG:
+            if (e.channel >= VELOCITY_TRACE_AXIS_COUNT) break;
+            app.config[e.channel] = e.config;
+            if (e.channel == VELOCITY_TRACE_AXIS_FORWARD) {
+                TreadmillFilterConfig shm = { e.config.sensitivity, e.config.deadZone, e.config.smoothing,
+                                              e.config.maxSpeed, e.config.invertDirection ? 1u : 0u,
+                                              (uint32_t)e.config.filter, e.config.adaptivity };
+                TreadmillConfigWrite(d, &shm);
+            }
+            break;
+
+        case VELOCITY_TRACE_CALIBRATION:
+            if (e.channel >= VELOCITY_TRACE_AXIS_COUNT) break;
+            app.calibration[e.channel] = e.calibration;
+            if (e.channel == VELOCITY_TRACE_AXIS_FORWARD) {
+                TreadmillCalibrationConfig shm;
+                static_assert(sizeof(shm) == sizeof(e.calibration), "same layout");
+                memcpy(&shm, &e.calibration, sizeof(shm));
+                TreadmillCalibrationWrite(d, &shm);
+            }
+            break;
+
+        case VELOCITY_TRACE_STREAM_MODE:
+            d->streamMode.store(e.channel, std::memory_order_relaxed);
+            break;
+
+        case VELOCITY_TRACE_DELTA:
+            r.deltas++;
+            if (e.channel == VELOCITY_TRACE_SENSOR_PRIMARY &&
+                d->streamMode.load(std::memory_order_relaxed) == TREADMILL_STREAM_RAW_DELTAS) {
+                TreadmillDelta delta = { e.timestamp, e.delta.dx, e.delta.dy };
+                TreadmillDeltaWrite(d, &delta, 1);
+            }
+            break;
+
+        case VELOCITY_TRACE_TICK: {
+            double out[VELOCITY_TRACE_AXIS_COUNT];
+            uint32_t n = (uint32_t)std::min<size_t>((size_t)std::max(e.tick.primaryEvents, 0),
+                                                    primary.size() - nextPrimary);
+            app.Step(e.tick, primary.data() + nextPrimary, n, e.timestamp, t.frequency, out);
+            nextPrimary += n;
+            r.ticks++;
+            if (out[0] != e.tick.forward || out[1] != e.tick.strafe || out[2] != e.tick.turn) r.tickMismatches++;
+            Hash(&hash, out, sizeof(out));
+
+            if (o.refilter) TreadmillSharedWriteMotion(d, (float)out[0], (float)out[1], (float)out[2], 1, e.timestamp);
+            else TreadmillSharedWriteMotion(d, (float)e.tick.forward, (float)e.tick.strafe, (float)e.tick.turn, 1, e.timestamp);
+            break;
+        }
+
+        case VELOCITY_TRACE_STOP:
+            TreadmillSharedWriteMotion(d, 0.0f, 0.0f, 0.0f, 0, e.timestamp);
+            break;
+
+        case VELOCITY_TRACE_LAYER:
+            for (int i = 0; i < VELOCITY_TRACE_AXIS_COUNT; i++) scale[i] = e.layer.scale[i];
+            if (o.predictMode < 0) velocity.predictor.mode = e.layer.predictMode;
+            break;
+
+        case VELOCITY_TRACE_LOSS:
+            r.lost += e.loss.count;
+            break;
+
+        case VELOCITY_TRACE_FRAME: {
+            // LatchFrameSnapshot
+            FrameOut f;
+            f.timestamp = e.timestamp;
+            f.display   = e.frame.display;
+            f.axes[0]   = FrameVelocityRead(&velocity, d, e.timestamp, e.frame.display);
+            f.axes[1]   = velocity.strafe;
+            f.axes[2]   = velocity.turn;
+            for (int i = 0; i < VELOCITY_TRACE_AXIS_COUNT; i++) f.axes[i] *= scale[i];
+            Hash(&hash, f.axes, sizeof(f.axes));
+
+            f.recorded    = !isnan(e.frame.forward);
+            f.expected[0] = e.frame.forward;
+            f.expected[1] = e.frame.strafe;
+            f.expected[2] = e.frame.turn;
+            if (f.recorded) {
+                double error = 0.0;
+                for (int i = 0; i < VELOCITY_TRACE_AXIS_COUNT; i++)
+                    error = std::max(error, fabs((double)f.axes[i] - (double)f.expected[i]));
+                r.framesCompared++;
+                r.maxFrameError = std::max(r.maxFrameError, error);
+                if (compare && error > FRAME_MATCH_TOLERANCE) r.frameMismatches++;
+            }
+
+            if (!r.frames.empty()) {
+                double prev   = r.frames.back().axes[0];
+                double change = f.axes[0] - prev;
+                sumSq    += change * change;
+                r.maxDrop = std::max(r.maxDrop, fabs(prev) - fabs((double)f.axes[0]));
+            }
+            r.frames.push_back(f);
+            break;
+        }
+        }
+    }
+
+    r.replaySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - began).count();
+    r.jitterRms     = r.frames.size() > 1 ? sqrt(sumSq / (double)(r.frames.size() - 1)) : 0.0;
+    r.hash          = hash;
+    if (!t.events.empty())
+        r.traceSeconds = (double)(t.events.back().timestamp - t.events.front().timestamp) / (double)t.frequency;
+    return r;
+}
+
+// ─── Synthesis ──────────────────────────────────────────────────
+
+const double kPi              = 3.14159265358979323846;
+
+// Walk up to speed, slow down, stop; a little sway on strafe and a turn
+// in the middle. Fractions of full speed, `u` is the fraction of the run.
+void WalkProfile(double u, double out[VELOCITY_TRACE_AXIS_COUNT])
+{
+    double forward;
+    if (u < 0.05)       forward = 0.0;
+    else if (u < 0.20)  forward = 0.5 * (u - 0.05) / 0.15;
+    else if (u < 0.50)  forward = 0.5;
+    else if (u < 0.65)  forward = 0.5 - 0.35 * (u - 0.50) / 0.15;
+    else if (u < 0.85)  forward = 0.15;
+    else if (u < 0.90)  forward = 0.15 * (0.90 - u) / 0.05;
+    else                forward = 0.0;
+
+    out[VELOCITY_TRACE_AXIS_FORWARD] = forward;
+    out[VELOCITY_TRACE_AXIS_STRAFE]  = forward * 0.1 * sin(2.0 * kPi * 4.0 * u);
+    out[VELOCITY_TRACE_AXIS_TURN]    = u > 0.30 && u < 0.40 ? 0.3 : 0.0;
+}
+
+// What VelocityTraceWriter records for one session of the simulated walk.
+Trace SynthesizeApp(const Options& o, uint32_t seed)
+{
+    Trace t;
+    t.frequency = NS_PER_SECOND;
+    Lcg     rng(seed);
+    int64_t start = NS_PER_SECOND;
+    int64_t end   = start + (int64_t)(o.seconds * NS_PER_SECOND);
+
+    t.events.push_back(MakeEvent(start, VELOCITY_TRACE_STREAM_MODE,
+                                 o.raw ? TREADMILL_STREAM_RAW_DELTAS : TREADMILL_STREAM_VELOCITY));
+    t.events.push_back(MakeEvent(start, VELOCITY_TRACE_START));
+    TreadmillInputConfig defaults;
+    TreadmillInput_DefaultConfig(&defaults);
+    if (o.filter >= 0) defaults.filter = o.filter;
+    for (uint8_t axis = 0; axis < VELOCITY_TRACE_AXIS_COUNT; axis++) {
+        Event e = MakeEvent(start, VELOCITY_TRACE_CONFIG, axis);
+        e.config = TraceConfig(defaults);
+        if (axis != VELOCITY_TRACE_AXIS_FORWARD) e.config.filter = TREADMILL_INPUT_FILTER_EMA;
+        t.events.push_back(e);
+    }
+    if (o.countsPerMeter > 0.0) {
+        TreadmillInputCalibration calibration;
+        calibration.countsPerMeter = o.countsPerMeter;
+        TreadmillInput_BakeCurve(&calibration, SYNTH_TOP_SPEED, NULL, 0);
+        Event e = MakeEvent(start, VELOCITY_TRACE_CALIBRATION, VELOCITY_TRACE_AXIS_FORWARD);
+        memcpy(&e.calibration, &calibration, sizeof(e.calibration));
+        t.events.push_back(e);
+    }
+
+    // Mouse reports, quantised to whole counts; each is stamped when the
+    // capture thread read it, up to 0.25 ms late
+    std::vector<Event> deltas;
+    double  interval = 1.0 / o.mouseHz;
+    double  carry[VELOCITY_TRACE_AXIS_COUNT] = {};
+    double  prev = 0.0;
+    for (double s = interval; s < o.seconds; s += interval) {
+        double report = s + 0.1 * interval * rng.Next();
+        double speed[VELOCITY_TRACE_AXIS_COUNT];
+        WalkProfile(report / o.seconds, speed);
+        for (int i = 0; i < VELOCITY_TRACE_AXIS_COUNT; i++) carry[i] += speed[i] * kFullSpeedCounts * (report - prev);
+        prev = report;
+
+        int32_t counts[VELOCITY_TRACE_AXIS_COUNT];
+        for (int i = 0; i < VELOCITY_TRACE_AXIS_COUNT; i++) {
+            counts[i] = (int32_t)(carry[i] >= 0 ? floor(carry[i]) : ceil(carry[i]));
+            carry[i] -= counts[i];
+        }
+
+        int64_t at = start + (int64_t)llround((report + 0.000125 * (1.0 + rng.Next())) * NS_PER_SECOND);
+        if (!deltas.empty() && at < deltas.back().timestamp) at = deltas.back().timestamp;
+        if (counts[0] || counts[1]) {
+            Event e = MakeEvent(at, VELOCITY_TRACE_DELTA, VELOCITY_TRACE_SENSOR_PRIMARY);
+            e.delta.dx = -counts[VELOCITY_TRACE_AXIS_STRAFE];       // right is -X after the app's negation
+            e.delta.dy = -counts[VELOCITY_TRACE_AXIS_FORWARD];      // forward is -Y
+            deltas.push_back(e);
+        }
+        if (counts[2]) {
+            Event e = MakeEvent(at, VELOCITY_TRACE_DELTA, VELOCITY_TRACE_SENSOR_TURN);
+            e.delta.dx = -counts[VELOCITY_TRACE_AXIS_TURN];
+            deltas.push_back(e);
+        }
+    }
+
+    // The app's jittered tick over the deltas that had arrived
+    AppModel app;
+    memset(&app, 0, sizeof(app));
+    for (const Event& e : t.events) {
+        if (e.type == VELOCITY_TRACE_CONFIG)      app.config[e.channel]      = e.config;
+        if (e.type == VELOCITY_TRACE_CALIBRATION) app.calibration[e.channel] = e.calibration;
+    }
+    app.Start(start);
+
+    int64_t period = NS_PER_SECOND / o.tickHz;
+    size_t  next   = 0;
+    for (int64_t grid = start + period; grid < end; grid += period) {
+        int64_t at = grid + (int64_t)(rng.Next() * 0.5 * NS_PER_MS);
+        Event e = MakeEvent(at, VELOCITY_TRACE_TICK);
+        std::vector<TreadmillInputEvent> drained;
+        for (; next < deltas.size() && deltas[next].timestamp <= at; next++) {
+            if (deltas[next].channel == VELOCITY_TRACE_SENSOR_PRIMARY) {
+                e.tick.primaryDx += deltas[next].delta.dx;
+                e.tick.primaryDy += deltas[next].delta.dy;
+                drained.push_back({ deltas[next].timestamp, deltas[next].delta.dx, deltas[next].delta.dy });
+            } else {
+                e.tick.turnDx += deltas[next].delta.dx;
+            }
+        }
+        e.tick.primaryEvents = (int32_t)drained.size();
+        double out[VELOCITY_TRACE_AXIS_COUNT];
+        app.Step(e.tick, drained.data(), (uint32_t)drained.size(), at, t.frequency, out);
+        e.tick.forward = out[0];
+        e.tick.strafe  = out[1];
+        e.tick.turn    = out[2];
+        t.events.push_back(e);
+    }
+    t.events.push_back(MakeEvent(end, VELOCITY_TRACE_STOP));
+
+    t.events.insert(t.events.end(), deltas.begin(), deltas.end());
+    SortTrace(&t);
+    return t;
+}
+
+bool Synthesize(const Options& o)
+{
+    Trace app = SynthesizeApp(o, 0x5EED0021u);
+    int64_t start = app.events.front().timestamp;
+
+    // The layer side is what this replay latches for generated frames
+    Trace withFrames = app;
+    AddFrames(&withFrames, o);
+    ReplayResult r = Replay(withFrames, o);
+
+    std::vector<Event> layer;
+    Event settings = MakeEvent(start, VELOCITY_TRACE_LAYER);
+    for (int i = 0; i < VELOCITY_TRACE_AXIS_COUNT; i++) settings.layer.scale[i] = 1.0f;
+    settings.layer.predictMode = o.predictMode >= 0 ? o.predictMode : PREDICT_MODE_DEFAULT;
+    layer.push_back(settings);
+    uint32_t frame = 1;
+    for (const FrameOut& f : r.frames) {
+        Event e = MakeEvent(f.timestamp, VELOCITY_TRACE_FRAME);
+        e.frame.forward = f.axes[0];
+        e.frame.strafe  = f.axes[1];
+        e.frame.turn    = f.axes[2];
+        e.frame.frame   = frame++;
+        e.frame.display = f.display;
+        layer.push_back(e);
+    }
+
+    std::string appPath   = o.synthesize + "-app.tmvt";
+    std::string layerPath = o.synthesize + "-layer.tmvt";
+    if (!WriteTrace(appPath.c_str(), app.events, app.frequency, start, VELOCITY_TRACE_SOURCE_APP) ||
+        !WriteTrace(layerPath.c_str(), layer, app.frequency, start, VELOCITY_TRACE_SOURCE_LAYER)) {
+        fprintf(stderr, "error: cannot write %s-*.tmvt\n", o.synthesize.c_str());
+        return false;
+    }
+    printf("treadmill_trace_replay: %.1f s %s walk, %zu app records -> %s, %zu frames -> %s\n",
+           o.seconds, o.raw ? "raw delta" : "velocity", app.events.size(), appPath.c_str(),
+           r.frames.size(), layerPath.c_str());
+    return true;
+}
+
+// ─── Reporting ──────────────────────────────────────────────────
+
+void PrintResult(const ReplayResult& r, bool deterministic)
+{
+    printf("  app     %zu ticks, %zu deltas, filter %s (%zu mismatched)\n", r.ticks, r.deltas,
+           r.tickMismatches ? "DIFFERS" : "bit-exact", r.tickMismatches);
+    printf("  layer   %zu frames, jitter rms %.5f, max drop %.5f", r.frames.size(), r.jitterRms, r.maxDrop);
+    if (r.lost) printf(", %llu records lost while recording", (unsigned long long)r.lost);
+    printf("\n");
+    if (r.framesCompared)
+        printf("  frames  %zu recorded, %zu mismatched, max error %.6f\n", r.framesCompared, r.frameMismatches,
+               r.maxFrameError);
+    double speed = r.replaySeconds > 0 ? r.traceSeconds / r.replaySeconds : 0.0;
+    printf("  replay  %.1f s of trace in %.3f s (%.0fx real time), %s\n", r.traceSeconds, r.replaySeconds, speed,
+           deterministic ? "deterministic" : "NOT deterministic");
+}
+
+bool WriteCsv(const char* path, const ReplayResult& r, int64_t origin, int64_t frequency)
+{
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "seconds,forward,strafe,turn,recorded_forward,recorded_strafe,recorded_turn\n");
+    for (const FrameOut& fr : r.frames) {
+        fprintf(f, "%.6f,%.6f,%.6f,%.6f", (double)(fr.timestamp - origin) / (double)frequency,
+                fr.axes[0], fr.axes[1], fr.axes[2]);
+        if (fr.recorded) fprintf(f, ",%.6f,%.6f,%.6f\n", fr.expected[0], fr.expected[1], fr.expected[2]);
+        else             fprintf(f, ",,,\n");
+    }
+    fclose(f);
+    return true;
+}
+
+bool WriteJson(const char* path, const Options& o, const ReplayResult& r, bool deterministic)
+{
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+
+    fprintf(f, "{\n  \"traces\": [");
+    for (size_t i = 0; i < o.traces.size(); i++) fprintf(f, "%s\"%s\"", i ? ", " : "", o.traces[i].c_str());
+    fprintf(f, "],\n");
+    fprintf(f, "  \"ticks\": %zu,\n  \"filter_mismatches\": %zu,\n  \"deltas\": %zu,\n", r.ticks, r.tickMismatches,
+            r.deltas);
+    fprintf(f, "  \"frames\": %zu,\n  \"frames_compared\": %zu,\n  \"frame_mismatches\": %zu,\n"
+               "  \"max_frame_error\": %.6f,\n", r.frames.size(), r.framesCompared, r.frameMismatches, r.maxFrameError);
+    fprintf(f, "  \"jitter_rms\": %.6f,\n  \"max_drop\": %.6f,\n  \"lost\": %llu,\n", r.jitterRms, r.maxDrop,
+            (unsigned long long)r.lost);
+    fprintf(f, "  \"trace_seconds\": %.3f,\n  \"replay_seconds\": %.6f,\n  \"deterministic\": %s\n}\n",
+            r.traceSeconds, r.replaySeconds, deterministic ? "true" : "false");
+    fclose(f);
+    return true;
+}
+
+} // namespace
+
+// ─── Main ───────────────────────────────────────────────────────
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if (!ParseOptions(argc, argv, &opt)) {
+        fprintf(stderr, "usage: %s --trace FILE... [--rate HZ] [--lead-ms MS] [--predict off|linear|accel] "
+                        "[--refilter] [--csv FILE] [--json FILE] [--check]\n"
+                        "       %s --synthesize BASE [--seconds S] [--mouse-hz HZ] [--tick-hz HZ] [--rate HZ] "
+                        "[--lead-ms MS] [--raw] [--filter ema|one-euro|kalman] [--counts-per-meter N]\n",
+                        argv[0], argv[0]);
+        return 2;
+    }
+    if (!opt.synthesize.empty()) return Synthesize(opt) ? 0 : 1;
+
+    Trace trace;
+    for (const std::string& path : opt.traces) {
+        if (!LoadTrace(path.c_str(), &trace)) return 1;
+    }
+    SortTrace(&trace);
+    if (trace.events.empty()) {
+        fprintf(stderr, "error: no records\n");
+        return 1;
+    }
+    if (!trace.hasFrames) AddFrames(&trace, opt);
+
+    printf("treadmill_trace_replay: %zu file(s), %zu records%s\n", opt.traces.size(), trace.events.size(),
+           trace.hasFrames ? "" : ", frames generated");
+
+    ReplayResult first  = Replay(trace, opt);
+    ReplayResult second = Replay(trace, opt);
+    bool deterministic  = first.hash == second.hash;
+    if (second.replaySeconds < first.replaySeconds) first.replaySeconds = second.replaySeconds;   // warm run
+    PrintResult(first, deterministic);
+
+    if (!opt.csvPath.empty() && !WriteCsv(opt.csvPath.c_str(), first, trace.events.front().timestamp, trace.frequency)) {
+        fprintf(stderr, "error: cannot write %s\n", opt.csvPath.c_str());
+        return 1;
+    }
+    if (!opt.jsonPath.empty() && !WriteJson(opt.jsonPath.c_str(), opt, first, deterministic)) {
+        fprintf(stderr, "error: cannot write %s\n", opt.jsonPath.c_str());
+        return 1;
+    }
+
+    if (opt.check) {
+        bool ok = true;
+        if (first.tickMismatches) {
+            fprintf(stderr, "\nFAIL: %zu filter steps did not reproduce\n", first.tickMismatches);
+            ok = false;
+        }
+        if (first.frameMismatches) {
+            fprintf(stderr, "\nFAIL: %zu recorded frames did not reproduce\n", first.frameMismatches);
+            ok = false;
+        }
+        if (!deterministic) {
+            fprintf(stderr, "\nFAIL: two passes over the same trace differ\n");
+            ok = false;
+        }
+        if (!(first.replaySeconds < first.traceSeconds)) {
+            fprintf(stderr, "\nFAIL: replay slower than real time\n");
+            ok = false;
+        }
+        if (!ok) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,364 @@
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Input Processing Core
+// ═══════════════════════════════════════════════════════════════════
+// See input_core.h. Pure C-style code: no allocation, no globals, no
+// libm transcendentals (input_core_math.h).
+// ═══════════════════════════════════════════════════════════════════
+
+#include "input_core.h"
+#include "input_core_math.h"
+
+#include <string.h>
+
+#define MIN_STEP_SECONDS    1e-6
+#define DEAD_ZONE_DECAY     0.8     // per reference tick
+#define DEAD_ZONE_SNAP      0.5     // filter units; below this inside the dead zone → 0
+#define NOMINAL_MAX_SPEED   100.0   // filter units per reference tick at MaxSpeed 100 %
+
+// Adaptive filters; time in reference ticks, speed in filter units
+#define ONE_EURO_REST_SCALE 0.5
+#define ONE_EURO_TREND_TAU  1.5
+#define ONE_EURO_BETA       0.5
+#define ONE_EURO_MAX_RATE   2.0
+#define KALMAN_NOISE        1.0     // measurement noise density per sensitivity², at smoothing 0.5
+#define KALMAN_JERK         1.5     // process noise density at adaptivity 1
+#define KALMAN_JERK_FLOOR   0.05    // added to adaptivity: at 0 the speed must still move
+#define FIXED_STEP_IDLE_RUN 16      // empty bins; a longer run resets the filter to rest
+#define FIXED_STEP_SPREAD   0.012   // seconds; longest report interval counts are spread over (125 Hz = 8 ms)
+
+static inline double Clamp(double v, double lo, double hi)
+{
+    return v < lo ? lo : v > hi ? hi : v;
+}
+
+// ─── API ────────────────────────────────────────────────────────
+
+int32_t TreadmillInput_AbiVersion(void)
+{
+    return TREADMILL_INPUT_ABI_VERSION;
+}
+
+void TreadmillInput_DefaultConfig(TreadmillInputConfig* config)
+{
+    config->sensitivity     = 2.0;
+    config->deadZone        = 5.0;
+    config->smoothing       = 0.25;
+    config->maxSpeed        = 100.0;
+    config->invertDirection = 0;
+    config->filter          = TREADMILL_INPUT_FILTER_EMA;
+    config->adaptivity      = 0.5;
+    memset(&config->calibration, 0, sizeof(config->calibration));
+}
+
+void TreadmillInput_Reset(TreadmillInputState* state, int64_t timestamp)
+{
+    state->smoothed      = 0.0;
+    state->pendingDeltaY = 0.0;
+    state->velocity      = 0.0;
+    state->lastTimestamp = timestamp;
+    state->lastEvent     = timestamp;
+    state->trend         = 0.0;
+    state->offset        = 0.0;
+    state->covariance[0] = 0.0;
+    state->covariance[1] = 0.0;
+    state->covariance[2] = 0.0;
+    state->speed         = 0.0;
+}
+
+// ─── Filters ────────────────────────────────────────────────────
+//
+// Each takes the step's input in units per reference tick and its
+// length in reference ticks, and returns the new estimate.
+
+// EMA with the smoothing factor compounded to the step length; inside
+// the dead zone, decay towards zero
+static double EmaStep(TreadmillInputState* state, const TreadmillInputConfig* config,
+                      double scaledDelta, double tickScale, double smoothing)
+{
+    double alpha    = 1.0 - InputMathPow(1.0 - smoothing, tickScale);
+    double smoothed = state->smoothed * (1.0 - alpha) + scaledDelta * alpha;
+
+    if (fabs(smoothed) < config->deadZone) {
+        smoothed *= InputMathPow(DEAD_ZONE_DECAY, tickScale);
+        if (fabs(smoothed) < DEAD_ZONE_SNAP) smoothed = 0.0;
+    }
+    return smoothed;
+}
+
+// One-Euro: a first-order low-pass whose rate is ONE_EURO_REST_SCALE
+// of the EMA's at rest (smoothing s per reference tick is a rate of
+// -ln(1 - s)) plus beta times the low-passed rate of change of the
+// estimate — smoother than the EMA at a steady walk, quicker when the
+// speed changes. It needs evenly spread counts: fed a slow mouse's
+// report bursts, the estimate's own ripple would open the cutoff.
+static double OneEuroStep(TreadmillInputState* state, const TreadmillInputConfig* config,
+                          double scaledDelta, double tickScale, double smoothing)
+{
+    if (smoothing >= 1.0) return scaledDelta;
+    double beta  = Clamp(config->adaptivity, 0.0, 1.0) * ONE_EURO_BETA;
+    double rate  = -InputMathLog(1.0 - smoothing) * ONE_EURO_REST_SCALE + beta * fabs(state->trend);
+    if (rate > ONE_EURO_MAX_RATE) rate = ONE_EURO_MAX_RATE;
+    double alpha = 1.0 - InputMathExp(-rate * tickScale);
+    double smoothed = state->smoothed + (scaledDelta - state->smoothed) * alpha;
+
+    double change = (smoothed - state->smoothed) / tickScale;
+    state->trend += (change - state->trend) * (tickScale / (tickScale + ONE_EURO_TREND_TAU));
+    return smoothed;
+}
+
+// Kalman, constant velocity: state (position, speed), white acceleration
+// noise, and the step's counts as a position measurement. Positions are
+// kept as the estimate's offset from the measured sum, which is all the
+// filter needs and never grows. Both noises are densities, so the gain
+// does not depend on the step length.
+static double KalmanStep(TreadmillInputState* state, const TreadmillInputConfig* config,
+                         double scaledDelta, double tickScale, double smoothing)
+{
+    double h = tickScale;
+    double* P = state->covariance;
+
+    // Predict: the estimate moves at its speed, the measurement by the counts
+    double offset = state->offset + (state->smoothed - scaledDelta) * h;
+    double adapt  = Clamp(config->adaptivity, 0.0, 1.0) + KALMAN_JERK_FLOOR;
+    double q      = KALMAN_JERK * adapt * adapt;
+    P[0] += h * (2.0 * P[1] + h * P[2]) + q * h * h * h / 3.0;
+    P[1] += h * P[2] + q * h * h / 2.0;
+    P[2] += q * h;
+
+    // Update against the measured position (innovation = -offset)
+    double sensitivity = config->sensitivity;
+    double noise = sensitivity * sensitivity * KALMAN_NOISE * (1.0 - smoothing) / smoothing / h;
+    double s  = P[0] + noise;
+    if (s <= 0.0) {
+        state->offset = 0.0;
+        return scaledDelta;
+    }
+    double k0 = P[0] / s;
+    double k1 = P[1] / s;
+    double smoothed = state->smoothed - k1 * offset;
+    state->offset = offset * (1.0 - k0);
+    P[2] -= k1 * P[1];
+    P[1] *= 1.0 - k0;
+    P[0] *= 1.0 - k0;
+    return smoothed;
+}
+
+double TreadmillInput_Step(TreadmillInputState* state, const TreadmillInputConfig* config,
+                           double deltaY, double elapsedSeconds)
+{
+    // Fraction of a reference tick that this step covered
+    double tickScale = (elapsedSeconds > MIN_STEP_SECONDS ? elapsedSeconds : MIN_STEP_SECONDS)
+                     / TREADMILL_INPUT_REFERENCE_TICK;
+
+    // Mouse Y: negative = surface moving forward = positive velocity (unless inverted).
+    // Divided by tickScale: the filter works in units per reference tick
+    double direction   = config->invertDirection ? 1.0 : -1.0;
+    double scaledDelta = deltaY * direction * config->sensitivity / tickScale;
+    double smoothing   = Clamp(config->smoothing, 0.05, 1.0);
+
+    // The adaptive filters' dead zone only gates the output
+    double smoothed, output;
+    switch (config->filter) {
+    case TREADMILL_INPUT_FILTER_ONE_EURO:
+        smoothed = OneEuroStep(state, config, scaledDelta, tickScale, smoothing);
+        output   = fabs(smoothed) < config->deadZone ? 0.0 : smoothed;
+        break;
+    case TREADMILL_INPUT_FILTER_KALMAN:
+        smoothed = KalmanStep(state, config, scaledDelta, tickScale, smoothing);
+        output   = fabs(smoothed) < config->deadZone ? 0.0 : smoothed;
+        break;
+    default:
+        smoothed = EmaStep(state, config, scaledDelta, tickScale, smoothing);
+        output   = smoothed;
+        break;
+    }
+    state->smoothed = smoothed;
+
+    // Calibrated: filter units back to counts, then to m/s through the curve
+    const TreadmillInputCalibration* calibration = &config->calibration;
+    if (calibration->countsPerMeter > 0.0 && calibration->topSpeed > 0.0) {
+        state->speed    = output / (config->sensitivity * calibration->countsPerMeter * TREADMILL_INPUT_REFERENCE_TICK);
+        state->velocity = TreadmillInput_MapSpeed(calibration, state->speed);
+        return state->velocity;
+    }
+
+    double maxRawSpeed = NOMINAL_MAX_SPEED * (config->maxSpeed / 100.0);
+    state->speed    = 0.0;
+    state->velocity = Clamp(output / maxRawSpeed, -1.0, 1.0);
+    return state->velocity;
+}
+
+// Closes the pending bin and `empty` more without motion. A long run of
+// empty bins means the treadmill stopped: rather than step through it
+// (or take it as one step, which a Kalman filter overshoots), go back
+// to rest.
+static void CloseBins(TreadmillInputState* state, const TreadmillInputConfig* config,
+                      int64_t empty, int64_t step, double stepSeconds)
+{
+    TreadmillInput_Step(state, config, state->pendingDeltaY, stepSeconds);
+    state->pendingDeltaY  = 0.0;
+    state->lastTimestamp += step;
+
+    if (empty > FIXED_STEP_IDLE_RUN) {
+        int64_t lastEvent = state->lastEvent;
+        TreadmillInput_Reset(state, state->lastTimestamp + empty * step);
+        state->lastEvent = lastEvent;
+        return;
+    }
+    for (; empty > 0; empty--) {
+        TreadmillInput_Step(state, config, 0.0, stepSeconds);
+        state->lastTimestamp += step;
+    }
+}
+
+// Adaptive filters: the state's clock moves in fixed bins (last, last +
+// step], one step per bin. Each event's counts are spread evenly over
+// the time since the previous event (at most FIXED_STEP_SPREAD), so a
+// slow mouse's reports do not turn into a train of full and empty bins.
+// Counts spread before the clock are added to the pending bin.
+static double ProcessEventsFixedStep(TreadmillInputState* state, const TreadmillInputConfig* config,
+                                     const TreadmillInputEvent* events, uint32_t count,
+                                     int64_t now, int64_t frequency)
+{
+    int64_t step = (int64_t)((double)frequency * TREADMILL_INPUT_FIXED_STEP + 0.5);
+    if (step < 1) step = 1;
+    int64_t spread = (int64_t)((double)frequency * FIXED_STEP_SPREAD + 0.5);
+    double stepSeconds = (double)step / (double)frequency;
+
+    for (uint32_t i = 0; i < count; i++) {
+        int64_t t     = events[i].timestamp;
+        double  dy    = (double)events[i].dy;
+        int64_t start = t - spread > state->lastEvent ? t - spread : state->lastEvent;
+        if (start >= t) start = t - 1;      // same timestamp as the last event, or older
+        else state->lastEvent = t;
+
+        // Bins that end before the event's span begins get none of it
+        int64_t from = start > state->lastTimestamp ? start : state->lastTimestamp;
+        if (t > state->lastTimestamp + step && from >= state->lastTimestamp + step)
+            CloseBins(state, config, (from - state->lastTimestamp) / step - 1, step, stepSeconds);
+
+        // Then share the counts out over the bins the span covers
+        double left = dy;
+        while (t > state->lastTimestamp + step) {
+            int64_t end  = state->lastTimestamp + step;
+            double  part = dy * (double)(end - from) / (double)(t - start);
+            state->pendingDeltaY += part;
+            left -= part;
+            CloseBins(state, config, 0, step, stepSeconds);
+            from = end;
+        }
+        state->pendingDeltaY += left;
+    }
+
+    // Close every bin that has ended by `now` and that no later event can
+    // still spread into: up to the newest event, or a spread ago
+    int64_t settled = now - spread > state->lastEvent ? now - spread : state->lastEvent;
+    if (settled > now) settled = now;
+    if (settled >= state->lastTimestamp + step)
+        CloseBins(state, config, (settled - state->lastTimestamp) / step - 1, step, stepSeconds);
+    return state->velocity;
+}
+
+double TreadmillInput_ProcessEvents(TreadmillInputState* state, const TreadmillInputConfig* config,
+                                    const TreadmillInputEvent* events, uint32_t count,
+                                    int64_t now, int64_t frequency)
+{
+    if (frequency <= 0) return state->velocity;
+    if (config->filter == TREADMILL_INPUT_FILTER_ONE_EURO || config->filter == TREADMILL_INPUT_FILTER_KALMAN)
+        return ProcessEventsFixedStep(state, config, events, count, now, frequency);
+
+    double secondsPerTick = 1.0 / (double)frequency;
+
+    for (uint32_t i = 0; i < count; i++) {
+        state->pendingDeltaY += (double)events[i].dy;
+
+        // Same-timestamp events are one step; stale ones wait for the clock to move
+        int64_t t = events[i].timestamp;
+        if (t <= state->lastTimestamp) continue;
+        if (i + 1 < count && events[i + 1].timestamp == t) continue;
+
+        TreadmillInput_Step(state, config, state->pendingDeltaY,
+                            (double)(t - state->lastTimestamp) * secondsPerTick);
+        state->pendingDeltaY = 0.0;
+        state->lastTimestamp = t;
+    }
+
+    // Idle up to `now`, carrying anything still pending
+    if (now > state->lastTimestamp) {
+        TreadmillInput_Step(state, config, state->pendingDeltaY,
+                            (double)(now - state->lastTimestamp) * secondsPerTick);
+        state->pendingDeltaY = 0.0;
+        state->lastTimestamp = now;
+    }
+    return state->velocity;
+}
+
+// ─── Calibration ────────────────────────────────────────────────
+
+void TreadmillInput_BakeCurve(TreadmillInputCalibration* calibration, double topSpeed,
+                              const double* points, uint32_t count)
+{
+    calibration->topSpeed = topSpeed > 0.0 ? topSpeed : 0.0;
+
+    for (uint32_t i = 0; i < TREADMILL_INPUT_CURVE_SIZE; i++) {
+        double u = (double)i / (double)(TREADMILL_INPUT_CURVE_SIZE - 1);
+        double output;
+        if (count < 2) {
+            output = u;
+        } else {
+            double   x = u * (double)(count - 1);
+            uint32_t j = (uint32_t)x;
+            if (j >= count - 1) j = count - 2;
+            output = points[j] + (points[j + 1] - points[j]) * (x - (double)j);
+        }
+        calibration->curve[i] = (float)Clamp(output, 0.0, 1.0);
+    }
+}
+
+double TreadmillInput_MapSpeed(const TreadmillInputCalibration* calibration, double speed)
+{
+    if (!(calibration->topSpeed > 0.0)) return 0.0;
+
+    const float* curve = calibration->curve;
+    double x = fabs(speed) / calibration->topSpeed * (double)(TREADMILL_INPUT_CURVE_SIZE - 1);
+    double output;
+    if (x < (double)(TREADMILL_INPUT_CURVE_SIZE - 1)) {
+        int    i = (int)x;
+        output = (double)curve[i] + ((double)curve[i + 1] - (double)curve[i]) * (x - (double)i);
+    } else {
+        output = (double)curve[TREADMILL_INPUT_CURVE_SIZE - 1];
+    }
+    return speed < 0.0 ? -output : output;
+}
+
+void TreadmillInput_CalibrationBegin(TreadmillCalibrationRun* run)
+{
+    memset(run, 0, sizeof(*run));
+}
+
+void TreadmillInput_CalibrationAdd(TreadmillCalibrationRun* run, const TreadmillInputEvent* events, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        // The first event's counts moved before the run began
+        if (run->events++ == 0) {
+            run->first = run->last = events[i].timestamp;
+            continue;
+        }
+        run->counts += events[i].dy;
+        if (events[i].timestamp > run->last) run->last = events[i].timestamp;
+    }
+}
+
+double TreadmillInput_CalibrationSeconds(const TreadmillCalibrationRun* run, int64_t frequency)
+{
+    if (frequency <= 0) return 0.0;
+    return (double)(run->last - run->first) / (double)frequency;
+}
+
+double TreadmillInput_CalibrationResult(const TreadmillCalibrationRun* run, double beltSpeed, int64_t frequency)
+{
+    double seconds = TreadmillInput_CalibrationSeconds(run, frequency);
+    if (seconds <= 0.0 || beltSpeed <= 0.0 || run->counts == 0) return 0.0;
+    double counts = (double)(run->counts < 0 ? -run->counts : run->counts);
+    return counts / (beltSpeed * seconds);
+}
@@ -0,0 +1,193 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Input Processing Core (C ABI)
+// ═══════════════════════════════════════════════════════════════════
+// The filter that turns raw treadmill (mouse) deltas into a normalised
+// velocity: smoothing, dead zone and MaxSpeed normalisation. Every step
+// is scaled to a 16 ms reference tick, so the same settings feel the
+// same at any step rate — from the app's fixed processing tick down to
+// one step per raw input event.
+//
+// Three interchangeable smoothing filters (config.filter):
+//
+//   EMA        fixed-factor exponential average; inside the dead zone
+//              the state decays towards zero. The original filter,
+//              kept bit-exact so recorded traces still replay.
+//   ONE_EURO   low-pass whose cutoff rises with the rate of change
+//              (Casiez et al., 2012): smooth at a steady walk, quick
+//              when starting and stopping.
+//   KALMAN     constant-velocity Kalman filter over belt position and
+//              speed, the counts being noisy position measurements.
+//
+// `smoothing` sets how much each smooths steady motion and `adaptivity`
+// how readily the two adaptive ones follow a change. Their dead zone
+// gates the output only, so it never drags the estimate. Fed with raw
+// events (TreadmillInput_ProcessEvents) they step on a fixed
+// TREADMILL_INPUT_FIXED_STEP grid of the events' own timestamps, each
+// report's counts spread over the time since the one before: a rate
+// of change taken over single mouse reports is mostly noise. They
+// also run under TreadmillInput_Step, but a slow mouse's bursts then
+// reach them as they came.
+//
+// Physical units (config.calibration): once the sensor's counts per
+// meter of belt are known, the filtered speed is converted to m/s and
+// mapped through a response curve — a table baked ahead of time by
+// TreadmillInput_BakeCurve, so a step costs one interpolation — instead
+// of the MaxSpeed normalisation, whose counts per tick depend on the
+// mouse's DPI. TreadmillInput_Calibration* measure the counts per meter
+// from a run at a known belt speed.
+//
+// Built twice from input_core.cpp:
+//
+//   treadmill_input        — shared library P/Invoked by the WPF app
+//                            (InputProcessor.cs)
+//   treadmill_input_core   — static library for the layer, tests and
+//                            benchmarks
+//
+// The math uses only IEEE-754 basic operations (input_core_math.h, no
+// libm transcendentals, no FP contraction), so a given input stream
+// yields bit-identical output on Windows and Linux.
+//
+// All structs are plain C with explicit padding; keep them in sync with
+// NativeMethods.cs and bump TREADMILL_INPUT_ABI_VERSION on any change.
+// ═══════════════════════════════════════════════════════════════════
+
+#include <stdint.h>
+
+#define TREADMILL_INPUT_ABI_VERSION     3
+#define TREADMILL_INPUT_REFERENCE_TICK  0.016   // seconds; the tick the constants were tuned for
+#define TREADMILL_INPUT_FIXED_STEP      0.002   // seconds; event grid of the adaptive filters
+#define TREADMILL_INPUT_CURVE_SIZE      64      // response curve table entries
+
+// TreadmillInputConfig.filter
+#define TREADMILL_INPUT_FILTER_EMA      0
+#define TREADMILL_INPUT_FILTER_ONE_EURO 1
+#define TREADMILL_INPUT_FILTER_KALMAN   2
+#define TREADMILL_INPUT_FILTER_COUNT    3
+
+#if defined(TREADMILL_INPUT_SHARED)
+#  if defined(_WIN32)
+#    define TREADMILL_INPUT_API __declspec(dllexport)
+#  else
+#    define TREADMILL_INPUT_API __attribute__((visibility("default")))
+#  endif
+#else
+#  define TREADMILL_INPUT_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ─── Types ──────────────────────────────────────────────────────
+
+// Counts per meter and the response curve: output 0 … 1 at speeds
+// evenly spaced from 0 to topSpeed, held beyond it, mirrored for
+// backwards. Uncalibrated (countsPerMeter 0) uses MaxSpeed instead.
+typedef struct TreadmillInputCalibration {
+    double      countsPerMeter;     // sensor counts per meter of belt; 0 = uncalibrated
+    double      topSpeed;           // m/s of the last entry
+    float       curve[TREADMILL_INPUT_CURVE_SIZE];
+} TreadmillInputCalibration;
+
+typedef struct TreadmillInputConfig {
+    double      sensitivity;        // delta multiplier, 0.1 … 10
+    double      deadZone;           // filter units per reference tick, 0 … 50
+    double      smoothing;          // EMA factor per reference tick, 0.05 … 1 (lower = smoother)
+    double      maxSpeed;           // percent of the nominal top speed, 1 … 100 (uncalibrated)
+    int32_t     invertDirection;    // non-zero: positive Y delta = forward
+    int32_t     filter;             // TREADMILL_INPUT_FILTER_*; unknown values run EMA
+    double      adaptivity;         // ONE_EURO / KALMAN: 0 … 1, how readily they follow a change
+    TreadmillInputCalibration calibration;
+} TreadmillInputConfig;
+
+typedef struct TreadmillInputState {
+    double      smoothed;           // filter units per reference tick
+    double      pendingDeltaY;      // event deltas not yet stepped (no time had passed)
+    double      velocity;           // last output, -1 … 1
+    int64_t     lastTimestamp;      // event clock time the filter has reached
+    double      trend;              // ONE_EURO: filtered rate of change, units per reference tick²
+    double      offset;             // KALMAN: estimated minus measured position, units × ticks
+    double      covariance[3];      // KALMAN: P00, P01, P11 of (position, smoothed)
+    int64_t     lastEvent;          // ONE_EURO / KALMAN: timestamp of the latest event
+    double      speed;              // calibrated: last output in m/s, else 0
+} TreadmillInputState;
+
+typedef struct TreadmillInputEvent {
+    int64_t     timestamp;          // event clock ticks
+    int32_t     dx;
+    int32_t     dy;
+} TreadmillInputEvent;
+
+// A calibration run: forward counts over the span of their events.
+typedef struct TreadmillCalibrationRun {
+    int64_t     counts;             // Y counts of every event after the first
+    int64_t     first;              // event clock ticks; the span starts at the first event
+    int64_t     last;
+    uint32_t    events;
+    uint32_t    reserved;
+} TreadmillCalibrationRun;
+
+// ─── API ────────────────────────────────────────────────────────
+
+// TREADMILL_INPUT_ABI_VERSION of the library actually loaded.
+TREADMILL_INPUT_API int32_t TreadmillInput_AbiVersion(void);
+
+// The app's defaults (sensitivity 2, dead zone 5, smoothing 0.25, max speed 100,
+// EMA, adaptivity 0.5, uncalibrated).
+TREADMILL_INPUT_API void TreadmillInput_DefaultConfig(TreadmillInputConfig* config);
+
+// Zero velocity, with the event clock starting at `timestamp`.
+TREADMILL_INPUT_API void TreadmillInput_Reset(TreadmillInputState* state, int64_t timestamp);
+
+// One filter step: `deltaY` raw counts accumulated over `elapsedSeconds`.
+// Returns the normalised velocity (-1 … 1), also left in state->velocity.
+TREADMILL_INPUT_API double TreadmillInput_Step(TreadmillInputState* state,
+                                               const TreadmillInputConfig* config,
+                                               double deltaY, double elapsedSeconds);
+
+// Runs the filter at the raw-event rate: one step per distinct event
+// timestamp (events sharing a timestamp are summed), then an idle step
+// up to `now` so the velocity decays when the events stop. Events older
+// than the state's clock are folded into the next step. `frequency` is
+// event clock ticks per second. Returns the velocity at `now`.
+//
+// ONE_EURO and KALMAN instead sum the events into TREADMILL_INPUT_FIXED_STEP
+// bins, each event spread over the time since the previous one (up to
+// 12 ms), and step once per bin. The state's clock then stays on the
+// grid and only passes the newest event once no later one could still
+// spread back, 12 ms on; the partial bin stays pending.
+TREADMILL_INPUT_API double TreadmillInput_ProcessEvents(TreadmillInputState* state,
+                                                        const TreadmillInputConfig* config,
+                                                        const TreadmillInputEvent* events, uint32_t count,
+                                                        int64_t now, int64_t frequency);
+
+// ─── Calibration ────────────────────────────────────────────────
+
+// Bakes `count` curve points — outputs 0 … 1 at speeds evenly spaced
+// from 0 to `topSpeed` m/s, linearly interpolated — into the table.
+// Fewer than two points bake a straight line. countsPerMeter is kept.
+TREADMILL_INPUT_API void TreadmillInput_BakeCurve(TreadmillInputCalibration* calibration, double topSpeed,
+                                                  const double* points, uint32_t count);
+
+// The curve's output (-1 … 1) for `speed` m/s; 0 without a curve.
+TREADMILL_INPUT_API double TreadmillInput_MapSpeed(const TreadmillInputCalibration* calibration, double speed);
+
+TREADMILL_INPUT_API void TreadmillInput_CalibrationBegin(TreadmillCalibrationRun* run);
+
+// Adds raw events in timestamp order.
+TREADMILL_INPUT_API void TreadmillInput_CalibrationAdd(TreadmillCalibrationRun* run,
+                                                       const TreadmillInputEvent* events, uint32_t count);
+
+// Seconds the run spans so far (`frequency` event clock ticks per second).
+TREADMILL_INPUT_API double TreadmillInput_CalibrationSeconds(const TreadmillCalibrationRun* run, int64_t frequency);
+
+// Counts per meter with the belt running at `beltSpeed` m/s: the counts
+// after the first event over the time since it, so the mouse's report
+// rate does not matter. 0 if the run spans no time or saw no motion.
+TREADMILL_INPUT_API double TreadmillInput_CalibrationResult(const TreadmillCalibrationRun* run, double beltSpeed,
+                                                            int64_t frequency);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,95 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Deterministic Math for the Input Core
+// ═══════════════════════════════════════════════════════════════════
+// libm's exp/log/pow are only "faithfully rounded": MSVC's CRT and
+// glibc may disagree in the last bit, and the filter feeds its output
+// back into itself, so one ulp compounds into a different stream. These
+// replacements use only +, -, *, / and the exact frexp/ldexp/floor, so
+// every IEEE-754 platform computes the same bits — provided the
+// compiler does not fuse multiply-adds (-ffp-contract=off; MSVC's
+// default /fp:precise does not contract).
+//
+// exp and log are within ~2 ulp; pow = exp(y·ln x) loses another
+// ~|y·ln x| ulp, which is negligible for the filter's short steps.
+// ═══════════════════════════════════════════════════════════════════
+
+#include <math.h>
+
+// ln 2 split so that k·LN2_HI is exact for |k| < 2^11 (fdlibm's constants)
+#define INPUT_MATH_LN2_HI       6.93147180369123816490e-01
+#define INPUT_MATH_LN2_LO       1.90821492927058770002e-10
+#define INPUT_MATH_INV_LN2      1.44269504088896338700e+00
+#define INPUT_MATH_SQRT1_2      0.70710678118654752440
+
+// e^y
+static inline double InputMathExp(double y)
+{
+    if (y != y)       return y;
+    if (y < -745.2)   return 0.0;
+    if (y > 709.7)    return HUGE_VAL;
+
+    // y = k·ln2 + r, |r| ≤ ln2/2
+    double k = floor(y * INPUT_MATH_INV_LN2 + 0.5);
+    double r = (y - k * INPUT_MATH_LN2_HI) - k * INPUT_MATH_LN2_LO;
+
+    // Taylor series to r^13/13!; the remainder is below 1e-17 relative
+    double p = 1.0 / 6227020800.0;
+    p = p * r + 1.0 / 479001600.0;
+    p = p * r + 1.0 / 39916800.0;
+    p = p * r + 1.0 / 3628800.0;
+    p = p * r + 1.0 / 362880.0;
+    p = p * r + 1.0 / 40320.0;
+    p = p * r + 1.0 / 5040.0;
+    p = p * r + 1.0 / 720.0;
+    p = p * r + 1.0 / 120.0;
+    p = p * r + 1.0 / 24.0;
+    p = p * r + 1.0 / 6.0;
+    p = p * r + 0.5;
+    p = p * r + 1.0;
+    p = p * r + 1.0;
+    return ldexp(p, (int)k);
+}
+
+// ln x, x > 0
+static inline double InputMathLog(double x)
+{
+    if (x != x || x < 0.0) return NAN;
+    if (x == 0.0)          return -HUGE_VAL;
+    if (x == HUGE_VAL)     return x;
+
+    // x = m·2^k with m ∈ [√½, √2)
+    int k;
+    double m = frexp(x, &k);
+    if (m < INPUT_MATH_SQRT1_2) {
+        m *= 2.0;
+        k--;
+    }
+
+    // ln m = 2·atanh(f), f = (m-1)/(m+1), |f| ≤ 0.172; series to f^23
+    double f  = (m - 1.0) / (m + 1.0);
+    double f2 = f * f;
+    double s = 1.0 / 23.0;
+    s = s * f2 + 1.0 / 21.0;
+    s = s * f2 + 1.0 / 19.0;
+    s = s * f2 + 1.0 / 17.0;
+    s = s * f2 + 1.0 / 15.0;
+    s = s * f2 + 1.0 / 13.0;
+    s = s * f2 + 1.0 / 11.0;
+    s = s * f2 + 1.0 / 9.0;
+    s = s * f2 + 1.0 / 7.0;
+    s = s * f2 + 1.0 / 5.0;
+    s = s * f2 + 1.0 / 3.0;
+    s = s * f2 + 1.0;
+
+    double dk = (double)k;
+    return dk * INPUT_MATH_LN2_HI + (dk * INPUT_MATH_LN2_LO + 2.0 * f * s);
+}
+
+// base^exponent for base ≥ 0, exponent > 0 — all the filter needs
+static inline double InputMathPow(double base, double exponent)
+{
+    if (base <= 0.0)   return 0.0;
+    if (base == 1.0)   return 1.0;
+    return InputMathExp(exponent * InputMathLog(base));
+}
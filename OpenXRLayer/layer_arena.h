@@ -0,0 +1,76 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Layer Arena
+// ═══════════════════════════════════════════════════════════════════
+// Bump allocator for layer state that lives until xrDestroyInstance.
+// Nothing is freed individually: tables that have been replaced stay
+// valid until the arena is reset, which is what lets readers keep
+// using a pointer they loaded without any reference counting.
+// ═══════════════════════════════════════════════════════════════════
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#define LAYER_ARENA_CHUNK_SIZE  (16 * 1024)
+
+struct LayerArenaChunk {
+    LayerArenaChunk*    next;
+    size_t              size;       // usable bytes after the header
+    size_t              used;
+};
+
+struct LayerArena {
+    LayerArenaChunk*    head;
+    size_t              totalBytes;
+};
+
+static inline size_t LayerArenaAlignUp(size_t v, size_t align)
+{
+    return (v + align - 1) & ~(align - 1);
+}
+
+static inline unsigned char* LayerArenaChunkData(LayerArenaChunk* c)
+{
+    return (unsigned char*)c + LayerArenaAlignUp(sizeof(LayerArenaChunk), 16);
+}
+
+// Returns zeroed, `align`-aligned memory, or NULL if the system is out
+// of memory. `align` must be a power of two no larger than 16.
+static inline void* LayerArenaAlloc(LayerArena* arena, size_t bytes, size_t align = 16)
+{
+    LayerArenaChunk* c = arena->head;
+    if (c) {
+        size_t off = LayerArenaAlignUp(c->used, align);
+        if (off + bytes <= c->size) {
+            c->used = off + bytes;
+            return LayerArenaChunkData(c) + off;
+        }
+    }
+
+    size_t size   = bytes > LAYER_ARENA_CHUNK_SIZE ? bytes : LAYER_ARENA_CHUNK_SIZE;
+    size_t header = LayerArenaAlignUp(sizeof(LayerArenaChunk), 16);
+    c = (LayerArenaChunk*)calloc(1, header + size);
+    if (!c) return NULL;
+
+    c->next  = arena->head;
+    c->size  = size;
+    c->used  = bytes;
+    arena->head        = c;
+    arena->totalBytes += header + size;
+    return LayerArenaChunkData(c);
+}
+
+// Frees every chunk. Callers must guarantee no reader still holds a
+// pointer into the arena.
+static inline void LayerArenaReset(LayerArena* arena)
+{
+    LayerArenaChunk* c = arena->head;
+    while (c) {
+        LayerArenaChunk* next = c->next;
+        free(c);
+        c = next;
+    }
+    arena->head       = NULL;
+    arena->totalBytes = 0;
+}
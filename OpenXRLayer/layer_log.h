@@ -0,0 +1,187 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Layer Log Core
+// ═══════════════════════════════════════════════════════════════════
+// Bounded lock-free MPSC ring of preformatted log lines. Game threads
+// format straight into a claimed slot and never block or touch the
+// disk; a drain thread turns slots into timestamped text and hands it
+// to a sink in large batches. When the ring is full new messages are
+// dropped and counted rather than stalling the caller.
+//
+// Platform-neutral: the layer supplies the clock, thread and sink.
+// ═══════════════════════════════════════════════════════════════════
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <atomic>
+
+// ─── Levels ─────────────────────────────────────────────────────
+
+enum LogLevel {
+    LOG_LEVEL_OFF   = 0,
+    LOG_LEVEL_ERROR = 1,
+    LOG_LEVEL_WARN  = 2,
+    LOG_LEVEL_INFO  = 3,
+    LOG_LEVEL_DEBUG = 4,
+};
+
+#define LOG_LEVEL_ENV       "TREADMILL_LAYER_LOG_LEVEL"
+#define LOG_LEVEL_DEFAULT   LOG_LEVEL_INFO
+
+// Messages above this level are compiled out entirely.
+#ifndef LOG_MAX_LEVEL
+#define LOG_MAX_LEVEL       LOG_LEVEL_DEBUG
+#endif
+
+// Parses "off"/"error"/"warn"/"info"/"debug" or "0"…"4".
+// Returns `fallback` for NULL or unrecognised values.
+static inline int LogParseLevel(const char* s, int fallback)
+{
+    if (!s || !*s) return fallback;
+    if (s[0] >= '0' && s[0] <= '4' && s[1] == 0) return s[0] - '0';
+
+    static const char* const names[] = { "off", "error", "warn", "info", "debug" };
+    for (int i = 0; i < 5; i++) {
+        const char* a = s;
+        const char* b = names[i];
+        while (*a && *b && (*a | 0x20) == *b) { a++; b++; }
+        if (!*a && !*b) return i;
+    }
+    return fallback;
+}
+
+// ─── Ring ───────────────────────────────────────────────────────
+
+#define LOG_RING_SIZE       1024            // power of two
+#define LOG_MESSAGE_MAX     232             // bytes of text per slot, incl. NUL
+
+struct LogSlot {
+    std::atomic<uint32_t>   seq;            // Vyukov cell sequence
+    uint8_t                 level;
+    uint8_t                 reserved;
+    uint16_t                length;
+    uint32_t                threadId;
+    int64_t                 timestampUs;    // microseconds since the Unix epoch
+    char                    text[LOG_MESSAGE_MAX];
+};
+
+struct LogRing {
+    alignas(64) std::atomic<uint32_t>   head;       // next slot producers claim
+    alignas(64) uint32_t                tail;       // drain thread only
+    std::atomic<uint32_t>               dropped;
+    alignas(64) LogSlot                 slots[LOG_RING_SIZE];
+};
+
+static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "ring size must be a power of two");
+static_assert(sizeof(LogSlot) == 256, "keep slots a multiple of the cache line");
+
+static inline void LogRingInit(LogRing* r)
+{
+    for (uint32_t i = 0; i < LOG_RING_SIZE; i++) r->slots[i].seq.store(i, std::memory_order_relaxed);
+    r->tail = 0;
+    r->dropped.store(0, std::memory_order_relaxed);
+    r->head.store(0, std::memory_order_release);
+}
+
+// Formats one message into the ring. Returns false if it was dropped.
+static inline bool LogRingPushV(LogRing* r, int level, uint32_t threadId, int64_t timestampUs,
+                                const char* fmt, va_list args)
+{
+    uint32_t pos = r->head.load(std::memory_order_relaxed);
+    LogSlot* slot;
+    for (;;) {
+        slot = &r->slots[pos & (LOG_RING_SIZE - 1)];
+        uint32_t seq = slot->seq.load(std::memory_order_acquire);
+        int32_t  dif = (int32_t)(seq - pos);
+        if (dif == 0) {
+            if (r->head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (dif < 0) {
+            r->dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = r->head.load(std::memory_order_relaxed);
+        }
+    }
+
+    int n = vsnprintf(slot->text, LOG_MESSAGE_MAX, fmt, args);
+    if (n < 0) n = 0;
+    if (n > LOG_MESSAGE_MAX - 1) n = LOG_MESSAGE_MAX - 1;
+
+    slot->level       = (uint8_t)level;
+    slot->length      = (uint16_t)n;
+    slot->threadId    = threadId;
+    slot->timestampUs = timestampUs;
+    slot->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+static inline bool LogRingPush(LogRing* r, int level, uint32_t threadId, int64_t timestampUs,
+                               const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    bool ok = LogRingPushV(r, level, threadId, timestampUs, fmt, args);
+    va_end(args);
+    return ok;
+}
+
+// ─── Drain ──────────────────────────────────────────────────────
+
+typedef void (*LogSinkFn)(void* ctx, const char* data, size_t length);
+
+#define LOG_LINE_MAX    (LOG_MESSAGE_MAX + 48)
+
+// "HH:MM:SS.uuuuuu E [tid] message\r\n" (UTC time of day)
+static inline size_t LogFormatLine(char* out, int level, uint32_t threadId, int64_t timestampUs,
+                                   const char* text, size_t length)
+{
+    static const char levelChar[] = "-EWID";
+    int64_t  secs   = timestampUs / 1000000;
+    uint32_t micros = (uint32_t)(timestampUs % 1000000);
+    uint32_t tod    = (uint32_t)(secs % 86400);
+
+    int n = snprintf(out, LOG_LINE_MAX, "%02u:%02u:%02u.%06u %c [%5u] ",
+                     tod / 3600, (tod / 60) % 60, tod % 60, micros,
+                     levelChar[level >= 0 && level <= 4 ? level : 0], threadId);
+    if (n < 0) n = 0;
+    memcpy(out + n, text, length);
+    out[n + length]     = '\r';
+    out[n + length + 1] = '\n';
+    return (size_t)n + length + 2;
+}
+
+// Consumes every committed slot, batching lines into `buf` and calling
+// `sink` whenever it fills (and once at the end). Single consumer only.
+// Returns the number of messages written.
+static inline uint32_t LogRingDrain(LogRing* r, char* buf, size_t capacity,
+                                    LogSinkFn sink, void* ctx)
+{
+    size_t   used  = 0;
+    uint32_t count = 0;
+
+    uint32_t dropped = r->dropped.exchange(0, std::memory_order_relaxed);
+    if (dropped) {
+        used += (size_t)snprintf(buf, capacity, "... %u log messages dropped (ring full)\r\n", dropped);
+    }
+
+    for (;;) {
+        LogSlot* slot = &r->slots[r->tail & (LOG_RING_SIZE - 1)];
+        if (slot->seq.load(std::memory_order_acquire) != r->tail + 1) break;
+
+        if (capacity - used < LOG_LINE_MAX) {
+            sink(ctx, buf, used);
+            used = 0;
+        }
+        used += LogFormatLine(buf + used, slot->level, slot->threadId, slot->timestampUs,
+                              slot->text, slot->length);
+
+        slot->seq.store(r->tail + LOG_RING_SIZE, std::memory_order_release);
+        r->tail++;
+        count++;
+    }
+
+    if (used) sink(ctx, buf, used);
+    return count;
+}
@@ -0,0 +1,132 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Layer Platform Abstraction
+// ═══════════════════════════════════════════════════════════════════
+// The handful of OS services the layer needs: read-only shared memory,
+// clocks, environment, the log directory, a log file, read-only file
+// mappings and one background worker thread. One backend is compiled in,
+// selected by TREADMILL_PLATFORM in CMakeLists.txt:
+//
+//   win32  — layer_platform_win32.cpp  (file mapping, QPC, worker thread)
+//   posix  — layer_platform_posix.cpp  (shm_open/mmap, clock_gettime, pthread)
+//
+// All state is POD and zero-initialisable, so the layer can keep its
+// globals free of static constructors.
+// ═══════════════════════════════════════════════════════════════════
+
+#include "openxr_defs.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ─── Module Lifetime ────────────────────────────────────────────
+
+typedef void (*PlatformUnloadFn)();
+
+// Registers the function the backend calls when the module is unloaded
+// (DllMain detach / ELF destructor). On Win32 it runs under the loader
+// lock, so it must not wait on other threads there.
+void PlatformSetUnloadHandler(PlatformUnloadFn fn);
+
+// ─── Shared Memory ──────────────────────────────────────────────
+// Names are bare identifiers ("TreadmillDriverVelocity"); the backend
+// maps them to a Win32 file-mapping name or a POSIX "/name" object.
+
+struct PlatformSharedMemory {
+    void*   handle;     // backend-specific, NULL when closed
+    void*   view;
+    size_t  size;
+};
+
+// Maps an existing object read-only. Fails if it does not exist or is
+// smaller than `size`.
+bool PlatformSharedMemoryOpen(PlatformSharedMemory* shm, const char* name, size_t size);
+
+// Creates (or reopens) a read-write object of `size` bytes. Used by
+// producers: the Linux companion, tests and the mock runtime.
+bool PlatformSharedMemoryCreate(PlatformSharedMemory* shm, const char* name, size_t size);
+
+void PlatformSharedMemoryClose(PlatformSharedMemory* shm);
+
+// Removes the name so later opens fail (no-op on Win32, where the
+// mapping disappears with its last handle).
+void PlatformSharedMemoryUnlink(const char* name);
+
+// ─── Clocks ─────────────────────────────────────────────────────
+
+// High-resolution monotonic ticks — the clock domain of the producer's
+// sample timestamps (QPC / Stopwatch on Windows, CLOCK_MONOTONIC ns on
+// Linux).
+int64_t PlatformTimestamp();
+int64_t PlatformTimestampFrequency();
+
+// ─── OpenXR Time ────────────────────────────────────────────────
+// XrTime is in the runtime's own time base. The KHR extension named
+// here converts it into PlatformTimestamp's clock:
+//
+//   win32  — XR_KHR_win32_convert_performance_counter_time (QPC)
+//   posix  — XR_KHR_convert_timespec_time (CLOCK_MONOTONIC)
+
+extern const char* const kPlatformXrTimeExtension;
+extern const char* const kPlatformXrTimeConvertFn;  // entry point to resolve
+
+// Calls the resolved conversion entry point. False if the runtime fails.
+bool PlatformXrTimeToTimestamp(PFN_xrVoidFunction convert, XrInstance instance, XrTime time, int64_t* timestamp);
+
+// Coarse monotonic milliseconds for retry throttling.
+uint64_t PlatformMonotonicMs();
+
+// Wall clock, microseconds since the Unix epoch (log lines).
+int64_t PlatformWallClockUs();
+
+uint32_t PlatformThreadId();
+uint32_t PlatformProcessId();
+
+// Gives the rest of the time slice to another ready thread (spin waits).
+void PlatformYield();
+
+// ─── Environment & Paths ────────────────────────────────────────
+
+// Copies the variable into `buf`. False if unset or it doesn't fit.
+bool PlatformGetEnv(const char* name, char* buf, size_t capacity);
+
+// Directory for the layer log and the profile database, with a
+// trailing separator:
+//   %LOCALAPPDATA%\TreadmillDriver\OpenXRLayer\                     (win32)
+//   $XDG_STATE_HOME/treadmill-driver/openxr-layer/  (~/.local/state, posix)
+// The POSIX backend creates it; on Windows the companion app does.
+bool PlatformLogDirectory(char* buf, size_t capacity);
+
+// ─── Files (append-only log output) ─────────────────────────────
+
+typedef struct PlatformFile_T* PlatformFile;    // NULL = not open
+
+PlatformFile PlatformFileCreate(const char* path);  // truncates
+void         PlatformFileWrite(PlatformFile file, const void* data, size_t length);
+void         PlatformFileClose(PlatformFile file);
+
+// ─── Mapped Files (read-only data) ──────────────────────────────
+
+// Maps a whole existing file read-only; release it with
+// PlatformSharedMemoryClose. Fails if the file is missing, empty or
+// larger than `maxSize`.
+bool PlatformFileMapRead(PlatformSharedMemory* map, const char* path, size_t maxSize);
+
+// ─── Worker Thread ──────────────────────────────────────────────
+// Calls `fn(ctx)` every `intervalMs` until stopped, then once more.
+// The thread keeps the module loaded while it runs (Win32 module
+// reference, or -z nodelete on Linux), so unloading the layer can
+// never unmap code under it.
+
+typedef void (*PlatformWorkerFn)(void* ctx);
+
+struct PlatformWorker {
+    void*   thread;     // NULL when not running
+    void*   stop;
+};
+
+bool PlatformWorkerStart(PlatformWorker* worker, uint32_t intervalMs, PlatformWorkerFn fn, void* ctx);
+
+// `join` must be false while the Win32 loader lock is held (DllMain);
+// the POSIX backend always joins.
+void PlatformWorkerStop(PlatformWorker* worker, bool join);
@@ -0,0 +1,328 @@
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Layer Platform: POSIX backend (Linux)
+// ═══════════════════════════════════════════════════════════════════
+// Built with -z nodelete (see CMakeLists.txt): dlclose never unmaps
+// the layer, so the log worker needs no module reference of its own.
+
+#include "layer_platform.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+// ─── Module Lifetime ────────────────────────────────────────────
+
+static PlatformUnloadFn g_unloadHandler = NULL;
+
+void PlatformSetUnloadHandler(PlatformUnloadFn fn) { g_unloadHandler = fn; }
+
+__attribute__((destructor)) static void PlatformModuleUnload()
+{
+    if (g_unloadHandler) g_unloadHandler();
+}
+
+// ─── Shared Memory ──────────────────────────────────────────────
+
+static bool ShmObjectName(char* out, size_t capacity, const char* name)
+{
+    int n = snprintf(out, capacity, "/%s", name);
+    return n > 0 && (size_t)n < capacity;
+}
+
+bool PlatformSharedMemoryOpen(PlatformSharedMemory* shm, const char* name, size_t size)
+{
+    char objName[256];
+    if (!ShmObjectName(objName, sizeof(objName), name)) return false;
+
+    int fd = shm_open(objName, O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) return false;
+
+    // Touching pages past the end of a short object raises SIGBUS
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < size) {
+        close(fd);
+        return false;
+    }
+
+    void* view = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) return false;
+
+    shm->handle = view;     // the mapping outlives the descriptor
+    shm->view   = view;
+    shm->size   = size;
+    return true;
+}
+
+bool PlatformSharedMemoryCreate(PlatformSharedMemory* shm, const char* name, size_t size)
+{
+    char objName[256];
+    if (!ShmObjectName(objName, sizeof(objName), name)) return false;
+
+    int fd = shm_open(objName, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || ((size_t)st.st_size < size && ftruncate(fd, (off_t)size) != 0)) {
+        close(fd);
+        return false;
+    }
+
+    void* view = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) return false;
+
+    shm->handle = view;
+    shm->view   = view;
+    shm->size   = size;
+    return true;
+}
+
+void PlatformSharedMemoryClose(PlatformSharedMemory* shm)
+{
+    if (shm->view) munmap(shm->view, shm->size);
+    shm->handle = NULL;
+    shm->view   = NULL;
+    shm->size   = 0;
+}
+
+void PlatformSharedMemoryUnlink(const char* name)
+{
+    char objName[256];
+    if (ShmObjectName(objName, sizeof(objName), name)) shm_unlink(objName);
+}
+
+// ─── Clocks ─────────────────────────────────────────────────────
+
+int64_t PlatformTimestamp()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+int64_t PlatformTimestampFrequency() { return 1000000000; }
+
+const char* const kPlatformXrTimeExtension = "XR_KHR_convert_timespec_time";
+const char* const kPlatformXrTimeConvertFn = "xrConvertTimeToTimespecTimeKHR";
+
+typedef XrResult(XRAPI_PTR* PFN_xrConvertTimeToTimespecTimeKHR)(
+    XrInstance instance, XrTime time, struct timespec* timespecTime);
+
+bool PlatformXrTimeToTimestamp(PFN_xrVoidFunction convert, XrInstance instance, XrTime time, int64_t* timestamp)
+{
+    struct timespec ts;
+    if (XR_FAILED(((PFN_xrConvertTimeToTimespecTimeKHR)convert)(instance, time, &ts))) return false;
+    *timestamp = (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    return true;
+}
+
+uint64_t PlatformMonotonicMs() { return (uint64_t)PlatformTimestamp() / 1000000; }
+
+int64_t PlatformWallClockUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+uint32_t PlatformThreadId()
+{
+#if defined(__linux__)
+    return (uint32_t)syscall(SYS_gettid);
+#else
+    return (uint32_t)(uintptr_t)pthread_self();
+#endif
+}
+
+uint32_t PlatformProcessId() { return (uint32_t)getpid(); }
+
+void PlatformYield() { sched_yield(); }
+
+// ─── Environment & Paths ────────────────────────────────────────
+
+bool PlatformGetEnv(const char* name, char* buf, size_t capacity)
+{
+    const char* v = getenv(name);
+    if (!v) return false;
+    size_t n = strlen(v);
+    if (n == 0 || n >= capacity) return false;
+    memcpy(buf, v, n + 1);
+    return true;
+}
+
+// mkdir -p over an absolute path ending in '/'.
+static bool MakeDirectories(char* path)
+{
+    for (char* p = path + 1; *p; p++) {
+        if (*p != '/') continue;
+        *p = 0;
+        bool ok = mkdir(path, 0755) == 0 || errno == EEXIST;
+        *p = '/';
+        if (!ok) return false;
+    }
+    return true;
+}
+
+bool PlatformLogDirectory(char* buf, size_t capacity)
+{
+    int n;
+    const char* state = getenv("XDG_STATE_HOME");
+    const char* home  = getenv("HOME");
+    if (state && state[0] == '/')  n = snprintf(buf, capacity, "%s/treadmill-driver/openxr-layer/", state);
+    else if (home && home[0] == '/') n = snprintf(buf, capacity, "%s/.local/state/treadmill-driver/openxr-layer/", home);
+    else return false;
+
+    if (n <= 0 || (size_t)n >= capacity) return false;
+    return MakeDirectories(buf);
+}
+
+// ─── Files ──────────────────────────────────────────────────────
+// The handle is fd + 1 so that NULL still means "not open".
+
+PlatformFile PlatformFileCreate(const char* path)
+{
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    return fd < 0 ? NULL : (PlatformFile)(intptr_t)(fd + 1);
+}
+
+void PlatformFileWrite(PlatformFile file, const void* data, size_t length)
+{
+    int fd = (int)(intptr_t)file - 1;
+    const char* p = (const char*)data;
+    while (length > 0) {
+        ssize_t n = write(fd, p, length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        p      += n;
+        length -= (size_t)n;
+    }
+}
+
+void PlatformFileClose(PlatformFile file)
+{
+    if (file) close((int)(intptr_t)file - 1);
+}
+
+// ─── Mapped Files ───────────────────────────────────────────────
+
+bool PlatformFileMapRead(PlatformSharedMemory* map, const char* path, size_t maxSize)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 || (uint64_t)st.st_size > maxSize) {
+        close(fd);
+        return false;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void* view = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) return false;
+
+    map->handle = view;
+    map->view   = view;
+    map->size   = size;
+    return true;
+}
+
+// ─── Worker Thread ──────────────────────────────────────────────
+
+struct Worker {
+    pthread_t           thread;
+    pthread_mutex_t     lock;
+    pthread_cond_t      wake;           // CLOCK_MONOTONIC
+    bool                stop;
+    PlatformWorkerFn    fn;
+    void*               ctx;
+    uint32_t            intervalMs;
+};
+
+static void FreeWorker(Worker* w)
+{
+    pthread_cond_destroy(&w->wake);
+    pthread_mutex_destroy(&w->lock);
+    free(w);
+}
+
+static void* WorkerThreadProc(void* param)
+{
+    Worker* w = (Worker*)param;
+
+    pthread_mutex_lock(&w->lock);
+    while (!w->stop) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_nsec += (long)(w->intervalMs % 1000) * 1000000;
+        deadline.tv_sec  += w->intervalMs / 1000 + deadline.tv_nsec / 1000000000;
+        deadline.tv_nsec %= 1000000000;
+
+        if (pthread_cond_timedwait(&w->wake, &w->lock, &deadline) == ETIMEDOUT && !w->stop) {
+            pthread_mutex_unlock(&w->lock);
+            w->fn(w->ctx);
+            pthread_mutex_lock(&w->lock);
+        }
+    }
+    pthread_mutex_unlock(&w->lock);
+
+    w->fn(w->ctx);
+    return NULL;
+}
+
+bool PlatformWorkerStart(PlatformWorker* worker, uint32_t intervalMs, PlatformWorkerFn fn, void* ctx)
+{
+    Worker* w = (Worker*)calloc(1, sizeof(Worker));
+    if (!w) return false;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&w->wake, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&w->lock, NULL);
+
+    w->fn         = fn;
+    w->ctx        = ctx;
+    w->intervalMs = intervalMs;
+
+    if (pthread_create(&w->thread, NULL, WorkerThreadProc, w) != 0) {
+        FreeWorker(w);
+        return false;
+    }
+
+    worker->thread = w;
+    worker->stop   = w;
+    return true;
+}
+
+// There is no loader lock to deadlock on (destructors run from exit()
+// or dlclose with the worker still alive), so this always joins.
+void PlatformWorkerStop(PlatformWorker* worker, bool join)
+{
+    (void)join;
+    Worker* w = (Worker*)worker->thread;
+    if (!w) return;
+
+    pthread_mutex_lock(&w->lock);
+    w->stop = true;
+    pthread_cond_signal(&w->wake);
+    pthread_mutex_unlock(&w->lock);
+
+    pthread_join(w->thread, NULL);
+    FreeWorker(w);
+    worker->thread = NULL;
+    worker->stop   = NULL;
+}
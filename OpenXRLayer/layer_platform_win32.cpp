@@ -0,0 +1,263 @@
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Layer Platform: Win32 backend
+// ═══════════════════════════════════════════════════════════════════
+
+#include "layer_platform.h"
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <shlobj.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ─── Module Lifetime ────────────────────────────────────────────
+
+static PlatformUnloadFn g_unloadHandler = NULL;
+
+void PlatformSetUnloadHandler(PlatformUnloadFn fn) { g_unloadHandler = fn; }
+
+BOOL APIENTRY DllMain(HMODULE hModule, DWORD reason, LPVOID lpReserved)
+{
+    (void)lpReserved;
+    switch (reason) {
+    case DLL_PROCESS_ATTACH:
+        DisableThreadLibraryCalls(hModule);
+        break;
+    case DLL_PROCESS_DETACH:
+        if (g_unloadHandler) g_unloadHandler();
+        break;
+    }
+    return TRUE;
+}
+
+// ─── Shared Memory ──────────────────────────────────────────────
+
+bool PlatformSharedMemoryOpen(PlatformSharedMemory* shm, const char* name, size_t size)
+{
+    HANDLE h = OpenFileMappingA(FILE_MAP_READ, FALSE, name);
+    if (!h) return false;
+
+    void* view = MapViewOfFile(h, FILE_MAP_READ, 0, 0, size);
+    if (!view) {
+        CloseHandle(h);
+        return false;
+    }
+
+    shm->handle = h;
+    shm->view   = view;
+    shm->size   = size;
+    return true;
+}
+
+bool PlatformSharedMemoryCreate(PlatformSharedMemory* shm, const char* name, size_t size)
+{
+    HANDLE h = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                  (DWORD)((uint64_t)size >> 32), (DWORD)size, name);
+    if (!h) return false;
+
+    void* view = MapViewOfFile(h, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (!view) {
+        CloseHandle(h);
+        return false;
+    }
+
+    shm->handle = h;
+    shm->view   = view;
+    shm->size   = size;
+    return true;
+}
+
+void PlatformSharedMemoryClose(PlatformSharedMemory* shm)
+{
+    if (shm->view)   { UnmapViewOfFile(shm->view); shm->view = NULL; }
+    if (shm->handle) { CloseHandle((HANDLE)shm->handle); shm->handle = NULL; }
+    shm->size = 0;
+}
+
+void PlatformSharedMemoryUnlink(const char* name) { (void)name; }
+
+// ─── Clocks ─────────────────────────────────────────────────────
+
+int64_t PlatformTimestamp()
+{
+    LARGE_INTEGER t;
+    QueryPerformanceCounter(&t);
+    return t.QuadPart;
+}
+
+int64_t PlatformTimestampFrequency()
+{
+    LARGE_INTEGER f;
+    QueryPerformanceFrequency(&f);
+    return f.QuadPart;
+}
+
+const char* const kPlatformXrTimeExtension = "XR_KHR_win32_convert_performance_counter_time";
+const char* const kPlatformXrTimeConvertFn = "xrConvertTimeToWin32PerformanceCounterKHR";
+
+typedef XrResult(XRAPI_PTR* PFN_xrConvertTimeToWin32PerformanceCounterKHR)(
+    XrInstance instance, XrTime time, LARGE_INTEGER* performanceCounter);
+
+bool PlatformXrTimeToTimestamp(PFN_xrVoidFunction convert, XrInstance instance, XrTime time, int64_t* timestamp)
+{
+    LARGE_INTEGER counter;
+    if (XR_FAILED(((PFN_xrConvertTimeToWin32PerformanceCounterKHR)convert)(instance, time, &counter))) return false;
+    *timestamp = counter.QuadPart;
+    return true;
+}
+
+uint64_t PlatformMonotonicMs() { return GetTickCount64(); }
+
+int64_t PlatformWallClockUs()
+{
+    FILETIME ft;
+    GetSystemTimePreciseAsFileTime(&ft);
+    uint64_t t = ((uint64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+    return (int64_t)((t - 116444736000000000ULL) / 10);
+}
+
+uint32_t PlatformThreadId() { return (uint32_t)GetCurrentThreadId(); }
+
+uint32_t PlatformProcessId() { return (uint32_t)GetCurrentProcessId(); }
+
+void PlatformYield() { SwitchToThread(); }
+
+// ─── Environment & Paths ────────────────────────────────────────
+
+bool PlatformGetEnv(const char* name, char* buf, size_t capacity)
+{
+    DWORD n = GetEnvironmentVariableA(name, buf, (DWORD)capacity);
+    return n > 0 && n < capacity;
+}
+
+bool PlatformLogDirectory(char* buf, size_t capacity)
+{
+    char base[MAX_PATH];
+    if (FAILED(SHGetFolderPathA(NULL, CSIDL_LOCAL_APPDATA, NULL, 0, base))) return false;
+    int n = snprintf(buf, capacity, "%s\\TreadmillDriver\\OpenXRLayer\\", base);
+    return n > 0 && (size_t)n < capacity;
+}
+
+// ─── Files ──────────────────────────────────────────────────────
+
+PlatformFile PlatformFileCreate(const char* path)
+{
+    HANDLE h = CreateFileA(path, GENERIC_WRITE, FILE_SHARE_READ,
+                           NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    return h == INVALID_HANDLE_VALUE ? NULL : (PlatformFile)h;
+}
+
+void PlatformFileWrite(PlatformFile file, const void* data, size_t length)
+{
+    DWORD written;
+    WriteFile((HANDLE)file, data, (DWORD)length, &written, NULL);
+}
+
+void PlatformFileClose(PlatformFile file)
+{
+    if (file) CloseHandle((HANDLE)file);
+}
+
+// ─── Mapped Files ───────────────────────────────────────────────
+
+bool PlatformFileMapRead(PlatformSharedMemory* map, const char* path, size_t maxSize)
+{
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                              NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0 || (uint64_t)size.QuadPart > maxSize) {
+        CloseHandle(file);
+        return false;
+    }
+
+    // The mapping keeps the file open; its handle is the one Close releases
+    HANDLE h = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!h) return false;
+
+    void* view = MapViewOfFile(h, FILE_MAP_READ, 0, 0, (SIZE_T)size.QuadPart);
+    if (!view) {
+        CloseHandle(h);
+        return false;
+    }
+
+    map->handle = h;
+    map->view   = view;
+    map->size   = (size_t)size.QuadPart;
+    return true;
+}
+
+// ─── Worker Thread ──────────────────────────────────────────────
+
+struct WorkerArgs {
+    PlatformWorkerFn    fn;
+    void*               ctx;
+    DWORD               intervalMs;
+    HANDLE              stop;
+    HMODULE             module;
+};
+
+// Holds its own module reference so FreeLibrary can't unmap the code
+// under it; the reference is dropped as the thread exits.
+static DWORD WINAPI WorkerThreadProc(LPVOID param)
+{
+    WorkerArgs args = *(WorkerArgs*)param;
+    free(param);
+
+    while (WaitForSingleObject(args.stop, args.intervalMs) == WAIT_TIMEOUT) {
+        args.fn(args.ctx);
+    }
+    args.fn(args.ctx);
+    FreeLibraryAndExitThread(args.module, 0);
+    return 0;
+}
+
+bool PlatformWorkerStart(PlatformWorker* worker, uint32_t intervalMs, PlatformWorkerFn fn, void* ctx)
+{
+    WorkerArgs* args = (WorkerArgs*)malloc(sizeof(WorkerArgs));
+    if (!args) return false;
+
+    HANDLE stop = CreateEventA(NULL, TRUE, FALSE, NULL);
+    HMODULE self = NULL;
+    if (!stop || !GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS,
+                                     (LPCSTR)&WorkerThreadProc, &self)) {
+        if (stop) CloseHandle(stop);
+        free(args);
+        return false;
+    }
+
+    args->fn         = fn;
+    args->ctx        = ctx;
+    args->intervalMs = intervalMs;
+    args->stop       = stop;
+    args->module     = self;
+
+    HANDLE thread = CreateThread(NULL, 0, WorkerThreadProc, args, 0, NULL);
+    if (!thread) {
+        FreeLibrary(self);
+        CloseHandle(stop);
+        free(args);
+        return false;
+    }
+
+    worker->thread = thread;
+    worker->stop   = stop;
+    return true;
+}
+
+// Under the loader lock the thread has already exited (it pins the
+// module), so not joining there loses nothing.
+void PlatformWorkerStop(PlatformWorker* worker, bool join)
+{
+    if (!worker->thread) return;
+
+    SetEvent((HANDLE)worker->stop);
+    if (join) WaitForSingleObject((HANDLE)worker->thread, INFINITE);
+    CloseHandle((HANDLE)worker->thread);
+    CloseHandle((HANDLE)worker->stop);
+    worker->thread = NULL;
+    worker->stop   = NULL;
+}
@@ -0,0 +1,259 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Layer Telemetry Block
+// ═══════════════════════════════════════════════════════════════════
+// Counters the layer publishes about itself in a second named mapping,
+// created by the layer and read-only to the companion app
+// (SharedMemoryService.cs): calls per intercept, injections, queries
+// skipped because they named the other hand, sampled time spent in the
+// layer, the last latched axes and the display period.
+//
+// Counters live in per-thread slots, each on its own cache lines, so
+// a game's render and input threads never share a line. A thread takes
+// the next slot on its first intercepted call; past
+// TREADMILL_TELEMETRY_THREADS threads share slots, which is why every
+// counter is a relaxed fetch_add rather than a plain store. Readers sum
+// the slots; totals only ever grow while one process owns the block.
+//
+// One process owns the block at a time. A layer that finds it owned by
+// another process that is still live (instances, and a sync within
+// TREADMILL_TELEMETRY_STALE_MS) keeps its counters to itself; otherwise
+// it takes the block over and starts it from zero.
+//
+// Everything here is header-only and platform-neutral. Keep the offsets
+// in sync with the C# reader — they are part of the wire format. Lean
+// builds (TREADMILL_TELEMETRY=0) never create the block.
+// ═══════════════════════════════════════════════════════════════════
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+
+// ─── Constants ──────────────────────────────────────────────────
+
+#define TREADMILL_TELEMETRY_MEM_NAME    "TreadmillDriverTelemetry"
+#define TREADMILL_TELEMETRY_MAGIC       0x4C544D54u     // "TMTL"
+#define TREADMILL_TELEMETRY_VERSION     1
+#define TREADMILL_TELEMETRY_SIZE        4224
+#define TREADMILL_TELEMETRY_THREADS     16              // slots; more threads share them
+#define TREADMILL_TELEMETRY_CALL_SLOTS  16              // per-intercept counters in a slot
+#define TREADMILL_TELEMETRY_TIME_SAMPLE 64              // one call in this many is timed (power of two)
+#define TREADMILL_TELEMETRY_STALE_MS    5000            // owner considered gone after this
+
+// Intercepted calls, by counter index (wire format, not proc_table.h order)
+#define TELEMETRY_CALL_GET_INSTANCE_PROC_ADDR       0
+#define TELEMETRY_CALL_CREATE_API_LAYER_INSTANCE    1
+#define TELEMETRY_CALL_DESTROY_INSTANCE             2
+#define TELEMETRY_CALL_CREATE_SESSION               3
+#define TELEMETRY_CALL_DESTROY_SESSION              4
+#define TELEMETRY_CALL_SUGGEST_BINDINGS             5
+#define TELEMETRY_CALL_SYNC_ACTIONS                 6
+#define TELEMETRY_CALL_GET_ACTION_STATE_VECTOR2F    7
+#define TELEMETRY_CALL_GET_ACTION_STATE_FLOAT       8
+#define TELEMETRY_CALL_WAIT_FRAME                   9
+#define TELEMETRY_CALL_COUNT                        10
+
+// ─── Layout ─────────────────────────────────────────────────────
+//
+//  off  size  field
+//    0     4  magic               TREADMILL_TELEMETRY_MAGIC (written last)
+//    4     2  version             TREADMILL_TELEMETRY_VERSION
+//    6     2  threadSlots         TREADMILL_TELEMETRY_THREADS
+//    8     4  totalSize           TREADMILL_TELEMETRY_SIZE
+//   12     4  processId           owner
+//   16     8  timestampFrequency  owner's clock ticks per second
+//   24     4  timeSample          TREADMILL_TELEMETRY_TIME_SAMPLE
+//   28    36  reserved
+//
+//   64     4  liveInstances       instances the layer tracks
+//   68     4  forward             float, last latched axes (all instances)
+//   72     4  strafe
+//   76     4  turn
+//   80     8  updated             timestamp of the latest xrSyncActions
+//   88     8  displayPeriodNs     predictedDisplayPeriod of the latest xrWaitFrame
+//   96    32  reserved
+//
+//  128  4096  threads             16 slots of 256 bytes:
+//                                   0  128  calls[16]         uint64 per TELEMETRY_CALL_*
+//                                 128    8  injected          xrGetActionState* that injected
+//                                 136    8  skippedSubaction  tracked, but for the other hand
+//                                 144    8  timedCalls        calls whose time was measured
+//                                 152    8  timeTicks         their time in the layer (chained
+//                                                             calls excluded), timestamp ticks
+//                                 160    4  threadId          first thread to take the slot
+//                                 164   92  reserved
+
+struct TreadmillTelemetryThread {
+    std::atomic<uint64_t>   calls[TREADMILL_TELEMETRY_CALL_SLOTS];
+    std::atomic<uint64_t>   injected;
+    std::atomic<uint64_t>   skippedSubaction;
+    std::atomic<uint64_t>   timedCalls;
+    std::atomic<uint64_t>   timeTicks;
+    std::atomic<uint32_t>   threadId;
+    uint8_t                 reserved[92];
+};
+
+struct TreadmillTelemetry {
+    // Written at claim time
+    std::atomic<uint32_t>   magic;
+    uint16_t                version;
+    uint16_t                threadSlots;
+    uint32_t                totalSize;
+    uint32_t                processId;
+    int64_t                 timestampFrequency;
+    uint32_t                timeSample;
+    uint8_t                 headerReserved[36];
+
+    // Process-wide, once per frame or instance
+    std::atomic<uint32_t>   liveInstances;
+    std::atomic<uint32_t>   axisBits[3];            // forward, strafe, turn
+    std::atomic<int64_t>    updated;
+    std::atomic<int64_t>    displayPeriodNs;
+    uint8_t                 processReserved[32];
+
+    alignas(64) TreadmillTelemetryThread threads[TREADMILL_TELEMETRY_THREADS];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "counters are shared across processes");
+static_assert(sizeof(TreadmillTelemetryThread) == 256, "wire format");
+static_assert(sizeof(TreadmillTelemetry) == TREADMILL_TELEMETRY_SIZE, "wire format");
+static_assert(offsetof(TreadmillTelemetry, timestampFrequency) == 16,  "wire format");
+static_assert(offsetof(TreadmillTelemetry, liveInstances)      == 64,  "wire format");
+static_assert(offsetof(TreadmillTelemetry, updated)            == 80,  "wire format");
+static_assert(offsetof(TreadmillTelemetry, displayPeriodNs)    == 88,  "wire format");
+static_assert(offsetof(TreadmillTelemetry, threads)            == 128, "wire format");
+static_assert(offsetof(TreadmillTelemetryThread, injected)     == 128, "wire format");
+static_assert(offsetof(TreadmillTelemetryThread, timeTicks)    == 152, "wire format");
+static_assert(offsetof(TreadmillTelemetryThread, threadId)     == 160, "wire format");
+static_assert(TELEMETRY_CALL_COUNT <= TREADMILL_TELEMETRY_CALL_SLOTS, "call counters must fit a slot");
+static_assert((TREADMILL_TELEMETRY_TIME_SAMPLE & (TREADMILL_TELEMETRY_TIME_SAMPLE - 1)) == 0,
+              "time sample must be a power of two");
+
+// Every slot summed, plus the process-wide fields.
+struct TreadmillTelemetryTotals {
+    uint32_t    processId;
+    int64_t     timestampFrequency;
+    uint32_t    liveInstances;
+    float       axes[3];
+    int64_t     updated;
+    int64_t     displayPeriodNs;
+    uint64_t    calls[TELEMETRY_CALL_COUNT];
+    uint64_t    injected;
+    uint64_t    skippedSubaction;
+    uint64_t    timedCalls;
+    uint64_t    timeTicks;
+    uint32_t    threads;        // slots in use
+};
+
+// ─── Owner ──────────────────────────────────────────────────────
+
+static inline bool TreadmillTelemetryValidate(const TreadmillTelemetry* t)
+{
+    return t->magic.load(std::memory_order_acquire) == TREADMILL_TELEMETRY_MAGIC
+        && t->version     == TREADMILL_TELEMETRY_VERSION
+        && t->threadSlots == TREADMILL_TELEMETRY_THREADS
+        && t->totalSize   >= TREADMILL_TELEMETRY_SIZE
+        && t->timestampFrequency > 0;
+}
+
+// Zeroes every counter and writes the header, magic last so a reader
+// never validates a block that is being reset.
+static inline void TreadmillTelemetryInit(TreadmillTelemetry* t, uint32_t processId, int64_t timestampFrequency)
+{
+    t->magic.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    t->version            = TREADMILL_TELEMETRY_VERSION;
+    t->threadSlots        = TREADMILL_TELEMETRY_THREADS;
+    t->totalSize          = TREADMILL_TELEMETRY_SIZE;
+    t->processId          = processId;
+    t->timestampFrequency = timestampFrequency;
+    t->timeSample         = TREADMILL_TELEMETRY_TIME_SAMPLE;
+    t->liveInstances.store(0, std::memory_order_relaxed);
+    for (int i = 0; i < 3; i++) t->axisBits[i].store(0, std::memory_order_relaxed);
+    t->updated.store(0, std::memory_order_relaxed);
+    t->displayPeriodNs.store(0, std::memory_order_relaxed);
+    for (uint32_t s = 0; s < TREADMILL_TELEMETRY_THREADS; s++) {
+        TreadmillTelemetryThread* th = &t->threads[s];
+        for (uint32_t c = 0; c < TREADMILL_TELEMETRY_CALL_SLOTS; c++) th->calls[c].store(0, std::memory_order_relaxed);
+        th->injected.store(0, std::memory_order_relaxed);
+        th->skippedSubaction.store(0, std::memory_order_relaxed);
+        th->timedCalls.store(0, std::memory_order_relaxed);
+        th->timeTicks.store(0, std::memory_order_relaxed);
+        th->threadId.store(0, std::memory_order_relaxed);
+    }
+
+    t->magic.store(TREADMILL_TELEMETRY_MAGIC, std::memory_order_release);
+}
+
+// Takes a freshly mapped block for `processId` unless another process
+// still owns it. `now` and `staleTicks` are in the caller's timestamp
+// clock, which must be the owner's (it is per machine).
+static inline bool TreadmillTelemetryClaim(TreadmillTelemetry* t, uint32_t processId, int64_t timestampFrequency,
+                                           int64_t now, int64_t staleTicks)
+{
+    if (TreadmillTelemetryValidate(t) && t->processId != processId &&
+        t->liveInstances.load(std::memory_order_relaxed) > 0 &&
+        now - t->updated.load(std::memory_order_relaxed) < staleTicks)
+        return false;
+
+    TreadmillTelemetryInit(t, processId, timestampFrequency);
+    return true;
+}
+
+// Adds `from`'s counters to `to` (moving from a private block to the
+// mapped one); counts racing the move may land in either.
+static inline void TreadmillTelemetryMerge(TreadmillTelemetry* to, const TreadmillTelemetry* from)
+{
+    for (uint32_t s = 0; s < TREADMILL_TELEMETRY_THREADS; s++) {
+        const TreadmillTelemetryThread* src = &from->threads[s];
+        TreadmillTelemetryThread*       dst = &to->threads[s];
+        for (uint32_t c = 0; c < TREADMILL_TELEMETRY_CALL_SLOTS; c++)
+            dst->calls[c].fetch_add(src->calls[c].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        dst->injected.fetch_add(src->injected.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        dst->skippedSubaction.fetch_add(src->skippedSubaction.load(std::memory_order_relaxed),
+                                        std::memory_order_relaxed);
+        dst->timedCalls.fetch_add(src->timedCalls.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        dst->timeTicks.fetch_add(src->timeTicks.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        uint32_t none = 0;
+        dst->threadId.compare_exchange_strong(none, src->threadId.load(std::memory_order_relaxed),
+                                              std::memory_order_relaxed);
+    }
+    to->liveInstances.store(from->liveInstances.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    for (int i = 0; i < 3; i++)
+        to->axisBits[i].store(from->axisBits[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    to->updated.store(from->updated.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    to->displayPeriodNs.store(from->displayPeriodNs.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+// ─── Reader ─────────────────────────────────────────────────────
+
+// Sums the slots. False if the block is not (or no longer) valid.
+// Counters are read one by one, so totals may be a few counts apart.
+static inline bool TreadmillTelemetryRead(const TreadmillTelemetry* t, TreadmillTelemetryTotals* out)
+{
+    if (!TreadmillTelemetryValidate(t)) return false;
+
+    *out = TreadmillTelemetryTotals();
+    out->processId          = t->processId;
+    out->timestampFrequency = t->timestampFrequency;
+    out->liveInstances      = t->liveInstances.load(std::memory_order_relaxed);
+    for (int i = 0; i < 3; i++) {
+        uint32_t bits = t->axisBits[i].load(std::memory_order_relaxed);
+        memcpy(&out->axes[i], &bits, sizeof(bits));
+    }
+    out->updated         = t->updated.load(std::memory_order_relaxed);
+    out->displayPeriodNs = t->displayPeriodNs.load(std::memory_order_relaxed);
+
+    for (uint32_t s = 0; s < TREADMILL_TELEMETRY_THREADS; s++) {
+        const TreadmillTelemetryThread* th = &t->threads[s];
+        for (uint32_t c = 0; c < TELEMETRY_CALL_COUNT; c++) out->calls[c] += th->calls[c].load(std::memory_order_relaxed);
+        out->injected         += th->injected.load(std::memory_order_relaxed);
+        out->skippedSubaction += th->skippedSubaction.load(std::memory_order_relaxed);
+        out->timedCalls       += th->timedCalls.load(std::memory_order_relaxed);
+        out->timeTicks        += th->timeTicks.load(std::memory_order_relaxed);
+        if (th->threadId.load(std::memory_order_relaxed)) out->threads++;
+    }
+    return true;
+}
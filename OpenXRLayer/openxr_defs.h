@@ -10,13 +10,14 @@
 
 #ifdef _WIN32
 #define XR_LAYER_EXPORT __declspec(dllexport)
+#define XRAPI_CALL      __stdcall
+#define XRAPI_PTR       __stdcall
 #else
 #define XR_LAYER_EXPORT __attribute__((visibility("default")))
+#define XRAPI_CALL
+#define XRAPI_PTR
 #endif
 
-#define XRAPI_CALL  __stdcall
-#define XRAPI_PTR   __stdcall
-
 // ─── Fundamental Types ──────────────────────────────────────────
 
 typedef int32_t   XrResult;
@@ -24,6 +25,8 @@ typedef uint64_t  XrVersion;
 typedef uint64_t  XrPath;
 typedef uint32_t  XrBool32;
 typedef int64_t   XrTime;
+typedef int64_t   XrDuration;
+typedef uint64_t  XrSystemId;
 
 #define XR_DEFINE_HANDLE(name) typedef struct name##_T* name;
 
@@ -40,9 +43,13 @@ XR_DEFINE_HANDLE(XrActionSet)
 #define XR_NULL_HANDLE                  nullptr
 #define XR_SUCCESS                      0
 #define XR_ERROR_FUNCTION_UNSUPPORTED   (-1)
+#define XR_ERROR_EXTENSION_NOT_PRESENT  (-9)
+#define XR_ERROR_LIMIT_REACHED          (-10)
 #define XR_ERROR_HANDLE_INVALID         (-12)
 #define XR_ERROR_INITIALIZATION_FAILED  (-38)
 #define XR_MAX_API_LAYER_NAME_SIZE      256
+#define XR_MAX_APPLICATION_NAME_SIZE    128
+#define XR_MAX_ENGINE_NAME_SIZE         128
 
 #define XR_SUCCEEDED(result) ((result) >= 0)
 #define XR_FAILED(result)    ((result) < 0)
@@ -61,12 +68,16 @@ typedef enum XrStructureType {
     XR_TYPE_API_LAYER_PROPERTIES                   = 1,
     XR_TYPE_EXTENSION_PROPERTIES                   = 2,
     XR_TYPE_INSTANCE_CREATE_INFO                   = 3,
+    XR_TYPE_SESSION_CREATE_INFO                    = 8,
     XR_TYPE_ACTION_STATE_BOOLEAN                   = 23,
     XR_TYPE_ACTION_STATE_FLOAT                     = 24,
     XR_TYPE_ACTION_STATE_VECTOR2F                  = 25,
     XR_TYPE_ACTION_STATE_POSE                      = 27,
-    XR_TYPE_ACTION_STATE_GET_INFO                  = 44,
+    XR_TYPE_FRAME_WAIT_INFO                        = 33,
+    XR_TYPE_FRAME_STATE                            = 44,
     XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING  = 51,
+    XR_TYPE_ACTION_STATE_GET_INFO                  = 58,
+    XR_TYPE_ACTIONS_SYNC_INFO                      = 61,
 } XrStructureType;
 
 // ─── Core Structures ────────────────────────────────────────────
@@ -77,9 +88,9 @@ typedef struct XrVector2f {
 } XrVector2f;
 
 typedef struct XrApplicationInfo {
-    char        applicationName[128];
+    char        applicationName[XR_MAX_APPLICATION_NAME_SIZE];
     uint32_t    applicationVersion;
-    char        engineName[128];
+    char        engineName[XR_MAX_ENGINE_NAME_SIZE];
     uint32_t    engineVersion;
     XrVersion   apiVersion;
 } XrApplicationInfo;
@@ -95,6 +106,13 @@ typedef struct XrInstanceCreateInfo {
     const char* const*      enabledExtensionNames;
 } XrInstanceCreateInfo;
 
+typedef struct XrSessionCreateInfo {
+    XrStructureType     type;
+    const void*         next;
+    uint64_t            createFlags;
+    XrSystemId          systemId;
+} XrSessionCreateInfo;
+
 typedef struct XrActionStateGetInfo {
     XrStructureType     type;
     const void*         next;
@@ -120,6 +138,18 @@ typedef struct XrActionStateVector2f {
     XrBool32            isActive;
 } XrActionStateVector2f;
 
+typedef struct XrActiveActionSet {
+    XrActionSet actionSet;
+    XrPath      subactionPath;
+} XrActiveActionSet;
+
+typedef struct XrActionsSyncInfo {
+    XrStructureType             type;
+    const void*                 next;
+    uint32_t                    countActiveActionSets;
+    const XrActiveActionSet*    activeActionSets;
+} XrActionsSyncInfo;
+
 typedef struct XrActionSuggestedBinding {
     XrAction    action;
     XrPath      binding;
@@ -133,6 +163,19 @@ typedef struct XrInteractionProfileSuggestedBinding {
     const XrActionSuggestedBinding*     suggestedBindings;
 } XrInteractionProfileSuggestedBinding;
 
+typedef struct XrFrameWaitInfo {
+    XrStructureType     type;
+    const void*         next;
+} XrFrameWaitInfo;
+
+typedef struct XrFrameState {
+    XrStructureType     type;
+    void*               next;
+    XrTime              predictedDisplayTime;
+    XrDuration          predictedDisplayPeriod;
+    XrBool32            shouldRender;
+} XrFrameState;
+
 // ─── Function Pointer Types ─────────────────────────────────────
 
 typedef XrResult(XRAPI_PTR* PFN_xrVoidFunction)(void);
@@ -153,6 +196,17 @@ typedef XrResult(XRAPI_PTR* PFN_xrSuggestInteractionProfileBindings)(
     XrInstance instance,
     const XrInteractionProfileSuggestedBinding* suggestedBindings);
 
+typedef XrResult(XRAPI_PTR* PFN_xrCreateSession)(
+    XrInstance instance,
+    const XrSessionCreateInfo* createInfo,
+    XrSession* session);
+
+typedef XrResult(XRAPI_PTR* PFN_xrDestroySession)(XrSession session);
+
+typedef XrResult(XRAPI_PTR* PFN_xrSyncActions)(
+    XrSession session,
+    const XrActionsSyncInfo* syncInfo);
+
 typedef XrResult(XRAPI_PTR* PFN_xrGetActionStateFloat)(
     XrSession session,
     const XrActionStateGetInfo* getInfo,
@@ -163,6 +217,11 @@ typedef XrResult(XRAPI_PTR* PFN_xrGetActionStateVector2f)(
     const XrActionStateGetInfo* getInfo,
     XrActionStateVector2f* state);
 
+typedef XrResult(XRAPI_PTR* PFN_xrWaitFrame)(
+    XrSession session,
+    const XrFrameWaitInfo* frameWaitInfo,
+    XrFrameState* frameState);
+
 // ─── Loader Negotiation Types ───────────────────────────────────
 
 typedef enum XrLoaderInterfaceStructs {
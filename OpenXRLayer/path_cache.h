@@ -0,0 +1,129 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Binding Path Cache
+// ═══════════════════════════════════════════════════════════════════
+// xrSuggestInteractionProfileBindings classifies every suggested path
+// (axis_injection.h, app_profiles.h), and engines re-suggest the same
+// paths for ten or more interaction profiles at startup and again on
+// focus changes. Classifying from scratch costs an xrPathToString (a
+// runtime call that typically locks and copies) plus substring scans,
+// so results are cached per XrPath: an XrPath names the same string
+// for the instance's lifetime, and the profile is fixed at creation.
+//
+// Misses are cached too — most bindings are buttons and poses. The
+// layer seeds the table with the XrPaths of the paths it knows up
+// front (kInjectBuiltinPaths and the profile's), so a binding on one
+// of those is classified by integer compares alone, never converted
+// to a string.
+//
+// Open addressing with linear probing like action_set.h, but mutable:
+// only the suggest path touches it, inside PathCacheTryLock. A caller
+// that finds it busy classifies uncached instead of waiting. Grown
+// tables come from the arena and replaced ones stay there until
+// PathCacheClear (xrDestroyInstance).
+// ═══════════════════════════════════════════════════════════════════
+
+#include "axis_injection.h"
+#include "layer_arena.h"
+
+#include <atomic>
+
+#define PATH_CACHE_MIN_CAPACITY 64
+
+struct PathCacheEntry {
+    XrPath          path;       // XR_NULL_PATH = empty slot
+    InjectBinding   binding;
+};
+
+struct PathCache {
+    std::atomic<bool>   busy;
+    uint32_t            capacity;   // power of two, at least twice `count`; 0 before the first insert
+    uint32_t            shift;      // 64 - log2(capacity)
+    uint32_t            count;
+    bool                seeded;     // known paths inserted (done once per instance)
+    PathCacheEntry*     entries;
+    LayerArena          arena;
+};
+
+static inline bool PathCacheTryLock(PathCache* c)
+{
+    return !c->busy.exchange(true, std::memory_order_acquire);
+}
+
+static inline void PathCacheUnlock(PathCache* c)
+{
+    c->busy.store(false, std::memory_order_release);
+}
+
+// XrPaths are small runtime-assigned atoms; Fibonacci hashing spreads
+// them as in action_set.h.
+static inline uint32_t PathCacheSlot(const PathCache* c, XrPath path)
+{
+    return (uint32_t)((path * 0x9E3779B97F4A7C15ull) >> c->shift);
+}
+
+// The cached classification of `path`, or false if it has none yet.
+static inline bool PathCacheFind(const PathCache* c, XrPath path, InjectBinding* out)
+{
+    if (c->capacity == 0 || path == XR_NULL_PATH) return false;
+
+    uint32_t mask = c->capacity - 1;
+    for (uint32_t i = PathCacheSlot(c, path);; i = (i + 1) & mask) {
+        const PathCacheEntry* e = &c->entries[i];
+        if (e->path == path) {
+            *out = e->binding;
+            return true;
+        }
+        if (e->path == XR_NULL_PATH) return false;
+    }
+}
+
+static inline void PathCachePlace(PathCache* c, XrPath path, InjectBinding binding)
+{
+    uint32_t mask = c->capacity - 1;
+    uint32_t i    = PathCacheSlot(c, path);
+    while (c->entries[i].path != XR_NULL_PATH && c->entries[i].path != path) i = (i + 1) & mask;
+    if (c->entries[i].path == XR_NULL_PATH) c->count++;
+    c->entries[i].path    = path;
+    c->entries[i].binding = binding;
+}
+
+// Records `binding` for `path`, growing at a 50 % load factor. False
+// (cache unchanged) only if memory runs out.
+static inline bool PathCacheInsert(PathCache* c, XrPath path, InjectBinding binding)
+{
+    if (path == XR_NULL_PATH) return false;
+
+    if ((c->count + 1) * 2 > c->capacity) {
+        uint32_t capacity = c->capacity ? c->capacity * 2 : PATH_CACHE_MIN_CAPACITY;
+        PathCacheEntry* entries = (PathCacheEntry*)LayerArenaAlloc(&c->arena, capacity * sizeof(PathCacheEntry));
+        if (!entries) return false;
+
+        PathCacheEntry* old         = c->entries;
+        uint32_t        oldCapacity = c->capacity;
+        uint32_t        shift       = 64;
+        for (uint32_t n = capacity; n > 1; n >>= 1) shift--;
+
+        c->entries  = entries;
+        c->capacity = capacity;
+        c->shift    = shift;
+        c->count    = 0;
+        for (uint32_t i = 0; i < oldCapacity; i++)
+            if (old[i].path != XR_NULL_PATH) PathCachePlace(c, old[i].path, old[i].binding);
+    }
+
+    PathCachePlace(c, path, binding);
+    return true;
+}
+
+// Forgets every path; the instance they belonged to is gone. Callers
+// hold the lock or know no suggest call is in flight.
+static inline void PathCacheClear(PathCache* c)
+{
+    LayerArenaReset(&c->arena);
+    c->entries  = NULL;
+    c->capacity = 0;
+    c->shift    = 0;
+    c->count    = 0;
+    c->seeded   = false;
+}
@@ -0,0 +1,121 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Intercept Dispatch Table
+// ═══════════════════════════════════════════════════════════════════
+// xrGetInstanceProcAddr is called for every entry point an engine
+// resolves. The intercepted names are hashed into a perfect-hash table
+// at compile time, so a lookup is one strlen, one table read and at
+// most one memcmp against the only candidate.
+// ═══════════════════════════════════════════════════════════════════
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// ─── Layer Intercepts ───────────────────────────────────────────
+// One line per intercepted entry point. X(name) must have a matching
+// TreadmillLayer_<name> with the OpenXR signature.
+
+#define TREADMILL_INTERCEPTS(X) \
+    X(xrGetInstanceProcAddr) \
+    X(xrDestroyInstance) \
+    X(xrCreateSession) \
+    X(xrDestroySession) \
+    X(xrSuggestInteractionProfileBindings) \
+    X(xrSyncActions) \
+    X(xrGetActionStateVector2f) \
+    X(xrGetActionStateFloat) \
+    X(xrWaitFrame)
+
+#define TREADMILL_INTERCEPT_NAME(fn) #fn,
+
+static constexpr const char* kInterceptNames[] = { TREADMILL_INTERCEPTS(TREADMILL_INTERCEPT_NAME) };
+
+// ─── Hash ───────────────────────────────────────────────────────
+// Every OpenXR name starts with "xr" and many share long prefixes, so
+// hashing the full string costs more than a strcmp chain rejects in.
+// Instead the key is the length plus three sampled characters; the
+// table only has to separate the intercepted names, and the final
+// strcmp confirms the match.
+
+static constexpr uint32_t ProcNameLength(const char* s)
+{
+    uint32_t n = 0;
+    while (s[n]) n++;
+    return n;
+}
+
+static constexpr uint32_t ProcHash(const char* s, uint32_t length, uint32_t seed)
+{
+    uint32_t k = length;
+    if (length > 2) {
+        k |= (uint32_t)(uint8_t)s[2] << 8;
+        k |= (uint32_t)(uint8_t)s[length / 2] << 16;
+        k |= (uint32_t)(uint8_t)s[length - 1] << 24;
+    }
+    k ^= seed * 0x9E3779B9u;       // murmur3 finalizer
+    k ^= k >> 16;
+    k *= 0x85EBCA6Bu;
+    k ^= k >> 13;
+    k *= 0xC2B2AE35u;
+    return k ^ (k >> 16);
+}
+
+// ─── Table ──────────────────────────────────────────────────────
+
+#define PROC_TABLE_EMPTY 0xFF
+
+template <size_t N>
+struct ProcTable {
+    static_assert(N < PROC_TABLE_EMPTY, "index must fit in a slot byte");
+
+    // Smallest power of two at least 4x the entry count: sparse enough
+    // that a collision-free seed is found within a few tries.
+    static constexpr uint32_t kSize = [] {
+        uint32_t s = 8;
+        while (s < N * 4) s <<= 1;
+        return s;
+    }();
+
+    uint32_t    seed;
+    uint8_t     slots[kSize];   // index into the name list, or PROC_TABLE_EMPTY
+    uint8_t     lengths[N];     // rejects most misses without a strcmp
+};
+
+// Searches for a seed that maps every name to a distinct slot. Two
+// names with the same length and sampled characters never separate;
+// the search then runs out of constexpr steps and fails to compile.
+template <size_t N>
+static constexpr ProcTable<N> BuildProcTable(const char* const (&names)[N])
+{
+    ProcTable<N> t = {};
+    for (uint32_t seed = 0;; seed++) {
+        for (uint32_t i = 0; i < ProcTable<N>::kSize; i++) t.slots[i] = PROC_TABLE_EMPTY;
+
+        bool ok = true;
+        for (uint32_t i = 0; i < N && ok; i++) {
+            uint32_t len  = ProcNameLength(names[i]);
+            uint32_t slot = ProcHash(names[i], len, seed) & (ProcTable<N>::kSize - 1);
+            t.lengths[i]  = (uint8_t)len;
+            if (t.slots[slot] != PROC_TABLE_EMPTY) ok = false;
+            else t.slots[slot] = (uint8_t)i;
+        }
+        if (ok) {
+            t.seed = seed;
+            return t;
+        }
+    }
+}
+
+// Returns the index of `name` in `names`, or -1.
+template <size_t N>
+static inline int ProcTableFind(const ProcTable<N>& t, const char* const (&names)[N], const char* name)
+{
+    uint32_t len = (uint32_t)strlen(name);
+    uint8_t  idx = t.slots[ProcHash(name, len, t.seed) & (ProcTable<N>::kSize - 1)];
+    if (idx == PROC_TABLE_EMPTY || t.lengths[idx] != len) return -1;
+    return memcmp(names[idx], name, len) == 0 ? (int)idx : -1;
+}
+
+static constexpr ProcTable<sizeof(kInterceptNames) / sizeof(kInterceptNames[0])>
+    kInterceptTable = BuildProcTable(kInterceptNames);
@@ -0,0 +1,154 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Shared-Memory SPMC Ring
+// ═══════════════════════════════════════════════════════════════════
+// A fixed-size ring of trivially copyable entries that lives inside a
+// memory mapping: one producer, any number of consumers, no locks and
+// no consumer state in the mapping.
+//
+//   head    count of entries ever written, alone on its cache line so
+//           consumer polling never shares a line with the slots the
+//           producer is filling
+//   cursor  each consumer's read position ("tail"), kept in its own
+//           memory — consumers never write to the mapping, so they
+//           cannot slow the producer or each other
+//
+// The producer never waits. A consumer that falls more than a ring
+// behind skips what was overwritten and counts it in cursor->lost;
+// entry n is only returned if it was intact when copied.
+//
+// Entries are copied as 64-bit atomic words, so the layout in the
+// mapping is the entry's own bytes: a C# writer can fill slots with
+// plain stores as long as it publishes the head with a full fence after
+// each entry (see SharedMemoryService.cs).
+//
+// Header-only; used by treadmill_shared.h and any native consumer.
+// ═══════════════════════════════════════════════════════════════════
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+#define SHARED_RING_CACHE_LINE  64
+
+// ─── Layout ─────────────────────────────────────────────────────
+//
+//  off  size            field
+//    0     8            head
+//    8    56            reserved
+//   64    Size·sizeof(T) slots, entry n in slot n % Size
+
+template <typename T, uint32_t Size>
+struct SharedRing {
+    static_assert((Size & (Size - 1)) == 0 && Size >= 2, "ring size must be a power of two");
+    static_assert(sizeof(T) % 8 == 0, "entries are copied as 64-bit words");
+    static_assert(std::is_trivially_copyable<T>::value, "entries are copied bytewise");
+
+    static const uint32_t kWords = sizeof(T) / 8;
+
+    alignas(SHARED_RING_CACHE_LINE) std::atomic<uint64_t> head;
+    uint8_t                                               reserved[SHARED_RING_CACHE_LINE - 8];
+    std::atomic<uint64_t>                                 slots[Size][kWords];
+};
+
+// A consumer's position; owned by the consumer, never shared.
+struct SharedRingCursor {
+    uint64_t    next;           // next entry number to read
+    uint64_t    lost;           // entries overwritten before they were read
+};
+
+// ─── Producer ───────────────────────────────────────────────────
+
+template <typename T, uint32_t Size>
+static inline void SharedRingReset(SharedRing<T, Size>* r)
+{
+    r->head.store(0, std::memory_order_release);
+}
+
+// Appends `count` entries, publishing the head after each one: a
+// consumer can only detect an overwrite of the slot one past the head
+// it sees.
+template <typename T, uint32_t Size>
+static inline void SharedRingWrite(SharedRing<T, Size>* r, const T* items, uint32_t count)
+{
+    uint64_t head = r->head.load(std::memory_order_relaxed);
+
+    for (uint32_t i = 0; i < count; i++, head++) {
+        uint64_t words[SharedRing<T, Size>::kWords];
+        memcpy(words, &items[i], sizeof(T));
+
+        // Orders the previous head store before the slot stores, which is
+        // what lets a consumer detect the overwrite by re-reading the head
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::atomic<uint64_t>* slot = r->slots[head & (Size - 1)];
+        for (uint32_t w = 0; w < SharedRing<T, Size>::kWords; w++)
+            slot[w].store(words[w], std::memory_order_relaxed);
+        r->head.store(head + 1, std::memory_order_release);
+    }
+}
+
+// ─── Consumer ───────────────────────────────────────────────────
+
+// Starts a consumer at the current head (no backlog).
+template <typename T, uint32_t Size>
+static inline void SharedRingCursorInit(const SharedRing<T, Size>* r, SharedRingCursor* cursor)
+{
+    cursor->next = r->head.load(std::memory_order_acquire);
+    cursor->lost = 0;
+}
+
+// Entries written but not yet read by this cursor (may exceed what is
+// still readable).
+template <typename T, uint32_t Size>
+static inline uint64_t SharedRingPending(const SharedRing<T, Size>* r, const SharedRingCursor* cursor)
+{
+    uint64_t head = r->head.load(std::memory_order_acquire);
+    return head > cursor->next ? head - cursor->next : 0;
+}
+
+// Copies up to `max` unread entries, oldest first, and advances the
+// cursor. Wait-free. A head behind the cursor means the producer
+// restarted; the cursor follows it.
+template <typename T, uint32_t Size>
+static inline uint32_t SharedRingRead(const SharedRing<T, Size>* r, SharedRingCursor* cursor, T* out, uint32_t max)
+{
+    // The slot after the head may already be mid-overwrite, so only the
+    // newest Size - 1 entries are ever readable
+    const uint64_t window = Size - 1;
+
+    uint64_t head = r->head.load(std::memory_order_acquire);
+    if (head < cursor->next) cursor->next = head;
+    if (head - cursor->next > window) {
+        cursor->lost += head - cursor->next - window;
+        cursor->next  = head - window;
+    }
+
+    uint64_t available = head - cursor->next;
+    uint32_t n = available < max ? (uint32_t)available : max;
+    for (uint32_t i = 0; i < n; i++) {
+        const std::atomic<uint64_t>* slot = r->slots[(cursor->next + i) & (Size - 1)];
+        uint64_t words[SharedRing<T, Size>::kWords];
+        for (uint32_t w = 0; w < SharedRing<T, Size>::kWords; w++)
+            words[w] = slot[w].load(std::memory_order_relaxed);
+        memcpy(&out[i], words, sizeof(T));
+    }
+
+    // The producer may have lapped us mid-copy; entry p is only intact if
+    // entry p + Size had not started when we re-read the head
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t after = r->head.load(std::memory_order_relaxed);
+    uint64_t firstIntact = after > window ? after - window : 0;
+    if (cursor->next < firstIntact) {
+        uint64_t torn = firstIntact - cursor->next;
+        uint32_t skip = torn < n ? (uint32_t)torn : n;
+        memmove(out, out + skip, (n - skip) * sizeof(T));
+        n            -= skip;
+        cursor->lost += skip;
+        cursor->next += skip;
+    }
+
+    cursor->next += n;
+    return n;
+}
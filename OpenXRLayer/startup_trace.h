@@ -0,0 +1,126 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Startup Trace
+// ═══════════════════════════════════════════════════════════════════
+// The layer runs inside every VR title's launch, so negotiation,
+// instance creation and the deferred first-use work record their
+// phases here: a fixed array of begin/end timestamps, filled without
+// allocation or locks (a phase claims its slot with one CAS).
+// Recording is always on; it is two clock reads per phase.
+//
+// StartupTraceFormat renders the phases as Chrome trace-event JSON
+// ("X" complete events, microseconds from the first phase; nesting
+// follows from the times), which chrome://tracing and Perfetto open
+// directly. The layer writes it to $TREADMILL_STARTUP_TRACE, off the
+// application's threads.
+//
+// Platform-neutral: the caller supplies the clock and thread ids.
+// ═══════════════════════════════════════════════════════════════════
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+
+#define STARTUP_TRACE_ENV           "TREADMILL_STARTUP_TRACE"
+#define STARTUP_TRACE_MAX_PHASES    32
+
+struct StartupTracePhase {
+    const char*             name;           // string literal
+    int64_t                 begin;          // caller's clock ticks
+    std::atomic<int64_t>    end;            // 0 while the phase is open; publishes the rest
+    uint32_t                threadId;
+};
+
+struct StartupTrace {
+    std::atomic<uint32_t>   count;
+    StartupTracePhase       phases[STARTUP_TRACE_MAX_PHASES];
+};
+
+// Opens a phase; returns its index for StartupTraceEnd, or -1 if the
+// trace is full (the phase is then simply not recorded).
+static inline int StartupTraceBegin(StartupTrace* t, const char* name, uint32_t threadId, int64_t now)
+{
+    uint32_t i = t->count.load(std::memory_order_relaxed);
+    do {
+        if (i >= STARTUP_TRACE_MAX_PHASES) return -1;
+    } while (!t->count.compare_exchange_weak(i, i + 1, std::memory_order_relaxed));
+
+    StartupTracePhase* p = &t->phases[i];
+    p->name     = name;
+    p->begin    = now;
+    p->threadId = threadId;
+    return (int)i;
+}
+
+static inline void StartupTraceEnd(StartupTrace* t, int index, int64_t now)
+{
+    if (index < 0) return;
+    t->phases[index].end.store(now > 0 ? now : 1, std::memory_order_release);
+}
+
+// Forgets every phase after the first `keep` (once-per-process phases
+// such as negotiation, which later traces still want). No phase may
+// be open, and nothing formatting.
+static inline void StartupTraceReset(StartupTrace* t, uint32_t keep)
+{
+    uint32_t n = t->count.load(std::memory_order_relaxed);
+    if (keep > n) keep = n;
+    for (uint32_t i = keep; i < STARTUP_TRACE_MAX_PHASES; i++) t->phases[i].end.store(0, std::memory_order_relaxed);
+    t->count.store(keep, std::memory_order_release);
+}
+
+// Ticks of the phase called `name`, or -1 if it is missing or open.
+static inline int64_t StartupTraceDuration(const StartupTrace* t, const char* name)
+{
+    uint32_t n = t->count.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < n && i < STARTUP_TRACE_MAX_PHASES; i++) {
+        const StartupTracePhase* p = &t->phases[i];
+        int64_t end = p->end.load(std::memory_order_acquire);
+        if (end && strcmp(p->name, name) == 0) return end - p->begin;
+    }
+    return -1;
+}
+
+// Renders closed phases as Chrome trace-event JSON into `out`. Returns
+// the length written (excluding the NUL), or 0 if `capacity` is too
+// small. `frequency` is the caller's clock in ticks per second.
+static inline size_t StartupTraceFormat(const StartupTrace* t, int64_t frequency, uint32_t pid,
+                                        char* out, size_t capacity)
+{
+    uint32_t n = t->count.load(std::memory_order_acquire);
+    if (n > STARTUP_TRACE_MAX_PHASES) n = STARTUP_TRACE_MAX_PHASES;
+
+    int64_t origin  = 0;
+    bool    any     = false;
+    for (uint32_t i = 0; i < n; i++) {
+        if (!t->phases[i].end.load(std::memory_order_acquire)) continue;
+        if (!any || t->phases[i].begin < origin) origin = t->phases[i].begin;
+        any = true;
+    }
+
+    size_t len = 0;
+    int w = snprintf(out, capacity, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    if (w < 0 || (size_t)w >= capacity) return 0;
+    len = (size_t)w;
+
+    bool first = true;
+    for (uint32_t i = 0; i < n; i++) {
+        const StartupTracePhase* p = &t->phases[i];
+        int64_t end = p->end.load(std::memory_order_acquire);
+        if (!end) continue;
+
+        double ts  = (double)(p->begin - origin) * 1e6 / (double)frequency;
+        double dur = (double)(end - p->begin) * 1e6 / (double)frequency;
+        w = snprintf(out + len, capacity - len,
+                     "%s\n{\"name\":\"%s\",\"cat\":\"startup\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%u,\"tid\":%u}",
+                     first ? "" : ",", p->name, ts, dur, pid, p->threadId);
+        if (w < 0 || (size_t)w >= capacity - len) return 0;
+        len  += (size_t)w;
+        first = false;
+    }
+
+    w = snprintf(out + len, capacity - len, "\n]}\n");
+    if (w < 0 || (size_t)w >= capacity - len) return 0;
+    return len + (size_t)w;
+}
@@ -0,0 +1,110 @@
+// ═══════════════════════════════════════════════════════════════════
+// Action hash set + arena tests
+// ═══════════════════════════════════════════════════════════════════
+
+#include "action_set.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+// Handles as a runtime might hand them out: aligned heap-like pointers.
+uintptr_t Handle(uint32_t i) { return 0x7ff6a0000000ull + (uintptr_t)i * 0x40; }
+
+} // namespace
+
+TEST(ActionSet, EmptyAndNullNeverMatch)
+{
+    LayerArena arena = {};
+    ActionSet* set = ActionSetCreate(&arena, 0, NULL);
+    ASSERT_NE(set, nullptr);
+    EXPECT_EQ(set->capacity, (uint32_t)ACTION_SET_MIN_CAPACITY);
+    EXPECT_FALSE(ActionSetContains(set, Handle(1)));
+    EXPECT_FALSE(ActionSetContains(set, 0));
+    EXPECT_FALSE(ActionSetContains(NULL, Handle(1)));
+    EXPECT_FALSE(ActionSetInsert(set, 0));
+    LayerArenaReset(&arena);
+}
+
+TEST(ActionSet, InsertIsIdempotent)
+{
+    LayerArena arena = {};
+    ActionSet* set = ActionSetCreate(&arena, 4, NULL);
+    EXPECT_TRUE(ActionSetInsert(set, Handle(7)));
+    EXPECT_FALSE(ActionSetInsert(set, Handle(7)));
+    EXPECT_EQ(set->count, 1u);
+    EXPECT_TRUE(ActionSetContains(set, Handle(7)));
+    LayerArenaReset(&arena);
+}
+
+TEST(ActionSet, ValuesFollowKeysIntoCopies)
+{
+    LayerArena arena = {};
+    ActionSet* first = ActionSetCreate(&arena, 4, NULL);
+    ASSERT_TRUE(ActionSetInsert(first, Handle(1), 0x21));
+    ASSERT_TRUE(ActionSetInsert(first, Handle(2)));
+    EXPECT_FALSE(ActionSetInsert(first, Handle(1), 0x99));    // first value wins
+
+    ActionSet* second = ActionSetCreate(&arena, 64, first);
+    ASSERT_TRUE(ActionSetInsert(second, Handle(3), 0x103));
+
+    EXPECT_EQ(ActionSetValue(second, Handle(1)), 0x21u);
+    EXPECT_EQ(ActionSetValue(second, Handle(2)), 0u);
+    EXPECT_EQ(ActionSetValue(second, Handle(3)), 0x103u);
+    EXPECT_EQ(ActionSetValue(second, Handle(4)), 0u);
+    EXPECT_EQ(ActionSetFind(second, Handle(4)), -1);
+    EXPECT_EQ(ActionSetValue(NULL, Handle(1)), 0u);
+    LayerArenaReset(&arena);
+}
+
+TEST(ActionSet, RespectsLoadFactor)
+{
+    LayerArena arena = {};
+    ActionSet* set = ActionSetCreate(&arena, 0, NULL);
+    uint32_t inserted = 0;
+    for (uint32_t i = 1; i <= set->capacity; i++) {
+        if (ActionSetInsert(set, Handle(i))) inserted++;
+    }
+    EXPECT_EQ(inserted, set->capacity / 2);
+    LayerArenaReset(&arena);
+}
+
+TEST(ActionSet, GrowsPastOldFixedCap)
+{
+    LayerArena arena = {};
+    const ActionSet* published = NULL;
+
+    // Grow the way xrSuggestInteractionProfileBindings does: one copy per call
+    for (uint32_t batch = 0; batch < 8; batch++) {
+        ActionSet* next = ActionSetCreate(&arena, (published ? published->count : 0) + 64, published);
+        ASSERT_NE(next, nullptr);
+        for (uint32_t i = 0; i < 64; i++) ASSERT_TRUE(ActionSetInsert(next, Handle(batch * 64 + i + 1)));
+
+        // The previous table is untouched and still readable
+        if (published) {
+            EXPECT_EQ(published->count, batch * 64);
+            EXPECT_FALSE(ActionSetContains(published, Handle(batch * 64 + 1)));
+        }
+        published = next;
+    }
+
+    EXPECT_EQ(published->count, 512u);
+    for (uint32_t i = 1; i <= 512; i++) EXPECT_TRUE(ActionSetContains(published, Handle(i)));
+    EXPECT_FALSE(ActionSetContains(published, Handle(513)));
+    LayerArenaReset(&arena);
+    EXPECT_EQ(arena.totalBytes, 0u);
+}
+
+TEST(LayerArena, AlignsAndSpillsToNewChunks)
+{
+    LayerArena arena = {};
+    void* a = LayerArenaAlloc(&arena, 3, 1);
+    void* b = LayerArenaAlloc(&arena, 8, 16);
+    EXPECT_NE(a, nullptr);
+    EXPECT_EQ((uintptr_t)b % 16, 0u);
+
+    void* big = LayerArenaAlloc(&arena, LAYER_ARENA_CHUNK_SIZE * 2);
+    ASSERT_NE(big, nullptr);
+    EXPECT_GE(arena.totalBytes, (size_t)LAYER_ARENA_CHUNK_SIZE * 3);
+    LayerArenaReset(&arena);
+}
@@ -0,0 +1,230 @@
+// ═══════════════════════════════════════════════════════════════════
+// Application profiles — compiler, database validation and lookup
+// ═══════════════════════════════════════════════════════════════════
+
+#include "app_profiles.h"
+#include "profile_compiler.h"
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+
+namespace {
+
+const char* const kJson = R"({
+  // comments are allowed in hand-written files
+  "profiles": [
+    {
+      "application": "Trackpad Title",
+      "scale": { "forward": 1.5, "turn": -0.5 },
+      "builtinBindings": false,
+      "bindings": [
+        { "path": "/user/hand/left/input/trackpad", "x": "strafe", "y": "forward", "combine": "max" },
+        { "path": "/user/hand/right/input/trackpad/x", "value": "turn" }
+      ]
+    },
+    { "engine": "Some Engine", "scale": { "forward": 0.5 } },
+    { "application": "Some Engine" }
+  ]
+})";
+
+std::vector<uint8_t> Compile(const char* json)
+{
+    std::vector<uint8_t> db;
+    std::string error;
+    EXPECT_TRUE(profile_compiler::CompileProfiles(json, &db, &error)) << error;
+    return db;
+}
+
+std::string CompileError(const char* json)
+{
+    std::vector<uint8_t> db;
+    std::string error;
+    EXPECT_FALSE(profile_compiler::CompileProfiles(json, &db, &error)) << json;
+    return error;
+}
+
+bool Open(ProfileDb* db, const std::vector<uint8_t>& bytes)
+{
+    return ProfileDbOpen(db, bytes.data(), bytes.size());
+}
+
+ProfileDbHeader* Header(std::vector<uint8_t>& bytes) { return (ProfileDbHeader*)bytes.data(); }
+
+ProfileDbProfile* Profiles(std::vector<uint8_t>& bytes)
+{
+    return (ProfileDbProfile*)(bytes.data() + Header(bytes)->profilesOffset);
+}
+
+ProfileDbBinding* Bindings(std::vector<uint8_t>& bytes)
+{
+    return (ProfileDbBinding*)(bytes.data() + Header(bytes)->bindingsOffset);
+}
+
+} // namespace
+
+// ─── Lookup ─────────────────────────────────────────────────────
+
+TEST(AppProfiles, FindsByApplicationAndEngine)
+{
+    std::vector<uint8_t> bytes = Compile(kJson);
+    ProfileDb db;
+    ASSERT_TRUE(Open(&db, bytes));
+    EXPECT_EQ(db.header->profileCount, 3u);
+    EXPECT_EQ(db.header->bindingCount, 2u);
+
+    const ProfileDbProfile* p = ProfileDbFind(&db, "trackpad TITLE", PROFILE_MATCH_APPLICATION);
+    ASSERT_NE(p, nullptr);
+    EXPECT_STREQ(ProfileDbString(&db, p->name), "Trackpad Title");
+    EXPECT_FLOAT_EQ(p->scale[INJECT_AXIS_FORWARD], 1.5f);
+    EXPECT_FLOAT_EQ(p->scale[INJECT_AXIS_STRAFE], 1.0f);
+    EXPECT_FLOAT_EQ(p->scale[INJECT_AXIS_TURN], -0.5f);
+    EXPECT_EQ(p->flags & PROFILE_FLAG_BUILTIN, 0u);
+
+    EXPECT_EQ(ProfileDbFind(&db, "Trackpad Title", PROFILE_MATCH_ENGINE), nullptr);
+    EXPECT_EQ(ProfileDbFind(&db, "Trackpad", PROFILE_MATCH_APPLICATION), nullptr);
+    EXPECT_EQ(ProfileDbFind(&db, "", PROFILE_MATCH_APPLICATION), nullptr);
+
+    // The same name under both kinds resolves by kind
+    const ProfileDbProfile* engine = ProfileDbFind(&db, "some engine", PROFILE_MATCH_ENGINE);
+    const ProfileDbProfile* app    = ProfileDbFind(&db, "some engine", PROFILE_MATCH_APPLICATION);
+    ASSERT_NE(engine, nullptr);
+    ASSERT_NE(app, nullptr);
+    EXPECT_NE(engine, app);
+    EXPECT_FLOAT_EQ(engine->scale[INJECT_AXIS_FORWARD], 0.5f);
+    EXPECT_FLOAT_EQ(app->scale[INJECT_AXIS_FORWARD], 1.0f);
+}
+
+TEST(AppProfiles, ApplicationWinsOverEngine)
+{
+    std::vector<uint8_t> bytes = Compile(kJson);
+    ProfileDb db;
+    ASSERT_TRUE(Open(&db, bytes));
+
+    EXPECT_EQ(ProfileDbSelect(&db, "Trackpad Title", "Some Engine"),
+              ProfileDbFind(&db, "Trackpad Title", PROFILE_MATCH_APPLICATION));
+    EXPECT_EQ(ProfileDbSelect(&db, "Unknown", "Some Engine"),
+              ProfileDbFind(&db, "Some Engine", PROFILE_MATCH_ENGINE));
+    EXPECT_EQ(ProfileDbSelect(&db, "Unknown", "Unknown"), nullptr);
+
+    ProfileDb empty = {};
+    EXPECT_EQ(ProfileDbSelect(&empty, "Trackpad Title", "Some Engine"), nullptr);
+}
+
+// ─── Classification ─────────────────────────────────────────────
+
+TEST(AppProfiles, ListedPathsReplaceTheBuiltinClassification)
+{
+    std::vector<uint8_t> bytes = Compile(kJson);
+    ProfileDb db;
+    ASSERT_TRUE(Open(&db, bytes));
+    const ProfileDbProfile* p = ProfileDbFind(&db, "Trackpad Title", PROFILE_MATCH_APPLICATION);
+    ASSERT_NE(p, nullptr);
+
+    InjectBinding b = ProfileClassifyBinding(&db, p, "/user/hand/left/input/trackpad");
+    EXPECT_EQ(b.vec2f, kInjectLeftStick | INJECT_TARGET_COMBINE_MAX);
+    EXPECT_EQ(b.floatValue, 0u);
+    EXPECT_TRUE(b.leftStick);
+
+    b = ProfileClassifyBinding(&db, p, "/user/hand/right/input/trackpad/x");
+    EXPECT_EQ(b.vec2f, 0u);
+    EXPECT_EQ(InjectTargetX(b.floatValue), INJECT_AXIS_TURN);
+    EXPECT_EQ(InjectTargetHand(b.floatValue), INJECT_HAND_RIGHT);
+
+    // Built-in bindings are off for this profile
+    b = ProfileClassifyBinding(&db, p, "/user/hand/left/input/thumbstick");
+    EXPECT_EQ(b.vec2f, 0u);
+    EXPECT_FALSE(b.leftStick);
+}
+
+TEST(AppProfiles, BuiltinFlagKeepsUnlistedPaths)
+{
+    std::vector<uint8_t> bytes = Compile(kJson);
+    ProfileDb db;
+    ASSERT_TRUE(Open(&db, bytes));
+    const ProfileDbProfile* p = ProfileDbFind(&db, "Some Engine", PROFILE_MATCH_ENGINE);
+    ASSERT_NE(p, nullptr);
+    EXPECT_NE(p->flags & PROFILE_FLAG_BUILTIN, 0u);
+
+    InjectBinding b = ProfileClassifyBinding(&db, p, "/user/hand/left/input/thumbstick");
+    EXPECT_EQ(b.vec2f, kInjectLeftStick);
+
+    // No profile at all is the built-in classification
+    b = ProfileClassifyBinding(&db, nullptr, "/user/hand/right/input/thumbstick");
+    EXPECT_EQ(b.vec2f, kInjectRightStick);
+}
+
+TEST(AppProfiles, CombineMaxKeepsTheStrongerValue)
+{
+    const float axes[INJECT_AXIS_COUNT] = { 0.5f, -0.25f, 0.0f };
+    InjectTarget t = kInjectLeftStick | INJECT_TARGET_COMBINE_MAX;
+
+    XrVector2f v = { 0.1f, 0.75f };
+    ASSERT_TRUE(InjectVector2f(&v, t, axes));
+    EXPECT_FLOAT_EQ(v.x, -0.25f);                // treadmill stronger
+    EXPECT_FLOAT_EQ(v.y, 0.75f);                 // runtime stronger: not pushed past it
+
+    v = { 0.0f, -2.0f };
+    ASSERT_TRUE(InjectVector2f(&v, t, axes));
+    EXPECT_FLOAT_EQ(v.y, -1.0f);                 // still clamped
+}
+
+// ─── Validation ─────────────────────────────────────────────────
+
+TEST(AppProfiles, RejectsMalformedDatabases)
+{
+    const std::vector<uint8_t> good = Compile(kJson);
+    ProfileDb db;
+    ASSERT_TRUE(Open(&db, good));
+
+    auto rejects = [&](const char* what, void (*corrupt)(std::vector<uint8_t>&)) {
+        std::vector<uint8_t> bytes = good;
+        corrupt(bytes);
+        EXPECT_FALSE(Open(&db, bytes)) << what;
+        EXPECT_EQ(db.header, nullptr) << what;
+    };
+
+    rejects("truncated",          [](std::vector<uint8_t>& b) { b.resize(b.size() - 4); });
+    rejects("header only",        [](std::vector<uint8_t>& b) { b.resize(sizeof(ProfileDbHeader) - 1); });
+    rejects("magic",              [](std::vector<uint8_t>& b) { Header(b)->magic ^= 1; });
+    rejects("version",            [](std::vector<uint8_t>& b) { Header(b)->version++; });
+    rejects("profile count",      [](std::vector<uint8_t>& b) { Header(b)->profileCount = 0x10000000; });
+    rejects("strings unaligned",  [](std::vector<uint8_t>& b) { Header(b)->stringsOffset += 1; });
+    rejects("strings overrun",    [](std::vector<uint8_t>& b) { Header(b)->stringsSize += 8; });
+    rejects("name offset",        [](std::vector<uint8_t>& b) { Profiles(b)[0].name = Header(b)->stringsSize; });
+    rejects("binding range",      [](std::vector<uint8_t>& b) { Profiles(b)[0].bindingCount = 3; });
+    rejects("match kind",         [](std::vector<uint8_t>& b) { Profiles(b)[0].matchKind = 7; });
+    rejects("unsorted",           [](std::vector<uint8_t>& b) { std::swap(Profiles(b)[0], Profiles(b)[2]); });
+    rejects("scale",              [](std::vector<uint8_t>& b) { Profiles(b)[0].scale[0] = 1e9f; });
+    rejects("scale NaN",          [](std::vector<uint8_t>& b) { Profiles(b)[0].scale[1] = NAN; });
+    rejects("target axis",        [](std::vector<uint8_t>& b) { Bindings(b)[0].vec2f = 0xF; });
+    rejects("target bits",        [](std::vector<uint8_t>& b) { Bindings(b)[1].floatValue |= 0x8000; });
+    rejects("unterminated name",  [](std::vector<uint8_t>& b) { Header(b)->stringsSize -= 1; });
+}
+
+TEST(AppProfiles, CompilerReportsErrors)
+{
+    EXPECT_NE(CompileError("{").find("offset"), std::string::npos);
+    EXPECT_NE(CompileError("[]").find("profiles"), std::string::npos);
+    EXPECT_NE(CompileError(R"({"profiles":[{"scale":{}}]})").find("exactly one"), std::string::npos);
+    EXPECT_NE(CompileError(R"({"profiles":[{"application":"A","engine":"B"}]})").find("exactly one"), std::string::npos);
+    EXPECT_NE(CompileError(R"({"profiles":[{"application":"A","scale":{"up":1}}]})").find("up"), std::string::npos);
+    EXPECT_NE(CompileError(R"({"profiles":[{"application":"A","scale":{"turn":11}}]})").find("turn"), std::string::npos);
+    EXPECT_NE(CompileError(R"({"profiles":[{"application":"A","bindings":[{"path":"/user/gamepad/input/x","value":"turn"}]}]})")
+                  .find("/user/gamepad"), std::string::npos);
+    EXPECT_NE(CompileError(R"({"profiles":[{"application":"A","bindings":[{"path":"/user/hand/left/input/x"}]}]})")
+                  .find("no axis"), std::string::npos);
+    EXPECT_NE(CompileError(R"({"profiles":[{"application":"A","bindings":[{"path":"/user/hand/left/input/x","value":"turn","combine":"clamp"}]}]})")
+                  .find("combine"), std::string::npos);
+
+    std::string dup = CompileError(R"({"profiles":[{"application":"Title"},{"application":"TITLE"}]})");
+    EXPECT_NE(dup.find("duplicate"), std::string::npos) << dup;
+}
+
+TEST(AppProfiles, EmptyDatabaseMatchesNothing)
+{
+    std::vector<uint8_t> bytes = Compile(R"({"profiles":[]})");
+    ProfileDb db;
+    ASSERT_TRUE(Open(&db, bytes));
+    EXPECT_EQ(ProfileDbSelect(&db, "Anything", "Anything"), nullptr);
+}
@@ -0,0 +1,129 @@
+// ═══════════════════════════════════════════════════════════════════
+// Axis injection — binding classification, targets and clamping
+// ═══════════════════════════════════════════════════════════════════
+
+#include "axis_injection.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+const XrPath kLeft  = 11;
+const XrPath kRight = 12;
+
+// forward, strafe, turn
+const float kAxes[INJECT_AXIS_COUNT] = { 0.5f, -0.25f, 0.75f };
+
+} // namespace
+
+// ─── Targets ────────────────────────────────────────────────────
+
+TEST(AxisInjection, TargetsRoundTrip)
+{
+    InjectTarget t = InjectTargetMake(INJECT_AXIS_TURN, INJECT_AXIS_NONE, INJECT_HAND_RIGHT);
+    EXPECT_NE(t, 0u);
+    EXPECT_EQ(InjectTargetX(t), INJECT_AXIS_TURN);
+    EXPECT_EQ(InjectTargetY(t), INJECT_AXIS_NONE);
+    EXPECT_EQ(InjectTargetHand(t), INJECT_HAND_RIGHT);
+
+    EXPECT_EQ(kInjectLeftStick, InjectTargetMake(INJECT_AXIS_STRAFE, INJECT_AXIS_FORWARD, INJECT_HAND_LEFT));
+    EXPECT_EQ(kInjectRightStick, InjectTargetMake(INJECT_AXIS_TURN, INJECT_AXIS_NONE, INJECT_HAND_RIGHT));
+}
+
+// ─── Classification ─────────────────────────────────────────────
+
+TEST(AxisInjection, ClassifiesLeftThumbstick)
+{
+    InjectBinding b = InjectClassifyBinding("/user/hand/left/input/thumbstick");
+    EXPECT_EQ(b.vec2f, kInjectLeftStick);
+    EXPECT_EQ(b.floatValue, 0u);
+    EXPECT_TRUE(b.leftStick);
+
+    b = InjectClassifyBinding("/user/hand/left/input/thumbstick/y");
+    EXPECT_EQ(b.vec2f, 0u);
+    EXPECT_EQ(InjectTargetX(b.floatValue), INJECT_AXIS_FORWARD);
+    EXPECT_TRUE(b.leftStick);
+
+    b = InjectClassifyBinding("/user/hand/left/input/thumbstick/x");
+    EXPECT_EQ(InjectTargetX(b.floatValue), INJECT_AXIS_STRAFE);
+    EXPECT_EQ(InjectTargetHand(b.floatValue), INJECT_HAND_LEFT);
+}
+
+TEST(AxisInjection, ClassifiesRightThumbstick)
+{
+    InjectBinding b = InjectClassifyBinding("/user/hand/right/input/thumbstick");
+    EXPECT_EQ(b.vec2f, kInjectRightStick);
+    EXPECT_FALSE(b.leftStick);                  // does not end the left-stick fallback
+
+    b = InjectClassifyBinding("/user/hand/right/input/thumbstick/x");
+    EXPECT_EQ(InjectTargetX(b.floatValue), INJECT_AXIS_TURN);
+    EXPECT_EQ(InjectTargetHand(b.floatValue), INJECT_HAND_RIGHT);
+
+    // Right y carries nothing
+    b = InjectClassifyBinding("/user/hand/right/input/thumbstick/y");
+    EXPECT_EQ(b.vec2f, 0u);
+    EXPECT_EQ(b.floatValue, 0u);
+}
+
+TEST(AxisInjection, IgnoresOtherBindings)
+{
+    const char* paths[] = {
+        "/user/hand/left/input/trigger/value",
+        "/user/hand/right/input/a/click",
+        "/user/gamepad/input/thumbstick_left",
+    };
+    for (const char* path : paths) {
+        InjectBinding b = InjectClassifyBinding(path);
+        EXPECT_EQ(b.vec2f, 0u) << path;
+        EXPECT_EQ(b.floatValue, 0u) << path;
+        EXPECT_FALSE(b.leftStick) << path;
+    }
+}
+
+// ─── Injection ──────────────────────────────────────────────────
+
+TEST(AxisInjection, SubactionSelectsTheTargetsHand)
+{
+    EXPECT_TRUE(InjectSubactionMatches(kInjectLeftStick, XR_NULL_PATH, kLeft, kRight));
+    EXPECT_TRUE(InjectSubactionMatches(kInjectLeftStick, kLeft, kLeft, kRight));
+    EXPECT_FALSE(InjectSubactionMatches(kInjectLeftStick, kRight, kLeft, kRight));
+    EXPECT_TRUE(InjectSubactionMatches(kInjectRightStick, kRight, kLeft, kRight));
+    EXPECT_FALSE(InjectSubactionMatches(kInjectRightStick, kLeft, kLeft, kRight));
+}
+
+TEST(AxisInjection, AddsAndClampsEachComponent)
+{
+    XrVector2f v = { 0.1f, 0.75f };
+    ASSERT_TRUE(InjectVector2f(&v, kInjectLeftStick, kAxes));
+    EXPECT_FLOAT_EQ(v.x, -0.15f);
+    EXPECT_FLOAT_EQ(v.y, 1.0f);
+
+    v = { -0.5f, 0.3f };
+    ASSERT_TRUE(InjectVector2f(&v, kInjectRightStick, kAxes));
+    EXPECT_FLOAT_EQ(v.x, 0.25f);
+    EXPECT_FLOAT_EQ(v.y, 0.3f);                 // no axis on right y
+
+    float f = -0.9f;
+    ASSERT_TRUE(InjectFloat(&f, InjectTargetMake(INJECT_AXIS_STRAFE, INJECT_AXIS_NONE, INJECT_HAND_LEFT), kAxes));
+    EXPECT_FLOAT_EQ(f, -1.0f);
+}
+
+TEST(AxisInjection, ZeroAxesLeaveTheStateUntouched)
+{
+    const float zero[INJECT_AXIS_COUNT] = {};
+    XrVector2f v = { 2.0f, -3.0f };             // out of range on purpose: must not be clamped
+    EXPECT_FALSE(InjectVector2f(&v, kInjectLeftStick, zero));
+    EXPECT_EQ(v.x, 2.0f);
+    EXPECT_EQ(v.y, -3.0f);
+
+    // Only forward moving: x is left exactly as the runtime reported it
+    const float forward[INJECT_AXIS_COUNT] = { 0.5f, 0.0f, 0.0f };
+    v = { 2.0f, 0.0f };
+    EXPECT_TRUE(InjectVector2f(&v, kInjectLeftStick, forward));
+    EXPECT_EQ(v.x, 2.0f);
+    EXPECT_EQ(v.y, 0.5f);
+
+    float f = 0.3f;
+    EXPECT_FALSE(InjectFloat(&f, kInjectRightStick, forward));
+    EXPECT_EQ(f, 0.3f);
+}
@@ -0,0 +1,22 @@
+# ═══════════════════════════════════════════════════════════════════
+# Layer TLS model check (ELF)
+# ═══════════════════════════════════════════════════════════════════
+# Every intercept touches the telemetry slot (treadmill_layer.cpp). In a
+# -fPIC module the default TLS model reaches it through __tls_get_addr,
+# a call per intercept; initial-exec is a single %fs-relative load and
+# imports nothing. Fails if the built layer imports __tls_get_addr.
+#
+#   cmake -DNM=<nm> -DLAYER=<treadmill_layer.so> -P check_layer_tls.cmake
+
+execute_process(COMMAND "${NM}" -D --undefined-only "${LAYER}"
+                OUTPUT_VARIABLE symbols
+                RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${NM} failed on ${LAYER}")
+endif()
+
+if(symbols MATCHES "__tls_get_addr")
+    message(FATAL_ERROR "${LAYER} imports __tls_get_addr: a thread_local on the hot path lost "
+                        "its initial-exec TLS model")
+endif()
+message(STATUS "${LAYER}: no dynamic TLS calls")
@@ -0,0 +1,149 @@
+// ═══════════════════════════════════════════════════════════════════
+// Handle map — insert, find, remove, tombstones and concurrent readers
+// ═══════════════════════════════════════════════════════════════════
+
+#include "handle_map.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef HandleMap<int, 16> SmallMap;
+
+class HandleMapTest : public ::testing::Test {
+protected:
+    SmallMap    m_map = {};
+    int         m_values[16] = {};
+};
+
+// Keys that all land on `slot`, so tests can build probe chains
+std::vector<uint64_t> Colliding(uint32_t slot, size_t n)
+{
+    const SmallMap* none = NULL;
+    std::vector<uint64_t> keys;
+    for (uint64_t k = 1; keys.size() < n; k++)
+        if (HandleMapSlot(none, k) == slot) keys.push_back(k);
+    return keys;
+}
+
+} // namespace
+
+TEST_F(HandleMapTest, EmptyMapFindsNothing)
+{
+    EXPECT_EQ(HandleMapFind(&m_map, 1), nullptr);
+    EXPECT_EQ(HandleMapFind(&m_map, HANDLE_MAP_EMPTY), nullptr);
+    EXPECT_EQ(HandleMapFind(&m_map, HANDLE_MAP_TOMBSTONE), nullptr);
+    EXPECT_EQ(HandleMapRemove(&m_map, 1), nullptr);
+}
+
+TEST_F(HandleMapTest, FindsWhatWasInserted)
+{
+    ASSERT_TRUE(HandleMapInsert(&m_map, 0xA11CE000, &m_values[0]));
+    ASSERT_TRUE(HandleMapInsert(&m_map, 0xA11CE040, &m_values[1]));
+    EXPECT_EQ(HandleMapFind(&m_map, 0xA11CE000), &m_values[0]);
+    EXPECT_EQ(HandleMapFind(&m_map, 0xA11CE040), &m_values[1]);
+    EXPECT_EQ(HandleMapFind(&m_map, 0xA11CE080), nullptr);
+    EXPECT_EQ(m_map.count, 2u);
+}
+
+TEST_F(HandleMapTest, RejectsNullDuplicateAndOverfull)
+{
+    EXPECT_FALSE(HandleMapInsert(&m_map, HANDLE_MAP_EMPTY, &m_values[0]));
+    EXPECT_FALSE(HandleMapInsert(&m_map, HANDLE_MAP_TOMBSTONE, &m_values[0]));
+
+    ASSERT_TRUE(HandleMapInsert(&m_map, 5, &m_values[0]));
+    EXPECT_FALSE(HandleMapInsert(&m_map, 5, &m_values[1]));
+    EXPECT_EQ(HandleMapFind(&m_map, 5), &m_values[0]);
+
+    // Half full is the limit
+    for (uint64_t k = 6; k < 13; k++) ASSERT_TRUE(HandleMapInsert(&m_map, k, &m_values[k]));
+    EXPECT_EQ(m_map.count, 8u);
+    EXPECT_FALSE(HandleMapInsert(&m_map, 100, &m_values[0]));
+}
+
+TEST_F(HandleMapTest, RemoveKeepsProbeChainsIntact)
+{
+    std::vector<uint64_t> keys = Colliding(3, 3);
+    for (int i = 0; i < 3; i++) ASSERT_TRUE(HandleMapInsert(&m_map, keys[i], &m_values[i]));
+
+    // Removing the head leaves a tombstone the others are found past
+    EXPECT_EQ(HandleMapRemove(&m_map, keys[0]), &m_values[0]);
+    EXPECT_EQ(m_map.keys[3].load(), HANDLE_MAP_TOMBSTONE);
+    EXPECT_EQ(HandleMapFind(&m_map, keys[0]), nullptr);
+    EXPECT_EQ(HandleMapFind(&m_map, keys[1]), &m_values[1]);
+    EXPECT_EQ(HandleMapFind(&m_map, keys[2]), &m_values[2]);
+    EXPECT_EQ(m_map.count, 2u);
+
+    // A reinsert reuses the tombstone
+    ASSERT_TRUE(HandleMapInsert(&m_map, keys[0], &m_values[5]));
+    EXPECT_EQ(m_map.keys[3].load(), keys[0]);
+    EXPECT_EQ(HandleMapFind(&m_map, keys[0]), &m_values[5]);
+}
+
+TEST_F(HandleMapTest, TrailingTombstonesBecomeEmpty)
+{
+    std::vector<uint64_t> keys = Colliding(7, 3);
+    for (int i = 0; i < 3; i++) ASSERT_TRUE(HandleMapInsert(&m_map, keys[i], &m_values[i]));
+
+    EXPECT_EQ(HandleMapRemove(&m_map, keys[1]), &m_values[1]);
+    EXPECT_EQ(m_map.keys[8].load(), HANDLE_MAP_TOMBSTONE);
+
+    // The end of the chain goes, and takes the tombstone before it along
+    EXPECT_EQ(HandleMapRemove(&m_map, keys[2]), &m_values[2]);
+    EXPECT_EQ(m_map.keys[8].load(), HANDLE_MAP_EMPTY);
+    EXPECT_EQ(m_map.keys[9].load(), HANDLE_MAP_EMPTY);
+    EXPECT_EQ(HandleMapFind(&m_map, keys[0]), &m_values[0]);
+
+    EXPECT_EQ(HandleMapRemove(&m_map, keys[0]), &m_values[0]);
+    for (uint32_t i = 0; i < 16; i++) EXPECT_EQ(m_map.keys[i].load(), HANDLE_MAP_EMPTY) << i;
+    EXPECT_EQ(m_map.count, 0u);
+}
+
+TEST_F(HandleMapTest, ChurnNeverFillsWithTombstones)
+{
+    // Handles are never reused by a runtime: a long run of create and
+    // destroy must keep finding free slots
+    for (uint64_t k = 1; k < 10000; k++) {
+        ASSERT_TRUE(HandleMapInsert(&m_map, k * 0x40, &m_values[k & 15])) << k;
+        ASSERT_TRUE(HandleMapInsert(&m_map, k * 0x40 + 1, &m_values[0])) << k;
+        ASSERT_EQ(HandleMapRemove(&m_map, k * 0x40), &m_values[k & 15]);
+        ASSERT_EQ(HandleMapRemove(&m_map, k * 0x40 + 1), &m_values[0]);
+    }
+    EXPECT_EQ(m_map.count, 0u);
+}
+
+TEST(HandleMapConcurrency, ReadersAlwaysSeeStableKeys)
+{
+    // One key stays while a writer churns others around it; readers must
+    // find it every time and never see another key's value
+    static HandleMap<int, 64> map;
+    static int values[2];
+    ASSERT_TRUE(HandleMapInsert(&map, 0x1000, &values[0]));
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> misses{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; t++) {
+        readers.emplace_back([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (HandleMapFind(&map, 0x1000) != &values[0]) misses++;
+                int* other = HandleMapFind(&map, 0x2000);
+                if (other && other != &values[1]) misses++;
+            }
+        });
+    }
+
+    for (uint64_t k = 1; k < 200000; k++) {
+        HandleMapInsert(&map, 0x2000, &values[1]);
+        HandleMapInsert(&map, 0x2000 + k * 0x40, &values[1]);
+        HandleMapRemove(&map, 0x2000);
+        HandleMapRemove(&map, 0x2000 + k * 0x40);
+    }
+    stop = true;
+    for (std::thread& t : readers) t.join();
+    EXPECT_EQ(misses.load(), 0u);
+}
@@ -0,0 +1,538 @@
+// ═══════════════════════════════════════════════════════════════════
+// Unit tests for input_core.h / input_core_math.h
+// ═══════════════════════════════════════════════════════════════════
+
+#include "input_core.h"
+#include "input_core_math.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+namespace {
+
+const int64_t kNs = 1000000000;
+
+// The filter as InputProcessor.cs computed it before the core existed (libm pow)
+double ReferenceStep(double* smoothed, const TreadmillInputConfig& c, double deltaY, double elapsed)
+{
+    double tickScale = fmax(elapsed, 1e-6) / 0.016;
+    double direction = c.invertDirection ? 1.0 : -1.0;
+    double scaled    = deltaY * direction * c.sensitivity / tickScale;
+    double alpha     = 1.0 - pow(1.0 - fmin(fmax(c.smoothing, 0.05), 1.0), tickScale);
+    *smoothed = *smoothed * (1.0 - alpha) + scaled * alpha;
+    if (fabs(*smoothed) < c.deadZone) {
+        *smoothed *= pow(0.8, tickScale);
+        if (fabs(*smoothed) < 0.5) *smoothed = 0;
+    }
+    return fmin(fmax(*smoothed / (100.0 * (c.maxSpeed / 100.0)), -1.0), 1.0);
+}
+
+TreadmillInputConfig Defaults()
+{
+    TreadmillInputConfig c;
+    TreadmillInput_DefaultConfig(&c);
+    return c;
+}
+
+// `seconds` of a `rateHz` mouse walking at ~`countsPerEvent`, timestamps jittered ±10 µs
+std::vector<TreadmillInputEvent> Stream(int rateHz, double seconds, int countsPerEvent, uint32_t seed)
+{
+    std::vector<TreadmillInputEvent> events;
+    uint32_t rng = seed;
+    int64_t period = kNs / rateHz;
+    for (int64_t i = 1; i <= (int64_t)(seconds * rateHz); i++) {
+        rng = rng * 1664525u + 1013904223u;
+        TreadmillInputEvent e;
+        e.timestamp = i * period + (int64_t)(rng >> 20) % 20000 - 10000;
+        e.dx = 0;
+        e.dy = -countsPerEvent + (int32_t)((rng >> 8) % 5) - 2;
+        events.push_back(e);
+    }
+    return events;
+}
+
+// `seconds` of the belt moving forward at `countsPerSecond`, reported
+// by a `rateHz` mouse in whole counts, timestamps jittered ±10 µs
+std::vector<TreadmillInputEvent> Belt(int rateHz, double seconds, double countsPerSecond, uint32_t seed)
+{
+    std::vector<TreadmillInputEvent> events;
+    uint32_t rng   = seed;
+    int64_t period = kNs / rateHz;
+    double  carry  = 0.0;
+    for (int64_t i = 1; i <= (int64_t)(seconds * rateHz); i++) {
+        rng = rng * 1664525u + 1013904223u;
+        carry += countsPerSecond / rateHz;
+        TreadmillInputEvent e;
+        e.timestamp = i * period + (int64_t)(rng >> 20) % 20000 - 10000;
+        e.dx = 0;
+        e.dy = -(int32_t)carry;
+        carry += e.dy;
+        events.push_back(e);
+    }
+    return events;
+}
+
+uint64_t Bits(double d)
+{
+    uint64_t u;
+    memcpy(&u, &d, sizeof(u));
+    return u;
+}
+
+} // namespace
+
+// ─── Math ───────────────────────────────────────────────────────
+
+TEST(InputCoreMath, PowMatchesLibm)
+{
+    const double bases[] = { 0.95, 0.8, 0.75, 0.5, 0.3, 0.05, 1e-3 };
+    for (double b : bases) {
+        for (double e = 6.25e-5; e < 200.0; e *= 1.37) {
+            // exp(e·ln b): the log's rounding is magnified by |e·ln b|
+            double want = pow(b, e);
+            double ulps = 4.0 + fabs(e * log(b));
+            EXPECT_NEAR(InputMathPow(b, e), want, fabs(want) * ulps * 2.3e-16) << b << "^" << e;
+        }
+    }
+}
+
+TEST(InputCoreMath, ExpAndLogMatchLibm)
+{
+    for (double y = -700.0; y < 700.0; y += 3.17)
+        EXPECT_NEAR(InputMathExp(y), exp(y), exp(y) * 4e-16) << y;
+    for (double x = 1e-300; x < 1e300; x *= 7.3)
+        EXPECT_NEAR(InputMathLog(x), log(x), fabs(log(x)) * 4e-16 + 4e-16) << x;
+}
+
+TEST(InputCoreMath, EdgeCases)
+{
+    EXPECT_EQ(InputMathPow(0.0, 2.5), 0.0);
+    EXPECT_EQ(InputMathPow(1.0, 123.0), 1.0);
+    EXPECT_EQ(InputMathExp(0.0), 1.0);
+    EXPECT_EQ(InputMathLog(1.0), 0.0);
+    EXPECT_EQ(InputMathExp(-1000.0), 0.0);
+    EXPECT_EQ(InputMathExp(1000.0), HUGE_VAL);
+}
+
+// ─── Step ───────────────────────────────────────────────────────
+
+TEST(InputCore, StepMatchesReferenceFilter)
+{
+    TreadmillInputConfig c = Defaults();
+    TreadmillInputState st;
+    TreadmillInput_Reset(&st, 0);
+    double ref = 0.0;
+
+    // Walk, hold, stop, at a mix of tick lengths
+    const double ticks[] = { 0.001, 0.002, 0.016, 0.0333 };
+    for (int i = 0; i < 400; i++) {
+        double dt    = ticks[i % 4];
+        double delta = i < 250 ? -3000.0 * dt : 0.0;
+        double want  = ReferenceStep(&ref, c, delta, dt);
+        ASSERT_NEAR(TreadmillInput_Step(&st, &c, delta, dt), want, 1e-12) << i;
+        ASSERT_NEAR(st.smoothed, ref, 1e-9) << i;
+    }
+    EXPECT_EQ(st.velocity, 0.0);
+}
+
+TEST(InputCore, DirectionAndNormalisation)
+{
+    TreadmillInputConfig c = Defaults();
+    TreadmillInputState st;
+
+    // A long step at 300 counts per reference tick saturates either way
+    TreadmillInput_Reset(&st, 0);
+    EXPECT_EQ(TreadmillInput_Step(&st, &c, -300.0 * 100, 1.6), 1.0);
+    c.invertDirection = 1;
+    TreadmillInput_Reset(&st, 0);
+    EXPECT_EQ(TreadmillInput_Step(&st, &c, -300.0 * 100, 1.6), -1.0);
+
+    // Settled at 40 units per tick (×2 sensitivity) = 80 % of max, 100 % at MaxSpeed 80
+    c = Defaults();
+    TreadmillInput_Reset(&st, 0);
+    EXPECT_NEAR(TreadmillInput_Step(&st, &c, -40.0 * 100, 1.6), 0.8, 1e-9);
+    c.maxSpeed = 80.0;
+    TreadmillInput_Reset(&st, 0);
+    EXPECT_NEAR(TreadmillInput_Step(&st, &c, -40.0 * 100, 1.6), 1.0, 1e-9);
+}
+
+TEST(InputCore, DeadZoneDecaysToZero)
+{
+    TreadmillInputConfig c = Defaults();
+    TreadmillInputState st;
+    TreadmillInput_Reset(&st, 0);
+    st.smoothed = 4.0;      // inside the dead zone of 5
+
+    double prev = st.smoothed;
+    for (int i = 0; i < 3 && st.smoothed != 0.0; i++) {
+        TreadmillInput_Step(&st, &c, 0.0, 0.016);
+        EXPECT_LT(fabs(st.smoothed), prev);
+        prev = fabs(st.smoothed);
+    }
+    for (int i = 0; i < 50; i++) TreadmillInput_Step(&st, &c, 0.0, 0.016);
+    EXPECT_EQ(st.smoothed, 0.0);
+    EXPECT_EQ(st.velocity, 0.0);
+}
+
+// ─── Events ─────────────────────────────────────────────────────
+
+TEST(InputCore, EventsSharingATimestampAreOneStep)
+{
+    TreadmillInputConfig c = Defaults();
+    TreadmillInputState a, b;
+    TreadmillInput_Reset(&a, 0);
+    TreadmillInput_Reset(&b, 0);
+
+    TreadmillInputEvent split[] = { { 1000000, 0, -3 }, { 1000000, 0, -4 }, { 2000000, 0, -5 } };
+    TreadmillInputEvent merged[] = { { 1000000, 0, -7 }, { 2000000, 0, -5 } };
+
+    double va = TreadmillInput_ProcessEvents(&a, &c, split, 3, 2000000, kNs);
+    double vb = TreadmillInput_ProcessEvents(&b, &c, merged, 2, 2000000, kNs);
+    EXPECT_EQ(Bits(va), Bits(vb));
+    EXPECT_EQ(Bits(a.smoothed), Bits(b.smoothed));
+}
+
+TEST(InputCore, StaleEventsFoldIntoTheNextStep)
+{
+    TreadmillInputConfig c = Defaults();
+    TreadmillInputState a, b;
+    TreadmillInput_Reset(&a, 5000000);
+    TreadmillInput_Reset(&b, 5000000);
+
+    TreadmillInputEvent stale[] = { { 4000000, 0, -6 }, { 6000000, 0, -2 } };
+    TreadmillInputEvent folded[] = { { 6000000, 0, -8 } };
+    TreadmillInput_ProcessEvents(&a, &c, stale, 2, 6000000, kNs);
+    TreadmillInput_ProcessEvents(&b, &c, folded, 1, 6000000, kNs);
+    EXPECT_EQ(Bits(a.smoothed), Bits(b.smoothed));
+
+    // Nothing newer than the clock: held as pending, not lost
+    TreadmillInputEvent late[] = { { 5500000, 0, -9 } };
+    TreadmillInput_ProcessEvents(&a, &c, late, 1, 6000000, kNs);
+    EXPECT_EQ(a.pendingDeltaY, -9.0);
+    EXPECT_EQ(a.lastTimestamp, 6000000);
+}
+
+TEST(InputCore, BatchingDoesNotChangeTheResult)
+{
+    // However the stream is cut into calls, the steps are the same
+    TreadmillInputConfig c = Defaults();
+    std::vector<TreadmillInputEvent> ev = Stream(8000, 0.5, 4, 0xC0FFEEu);
+    int64_t end = ev.back().timestamp;
+
+    TreadmillInputState whole;
+    TreadmillInput_Reset(&whole, 0);
+    TreadmillInput_ProcessEvents(&whole, &c, ev.data(), (uint32_t)ev.size(), end, kNs);
+
+    TreadmillInputState pieces;
+    TreadmillInput_Reset(&pieces, 0);
+    for (size_t i = 0; i < ev.size(); i += 7) {
+        uint32_t n = (uint32_t)std::min<size_t>(7, ev.size() - i);
+        TreadmillInput_ProcessEvents(&pieces, &c, &ev[i], n, ev[i + n - 1].timestamp, kNs);
+    }
+    EXPECT_EQ(Bits(whole.smoothed), Bits(pieces.smoothed));
+    EXPECT_EQ(Bits(whole.velocity), Bits(pieces.velocity));
+}
+
+TEST(InputCore, EventRateMatchesTickRate)
+{
+    // Same movement filtered per event at 8 kHz and per 2 ms tick settles
+    // to the same speed — the reference-tick scaling makes the rate irrelevant
+    TreadmillInputConfig c = Defaults();
+    std::vector<TreadmillInputEvent> ev = Stream(8000, 2.0, 4, 0xBEEFu);
+
+    TreadmillInputState perEvent;
+    TreadmillInput_Reset(&perEvent, 0);
+    TreadmillInput_ProcessEvents(&perEvent, &c, ev.data(), (uint32_t)ev.size(), 2 * kNs, kNs);
+
+    TreadmillInputState perTick;
+    TreadmillInput_Reset(&perTick, 0);
+    size_t i = 0;
+    for (int64_t now = 2000000; now <= 2 * kNs; now += 2000000) {
+        double sum = 0;
+        for (; i < ev.size() && ev[i].timestamp <= now; i++) sum += ev[i].dy;
+        TreadmillInput_Step(&perTick, &c, sum, 0.002);
+    }
+
+    // 4 counts per 125 µs = 512 per 16 ms tick → saturated; check the unsaturated filter state
+    EXPECT_NEAR(perEvent.smoothed, perTick.smoothed, fabs(perTick.smoothed) * 0.05);
+}
+
+TEST(InputCore, IdleStepDecaysAfterEventsStop)
+{
+    TreadmillInputConfig c = Defaults();
+    std::vector<TreadmillInputEvent> ev = Stream(1000, 0.5, 2, 1u);
+    TreadmillInputState st;
+    TreadmillInput_Reset(&st, 0);
+    double moving = TreadmillInput_ProcessEvents(&st, &c, ev.data(), (uint32_t)ev.size(), kNs / 2, kNs);
+    EXPECT_GT(moving, 0.1);
+
+    double stopped = TreadmillInput_ProcessEvents(&st, &c, NULL, 0, 2 * kNs, kNs);
+    EXPECT_EQ(stopped, 0.0);
+}
+
+// ─── Filters ────────────────────────────────────────────────────
+
+// ProcessEvents once per `callNs` over `ev`, up to `endNs`; the velocity after each call
+std::vector<double> Feed(TreadmillInputState* st, const TreadmillInputConfig& c,
+                         const std::vector<TreadmillInputEvent>& ev, int64_t callNs, int64_t endNs)
+{
+    std::vector<double> out;
+    size_t i = 0;
+    for (int64_t now = callNs; now <= endNs; now += callNs) {
+        uint32_t n = 0;
+        while (i + n < ev.size() && ev[i + n].timestamp <= now) n++;
+        out.push_back(TreadmillInput_ProcessEvents(st, &c, ev.data() + i, n, now, kNs));
+        i += n;
+    }
+    return out;
+}
+
+TEST(InputCore, DefaultFilterIsEma)
+{
+    EXPECT_EQ(Defaults().filter, TREADMILL_INPUT_FILTER_EMA);
+
+    // Unknown filters run EMA too
+    TreadmillInputConfig ema = Defaults(), unknown = Defaults();
+    unknown.filter = TREADMILL_INPUT_FILTER_COUNT;
+    std::vector<TreadmillInputEvent> ev = Stream(1000, 0.5, 2, 7u);
+    TreadmillInputState a, b;
+    TreadmillInput_Reset(&a, 0);
+    TreadmillInput_Reset(&b, 0);
+    Feed(&a, ema, ev, 2000000, kNs / 2);
+    Feed(&b, unknown, ev, 2000000, kNs / 2);
+    EXPECT_EQ(Bits(a.smoothed), Bits(b.smoothed));
+}
+
+TEST(InputCore, AdaptiveFiltersSettleToTheSameSpeedAtAnyMouseRate)
+{
+    // 2 counts per ms = 32 per reference tick, × sensitivity 2 → 0.64,
+    // from a 125 Hz mouse's bursts as from a 1 kHz one
+    for (int32_t filter : { TREADMILL_INPUT_FILTER_ONE_EURO, TREADMILL_INPUT_FILTER_KALMAN }) {
+        TreadmillInputConfig c = Defaults();
+        c.filter = filter;
+        for (int rateHz : { 125, 500, 1000 }) {
+            std::vector<TreadmillInputEvent> ev = Stream(rateHz, 2.0, 2000 / rateHz, 0xA11CEu);
+            TreadmillInputState st;
+            TreadmillInput_Reset(&st, 0);
+            std::vector<double> v = Feed(&st, c, ev, 2000000, 2 * kNs);
+
+            // The last second: on the speed, and no wilder than Stream's ±2 count noise
+            double lo = 1.0, hi = -1.0;
+            for (size_t k = v.size() / 2; k < v.size(); k++) {
+                lo = std::min(lo, v[k]);
+                hi = std::max(hi, v[k]);
+            }
+            EXPECT_NEAR((lo + hi) / 2, 0.64, 0.04) << "filter " << filter << " at " << rateHz << " Hz";
+            EXPECT_LT(hi - lo, 0.3) << "filter " << filter << " at " << rateHz << " Hz";
+
+            // And back to rest once the events stop
+            EXPECT_EQ(TreadmillInput_ProcessEvents(&st, &c, NULL, 0, 3 * kNs, kNs), 0.0)
+                << "filter " << filter << " at " << rateHz << " Hz";
+        }
+    }
+}
+
+TEST(InputCore, AdaptiveFiltersFollowAStartSoonerThanEma)
+{
+    std::vector<TreadmillInputEvent> ev = Stream(1000, 1.0, 2, 0x57A27u);
+    int64_t reached[TREADMILL_INPUT_FILTER_COUNT];
+    for (int32_t filter = 0; filter < TREADMILL_INPUT_FILTER_COUNT; filter++) {
+        TreadmillInputConfig c = Defaults();
+        c.filter = filter;
+        TreadmillInputState st;
+        TreadmillInput_Reset(&st, 0);
+        std::vector<double> v = Feed(&st, c, ev, 2000000, kNs);
+        size_t k = 0;
+        while (k < v.size() && v[k] < 0.64 * 0.9) k++;
+        reached[filter] = (int64_t)k;
+    }
+    EXPECT_LT(reached[TREADMILL_INPUT_FILTER_ONE_EURO], reached[TREADMILL_INPUT_FILTER_EMA]);
+    EXPECT_LT(reached[TREADMILL_INPUT_FILTER_KALMAN], reached[TREADMILL_INPUT_FILTER_EMA]);
+}
+
+TEST(InputCore, FixedStepBatchingDoesNotChangeTheResult)
+{
+    for (int32_t filter : { TREADMILL_INPUT_FILTER_ONE_EURO, TREADMILL_INPUT_FILTER_KALMAN }) {
+        TreadmillInputConfig c = Defaults();
+        c.filter = filter;
+        std::vector<TreadmillInputEvent> ev = Stream(8000, 0.5, 1, 0xC0FFEEu);
+        int64_t end = ev.back().timestamp;
+
+        TreadmillInputState whole;
+        TreadmillInput_Reset(&whole, 0);
+        TreadmillInput_ProcessEvents(&whole, &c, ev.data(), (uint32_t)ev.size(), end, kNs);
+
+        TreadmillInputState pieces;
+        TreadmillInput_Reset(&pieces, 0);
+        for (size_t i = 0; i < ev.size(); i += 7) {
+            uint32_t n = (uint32_t)std::min<size_t>(7, ev.size() - i);
+            TreadmillInput_ProcessEvents(&pieces, &c, &ev[i], n, ev[i + n - 1].timestamp, kNs);
+        }
+        EXPECT_EQ(whole.lastTimestamp, pieces.lastTimestamp);
+        EXPECT_EQ(Bits(whole.smoothed), Bits(pieces.smoothed));
+        EXPECT_EQ(Bits(whole.pendingDeltaY), Bits(pieces.pendingDeltaY));
+    }
+}
+
+// ─── Calibration ────────────────────────────────────────────────
+
+TEST(InputCoreCalibration, CurveInterpolatesAndHolds)
+{
+    TreadmillInputCalibration cal = {};
+    EXPECT_EQ(TreadmillInput_MapSpeed(&cal, 1.0), 0.0);
+
+    // No points: a straight line to full output at the top speed
+    TreadmillInput_BakeCurve(&cal, 2.0, NULL, 0);
+    EXPECT_EQ(TreadmillInput_MapSpeed(&cal, 0.0), 0.0);
+    EXPECT_NEAR(TreadmillInput_MapSpeed(&cal, 0.5), 0.25, 1e-6);
+    EXPECT_NEAR(TreadmillInput_MapSpeed(&cal, -1.5), -0.75, 1e-6);
+    EXPECT_EQ(TreadmillInput_MapSpeed(&cal, 2.0), 1.0);
+    EXPECT_EQ(TreadmillInput_MapSpeed(&cal, 9.0), 1.0);
+
+    // Slow first, then steep; the table follows the points between its entries
+    const double points[] = { 0.0, 0.2, 1.0 };
+    TreadmillInput_BakeCurve(&cal, 2.0, points, 3);
+    EXPECT_NEAR(TreadmillInput_MapSpeed(&cal, 0.5), 0.1, 1e-6);
+    EXPECT_NEAR(TreadmillInput_MapSpeed(&cal, 1.0), 0.2, 0.01);
+    EXPECT_NEAR(TreadmillInput_MapSpeed(&cal, 1.5), 0.6, 1e-6);
+    EXPECT_EQ(TreadmillInput_MapSpeed(&cal, -3.0), -1.0);
+
+    // Outputs are clamped to 0 … 1
+    const double wild[] = { -0.5, 2.0 };
+    TreadmillInput_BakeCurve(&cal, 1.0, wild, 2);
+    EXPECT_EQ(cal.curve[0], 0.0f);
+    EXPECT_EQ(cal.curve[TREADMILL_INPUT_CURVE_SIZE - 1], 1.0f);
+}
+
+TEST(InputCoreCalibration, CountsPerMeterDoNotDependOnMouseRate)
+{
+    // 2000 counts per meter at 1.25 m/s = 2500 counts per second
+    for (int rateHz : { 125, 500, 1000, 8000 }) {
+        std::vector<TreadmillInputEvent> ev = Belt(rateHz, 4.0, 2500.0, 0xCA1Bu);
+        TreadmillCalibrationRun run;
+        TreadmillInput_CalibrationBegin(&run);
+        for (size_t i = 0; i < ev.size(); i += 5)
+            TreadmillInput_CalibrationAdd(&run, &ev[i], (uint32_t)std::min<size_t>(5, ev.size() - i));
+
+        EXPECT_NEAR(TreadmillInput_CalibrationSeconds(&run, kNs), 4.0, 0.01) << rateHz << " Hz";
+        EXPECT_NEAR(TreadmillInput_CalibrationResult(&run, 1.25, kNs), 2000.0, 2000.0 * 0.002) << rateHz << " Hz";
+    }
+
+    TreadmillCalibrationRun empty;
+    TreadmillInput_CalibrationBegin(&empty);
+    EXPECT_EQ(TreadmillInput_CalibrationResult(&empty, 1.25, kNs), 0.0);
+}
+
+TEST(InputCoreCalibration, SpeedDoesNotDependOnTickOrMouseRate)
+{
+    // A 1 m/s belt under a 2000 counts-per-meter sensor reads 1 m/s, half
+    // the straight line to 2 m/s, whatever the step rate, the mouse's
+    // report rate or the filter. Averaged over the last second: a slow
+    // mouse's reports ripple the EMA
+    TreadmillInputConfig c = Defaults();
+    c.calibration.countsPerMeter = 2000.0;
+    TreadmillInput_BakeCurve(&c.calibration, 2.0, NULL, 0);
+
+    for (int tickHz : { 30, 60, 250, 1000 }) {
+        std::vector<TreadmillInputEvent> ev = Belt(1000, 2.0, 2000.0, 0x71C4u);
+        TreadmillInputState st;
+        TreadmillInput_Reset(&st, 0);
+        int64_t period = kNs / tickHz;
+        size_t  i      = 0;
+        double  speed = 0.0, velocity = 0.0;
+        int     n     = 0;
+        for (int64_t now = period; now <= 2 * kNs; now += period) {
+            double sum = 0;
+            for (; i < ev.size() && ev[i].timestamp <= now; i++) sum += ev[i].dy;
+            TreadmillInput_Step(&st, &c, sum, (double)period / kNs);
+            if (now > kNs) {
+                speed    += st.speed;
+                velocity += st.velocity;
+                n++;
+            }
+        }
+        EXPECT_NEAR(speed / n, 1.0, 0.01) << "Step at " << tickHz << " Hz";
+        EXPECT_NEAR(velocity / n, 0.5, 0.005) << "Step at " << tickHz << " Hz";
+    }
+
+    for (int32_t filter = 0; filter < TREADMILL_INPUT_FILTER_COUNT; filter++) {
+        c.filter = filter;
+        for (int rateHz : { 125, 1000, 8000 }) {
+            std::vector<TreadmillInputEvent> ev = Belt(rateHz, 2.0, 2000.0, 0x71C4u);
+            TreadmillInputState st;
+            TreadmillInput_Reset(&st, 0);
+            std::vector<double> v = Feed(&st, c, ev, 2000000, 2 * kNs);
+            double velocity = 0.0;
+            for (size_t k = v.size() / 2; k < v.size(); k++) velocity += v[k];
+            velocity /= (double)(v.size() - v.size() / 2);
+            EXPECT_NEAR(velocity, 0.5, 0.005) << "filter " << filter << " at " << rateHz << " Hz";
+        }
+    }
+}
+
+TEST(InputCoreCalibration, SensitivityDoesNotChangeTheSpeed)
+{
+    TreadmillInputConfig c = Defaults();
+    c.calibration.countsPerMeter = 2000.0;
+    TreadmillInput_BakeCurve(&c.calibration, 2.0, NULL, 0);
+    for (double sensitivity : { 0.5, 1.0, 4.0 }) {
+        c.sensitivity = sensitivity;
+        TreadmillInputState st;
+        TreadmillInput_Reset(&st, 0);
+        TreadmillInput_Step(&st, &c, -2000.0 * 1.6, 1.6);
+        EXPECT_NEAR(st.speed, 1.0, 1e-9) << sensitivity;
+        EXPECT_NEAR(st.velocity, 0.5, 1e-6) << sensitivity;
+    }
+}
+
+TEST(InputCoreCalibration, UncalibratedUsesMaxSpeed)
+{
+    // A curve without counts per meter is ignored
+    TreadmillInputConfig c = Defaults();
+    TreadmillInput_BakeCurve(&c.calibration, 2.0, NULL, 0);
+    TreadmillInputState st;
+    TreadmillInput_Reset(&st, 0);
+    EXPECT_NEAR(TreadmillInput_Step(&st, &c, -40.0 * 100, 1.6), 0.8, 1e-9);
+    EXPECT_EQ(st.speed, 0.0);
+}
+
+// ─── Bit-exactness ──────────────────────────────────────────────
+
+TEST(InputCore, GoldenStreamIsBitExact)
+{
+    // FNV-1a over every output bit pattern of a fixed 2 s, 8 kHz walk/stop
+    // stream. The core uses no libm transcendentals and no FMA contraction,
+    // so this hash is the same on every platform and compiler; a change
+    // here means the filter's output changed.
+    TreadmillInputConfig c = Defaults();
+    c.sensitivity = 0.37;
+    std::vector<TreadmillInputEvent> ev = Stream(8000, 1.5, 3, 0x5EEDu);
+
+    TreadmillInputState st;
+    TreadmillInput_Reset(&st, 0);
+    uint64_t hash = 1469598103934665603ull;
+    size_t i = 0;
+    for (int64_t now = 1000000; now <= 2 * kNs; now += 1000000) {
+        uint32_t n = 0;
+        while (i + n < ev.size() && ev[i + n].timestamp <= now) n++;
+        double v = TreadmillInput_ProcessEvents(&st, &c, ev.data() + i, n, now, kNs);
+        i += n;
+        hash = (hash ^ Bits(v)) * 1099511628211ull;
+        hash = (hash ^ Bits(st.smoothed)) * 1099511628211ull;
+    }
+    EXPECT_EQ(hash, 0x9DA7DD5A61EA8A33ull);
+}
+
+TEST(InputCore, AbiVersion)
+{
+    EXPECT_EQ(TreadmillInput_AbiVersion(), TREADMILL_INPUT_ABI_VERSION);
+    EXPECT_EQ(sizeof(TreadmillInputCalibration), 272u);
+    EXPECT_EQ(sizeof(TreadmillInputConfig), 320u);
+    EXPECT_EQ(sizeof(TreadmillInputState), 88u);
+    EXPECT_EQ(sizeof(TreadmillInputEvent), 16u);
+    EXPECT_EQ(sizeof(TreadmillCalibrationRun), 32u);
+}
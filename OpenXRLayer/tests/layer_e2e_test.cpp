@@ -0,0 +1,952 @@
+// ═══════════════════════════════════════════════════════════════════
+// End-to-end: the built treadmill_layer under the mock runtime
+// ═══════════════════════════════════════════════════════════════════
+// Loads the real layer library through the mini loader, so these cover
+// negotiation, chaining and the injection rules exactly as a game sees
+// them. Each test creates and destroys its own instance and session;
+// the shared memory and its watcher are process-wide.
+
+#include "mock_runtime.h"
+#include "layer_platform.h"
+#include "treadmill_shared.h"
+#include "input_core.h"
+#include "layer_telemetry.h"
+#include "velocity_trace.h"
+#include "velocity_predictor.h"
+#include "profile_compiler.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdlib.h>
+#include <thread>
+
+#ifndef TREADMILL_TELEMETRY
+#define TREADMILL_TELEMETRY 1       // 0 when the layer is built lean
+#endif
+
+namespace {
+
+const char* const kLayerName = "XR_APILAYER_TREADMILL_driver";
+
+enum : uint32_t { LEFT_STICK, RIGHT_STICK, LEFT_STICK_Y, LEFT_TRIGGER, RIGHT_STICK_X, ACTION_COUNT };
+
+const char* const kBindings[ACTION_COUNT] = {
+    "/user/hand/left/input/thumbstick",
+    "/user/hand/right/input/thumbstick",
+    "/user/hand/left/input/thumbstick/y",
+    "/user/hand/left/input/trigger/value",
+    "/user/hand/right/input/thumbstick/x",
+};
+
+class LayerE2E : public ::testing::Test {
+protected:
+    static void SetUpTestSuite()
+    {
+        PlatformSharedMemoryUnlink(TREADMILL_TELEMETRY_MEM_NAME);   // the layer creates it on first use
+        std::string error;
+        ASSERT_TRUE(MiniLoaderLoadLayer(TREADMILL_LAYER_PATH, kLayerName, &s_layers[0], &error)) << error;
+    }
+
+    static void TearDownTestSuite()
+    {
+        MiniLoaderUnloadLayer(&s_layers[0]);
+        PlatformSharedMemoryUnlink(TREADMILL_TELEMETRY_MEM_NAME);
+    }
+
+    void SetUp() override
+    {
+        StartProducer();
+
+        MockRuntime::Reset();
+        CreateInstance();
+
+        for (uint32_t i = 0; i < ACTION_COUNT; i++) MockRuntime::SetActionValue(MockRuntime::MakeAction(i), 0.0f, 0.25f);
+    }
+
+    void CreateInstance(const char* application = "treadmill_layer_harness", const char* engine = "")
+    {
+        if (m_instance) m_xr.DestroyInstance(m_instance);
+        PFN_xrGetInstanceProcAddr gipa = NULL;
+        ASSERT_EQ(MiniLoaderCreateInstance(s_layers, &m_instance, &gipa, application, engine), XR_SUCCESS);
+        ASSERT_TRUE(MiniLoaderResolveDispatch(gipa, m_instance, &m_xr));
+        ASSERT_EQ(MiniLoaderCreateSession(m_xr, m_instance, &m_session), XR_SUCCESS);
+    }
+
+    // Another application instance on the same layer, with its own
+    // session: an overlay, or an engine that recreated its instance
+    struct OtherApp {
+        XrInstance                  instance = XR_NULL_HANDLE;
+        XrSession                   session  = XR_NULL_HANDLE;
+        AppDispatch                 xr       = {};
+        PFN_xrGetInstanceProcAddr   gipa     = NULL;
+    };
+
+    void CreateOther(OtherApp* app)
+    {
+        ASSERT_EQ(MiniLoaderCreateInstance(s_layers, &app->instance, &app->gipa, "treadmill_e2e_overlay"), XR_SUCCESS);
+        ASSERT_TRUE(MiniLoaderResolveDispatch(app->gipa, app->instance, &app->xr));
+        ASSERT_EQ(MiniLoaderCreateSession(app->xr, app->instance, &app->session), XR_SUCCESS);
+    }
+
+    static void SuggestOn(const OtherApp& app, uint32_t action, const char* path)
+    {
+        XrActionSuggestedBinding b = { MockRuntime::MakeAction(action), XR_NULL_PATH };
+        ASSERT_EQ(app.xr.StringToPath(app.instance, path, &b.binding), XR_SUCCESS);
+        XrInteractionProfileSuggestedBinding s = {};
+        s.type                   = XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING;
+        s.countSuggestedBindings = 1;
+        s.suggestedBindings      = &b;
+        ASSERT_EQ(app.xr.SuggestInteractionProfileBindings(app.instance, &s), XR_SUCCESS);
+    }
+
+    static void SyncOn(const OtherApp& app)
+    {
+        XrActionsSyncInfo sync = {};
+        sync.type = XR_TYPE_ACTIONS_SYNC_INFO;
+        ASSERT_EQ(app.xr.SyncActions(app.session, &sync), XR_SUCCESS);
+    }
+
+    static float StickYOn(const OtherApp& app, uint32_t action)
+    {
+        XrActionStateGetInfo info = { XR_TYPE_ACTION_STATE_GET_INFO, NULL, MockRuntime::MakeAction(action), XR_NULL_PATH };
+        XrActionStateVector2f state = {};
+        state.type = XR_TYPE_ACTION_STATE_VECTOR2F;
+        EXPECT_EQ(app.xr.GetActionStateVector2f(app.session, &info, &state), XR_SUCCESS);
+        return state.currentState.y;
+    }
+
+    void TearDown() override
+    {
+        if (m_instance) m_xr.DestroyInstance(m_instance);
+        if (!m_profilePath.empty()) {
+            unsetenv(PROFILE_DB_ENV);
+            remove(m_profilePath.c_str());
+        }
+        PlatformSharedMemoryClose(&m_shm);
+        PlatformSharedMemoryUnlink(TREADMILL_SHARED_MEM_NAME);
+    }
+
+    // Stands in for a companion that exits and later starts again; the
+    // layer may still hold the old object
+    void RemoveProducer()
+    {
+        Publish(0.0f, 0);
+        PlatformSharedMemoryClose(&m_shm);
+        PlatformSharedMemoryUnlink(TREADMILL_SHARED_MEM_NAME);
+        m_data = nullptr;
+    }
+
+    void StartProducer()
+    {
+        ASSERT_TRUE(PlatformSharedMemoryCreate(&m_shm, TREADMILL_SHARED_MEM_NAME, sizeof(TreadmillSharedData)));
+        m_data = (TreadmillSharedData*)m_shm.view;
+        TreadmillSharedInit(m_data, PlatformTimestampFrequency());
+    }
+
+    // Publishes and syncs, as a 1 kHz game loop would, until the layer
+    // injects `velocity`; returns the milliseconds it took, or -1.
+    int WaitForPickup(float velocity, int timeoutMs)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (;;) {
+            int elapsed = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            if (elapsed > timeoutMs) return -1;
+
+            Publish(velocity);
+            Sync();
+            if (GetVector2f(LEFT_STICK).currentState.y == 0.25f + velocity) return elapsed;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    void Publish(float velocity, uint32_t active = 1)
+    {
+        TreadmillSharedWrite(m_data, velocity, active, PlatformTimestamp());
+    }
+
+    void PublishMotion(float forward, float strafe, float turn)
+    {
+        TreadmillSharedWriteMotion(m_data, forward, strafe, turn, 1, PlatformTimestamp());
+    }
+
+    XrPath Path(const char* path)
+    {
+        XrPath p = XR_NULL_PATH;
+        EXPECT_EQ(m_xr.StringToPath(m_instance, path, &p), XR_SUCCESS);
+        return p;
+    }
+
+    // Compiles `json` to a temporary database and points the layer at it;
+    // an instance reads it on its first input call
+    void InstallProfiles(const char* json)
+    {
+        std::vector<uint8_t> db;
+        std::string error;
+        ASSERT_TRUE(profile_compiler::CompileProfiles(json, &db, &error)) << error;
+        m_profilePath = ::testing::TempDir() + "treadmill_e2e_profiles.bin";
+        std::ofstream(m_profilePath, std::ios::binary).write((const char*)db.data(), (std::streamsize)db.size());
+        setenv(PROFILE_DB_ENV, m_profilePath.c_str(), 1);
+    }
+
+    void SuggestPaths(const char* const* paths, uint32_t count)
+    {
+        std::vector<XrActionSuggestedBinding> b(count);
+        for (uint32_t i = 0; i < count; i++) {
+            b[i].action  = MockRuntime::MakeAction(i);
+            b[i].binding = Path(paths[i]);
+        }
+        XrInteractionProfileSuggestedBinding s = {};
+        s.type                   = XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING;
+        s.countSuggestedBindings = count;
+        s.suggestedBindings      = b.data();
+        ASSERT_EQ(m_xr.SuggestInteractionProfileBindings(m_instance, &s), XR_SUCCESS);
+    }
+
+    void PublishAt(float velocity, int64_t timestamp)
+    {
+        TreadmillSharedWrite(m_data, velocity, 1, timestamp);
+    }
+
+    // Raw delta mode with the app's default filter settings, optionally inverted
+    void EnableRawDeltas(uint32_t invert = 0)
+    {
+        TreadmillFilterConfig config = { 2.0, 5.0, 0.25, 100.0, invert, TREADMILL_INPUT_FILTER_EMA, 0.5 };
+        TreadmillConfigWrite(m_data, &config);
+        m_data->streamMode.store(TREADMILL_STREAM_RAW_DELTAS);
+    }
+
+    // `count` deltas of `dy` at 1 kHz, starting now
+    void StreamDeltas(int count, int32_t dy)
+    {
+        int64_t now = PlatformTimestamp();
+        int64_t ms  = PlatformTimestampFrequency() / 1000;
+        for (int i = 0; i < count; i++) {
+            TreadmillDelta delta = { now + i * ms, 0, dy };
+            TreadmillDeltaWrite(m_data, &delta, 1);
+        }
+    }
+
+    void WaitFrame()
+    {
+        XrFrameWaitInfo info = { XR_TYPE_FRAME_WAIT_INFO, NULL };
+        XrFrameState state = {};
+        state.type = XR_TYPE_FRAME_STATE;
+        ASSERT_EQ(m_xr.WaitFrame(m_session, &info, &state), XR_SUCCESS);
+    }
+
+    // Feeds three samples 10 ms apart through xrSyncActions, ending now
+    void PublishRamp(float v0, float v1, float v2)
+    {
+        int64_t now = PlatformTimestamp();
+        int64_t ms  = PlatformTimestampFrequency() / 1000;
+        PublishAt(v0, now - 20 * ms);
+        Sync();
+        PublishAt(v1, now - 10 * ms);
+        Sync();
+        PublishAt(v2, now);
+    }
+
+    void SuggestAll()
+    {
+        XrActionSuggestedBinding b[ACTION_COUNT];
+        for (uint32_t i = 0; i < ACTION_COUNT; i++) {
+            b[i].action = MockRuntime::MakeAction(i);
+            ASSERT_EQ(m_xr.StringToPath(m_instance, kBindings[i], &b[i].binding), XR_SUCCESS);
+        }
+        XrInteractionProfileSuggestedBinding s = {};
+        s.type                   = XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING;
+        s.countSuggestedBindings = ACTION_COUNT;
+        s.suggestedBindings      = b;
+        ASSERT_EQ(m_xr.SuggestInteractionProfileBindings(m_instance, &s), XR_SUCCESS);
+    }
+
+    void Sync()
+    {
+        XrActionsSyncInfo sync = {};
+        sync.type = XR_TYPE_ACTIONS_SYNC_INFO;
+        ASSERT_EQ(m_xr.SyncActions(m_session, &sync), XR_SUCCESS);
+    }
+
+    XrActionStateVector2f GetVector2f(uint32_t action, XrPath subaction = XR_NULL_PATH)
+    {
+        XrActionStateGetInfo info = { XR_TYPE_ACTION_STATE_GET_INFO, NULL, MockRuntime::MakeAction(action), subaction };
+        XrActionStateVector2f state = {};
+        state.type = XR_TYPE_ACTION_STATE_VECTOR2F;
+        EXPECT_EQ(m_xr.GetActionStateVector2f(m_session, &info, &state), XR_SUCCESS);
+        return state;
+    }
+
+    float GetFloat(uint32_t action)
+    {
+        XrActionStateGetInfo info = { XR_TYPE_ACTION_STATE_GET_INFO, NULL, MockRuntime::MakeAction(action), XR_NULL_PATH };
+        XrActionStateFloat state = {};
+        state.type = XR_TYPE_ACTION_STATE_FLOAT;
+        EXPECT_EQ(m_xr.GetActionStateFloat(m_session, &info, &state), XR_SUCCESS);
+        return state.currentState;
+    }
+
+    static std::vector<LoadedLayer> s_layers;
+
+    PlatformSharedMemory    m_shm = {};
+    TreadmillSharedData*    m_data = nullptr;
+    XrInstance              m_instance = XR_NULL_HANDLE;
+    XrSession               m_session = XR_NULL_HANDLE;
+    AppDispatch             m_xr = {};
+    std::string             m_profilePath;
+};
+
+const char* const kProfiles = R"({
+  "profiles": [
+    {
+      "application": "E2E Trackpad Title",
+      "scale": { "forward": 0.5 },
+      "builtinBindings": false,
+      "bindings": [
+        { "path": "/user/hand/left/input/trackpad", "x": "strafe", "y": "forward", "combine": "max" }
+      ]
+    },
+    { "engine": "E2E Engine", "scale": { "forward": 2.0 } }
+  ]
+})";
+
+// Action 0 on the trackpad, action 1 on the left stick
+const char* const kProfilePaths[] = {
+    "/user/hand/left/input/trackpad",
+    "/user/hand/left/input/thumbstick",
+};
+
+std::vector<LoadedLayer> LayerE2E::s_layers(1);
+
+} // namespace
+
+TEST_F(LayerE2E, NothingInjectedBeforeFirstSync)
+{
+    SuggestAll();
+    Publish(0.5f);
+    EXPECT_FLOAT_EQ(GetVector2f(LEFT_STICK).currentState.y, 0.25f);
+}
+
+TEST_F(LayerE2E, InjectsIntoTrackedActionsOnly)
+{
+    SuggestAll();
+    Publish(0.5f);
+    Sync();
+
+    EXPECT_FLOAT_EQ(GetVector2f(LEFT_STICK).currentState.y, 0.75f);
+    EXPECT_FLOAT_EQ(GetFloat(LEFT_STICK_Y), 0.75f);
+    EXPECT_FLOAT_EQ(GetVector2f(RIGHT_STICK).currentState.y, 0.25f);
+    EXPECT_FLOAT_EQ(GetFloat(LEFT_TRIGGER), 0.25f);
+    EXPECT_EQ(MockRuntime::GetStats().syncCount, 1u);
+}
+
+TEST_F(LayerE2E, ClampsToUnitRange)
+{
+    SuggestAll();
+    Publish(0.9f);
+    Sync();
+    XrActionStateVector2f s = GetVector2f(LEFT_STICK);
+    EXPECT_FLOAT_EQ(s.currentState.y, 1.0f);
+    EXPECT_EQ(s.isActive, (XrBool32)XR_TRUE);
+}
+
+TEST_F(LayerE2E, RightHandSubactionIsLeftAlone)
+{
+    SuggestAll();
+    Publish(0.5f);
+    Sync();
+
+    XrPath right = XR_NULL_PATH;
+    ASSERT_EQ(m_xr.StringToPath(m_instance, "/user/hand/right", &right), XR_SUCCESS);
+    EXPECT_FLOAT_EQ(GetVector2f(LEFT_STICK, right).currentState.y, 0.25f);
+}
+
+TEST_F(LayerE2E, InjectsStrafeAndTurn)
+{
+    SuggestAll();
+    PublishMotion(0.5f, -0.25f, 0.5f);
+    Sync();
+
+    XrActionStateVector2f left = GetVector2f(LEFT_STICK);
+    EXPECT_FLOAT_EQ(left.currentState.x, -0.25f);
+    EXPECT_FLOAT_EQ(left.currentState.y, 0.75f);
+
+    XrActionStateVector2f right = GetVector2f(RIGHT_STICK);
+    EXPECT_FLOAT_EQ(right.currentState.x, 0.5f);
+    EXPECT_FLOAT_EQ(right.currentState.y, 0.25f);
+    EXPECT_EQ(right.isActive, (XrBool32)XR_TRUE);
+    EXPECT_FLOAT_EQ(GetFloat(RIGHT_STICK_X), 0.75f);
+
+    // Each stick answers to its own hand only
+    EXPECT_FLOAT_EQ(GetVector2f(RIGHT_STICK, Path("/user/hand/right")).currentState.x, 0.5f);
+    EXPECT_FLOAT_EQ(GetVector2f(RIGHT_STICK, Path("/user/hand/left")).currentState.x, 0.0f);
+}
+
+TEST_F(LayerE2E, TurnAloneActivatesOnlyTheRightStick)
+{
+    SuggestAll();
+    PublishMotion(0.0f, 0.0f, -0.5f);
+    Sync();
+
+    XrActionStateVector2f left = GetVector2f(LEFT_STICK);
+    EXPECT_FLOAT_EQ(left.currentState.x, 0.0f);
+    EXPECT_FLOAT_EQ(left.currentState.y, 0.25f);
+    EXPECT_FLOAT_EQ(GetVector2f(RIGHT_STICK).currentState.x, -0.5f);
+}
+
+TEST_F(LayerE2E, ResuggestingResolvesEachPathOnce)
+{
+    // The thumbstick paths are resolved up front; only the trigger needs a string
+    SuggestAll();
+    EXPECT_EQ(MockRuntime::GetStats().pathToStringCount, 1u);
+
+    // Engines re-suggest for every interaction profile
+    for (int i = 0; i < 10; i++) SuggestAll();
+    EXPECT_EQ(MockRuntime::GetStats().pathToStringCount, 1u);
+
+    Publish(0.5f);
+    Sync();
+    EXPECT_FLOAT_EQ(GetVector2f(LEFT_STICK).currentState.y, 0.75f);
+    EXPECT_FLOAT_EQ(GetFloat(LEFT_TRIGGER), 0.25f);
+
+    // A new instance starts with an empty cache
+    CreateInstance();
+    SuggestAll();
+    EXPECT_EQ(MockRuntime::GetStats().pathToStringCount, 2u);
+}
+
+TEST_F(LayerE2E, FallbackInjectsAnyVector2fWithoutBindings)
+{
+    Publish(0.5f);
+    Sync();
+    EXPECT_FLOAT_EQ(GetVector2f(RIGHT_STICK).currentState.y, 0.75f);
+    EXPECT_FLOAT_EQ(GetFloat(LEFT_STICK_Y), 0.25f);
+}
+
+TEST_F(LayerE2E, VelocityIsLatchedPerSync)
+{
+    SuggestAll();
+    Publish(0.5f);
+    Sync();
+    Publish(-0.5f);
+    EXPECT_FLOAT_EQ(GetVector2f(LEFT_STICK).currentState.y, 0.75f);
+    Sync();
+    EXPECT_FLOAT_EQ(GetVector2f(LEFT_STICK).currentState.y, -0.25f);
+}
+
+TEST_F(LayerE2E, InactiveProducerInjectsNothing)
+{
+    SuggestAll();
+    Publish(0.5f, 0);
+    Sync();
+    EXPECT_FLOAT_EQ(GetVector2f(LEFT_STICK).currentState.y, 0.25f);
+}
+
+TEST_F(LayerE2E, PredictsToDisplayTime)
+{
+    SuggestAll();
+    PublishRamp(0.1f, 0.2f, 0.3f);
+    MockRuntime::SetDisplayLead(10 * 1000000);
+    WaitFrame();
+    Sync();
+
+    // 0.1 per 10 ms, extrapolated 10 ms (plus however long the test took)
+    float y = GetVector2f(LEFT_STICK).currentState.y;
+    EXPECT_GT(y, 0.25f + 0.38f);
+    EXPECT_LT(y, 0.25f + 0.50f);
+}
+
+TEST_F(LayerE2E, NoPredictionWithoutFrameLoop)
+{
+    SuggestAll();
+    PublishRamp(0.1f, 0.2f, 0.3f);
+    Sync();
+    EXPECT_FLOAT_EQ(GetVector2f(LEFT_STICK).currentState.y, 0.55f);
+}
+
+TEST_F(LayerE2E, NoPredictionWithoutTimeConversion)
+{
+    MockRuntime::SetTimeConversionSupported(false);
+    CreateInstance();   // the layer's extension request fails, retried without it
+
+    SuggestAll();
+    PublishRamp(0.1f, 0.2f, 0.3f);
+    MockRuntime::SetDisplayLead(10 * 1000000);
+    WaitFrame();
+    Sync();
+    EXPECT_FLOAT_EQ(GetVector2f(LEFT_STICK).currentState.y, 0.55f);
+}
+
+TEST_F(LayerE2E, PredictionStopsAtZero)
+{
+    SuggestAll();
+    PublishRamp(0.25f, 0.15f, 0.05f);
+    MockRuntime::SetDisplayLead(30 * 1000000);
+    WaitFrame();
+    Sync();
+    EXPECT_FLOAT_EQ(GetVector2f(LEFT_STICK).currentState.y, 0.25f);
+}
+
+TEST_F(LayerE2E, RawDeltasAreFilteredPerSync)
+{
+    SuggestAll();
+    EnableRawDeltas();
+    Publish(0.0f);
+    Sync();                     // starts reading at the current head
+    EXPECT_FLOAT_EQ(GetVector2f(LEFT_STICK).currentState.y, 0.25f);
+
+    StreamDeltas(50, -40);
+    Publish(0.0f);
+    Sync();
+
+    // Forward motion even though the app's own velocity is 0
+    float y = GetVector2f(LEFT_STICK).currentState.y;
+    EXPECT_GT(y, 0.25f + 0.2f);
+    EXPECT_LE(y, 1.0f);
+}
+
+TEST_F(LayerE2E, RawDeltasUseThePublishedConfig)
+{
+    SuggestAll();
+    EnableRawDeltas(1);
+    Publish(0.0f);
+    Sync();
+
+    StreamDeltas(50, -40);
+    Publish(0.0f);
+    Sync();
+    EXPECT_LT(GetVector2f(LEFT_STICK).currentState.y, 0.25f - 0.2f);
+}
+
+TEST_F(LayerE2E, DeltasIgnoredInVelocityMode)
+{
+    SuggestAll();
+    Publish(0.5f);
+    Sync();
+    StreamDeltas(50, -40);
+    Publish(0.0f);
+    Sync();
+    EXPECT_FLOAT_EQ(GetVector2f(LEFT_STICK).currentState.y, 0.25f);
+}
+
+TEST_F(LayerE2E, InactiveProducerStopsRawDeltas)
+{
+    SuggestAll();
+    EnableRawDeltas();
+    Publish(0.0f);
+    Sync();
+    StreamDeltas(50, -40);
+    Publish(0.0f, 0);
+    Sync();
+    EXPECT_FLOAT_EQ(GetVector2f(LEFT_STICK).currentState.y, 0.25f);
+}
+
+TEST_F(LayerE2E, PicksUpCompanionStartedAfterInstance)
+{
+    m_xr.DestroyInstance(m_instance);
+    m_instance = XR_NULL_HANDLE;
+    RemoveProducer();
+    CreateInstance();
+    SuggestAll();
+    Sync();
+    EXPECT_FLOAT_EQ(GetVector2f(LEFT_STICK).currentState.y, 0.25f);
+
+    StartProducer();
+    int ms = WaitForPickup(0.5f, 1000);
+    EXPECT_GE(ms, 0);
+    EXPECT_LT(ms, 100);
+}
+
+TEST_F(LayerE2E, FollowsCompanionThatRecreatesTheBlock)
+{
+    SuggestAll();
+    ASSERT_GE(WaitForPickup(0.5f, 1000), 0);
+
+    // The layer's view now maps an orphaned object
+    RemoveProducer();
+    Sync();
+    EXPECT_FLOAT_EQ(GetVector2f(LEFT_STICK).currentState.y, 0.25f);
+
+    StartProducer();
+    int ms = WaitForPickup(0.3f, 1000);
+    EXPECT_GE(ms, 0);
+    EXPECT_LT(ms, 100);
+}
+
+TEST_F(LayerE2E, CompanionRestartInPlaceStartsOver)
+{
+    SuggestAll();
+    EnableRawDeltas();
+    Publish(0.0f);
+    Sync();
+    StreamDeltas(50, -40);
+    Publish(0.0f);
+    Sync();
+    EXPECT_GT(GetVector2f(LEFT_STICK).currentState.y, 0.25f + 0.2f);
+
+    // Same object, new writer: the old writer's motion must not carry over
+    TreadmillSharedInit(m_data, PlatformTimestampFrequency());
+    EnableRawDeltas();
+    Publish(0.0f);
+    Sync();
+    EXPECT_FLOAT_EQ(GetVector2f(LEFT_STICK).currentState.y, 0.25f);
+}
+
+TEST_F(LayerE2E, ProfileRedirectsBindingsForItsApplication)
+{
+    InstallProfiles(kProfiles);
+    CreateInstance("e2e trackpad title");          // names match case-insensitively
+    SuggestPaths(kProfilePaths, 2);
+    EXPECT_EQ(MockRuntime::GetStats().pathToStringCount, 0u);   // profile paths are resolved up front too
+    Publish(0.8f);
+    Sync();
+
+    // Scaled to 0.4, and "max" keeps the stronger of that and the runtime's 0.25
+    EXPECT_FLOAT_EQ(GetVector2f(0).currentState.y, 0.4f);
+    // builtinBindings is off, so the thumbstick is not injected
+    EXPECT_FLOAT_EQ(GetVector2f(1).currentState.y, 0.25f);
+
+    PublishMotion(0.2f, 0.0f, 0.0f);
+    Sync();
+    EXPECT_FLOAT_EQ(GetVector2f(0).currentState.y, 0.25f);
+}
+
+TEST_F(LayerE2E, EngineProfileKeepsBuiltinBindings)
+{
+    InstallProfiles(kProfiles);
+    CreateInstance("Some Other Title", "E2E Engine");
+    SuggestPaths(kProfilePaths, 2);
+    Publish(0.25f);
+    Sync();
+
+    EXPECT_FLOAT_EQ(GetVector2f(0).currentState.y, 0.25f);    // trackpad is not a built-in target
+    EXPECT_FLOAT_EQ(GetVector2f(1).currentState.y, 0.75f);    // 0.25 + 2.0 * 0.25
+}
+
+TEST_F(LayerE2E, UnmatchedApplicationUsesBuiltinBindings)
+{
+    InstallProfiles(kProfiles);
+    CreateInstance();
+    SuggestPaths(kProfilePaths, 2);
+    Publish(0.5f);
+    Sync();
+
+    EXPECT_FLOAT_EQ(GetVector2f(0).currentState.y, 0.25f);
+    EXPECT_FLOAT_EQ(GetVector2f(1).currentState.y, 0.75f);
+}
+
+TEST_F(LayerE2E, ProfileIsReadOnFirstUse)
+{
+    // Creation no longer touches the file system, so a database that
+    // appears between creation and the first suggest still applies
+    CreateInstance("E2E Trackpad Title");
+    InstallProfiles(kProfiles);
+    SuggestPaths(kProfilePaths, 2);
+    Publish(0.8f);
+    Sync();
+
+    EXPECT_FLOAT_EQ(GetVector2f(0).currentState.y, 0.4f);
+}
+
+TEST_F(LayerE2E, WritesStartupTrace)
+{
+    std::string path = ::testing::TempDir() + "treadmill_e2e_startup.json";
+    remove(path.c_str());
+    setenv("TREADMILL_STARTUP_TRACE", path.c_str(), 1);
+    CreateInstance();
+    SuggestAll();
+    Sync();
+    m_xr.DestroyInstance(m_instance);
+    m_instance = XR_NULL_HANDLE;
+    unsetenv("TREADMILL_STARTUP_TRACE");
+
+    std::stringstream json;
+    json << std::ifstream(path).rdbuf();
+    remove(path.c_str());
+
+    EXPECT_EQ(json.str().rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0), 0u) << json.str();
+    for (const char* phase : { "xrNegotiateLoaderApiLayerInterface", "xrCreateApiLayerInstance", "next xrCreateApiLayerInstance", "resolve next functions",
+                               "first use", "load profile", "resolve hand paths", "open shared memory" })
+        EXPECT_NE(json.str().find(std::string("\"name\":\"") + phase + "\""), std::string::npos) << phase;
+}
+
+TEST_F(LayerE2E, RecordsVelocityTrace)
+{
+    std::string path = ::testing::TempDir() + "treadmill_e2e_velocity.tmvt";
+    remove(path.c_str());
+    setenv(VELOCITY_TRACE_ENV, path.c_str(), 1);
+    CreateInstance();                           // the path is read on first use
+    SuggestAll();
+    const float kMotion[][VELOCITY_TRACE_AXIS_COUNT] = { { 0.5f, 0.0f, 0.0f }, { 0.5f, -0.25f, 0.5f }, { 0.0f, 0.0f, -0.5f } };
+    for (const auto& m : kMotion) {
+        PublishMotion(m[0], m[1], m[2]);
+        Sync();
+    }
+    m_xr.DestroyInstance(m_instance);
+    m_instance = XR_NULL_HANDLE;
+    unsetenv(VELOCITY_TRACE_ENV);
+
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    remove(path.c_str());
+
+    VelocityTraceReader reader;
+    ASSERT_TRUE(VelocityTraceOpen(&reader, data.data(), data.size()));
+    EXPECT_EQ(reader.header.source, (uint32_t)VELOCITY_TRACE_SOURCE_LAYER);
+    EXPECT_EQ(reader.header.timestampFrequency, PlatformTimestampFrequency());
+
+    VelocityTraceRecord rec;
+    ASSERT_TRUE(VelocityTraceNext(&reader, &rec));
+    VelocityTraceLayer layer;
+    ASSERT_EQ(rec.type, VELOCITY_TRACE_LAYER);
+    ASSERT_TRUE(VelocityTracePayload(&rec, &layer));
+    EXPECT_EQ(layer.scale[0], 1.0f);
+    EXPECT_EQ(layer.predictMode, PREDICT_MODE_DEFAULT);
+
+    // What each sync latched, in order: no frame loop, so nothing is predicted
+    int64_t last = 0;
+    for (uint32_t i = 0; i < sizeof(kMotion) / sizeof(kMotion[0]); i++) {
+        ASSERT_TRUE(VelocityTraceNext(&reader, &rec)) << i;
+        VelocityTraceFrame frame;
+        ASSERT_EQ(rec.type, VELOCITY_TRACE_FRAME);
+        ASSERT_TRUE(VelocityTracePayload(&rec, &frame));
+        EXPECT_EQ(frame.frame, i + 1);
+        EXPECT_EQ(frame.display, 0);
+        EXPECT_FLOAT_EQ(frame.forward, kMotion[i][VELOCITY_TRACE_AXIS_FORWARD]);
+        EXPECT_FLOAT_EQ(frame.strafe, kMotion[i][VELOCITY_TRACE_AXIS_STRAFE]);
+        EXPECT_FLOAT_EQ(frame.turn, kMotion[i][VELOCITY_TRACE_AXIS_TURN]);
+        EXPECT_GT(rec.timestamp, last);
+        last = rec.timestamp;
+    }
+    EXPECT_FALSE(VelocityTraceNext(&reader, &rec));
+    EXPECT_FALSE(VelocityTraceTruncated(&reader));
+}
+
+TEST_F(LayerE2E, InstancesTrackTheirOwnActions)
+{
+    SuggestAll();
+    OtherApp other;
+    CreateOther(&other);
+    Publish(0.5f);
+    Sync();
+    SyncOn(other);
+
+    // The other instance has no bindings yet, so it injects into every
+    // vector2f; this one only into its left stick
+    EXPECT_FLOAT_EQ(StickYOn(other, RIGHT_STICK), 0.75f);
+    EXPECT_FLOAT_EQ(GetVector2f(RIGHT_STICK).currentState.y, 0.25f);
+    EXPECT_FLOAT_EQ(GetVector2f(LEFT_STICK).currentState.y, 0.75f);
+
+    SuggestOn(other, LEFT_STICK, kBindings[LEFT_STICK]);
+    EXPECT_FLOAT_EQ(StickYOn(other, RIGHT_STICK), 0.25f);
+    EXPECT_FLOAT_EQ(StickYOn(other, LEFT_STICK), 0.75f);
+    other.xr.DestroyInstance(other.instance);
+}
+
+TEST_F(LayerE2E, DestroyingAnInstanceLeavesTheOthers)
+{
+    OtherApp other;
+    CreateOther(&other);
+    SuggestOn(other, LEFT_STICK, kBindings[LEFT_STICK]);
+    SyncOn(other);
+    SuggestAll();
+    ASSERT_GE(WaitForPickup(0.5f, 1000), 0);
+
+    ASSERT_EQ(other.xr.DestroyInstance(other.instance), XR_SUCCESS);
+
+    // Tracking, the shared memory and its watcher all carry on
+    Publish(0.25f);
+    Sync();
+    EXPECT_FLOAT_EQ(GetVector2f(LEFT_STICK).currentState.y, 0.5f);
+    EXPECT_FLOAT_EQ(GetVector2f(RIGHT_STICK).currentState.y, 0.25f);
+
+    RemoveProducer();
+    StartProducer();
+    int ms = WaitForPickup(0.3f, 1000);
+    EXPECT_GE(ms, 0);
+    EXPECT_LT(ms, 100);
+}
+
+TEST_F(LayerE2E, InstanceCreatedDuringTheLastDestroyKeepsAWatcher)
+{
+    // The last instance goes on another thread while a new one reaches
+    // first use: whichever way they interleave, a watcher is left running
+    for (int round = 0; round < 20; round++) {
+        XrInstance  last = m_instance;
+        AppDispatch xr   = m_xr;
+        m_instance = XR_NULL_HANDLE;
+        std::thread destroy([&] { xr.DestroyInstance(last); });
+        CreateInstance();
+        SuggestAll();
+        destroy.join();
+    }
+
+    ASSERT_GE(WaitForPickup(0.5f, 1000), 0);
+    RemoveProducer();
+    StartProducer();
+    int ms = WaitForPickup(0.3f, 1000);
+    EXPECT_GE(ms, 0);
+    EXPECT_LT(ms, 100);
+}
+
+TEST_F(LayerE2E, DestroyedSessionDoesNotHoldTheOldBlock)
+{
+    // The other instance reads the first block once, then drops its session
+    OtherApp other;
+    CreateOther(&other);
+    SuggestAll();
+    ASSERT_GE(WaitForPickup(0.5f, 1000), 0);
+    SyncOn(other);
+    ASSERT_EQ(other.xr.DestroySession(other.session), XR_SUCCESS);
+
+    for (float velocity : { 0.3f, 0.1f }) {
+        RemoveProducer();
+        StartProducer();
+        int ms = WaitForPickup(velocity, 1000);
+        EXPECT_GE(ms, 0);
+        EXPECT_LT(ms, 100);
+    }
+    other.xr.DestroyInstance(other.instance);
+}
+
+TEST_F(LayerE2E, IdleSessionDoesNotBlockLaterRestarts)
+{
+    // The other session keeps announcing the first block: it never syncs again
+    OtherApp other;
+    CreateOther(&other);
+    SuggestAll();
+    ASSERT_GE(WaitForPickup(0.5f, 1000), 0);
+    SyncOn(other);
+
+    for (float velocity : { 0.3f, 0.1f, 0.2f }) {
+        RemoveProducer();
+        StartProducer();
+        int ms = WaitForPickup(velocity, 1000);
+        EXPECT_GE(ms, 0);
+        EXPECT_LT(ms, 100);
+    }
+
+    // When it does sync again, it follows the live block
+    Publish(0.4f);
+    SyncOn(other);
+    EXPECT_FLOAT_EQ(StickYOn(other, LEFT_STICK), 0.65f);
+    other.xr.DestroyInstance(other.instance);
+}
+
+TEST_F(LayerE2E, FramesArePerSession)
+{
+    SuggestAll();
+    OtherApp other;
+    CreateOther(&other);
+    SuggestOn(other, LEFT_STICK, kBindings[LEFT_STICK]);
+
+    // Only this session has synced: the other one has nothing latched
+    Publish(0.5f);
+    Sync();
+    EXPECT_FLOAT_EQ(GetVector2f(LEFT_STICK).currentState.y, 0.75f);
+    EXPECT_FLOAT_EQ(StickYOn(other, LEFT_STICK), 0.25f);
+
+    Publish(0.25f);
+    SyncOn(other);
+    EXPECT_FLOAT_EQ(StickYOn(other, LEFT_STICK), 0.5f);
+    EXPECT_FLOAT_EQ(GetVector2f(LEFT_STICK).currentState.y, 0.75f);
+    other.xr.DestroyInstance(other.instance);
+}
+
+TEST_F(LayerE2E, RecreatedSessionStartsWithoutFrames)
+{
+    SuggestAll();
+    Publish(0.5f);
+    Sync();
+    EXPECT_FLOAT_EQ(GetVector2f(LEFT_STICK).currentState.y, 0.75f);
+
+    // A destroyed session is unknown to the layer
+    ASSERT_EQ(m_xr.DestroySession(m_session), XR_SUCCESS);
+    XrActionsSyncInfo sync = {};
+    sync.type = XR_TYPE_ACTIONS_SYNC_INFO;
+    EXPECT_EQ(m_xr.SyncActions(m_session, &sync), XR_ERROR_HANDLE_INVALID);
+
+    ASSERT_EQ(MiniLoaderCreateSession(m_xr, m_instance, &m_session), XR_SUCCESS);
+    EXPECT_FLOAT_EQ(GetVector2f(LEFT_STICK).currentState.y, 0.25f);
+    Sync();
+    EXPECT_FLOAT_EQ(GetVector2f(LEFT_STICK).currentState.y, 0.75f);
+}
+
+TEST_F(LayerE2E, InstancesBeyondThePoolPassThrough)
+{
+    // The pool holds 32; this one and 31 others fill it
+    std::vector<OtherApp> others(32);
+    for (OtherApp& o : others) CreateOther(&o);
+
+    // The last was passed through: its queries come straight from the runtime
+    Publish(0.5f);
+    SyncOn(others.back());
+    EXPECT_FLOAT_EQ(StickYOn(others.back(), LEFT_STICK), 0.25f);
+    SyncOn(others.front());
+    EXPECT_FLOAT_EQ(StickYOn(others.front(), LEFT_STICK), 0.75f);
+
+    // ...and it was created as the app asked, without the time
+    // conversion extension the layer adds for prediction
+    PFN_xrVoidFunction convert = NULL;
+    EXPECT_EQ(others.front().gipa(others.front().instance, kPlatformXrTimeConvertFn, &convert), XR_SUCCESS);
+    EXPECT_NE(others.back().gipa(others.back().instance, kPlatformXrTimeConvertFn, &convert), XR_SUCCESS);
+
+    for (OtherApp& o : others) EXPECT_EQ(o.xr.DestroyInstance(o.instance), XR_SUCCESS);
+}
+
+TEST_F(LayerE2E, PublishesTelemetry)
+{
+#if !TREADMILL_TELEMETRY
+    GTEST_SKIP() << "telemetry is compiled out of the lean build";
+#else
+    SuggestAll();
+    Publish(0.5f);
+    Sync();
+
+    // First use has mapped the block, with what was counted before it
+    PlatformSharedMemory shm = {};
+    ASSERT_TRUE(PlatformSharedMemoryOpen(&shm, TREADMILL_TELEMETRY_MEM_NAME, sizeof(TreadmillTelemetry)));
+    const TreadmillTelemetry* t = (const TreadmillTelemetry*)shm.view;
+    TreadmillTelemetryTotals before;
+    ASSERT_TRUE(TreadmillTelemetryRead(t, &before));
+    EXPECT_EQ(before.processId, PlatformProcessId());
+    EXPECT_EQ(before.liveInstances, 1u);
+    EXPECT_GE(before.calls[TELEMETRY_CALL_CREATE_API_LAYER_INSTANCE], 1u);
+    EXPECT_GE(before.threads, 1u);
+
+    XrPath right = Path("/user/hand/right");
+    WaitFrame();
+    Publish(0.25f);
+    Sync();
+    GetVector2f(LEFT_STICK);
+    GetVector2f(LEFT_STICK);
+    GetVector2f(LEFT_STICK, right);     // skipped: the other hand
+    GetVector2f(RIGHT_STICK);           // tracked for turn, which is 0: left alone
+    GetFloat(LEFT_STICK_Y);
+
+    TreadmillTelemetryTotals after;
+    ASSERT_TRUE(TreadmillTelemetryRead(t, &after));
+    EXPECT_EQ(after.calls[TELEMETRY_CALL_WAIT_FRAME] - before.calls[TELEMETRY_CALL_WAIT_FRAME], 1u);
+    EXPECT_EQ(after.calls[TELEMETRY_CALL_SYNC_ACTIONS] - before.calls[TELEMETRY_CALL_SYNC_ACTIONS], 1u);
+    EXPECT_EQ(after.calls[TELEMETRY_CALL_GET_ACTION_STATE_VECTOR2F] -
+              before.calls[TELEMETRY_CALL_GET_ACTION_STATE_VECTOR2F], 4u);
+    EXPECT_EQ(after.calls[TELEMETRY_CALL_GET_ACTION_STATE_FLOAT] -
+              before.calls[TELEMETRY_CALL_GET_ACTION_STATE_FLOAT], 1u);
+    EXPECT_EQ(after.injected - before.injected, 3u);
+    EXPECT_EQ(after.skippedSubaction - before.skippedSubaction, 1u);
+    EXPECT_FLOAT_EQ(after.axes[0], 0.25f);
+    EXPECT_EQ(after.displayPeriodNs, 1000000000 / 90);
+    EXPECT_GT(after.updated, before.updated);
+    EXPECT_GE(after.timedCalls, 1u);
+
+    m_xr.DestroyInstance(m_instance);
+    m_instance = XR_NULL_HANDLE;
+    ASSERT_TRUE(TreadmillTelemetryRead(t, &after));
+    EXPECT_EQ(after.liveInstances, 0u);
+    PlatformSharedMemoryClose(&shm);
+#endif
+}
@@ -0,0 +1,112 @@
+// ═══════════════════════════════════════════════════════════════════
+// Layer log core tests
+// ═══════════════════════════════════════════════════════════════════
+
+#include "layer_log.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void StringSink(void* ctx, const char* data, size_t length)
+{
+    static_cast<std::string*>(ctx)->append(data, length);
+}
+
+std::string DrainAll(LogRing* ring)
+{
+    std::string out;
+    char buf[4096];
+    LogRingDrain(ring, buf, sizeof(buf), StringSink, &out);
+    return out;
+}
+
+} // namespace
+
+TEST(LayerLog, ParsesLevels)
+{
+    EXPECT_EQ(LogParseLevel(NULL, LOG_LEVEL_INFO), LOG_LEVEL_INFO);
+    EXPECT_EQ(LogParseLevel("", LOG_LEVEL_INFO), LOG_LEVEL_INFO);
+    EXPECT_EQ(LogParseLevel("off", LOG_LEVEL_INFO), LOG_LEVEL_OFF);
+    EXPECT_EQ(LogParseLevel("DEBUG", LOG_LEVEL_INFO), LOG_LEVEL_DEBUG);
+    EXPECT_EQ(LogParseLevel("Warn", LOG_LEVEL_INFO), LOG_LEVEL_WARN);
+    EXPECT_EQ(LogParseLevel("1", LOG_LEVEL_INFO), LOG_LEVEL_ERROR);
+    EXPECT_EQ(LogParseLevel("7", LOG_LEVEL_INFO), LOG_LEVEL_INFO);
+    EXPECT_EQ(LogParseLevel("information", LOG_LEVEL_WARN), LOG_LEVEL_WARN);
+}
+
+TEST(LayerLog, FormatsTimestampedLines)
+{
+    auto ring = std::make_unique<LogRing>();
+    LogRingInit(ring.get());
+
+    // 2026-01-01 13:45:07.000042 UTC
+    int64_t ts = (int64_t)1767275107 * 1000000 + 42;
+    ASSERT_TRUE(LogRingPush(ring.get(), LOG_LEVEL_WARN, 77, ts, "hello %d", 5));
+
+    EXPECT_EQ(DrainAll(ring.get()), "13:45:07.000042 W [   77] hello 5\r\n");
+    EXPECT_EQ(DrainAll(ring.get()), "");
+}
+
+TEST(LayerLog, TruncatesLongMessages)
+{
+    auto ring = std::make_unique<LogRing>();
+    LogRingInit(ring.get());
+    std::string big(1000, 'x');
+    ASSERT_TRUE(LogRingPush(ring.get(), LOG_LEVEL_INFO, 1, 0, "%s", big.c_str()));
+
+    std::string out = DrainAll(ring.get());
+    EXPECT_EQ(out.size(), strlen("00:00:00.000000 I [    1] ") + LOG_MESSAGE_MAX - 1 + 2);
+}
+
+TEST(LayerLog, DropsAndReportsWhenFull)
+{
+    auto ring = std::make_unique<LogRing>();
+    LogRingInit(ring.get());
+    for (int i = 0; i < LOG_RING_SIZE; i++) ASSERT_TRUE(LogRingPush(ring.get(), LOG_LEVEL_INFO, 1, 0, "m%d", i));
+    EXPECT_FALSE(LogRingPush(ring.get(), LOG_LEVEL_INFO, 1, 0, "overflow"));
+    EXPECT_FALSE(LogRingPush(ring.get(), LOG_LEVEL_INFO, 1, 0, "overflow"));
+
+    std::string out = DrainAll(ring.get());
+    EXPECT_EQ(out.rfind("... 2 log messages dropped", 0), 0u);
+    EXPECT_EQ(out.find("overflow"), std::string::npos);
+
+    // Slots are recycled after a drain
+    EXPECT_TRUE(LogRingPush(ring.get(), LOG_LEVEL_INFO, 1, 0, "again"));
+    EXPECT_NE(DrainAll(ring.get()).find("again"), std::string::npos);
+}
+
+TEST(LayerLog, ConcurrentProducersKeepPerThreadOrder)
+{
+    auto ring = std::make_unique<LogRing>();
+    LogRingInit(ring.get());
+
+    const int kThreads = 4;
+    const int kPerThread = LOG_RING_SIZE / kThreads;
+    std::vector<std::thread> producers;
+    for (int t = 0; t < kThreads; t++) {
+        producers.emplace_back([&, t] {
+            for (int i = 0; i < kPerThread; i++) LogRingPush(ring.get(), LOG_LEVEL_INFO, (uint32_t)t, 0, "%d", i);
+        });
+    }
+    for (auto& p : producers) p.join();
+
+    std::string out = DrainAll(ring.get());
+    std::vector<int> next(kThreads, 0);
+    size_t lines = 0, pos = 0;
+    while ((pos = out.find('[', pos)) != std::string::npos) {
+        unsigned tid = 0;
+        int seq = -1;
+        ASSERT_EQ(sscanf(out.c_str() + pos, "[%u] %d", &tid, &seq), 2);
+        ASSERT_LT(tid, (unsigned)kThreads);
+        EXPECT_EQ(seq, next[tid]++);
+        lines++;
+        pos++;
+    }
+    EXPECT_EQ(lines, (size_t)(kThreads * kPerThread));
+}
@@ -0,0 +1,127 @@
+// ═══════════════════════════════════════════════════════════════════
+// Layer telemetry block — layout, ownership, merge and totals
+// ═══════════════════════════════════════════════════════════════════
+
+#include "layer_telemetry.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+namespace {
+
+const int64_t kFrequency = 1000000000;
+const int64_t kStale     = kFrequency * TREADMILL_TELEMETRY_STALE_MS / 1000;
+
+class LayerTelemetryTest : public ::testing::Test {
+protected:
+    // Zeroed, as a freshly created mapping is
+    void SetUp() override { memset((void*)m_block.get(), 0, sizeof(TreadmillTelemetry)); }
+
+    TreadmillTelemetry* Block() { return m_block.get(); }
+
+    std::unique_ptr<TreadmillTelemetry> m_block{new TreadmillTelemetry};
+};
+
+} // namespace
+
+TEST_F(LayerTelemetryTest, FreshBlockIsClaimed)
+{
+    TreadmillTelemetryTotals totals;
+    EXPECT_FALSE(TreadmillTelemetryRead(Block(), &totals));
+
+    ASSERT_TRUE(TreadmillTelemetryClaim(Block(), 42, kFrequency, 1000, kStale));
+    ASSERT_TRUE(TreadmillTelemetryRead(Block(), &totals));
+    EXPECT_EQ(totals.processId, 42u);
+    EXPECT_EQ(totals.timestampFrequency, kFrequency);
+    EXPECT_EQ(Block()->timeSample, (uint32_t)TREADMILL_TELEMETRY_TIME_SAMPLE);
+    EXPECT_EQ(totals.liveInstances, 0u);
+    EXPECT_EQ(totals.threads, 0u);
+}
+
+TEST_F(LayerTelemetryTest, LiveOwnerKeepsTheBlock)
+{
+    ASSERT_TRUE(TreadmillTelemetryClaim(Block(), 42, kFrequency, 1000, kStale));
+    Block()->liveInstances.store(1);
+    Block()->updated.store(5000);
+    Block()->threads[0].calls[TELEMETRY_CALL_SYNC_ACTIONS].store(7);
+
+    // Another game while the first one still syncs: refused, counts kept
+    EXPECT_FALSE(TreadmillTelemetryClaim(Block(), 43, kFrequency, 5000 + kStale / 2, kStale));
+    EXPECT_EQ(Block()->processId, 42u);
+    EXPECT_EQ(Block()->threads[0].calls[TELEMETRY_CALL_SYNC_ACTIONS].load(), 7u);
+
+    // The same process (its layer reloaded) takes it back, from zero
+    EXPECT_TRUE(TreadmillTelemetryClaim(Block(), 42, kFrequency, 6000, kStale));
+    EXPECT_EQ(Block()->threads[0].calls[TELEMETRY_CALL_SYNC_ACTIONS].load(), 0u);
+}
+
+TEST_F(LayerTelemetryTest, StaleOrIdleOwnerIsTakenOver)
+{
+    ASSERT_TRUE(TreadmillTelemetryClaim(Block(), 42, kFrequency, 1000, kStale));
+    Block()->liveInstances.store(1);
+    Block()->updated.store(5000);
+
+    // Crashed (no sync for the stale time) ...
+    EXPECT_TRUE(TreadmillTelemetryClaim(Block(), 43, kFrequency, 5000 + kStale, kStale));
+    EXPECT_EQ(Block()->processId, 43u);
+
+    // ... or still running but without instances
+    Block()->updated.store(9000);
+    EXPECT_TRUE(TreadmillTelemetryClaim(Block(), 44, kFrequency, 9001, kStale));
+    EXPECT_EQ(Block()->processId, 44u);
+}
+
+TEST_F(LayerTelemetryTest, ReadSumsEveryThreadSlot)
+{
+    ASSERT_TRUE(TreadmillTelemetryClaim(Block(), 42, kFrequency, 0, kStale));
+    for (uint32_t s = 0; s < TREADMILL_TELEMETRY_THREADS; s += 5) {
+        TreadmillTelemetryThread* th = &Block()->threads[s];
+        th->calls[TELEMETRY_CALL_GET_ACTION_STATE_VECTOR2F].store(10);
+        th->injected.store(8);
+        th->skippedSubaction.store(1);
+        th->timedCalls.store(2);
+        th->timeTicks.store(300);
+        th->threadId.store(100 + s);
+    }
+    float forward = 0.5f;
+    uint32_t bits;
+    memcpy(&bits, &forward, sizeof(bits));
+    Block()->axisBits[0].store(bits);
+    Block()->displayPeriodNs.store(11111111);
+
+    TreadmillTelemetryTotals totals;
+    ASSERT_TRUE(TreadmillTelemetryRead(Block(), &totals));
+    EXPECT_EQ(totals.threads, 4u);      // slots 0, 5, 10, 15
+    EXPECT_EQ(totals.calls[TELEMETRY_CALL_GET_ACTION_STATE_VECTOR2F], 40u);
+    EXPECT_EQ(totals.calls[TELEMETRY_CALL_SYNC_ACTIONS], 0u);
+    EXPECT_EQ(totals.injected, 32u);
+    EXPECT_EQ(totals.skippedSubaction, 4u);
+    EXPECT_EQ(totals.timedCalls, 8u);
+    EXPECT_EQ(totals.timeTicks, 1200u);
+    EXPECT_FLOAT_EQ(totals.axes[0], 0.5f);
+    EXPECT_EQ(totals.displayPeriodNs, 11111111);
+}
+
+TEST_F(LayerTelemetryTest, MergeCarriesPrivateCountsOver)
+{
+    // What the layer counted before the block was mapped
+    std::unique_ptr<TreadmillTelemetry> local(new TreadmillTelemetry);
+    memset((void*)local.get(), 0, sizeof(TreadmillTelemetry));
+    local->threads[3].calls[TELEMETRY_CALL_CREATE_API_LAYER_INSTANCE].store(1);
+    local->threads[3].calls[TELEMETRY_CALL_GET_INSTANCE_PROC_ADDR].store(25);
+    local->threads[3].threadId.store(77);
+    local->liveInstances.store(2);
+
+    ASSERT_TRUE(TreadmillTelemetryClaim(Block(), 42, kFrequency, 0, kStale));
+    Block()->threads[3].calls[TELEMETRY_CALL_GET_INSTANCE_PROC_ADDR].store(5);
+    Block()->threads[3].threadId.store(78);
+    TreadmillTelemetryMerge(Block(), local.get());
+
+    TreadmillTelemetryTotals totals;
+    ASSERT_TRUE(TreadmillTelemetryRead(Block(), &totals));
+    EXPECT_EQ(totals.calls[TELEMETRY_CALL_CREATE_API_LAYER_INSTANCE], 1u);
+    EXPECT_EQ(totals.calls[TELEMETRY_CALL_GET_INSTANCE_PROC_ADDR], 30u);
+    EXPECT_EQ(Block()->threads[3].threadId.load(), 78u);     // a slot keeps its first thread
+    EXPECT_EQ(totals.liveInstances, 2u);
+}
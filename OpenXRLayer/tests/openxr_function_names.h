@@ -0,0 +1,42 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════════════
+// OpenXR 1.0 core entry points plus the extensions engines commonly
+// resolve at startup — the set an xrGetInstanceProcAddr sweep sees.
+// Shared by the proc-table tests and benchmarks.
+// ═══════════════════════════════════════════════════════════════════
+
+static const char* const kOpenXRFunctionNames[] = {
+    // Core 1.0
+    "xrAcquireSwapchainImage", "xrApplyHapticFeedback", "xrAttachSessionActionSets",
+    "xrBeginFrame", "xrBeginSession", "xrCreateAction", "xrCreateActionSet",
+    "xrCreateActionSpace", "xrCreateInstance", "xrCreateReferenceSpace", "xrCreateSession",
+    "xrCreateSwapchain", "xrDestroyAction", "xrDestroyActionSet", "xrDestroyInstance",
+    "xrDestroySession", "xrDestroySpace", "xrDestroySwapchain", "xrEndFrame", "xrEndSession",
+    "xrEnumerateApiLayerProperties", "xrEnumerateBoundSourcesForAction",
+    "xrEnumerateEnvironmentBlendModes", "xrEnumerateInstanceExtensionProperties",
+    "xrEnumerateReferenceSpaces", "xrEnumerateSwapchainFormats", "xrEnumerateSwapchainImages",
+    "xrEnumerateViewConfigurationViews", "xrEnumerateViewConfigurations",
+    "xrGetActionStateBoolean", "xrGetActionStateFloat", "xrGetActionStatePose",
+    "xrGetActionStateVector2f", "xrGetCurrentInteractionProfile", "xrGetInputSourceLocalizedName",
+    "xrGetInstanceProcAddr", "xrGetInstanceProperties", "xrGetReferenceSpaceBoundsRect",
+    "xrGetSystem", "xrGetSystemProperties", "xrGetViewConfigurationProperties", "xrLocateSpace",
+    "xrLocateViews", "xrPathToString", "xrPollEvent", "xrReleaseSwapchainImage",
+    "xrRequestExitSession", "xrResultToString", "xrStopHapticFeedback", "xrStringToPath",
+    "xrStructureTypeToString", "xrSuggestInteractionProfileBindings", "xrSyncActions",
+    "xrWaitFrame", "xrWaitSwapchainImage",
+
+    // Common extensions
+    "xrGetD3D11GraphicsRequirementsKHR", "xrGetD3D12GraphicsRequirementsKHR",
+    "xrGetOpenGLGraphicsRequirementsKHR", "xrGetVulkanGraphicsRequirementsKHR",
+    "xrGetVulkanGraphicsRequirements2KHR", "xrGetVulkanInstanceExtensionsKHR",
+    "xrGetVulkanDeviceExtensionsKHR", "xrGetVulkanGraphicsDeviceKHR",
+    "xrGetVulkanGraphicsDevice2KHR", "xrCreateVulkanInstanceKHR", "xrCreateVulkanDeviceKHR",
+    "xrConvertWin32PerformanceCounterToTimeKHR", "xrConvertTimeToWin32PerformanceCounterKHR",
+    "xrConvertTimespecTimeToTimeKHR", "xrConvertTimeToTimespecTimeKHR",
+    "xrCreateDebugUtilsMessengerEXT", "xrDestroyDebugUtilsMessengerEXT",
+    "xrSetDebugUtilsObjectNameEXT", "xrSubmitDebugUtilsMessageEXT",
+    "xrSessionBeginDebugUtilsLabelRegionEXT", "xrSessionEndDebugUtilsLabelRegionEXT",
+    "xrCreateHandTrackerEXT", "xrDestroyHandTrackerEXT", "xrLocateHandJointsEXT",
+    "xrGetVisibilityMaskKHR", "xrPerfSettingsSetPerformanceLevelEXT",
+    "xrEnumerateDisplayRefreshRatesFB", "xrGetDisplayRefreshRateFB", "xrRequestDisplayRefreshRateFB",
+};
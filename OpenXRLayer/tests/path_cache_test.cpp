@@ -0,0 +1,105 @@
+// ═══════════════════════════════════════════════════════════════════
+// Binding path cache — lookup, growth, negative entries and clearing
+// ═══════════════════════════════════════════════════════════════════
+
+#include "path_cache.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+InjectBinding Binding(InjectTarget vec2f, InjectTarget floatValue, bool leftStick)
+{
+    InjectBinding b = { vec2f, floatValue, leftStick };
+    return b;
+}
+
+class PathCacheTest : public ::testing::Test {
+protected:
+    void TearDown() override { PathCacheClear(&m_cache); }
+
+    PathCache m_cache = {};
+};
+
+} // namespace
+
+TEST_F(PathCacheTest, EmptyCacheFindsNothing)
+{
+    InjectBinding b;
+    EXPECT_FALSE(PathCacheFind(&m_cache, 1, &b));
+    EXPECT_FALSE(PathCacheFind(&m_cache, XR_NULL_PATH, &b));
+    EXPECT_FALSE(PathCacheInsert(&m_cache, XR_NULL_PATH, Binding(0, 0, false)));
+    EXPECT_EQ(m_cache.count, 0u);
+}
+
+TEST_F(PathCacheTest, RemembersHitsAndMisses)
+{
+    ASSERT_TRUE(PathCacheInsert(&m_cache, 7, Binding(kInjectLeftStick, 0, true)));
+    ASSERT_TRUE(PathCacheInsert(&m_cache, 8, Binding(0, 0, false)));     // a button: cached as "nothing"
+
+    InjectBinding b;
+    ASSERT_TRUE(PathCacheFind(&m_cache, 7, &b));
+    EXPECT_EQ(b.vec2f, kInjectLeftStick);
+    EXPECT_TRUE(b.leftStick);
+
+    ASSERT_TRUE(PathCacheFind(&m_cache, 8, &b));
+    EXPECT_EQ(b.vec2f, 0u);
+    EXPECT_EQ(b.floatValue, 0u);
+    EXPECT_FALSE(b.leftStick);
+
+    EXPECT_FALSE(PathCacheFind(&m_cache, 9, &b));
+}
+
+TEST_F(PathCacheTest, ReinsertReplacesWithoutGrowingCount)
+{
+    ASSERT_TRUE(PathCacheInsert(&m_cache, 3, Binding(0, 0, false)));
+    ASSERT_TRUE(PathCacheInsert(&m_cache, 3, Binding(0, kInjectRightStick, false)));
+    EXPECT_EQ(m_cache.count, 1u);
+
+    InjectBinding b;
+    ASSERT_TRUE(PathCacheFind(&m_cache, 3, &b));
+    EXPECT_EQ(b.floatValue, kInjectRightStick);
+}
+
+TEST_F(PathCacheTest, GrowsKeepingEveryEntry)
+{
+    // Sequential atoms, as runtimes hand them out, and sparse ones
+    const uint32_t n = 1000;
+    for (uint32_t i = 1; i <= n; i++) {
+        XrPath path = (i & 1) ? i : (XrPath)i << 32;
+        ASSERT_TRUE(PathCacheInsert(&m_cache, path, Binding(i, 0, false)));
+    }
+    EXPECT_EQ(m_cache.count, n);
+    EXPECT_GE(m_cache.capacity, 2 * n);
+
+    for (uint32_t i = 1; i <= n; i++) {
+        XrPath path = (i & 1) ? i : (XrPath)i << 32;
+        InjectBinding b;
+        ASSERT_TRUE(PathCacheFind(&m_cache, path, &b)) << i;
+        EXPECT_EQ(b.vec2f, i);
+    }
+}
+
+TEST_F(PathCacheTest, ClearForgetsEverything)
+{
+    ASSERT_TRUE(PathCacheInsert(&m_cache, 5, Binding(kInjectLeftStick, 0, true)));
+    m_cache.seeded = true;
+    PathCacheClear(&m_cache);
+
+    InjectBinding b;
+    EXPECT_FALSE(PathCacheFind(&m_cache, 5, &b));
+    EXPECT_FALSE(m_cache.seeded);
+    EXPECT_EQ(m_cache.arena.totalBytes, 0u);
+
+    ASSERT_TRUE(PathCacheInsert(&m_cache, 5, Binding(0, 0, false)));
+    EXPECT_TRUE(PathCacheFind(&m_cache, 5, &b));
+}
+
+TEST_F(PathCacheTest, TryLockIsExclusive)
+{
+    ASSERT_TRUE(PathCacheTryLock(&m_cache));
+    EXPECT_FALSE(PathCacheTryLock(&m_cache));
+    PathCacheUnlock(&m_cache);
+    EXPECT_TRUE(PathCacheTryLock(&m_cache));
+    PathCacheUnlock(&m_cache);
+}
@@ -0,0 +1,228 @@
+// ═══════════════════════════════════════════════════════════════════
+// Layer platform backend tests (POSIX backend on Linux CI)
+// ═══════════════════════════════════════════════════════════════════
+
+#include "layer_platform.h"
+#include "treadmill_shared.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <string.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// Unique per process so parallel ctest runs don't collide.
+std::string TestShmName(const char* tag)
+{
+    char buf[64];
+    snprintf(buf, sizeof(buf), "TreadmillPlatformTest_%s_%u", tag, PlatformThreadId());
+    return buf;
+}
+
+} // namespace
+
+TEST(Platform, SharedMemoryRoundTrip)
+{
+    std::string name = TestShmName("rt");
+    PlatformSharedMemory writer = {};
+    ASSERT_TRUE(PlatformSharedMemoryCreate(&writer, name.c_str(), sizeof(TreadmillSharedData)));
+
+    TreadmillSharedData* w = (TreadmillSharedData*)writer.view;
+    TreadmillSharedInit(w, PlatformTimestampFrequency());
+    TreadmillSharedWrite(w, 0.75f, 1, PlatformTimestamp());
+
+    PlatformSharedMemory reader = {};
+    ASSERT_TRUE(PlatformSharedMemoryOpen(&reader, name.c_str(), sizeof(TreadmillSharedData)));
+
+    const TreadmillSharedData* r = (const TreadmillSharedData*)reader.view;
+    ASSERT_TRUE(TreadmillSharedValidate(r));
+    TreadmillSample s;
+    ASSERT_TRUE(TreadmillSharedRead(r, &s));
+    EXPECT_EQ(s.velocity, 0.75f);
+    EXPECT_FALSE(TreadmillSampleIsStale(&s, PlatformTimestamp(), PlatformTimestampFrequency()));
+
+    PlatformSharedMemoryClose(&reader);
+    PlatformSharedMemoryClose(&writer);
+    PlatformSharedMemoryUnlink(name.c_str());
+    EXPECT_EQ(reader.view, nullptr);
+}
+
+TEST(Platform, OpenFailsForMissingOrShortObject)
+{
+    std::string name = TestShmName("short");
+    PlatformSharedMemory shm = {};
+    EXPECT_FALSE(PlatformSharedMemoryOpen(&shm, name.c_str(), 64));
+
+    // A v1-sized object must not be mapped at v2 size
+    PlatformSharedMemory small = {};
+    ASSERT_TRUE(PlatformSharedMemoryCreate(&small, name.c_str(), 16));
+    EXPECT_FALSE(PlatformSharedMemoryOpen(&shm, name.c_str(), 64));
+    EXPECT_EQ(shm.view, nullptr);
+
+    PlatformSharedMemoryClose(&small);
+    PlatformSharedMemoryUnlink(name.c_str());
+}
+
+// The velocity ring through real mappings: the writer's view and one
+// view per reader, as the app and the layer (plus any other native
+// consumer) see it. 8 kHz writer, readers polling at frame-ish rates.
+TEST(Platform, VelocityRingAcrossMappings)
+{
+    std::string name = TestShmName("ring");
+    PlatformSharedMemory writer = {};
+    ASSERT_TRUE(PlatformSharedMemoryCreate(&writer, name.c_str(), sizeof(TreadmillSharedData)));
+    TreadmillSharedData* w = (TreadmillSharedData*)writer.view;
+    TreadmillSharedInit(w, PlatformTimestampFrequency());
+
+    const int kReaders = 3;
+    const int kSamples = 2000;      // 250 ms
+    PlatformSharedMemory views[kReaders] = {};
+    SharedRingCursor     cursors[kReaders];
+    for (int i = 0; i < kReaders; i++) {
+        ASSERT_TRUE(PlatformSharedMemoryOpen(&views[i], name.c_str(), sizeof(TreadmillSharedData)));
+        TreadmillVelocityCursorInit((const TreadmillSharedData*)views[i].view, &cursors[i]);
+    }
+
+    std::atomic<bool> done{false};
+    std::atomic<int>  bad{0};
+    std::vector<std::thread> readers;
+    std::vector<int> seen(kReaders, 0);
+    for (int i = 0; i < kReaders; i++) {
+        readers.emplace_back([&, i] {
+            const TreadmillSharedData* r = (const TreadmillSharedData*)views[i].view;
+            TreadmillVelocitySample out[128];
+            uint32_t lastBeat = 0;
+            bool finished = false;
+            while (!finished) {
+                finished = done.load(std::memory_order_acquire);
+                uint32_t n;
+                while ((n = TreadmillVelocityRead(r, &cursors[i], out, 128)) > 0) {
+                    for (uint32_t k = 0; k < n; k++) {
+                        // The writer encodes the heartbeat into the velocity
+                        if (out[k].heartbeat != lastBeat + 1 || out[k].velocity != (float)out[k].heartbeat / kSamples)
+                            bad.fetch_add(1);
+                        lastBeat = out[k].heartbeat;
+                    }
+                    seen[i] += (int)n;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1 + 3 * i));
+            }
+        });
+    }
+
+    int64_t period = PlatformTimestampFrequency() / 8000;
+    int64_t next   = PlatformTimestamp();
+    for (int beat = 1; beat <= kSamples; beat++) {
+        next += period;
+        while (PlatformTimestamp() < next) std::this_thread::yield();
+        TreadmillSharedWrite(w, (float)beat / kSamples, 1, next);
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& t : readers) t.join();
+
+    EXPECT_EQ(bad.load(), 0);
+    for (int i = 0; i < kReaders; i++) {
+        EXPECT_EQ(seen[i], kSamples);
+        EXPECT_EQ(cursors[i].lost, 0u);
+        PlatformSharedMemoryClose(&views[i]);
+    }
+    PlatformSharedMemoryClose(&writer);
+    PlatformSharedMemoryUnlink(name.c_str());
+}
+
+TEST(Platform, ClocksAreMonotonic)
+{
+    int64_t  t0 = PlatformTimestamp();
+    uint64_t m0 = PlatformMonotonicMs();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    int64_t  t1 = PlatformTimestamp();
+    uint64_t m1 = PlatformMonotonicMs();
+
+    EXPECT_GE(t1 - t0, PlatformTimestampFrequency() / 100);
+    EXPECT_GE(m1 - m0, 10u);
+    EXPECT_GT(PlatformWallClockUs(), 1600000000LL * 1000000);   // after 2020
+}
+
+TEST(Platform, GetEnvRespectsCapacity)
+{
+    setenv("TREADMILL_PLATFORM_TEST", "debug", 1);
+    char buf[8];
+    ASSERT_TRUE(PlatformGetEnv("TREADMILL_PLATFORM_TEST", buf, sizeof(buf)));
+    EXPECT_STREQ(buf, "debug");
+    EXPECT_FALSE(PlatformGetEnv("TREADMILL_PLATFORM_TEST", buf, 5));
+    unsetenv("TREADMILL_PLATFORM_TEST");
+    EXPECT_FALSE(PlatformGetEnv("TREADMILL_PLATFORM_TEST", buf, sizeof(buf)));
+}
+
+TEST(Platform, LogDirectoryFollowsXdgStateHome)
+{
+    char tmpl[] = "/tmp/treadmill_xdg_XXXXXX";
+    ASSERT_NE(mkdtemp(tmpl), nullptr);
+    setenv("XDG_STATE_HOME", tmpl, 1);
+
+    char dir[512];
+    ASSERT_TRUE(PlatformLogDirectory(dir, sizeof(dir)));
+    EXPECT_EQ(std::string(dir), std::string(tmpl) + "/treadmill-driver/openxr-layer/");
+
+    std::string path = std::string(dir) + "layer_log.txt";
+    PlatformFile f = PlatformFileCreate(path.c_str());
+    ASSERT_NE(f, nullptr);
+    PlatformFileWrite(f, "hello\n", 6);
+    PlatformFileClose(f);
+
+    FILE* in = fopen(path.c_str(), "rb");
+    ASSERT_NE(in, nullptr);
+    char text[16] = {};
+    EXPECT_EQ(fread(text, 1, sizeof(text), in), 6u);
+    fclose(in);
+    EXPECT_STREQ(text, "hello\n");
+
+    unsetenv("XDG_STATE_HOME");
+    std::string cleanup = std::string("rm -rf ") + tmpl;
+    EXPECT_EQ(system(cleanup.c_str()), 0);
+}
+
+TEST(Platform, FileMapReadRespectsMaxSize)
+{
+    char path[] = "/tmp/treadmill_map_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(write(fd, "0123456789", 10), 10);
+    close(fd);
+
+    PlatformSharedMemory map = {};
+    ASSERT_TRUE(PlatformFileMapRead(&map, path, 16));
+    EXPECT_EQ(map.size, 10u);
+    EXPECT_EQ(memcmp(map.view, "0123456789", 10), 0);
+    PlatformSharedMemoryClose(&map);
+    EXPECT_EQ(map.view, nullptr);
+
+    EXPECT_FALSE(PlatformFileMapRead(&map, path, 8));
+    EXPECT_FALSE(PlatformFileMapRead(&map, "/tmp/treadmill_map_missing", 16));
+    EXPECT_EQ(map.view, nullptr);
+    unlink(path);
+}
+
+TEST(Platform, WorkerTicksAndRunsOnceMoreOnStop)
+{
+    std::atomic<int> ticks{0};
+    PlatformWorker worker = {};
+    ASSERT_TRUE(PlatformWorkerStart(&worker, 5, [](void* ctx) {
+        ((std::atomic<int>*)ctx)->fetch_add(1);
+    }, &ticks));
+
+    while (ticks.load() < 3) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    PlatformWorkerStop(&worker, true);
+    int after = ticks.load();
+    EXPECT_EQ(worker.thread, nullptr);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(ticks.load(), after);
+}
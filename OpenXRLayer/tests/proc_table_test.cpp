@@ -0,0 +1,38 @@
+// ═══════════════════════════════════════════════════════════════════
+// Intercept dispatch table tests
+// ═══════════════════════════════════════════════════════════════════
+
+#include "proc_table.h"
+#include "openxr_function_names.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+TEST(ProcTable, FindsEveryIntercept)
+{
+    const size_t n = sizeof(kInterceptNames) / sizeof(kInterceptNames[0]);
+    for (size_t i = 0; i < n; i++) {
+        EXPECT_EQ(ProcTableFind(kInterceptTable, kInterceptNames, kInterceptNames[i]), (int)i)
+            << kInterceptNames[i];
+    }
+}
+
+TEST(ProcTable, MatchesStrcmpOverOpenXRNames)
+{
+    for (const char* name : kOpenXRFunctionNames) {
+        int expected = -1;
+        for (size_t i = 0; i < sizeof(kInterceptNames) / sizeof(kInterceptNames[0]); i++) {
+            if (strcmp(kInterceptNames[i], name) == 0) expected = (int)i;
+        }
+        EXPECT_EQ(ProcTableFind(kInterceptTable, kInterceptNames, name), expected) << name;
+    }
+}
+
+TEST(ProcTable, RejectsNearMisses)
+{
+    EXPECT_EQ(ProcTableFind(kInterceptTable, kInterceptNames, ""), -1);
+    EXPECT_EQ(ProcTableFind(kInterceptTable, kInterceptNames, "xrSyncAction"), -1);
+    EXPECT_EQ(ProcTableFind(kInterceptTable, kInterceptNames, "xrSyncActionsX"), -1);
+    EXPECT_EQ(ProcTableFind(kInterceptTable, kInterceptNames, "XRSYNCACTIONS"), -1);
+}
@@ -0,0 +1,366 @@
+// ═══════════════════════════════════════════════════════════════════
+// Shared memory protocol v5 — seqlock, delta ring, filter config and calibration tests
+// ═══════════════════════════════════════════════════════════════════
+
+#include "treadmill_shared.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// The stress writer encodes the timestamp into the velocity so a torn
+// read shows up as a mismatched pair.
+float VelocityFor(int64_t ts) { return (float)(ts & 0xFFFF) / 65536.0f; }
+
+// Ring entries carry their own checksum for the same reason
+TreadmillDelta DeltaFor(int64_t ts) { return { ts, (int32_t)ts, -(int32_t)(ts * 3) }; }
+
+void WriteDeltas(TreadmillSharedData* d, int64_t first, int count)
+{
+    for (int i = 0; i < count; i++) {
+        TreadmillDelta delta = DeltaFor(first + i);
+        TreadmillDeltaWrite(d, &delta, 1);
+    }
+}
+
+} // namespace
+
+TEST(SharedMemory, InitWritesValidHeader)
+{
+    TreadmillSharedData d;
+    TreadmillSharedInit(&d, 10000000);
+    EXPECT_TRUE(TreadmillSharedValidate(&d));
+
+    TreadmillSample s;
+    ASSERT_TRUE(TreadmillSharedRead(&d, &s));
+    EXPECT_EQ(s.active, 0u);
+    EXPECT_EQ(s.velocity, 0.0f);
+}
+
+TEST(SharedMemory, RejectsForeignHeader)
+{
+    TreadmillSharedData d;
+    TreadmillSharedInit(&d, 10000000);
+
+    d.header.magic = 0;
+    EXPECT_FALSE(TreadmillSharedValidate(&d));
+
+    TreadmillSharedInit(&d, 10000000);
+    d.header.version = 1;
+    EXPECT_FALSE(TreadmillSharedValidate(&d));
+
+    TreadmillSharedInit(&d, 0);
+    EXPECT_FALSE(TreadmillSharedValidate(&d));
+}
+
+TEST(SharedMemory, ReadReturnsLastWrite)
+{
+    TreadmillSharedData d;
+    TreadmillSharedInit(&d, 1000);
+    TreadmillSharedWrite(&d, 0.5f, 1, 42);
+    TreadmillSharedWrite(&d, -0.25f, 1, 43);
+
+    TreadmillSample s;
+    ASSERT_TRUE(TreadmillSharedRead(&d, &s));
+    EXPECT_EQ(s.velocity, -0.25f);
+    EXPECT_EQ(s.timestamp, 43);
+    EXPECT_EQ(s.active, 1u);
+    EXPECT_EQ(s.heartbeat, 2u);
+}
+
+TEST(SharedMemory, MotionRoundTrips)
+{
+    TreadmillSharedData d;
+    TreadmillSharedInit(&d, 1000);
+    TreadmillSharedWriteMotion(&d, 0.5f, -0.25f, 0.75f, 1, 42);
+
+    TreadmillSample s;
+    ASSERT_TRUE(TreadmillSharedRead(&d, &s));
+    EXPECT_EQ(s.velocity, 0.5f);
+    EXPECT_EQ(s.strafe, -0.25f);
+    EXPECT_EQ(s.turn, 0.75f);
+
+    // A forward-only writer clears the other axes
+    TreadmillSharedWrite(&d, 0.1f, 1, 43);
+    ASSERT_TRUE(TreadmillSharedRead(&d, &s));
+    EXPECT_EQ(s.strafe, 0.0f);
+    EXPECT_EQ(s.turn, 0.0f);
+}
+
+TEST(SharedMemory, ReadFailsWhileWriteInProgress)
+{
+    TreadmillSharedData d;
+    TreadmillSharedInit(&d, 1000);
+    d.sequence.store(1);
+
+    TreadmillSample s;
+    EXPECT_FALSE(TreadmillSharedRead(&d, &s));
+}
+
+TEST(SharedMemory, StaleSampleIsDetected)
+{
+    TreadmillSample s = {};
+    s.timestamp = 1000;
+    EXPECT_FALSE(TreadmillSampleIsStale(&s, 1200, 250));
+    EXPECT_FALSE(TreadmillSampleIsStale(&s, 1250, 250));
+    EXPECT_TRUE(TreadmillSampleIsStale(&s, 1251, 250));
+}
+
+TEST(SharedMemory, LiveWhileActiveAndFresh)
+{
+    TreadmillSharedData d;
+    TreadmillSharedInit(&d, 1000);
+    EXPECT_FALSE(TreadmillSharedIsLive(&d, 0, 250));    // not started
+
+    TreadmillSharedWrite(&d, 0.0f, 1, 1000);
+    EXPECT_TRUE(TreadmillSharedIsLive(&d, 1250, 250));
+    EXPECT_FALSE(TreadmillSharedIsLive(&d, 1251, 250));
+
+    TreadmillSharedWrite(&d, 0.0f, 0, 1300);
+    EXPECT_FALSE(TreadmillSharedIsLive(&d, 1300, 250));
+
+    d.sequence.store(d.sequence.load() + 1);             // mid-write: give it the benefit of the doubt
+    EXPECT_TRUE(TreadmillSharedIsLive(&d, 1300, 250));
+}
+
+TEST(SharedMemory, InitBumpsGeneration)
+{
+    TreadmillSharedData d;
+    d.generation.store(0);
+    TreadmillSharedInit(&d, 1000);
+    EXPECT_EQ(d.generation.load(), 1u);
+
+    // A restarting writer keeps the block but not the generation
+    TreadmillSharedWrite(&d, 0.5f, 1, 1);
+    TreadmillSharedInit(&d, 1000);
+    EXPECT_EQ(d.generation.load(), 2u);
+}
+
+TEST(SharedMemory, StressNoTornReads)
+{
+    TreadmillSharedData d;
+    TreadmillSharedInit(&d, 1000);
+    TreadmillSharedWrite(&d, VelocityFor(1), 1, 1);
+
+    std::atomic<bool> stop{false};
+    std::thread writer([&] {
+        int64_t ts = 1;
+        while (!stop.load(std::memory_order_relaxed)) {
+            ++ts;
+            TreadmillSharedWrite(&d, VelocityFor(ts), (uint32_t)(ts & 1) + 1, ts);
+        }
+    });
+
+    const int kReaders = 3;
+    const int kReads   = 200000;
+    std::vector<std::thread> readers;
+    std::atomic<int> torn{0}, succeeded{0}, regressions{0};
+
+    for (int r = 0; r < kReaders; r++) {
+        readers.emplace_back([&] {
+            int64_t lastTs = 0;
+            for (int i = 0; i < kReads;) {
+                TreadmillSample s;
+                if (!TreadmillSharedRead(&d, &s)) {
+                    std::this_thread::yield();   // writer preempted mid-write
+                    continue;
+                }
+                i++;
+                succeeded.fetch_add(1, std::memory_order_relaxed);
+                if (s.velocity != VelocityFor(s.timestamp) ||
+                    s.active != (uint32_t)(s.timestamp & 1) + 1) {
+                    torn.fetch_add(1, std::memory_order_relaxed);
+                }
+                if (s.timestamp < lastTs) regressions.fetch_add(1, std::memory_order_relaxed);
+                lastTs = s.timestamp;
+            }
+        });
+    }
+
+    for (auto& t : readers) t.join();
+    stop.store(true);
+    writer.join();
+
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_EQ(regressions.load(), 0);
+    EXPECT_EQ(succeeded.load(), kReaders * kReads);
+}
+
+TEST(SharedMemory, InitSelectsVelocityMode)
+{
+    TreadmillSharedData d;
+    TreadmillSharedInit(&d, 1000);
+    EXPECT_EQ(d.streamMode.load(), (uint32_t)TREADMILL_STREAM_VELOCITY);
+    EXPECT_EQ(d.deltaRing.head.load(), 0u);
+    EXPECT_EQ(d.velocityRing.head.load(), 0u);
+}
+
+TEST(SharedMemory, ConfigRoundTrip)
+{
+    TreadmillSharedData d;
+    TreadmillSharedInit(&d, 1000);
+    TreadmillFilterConfig in = { 2.5, 5.0, 0.125, 80.0, 1, 2, 0.75 };
+    TreadmillConfigWrite(&d, &in);
+    EXPECT_EQ(d.configSequence.load(), 2u);
+
+    TreadmillFilterConfig out = {};
+    ASSERT_TRUE(TreadmillConfigRead(&d, &out));
+    EXPECT_EQ(out.sensitivity, 2.5);
+    EXPECT_EQ(out.deadZone, 5.0);
+    EXPECT_EQ(out.smoothing, 0.125);
+    EXPECT_EQ(out.maxSpeed, 80.0);
+    EXPECT_EQ(out.invertDirection, 1u);
+    EXPECT_EQ(out.filter, 2u);
+    EXPECT_EQ(out.adaptivity, 0.75);
+
+    d.configSequence.store(3);
+    EXPECT_FALSE(TreadmillConfigRead(&d, &out));
+}
+
+TEST(SharedMemory, CalibrationRoundTrip)
+{
+    TreadmillSharedData d;
+    TreadmillSharedInit(&d, 1000);
+
+    TreadmillCalibrationConfig in = { 39370.0, 2.5, {} };
+    for (int i = 0; i < TREADMILL_CURVE_SIZE; i++) in.curve[i] = (float)i / (TREADMILL_CURVE_SIZE - 1);
+    TreadmillCalibrationWrite(&d, &in);
+    EXPECT_EQ(d.calibrationSequence.load(), 2u);
+    EXPECT_EQ(d.configSequence.load(), 0u);
+
+    TreadmillCalibrationConfig out = {};
+    ASSERT_TRUE(TreadmillCalibrationRead(&d, &out));
+    EXPECT_EQ(out.countsPerMeter, 39370.0);
+    EXPECT_EQ(out.topSpeed, 2.5);
+    EXPECT_EQ(memcmp(out.curve, in.curve, sizeof(in.curve)), 0);
+
+    d.calibrationSequence.store(5);
+    EXPECT_FALSE(TreadmillCalibrationRead(&d, &out));
+}
+
+TEST(SharedMemory, DeltaCursorStartsAtHead)
+{
+    TreadmillSharedData d;
+    TreadmillSharedInit(&d, 1000);
+    WriteDeltas(&d, 1, 5);
+
+    SharedRingCursor cursor;
+    TreadmillDeltaCursorInit(&d, &cursor);
+    TreadmillDelta out[8];
+    EXPECT_EQ(TreadmillDeltaRead(&d, &cursor, out, 8), 0u);
+
+    WriteDeltas(&d, 6, 3);
+    ASSERT_EQ(TreadmillDeltaRead(&d, &cursor, out, 8), 3u);
+    EXPECT_EQ(out[0].timestamp, 6);
+    EXPECT_EQ(out[2].timestamp, 8);
+    EXPECT_EQ(out[2].dy, DeltaFor(8).dy);
+    EXPECT_EQ(cursor.lost, 0u);
+}
+
+TEST(SharedMemory, DeltaReadHonoursMax)
+{
+    TreadmillSharedData d;
+    TreadmillSharedInit(&d, 1000);
+    SharedRingCursor cursor;
+    TreadmillDeltaCursorInit(&d, &cursor);
+    WriteDeltas(&d, 1, 10);
+
+    TreadmillDelta out[4];
+    EXPECT_EQ(TreadmillDeltaRead(&d, &cursor, out, 4), 4u);
+    EXPECT_EQ(out[3].timestamp, 4);
+    EXPECT_EQ(TreadmillDeltaRead(&d, &cursor, out, 4), 4u);
+    EXPECT_EQ(TreadmillDeltaRead(&d, &cursor, out, 4), 2u);
+    EXPECT_EQ(out[1].timestamp, 10);
+    EXPECT_EQ(TreadmillDeltaRead(&d, &cursor, out, 4), 0u);
+}
+
+TEST(SharedMemory, DeltaRingWrapsAndCountsLost)
+{
+    TreadmillSharedData d;
+    TreadmillSharedInit(&d, 1000);
+    SharedRingCursor cursor;
+    TreadmillDeltaCursorInit(&d, &cursor);
+    WriteDeltas(&d, 1, TREADMILL_DELTA_RING_SIZE + 10);
+
+    std::vector<TreadmillDelta> out(TREADMILL_DELTA_RING_SIZE + 10);
+    uint32_t n = TreadmillDeltaRead(&d, &cursor, out.data(), (uint32_t)out.size());
+
+    // The oldest slot is always treated as being overwritten
+    ASSERT_EQ(n, (uint32_t)TREADMILL_DELTA_RING_SIZE - 1);
+    EXPECT_EQ(cursor.lost, 11u);
+    EXPECT_EQ(out[0].timestamp, 12);
+    EXPECT_EQ(out[n - 1].timestamp, TREADMILL_DELTA_RING_SIZE + 10);
+}
+
+TEST(SharedMemory, DeltaCursorFollowsWriterRestart)
+{
+    TreadmillSharedData d;
+    TreadmillSharedInit(&d, 1000);
+    SharedRingCursor cursor;
+    TreadmillDeltaCursorInit(&d, &cursor);
+    WriteDeltas(&d, 1, 20);
+
+    TreadmillDelta out[32];
+    EXPECT_EQ(TreadmillDeltaRead(&d, &cursor, out, 32), 20u);
+
+    TreadmillSharedInit(&d, 1000);
+    WriteDeltas(&d, 100, 2);
+    EXPECT_EQ(TreadmillDeltaRead(&d, &cursor, out, 32), 0u);    // resynced to head 2
+    WriteDeltas(&d, 102, 1);
+    ASSERT_EQ(TreadmillDeltaRead(&d, &cursor, out, 32), 1u);
+    EXPECT_EQ(out[0].timestamp, 102);
+}
+
+TEST(SharedMemory, StressDeltaRingNoTornEntries)
+{
+    TreadmillSharedData d;
+    TreadmillSharedInit(&d, 1000);
+    std::atomic<bool> stop{false};
+    std::atomic<int64_t> written{0};
+    std::thread writer([&] {
+        int64_t ts = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            TreadmillDelta delta = DeltaFor(++ts);
+            TreadmillDeltaWrite(&d, &delta, 1);
+        }
+        written.store(ts);
+    });
+
+    // Small reads and the odd yield make readers fall behind and lap
+    const int kReaders = 3;
+    const int kReads   = 20000;
+    std::vector<std::thread> readers;
+    std::atomic<int> torn{0}, gaps{0};
+
+    for (int r = 0; r < kReaders; r++) {
+        readers.emplace_back([&, r] {
+            SharedRingCursor cursor = {};
+            TreadmillDelta out[64];
+            int64_t expected = 1;
+            for (int i = 0; i < kReads; i++) {
+                uint64_t lostBefore = cursor.lost;
+                uint32_t n = TreadmillDeltaRead(&d, &cursor, out, 16 + 16 * r);
+                expected += (int64_t)(cursor.lost - lostBefore);
+                for (uint32_t k = 0; k < n; k++) {
+                    TreadmillDelta want = DeltaFor(out[k].timestamp);
+                    if (out[k].dx != want.dx || out[k].dy != want.dy) torn.fetch_add(1);
+                    if (out[k].timestamp != expected) gaps.fetch_add(1);
+                    expected = out[k].timestamp + 1;
+                }
+                if (i % 1000 == 0) std::this_thread::yield();
+            }
+        });
+    }
+
+    for (auto& t : readers) t.join();
+    stop.store(true);
+    writer.join();
+
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_EQ(gaps.load(), 0);
+    EXPECT_GT(written.load(), 0);
+}
@@ -0,0 +1,271 @@
+// ═══════════════════════════════════════════════════════════════════
+// SPMC shared ring — cursor, overrun and multi-reader stress tests
+// ═══════════════════════════════════════════════════════════════════
+
+#include "shared_ring.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Self-checking entry: a torn copy fails Valid()
+struct Entry {
+    uint64_t    seq;
+    uint64_t    check;
+    uint64_t    pad;
+
+    static Entry Make(uint64_t seq) { return { seq, seq * 0x9E3779B97F4A7C15ull, ~seq }; }
+    bool Valid() const { return check == seq * 0x9E3779B97F4A7C15ull && pad == ~seq; }
+};
+
+typedef SharedRing<Entry, 8>    SmallRing;
+typedef SharedRing<Entry, 1024> StressRing;
+
+template <typename Ring>
+std::unique_ptr<Ring> NewRing()
+{
+    std::unique_ptr<Ring> r(new Ring);
+    SharedRingReset(r.get());
+    return r;
+}
+
+template <typename Ring>
+void WriteSeq(Ring* r, uint64_t first, uint64_t count)
+{
+    for (uint64_t i = 0; i < count; i++) {
+        Entry e = Entry::Make(first + i);
+        SharedRingWrite(r, &e, 1);
+    }
+}
+
+// What one consumer saw: every entry checked for tearing and order,
+// skips reconciled against cursor.lost
+struct ReaderResult {
+    uint64_t    seen   = 0;
+    uint64_t    lost   = 0;
+    int         torn   = 0;
+    int         gaps   = 0;
+};
+
+template <typename Ring>
+void Consume(const Ring* r, SharedRingCursor* cursor, uint64_t* expected, ReaderResult* res, uint32_t max)
+{
+    Entry out[64];
+    uint64_t lostBefore = cursor->lost;
+    uint32_t n = SharedRingRead(r, cursor, out, max < 64 ? max : 64);
+    *expected += cursor->lost - lostBefore;
+    for (uint32_t i = 0; i < n; i++) {
+        if (!out[i].Valid()) res->torn++;
+        if (out[i].seq != *expected) res->gaps++;
+        *expected = out[i].seq + 1;
+    }
+    res->seen += n;
+    res->lost  = cursor->lost;
+}
+
+} // namespace
+
+// ─── Layout ─────────────────────────────────────────────────────
+
+TEST(SharedRing, HeadIsAloneOnItsCacheLine)
+{
+    EXPECT_EQ(alignof(StressRing), (size_t)SHARED_RING_CACHE_LINE);
+    EXPECT_EQ(offsetof(StressRing, slots), (size_t)SHARED_RING_CACHE_LINE);
+    EXPECT_EQ(sizeof(StressRing), SHARED_RING_CACHE_LINE + 1024 * sizeof(Entry));
+}
+
+// ─── Single Thread ──────────────────────────────────────────────
+
+TEST(SharedRing, CursorStartsAtHead)
+{
+    auto r = NewRing<SmallRing>();
+    WriteSeq(r.get(), 0, 3);
+
+    SharedRingCursor c;
+    SharedRingCursorInit(r.get(), &c);
+    EXPECT_EQ(SharedRingPending(r.get(), &c), 0u);
+
+    WriteSeq(r.get(), 3, 2);
+    EXPECT_EQ(SharedRingPending(r.get(), &c), 2u);
+
+    Entry out[8];
+    ASSERT_EQ(SharedRingRead(r.get(), &c, out, 8), 2u);
+    EXPECT_EQ(out[0].seq, 3u);
+    EXPECT_EQ(out[1].seq, 4u);
+    EXPECT_TRUE(out[1].Valid());
+}
+
+TEST(SharedRing, ConsumersAreIndependent)
+{
+    auto r = NewRing<SmallRing>();
+    SharedRingCursor a, b;
+    SharedRingCursorInit(r.get(), &a);
+    SharedRingCursorInit(r.get(), &b);
+    WriteSeq(r.get(), 0, 4);
+
+    Entry out[8];
+    EXPECT_EQ(SharedRingRead(r.get(), &a, out, 8), 4u);
+    EXPECT_EQ(SharedRingRead(r.get(), &a, out, 8), 0u);
+
+    // b has not read anything yet; a's read took nothing from it
+    ASSERT_EQ(SharedRingRead(r.get(), &b, out, 2), 2u);
+    EXPECT_EQ(out[0].seq, 0u);
+    ASSERT_EQ(SharedRingRead(r.get(), &b, out, 8), 2u);
+    EXPECT_EQ(out[1].seq, 3u);
+}
+
+TEST(SharedRing, LappedConsumerSkipsToTheNewestWindow)
+{
+    auto r = NewRing<SmallRing>();
+    SharedRingCursor c;
+    SharedRingCursorInit(r.get(), &c);
+    WriteSeq(r.get(), 0, 20);
+
+    // Size 8: the newest 7 are readable, 13 are lost
+    Entry out[8];
+    ASSERT_EQ(SharedRingRead(r.get(), &c, out, 8), 7u);
+    EXPECT_EQ(c.lost, 13u);
+    EXPECT_EQ(out[0].seq, 13u);
+    EXPECT_EQ(out[6].seq, 19u);
+}
+
+TEST(SharedRing, ProducerRestartMovesCursorBack)
+{
+    auto r = NewRing<SmallRing>();
+    SharedRingCursor c;
+    SharedRingCursorInit(r.get(), &c);
+    WriteSeq(r.get(), 0, 5);
+
+    Entry out[8];
+    EXPECT_EQ(SharedRingRead(r.get(), &c, out, 8), 5u);
+
+    SharedRingReset(r.get());
+    WriteSeq(r.get(), 100, 1);
+    EXPECT_EQ(SharedRingRead(r.get(), &c, out, 8), 0u);
+    WriteSeq(r.get(), 101, 1);
+    ASSERT_EQ(SharedRingRead(r.get(), &c, out, 8), 1u);
+    EXPECT_EQ(out[0].seq, 101u);
+}
+
+// ─── Multi-threaded ─────────────────────────────────────────────
+
+// 8 kHz producer, readers polling at ~1 kHz: no reader may lose, tear
+// or reorder anything while it keeps up with a 1024-entry (128 ms) ring.
+TEST(SharedRing, Producer8kHzWithPollingReaders)
+{
+    auto r = NewRing<StressRing>();
+    const uint64_t kTotal  = 4000;                                   // 0.5 s
+    const auto     kPeriod = std::chrono::nanoseconds(1000000000 / 8000);
+
+    const int kReaders = 4;
+    std::vector<ReaderResult> results(kReaders);
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < kReaders; i++) {
+        readers.emplace_back([&, i] {
+            SharedRingCursor c = {};
+            uint64_t expected = 0;
+            while (!done.load(std::memory_order_acquire)) {
+                Consume(r.get(), &c, &expected, &results[i], 64);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            while (SharedRingPending(r.get(), &c)) Consume(r.get(), &c, &expected, &results[i], 64);
+        });
+    }
+
+    std::thread producer([&] {
+        auto next = std::chrono::steady_clock::now();
+        for (uint64_t seq = 0; seq < kTotal; seq++) {
+            next += kPeriod;
+            while (std::chrono::steady_clock::now() < next) std::this_thread::yield();
+            Entry e = Entry::Make(seq);
+            SharedRingWrite(r.get(), &e, 1);
+        }
+    });
+    producer.join();
+    done.store(true, std::memory_order_release);
+    for (auto& t : readers) t.join();
+
+    for (const ReaderResult& res : results) {
+        EXPECT_EQ(res.torn, 0);
+        EXPECT_EQ(res.gaps, 0);
+        EXPECT_EQ(res.seen + res.lost, kTotal);
+        EXPECT_EQ(res.lost, 0u);
+    }
+}
+
+// A reader that stalls longer than the ring loses the overwritten
+// entries, and only those — the others still arrive intact and in order.
+TEST(SharedRing, StalledReaderAccountsForEveryLoss)
+{
+    auto r = NewRing<StressRing>();
+    const uint64_t kTotal = 4000;
+
+    ReaderResult res;
+    SharedRingCursor c = {};
+    uint64_t expected = 0;
+    std::atomic<uint64_t> written{0};
+
+    std::thread producer([&] {
+        auto next = std::chrono::steady_clock::now();
+        for (uint64_t seq = 0; seq < kTotal; seq++) {
+            next += std::chrono::nanoseconds(125000);
+            while (std::chrono::steady_clock::now() < next) std::this_thread::yield();
+            Entry e = Entry::Make(seq);
+            SharedRingWrite(r.get(), &e, 1);
+            written.store(seq + 1, std::memory_order_release);
+        }
+    });
+
+    while (written.load(std::memory_order_acquire) < 100) std::this_thread::yield();
+    Consume(r.get(), &c, &expected, &res, 64);
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));      // ~2000 entries, two rings
+    producer.join();
+    while (SharedRingPending(r.get(), &c)) Consume(r.get(), &c, &expected, &res, 64);
+
+    EXPECT_EQ(res.torn, 0);
+    EXPECT_EQ(res.gaps, 0);
+    EXPECT_GT(res.lost, 0u);
+    EXPECT_EQ(res.seen + res.lost, kTotal);
+}
+
+// Free-running producer over an 8-entry ring: readers are lapped
+// constantly, so this is the torn-copy detection under fire.
+TEST(SharedRing, StressLappedReadersNeverSeeTornEntries)
+{
+    auto r = NewRing<SmallRing>();
+    std::atomic<bool> stop{false};
+    std::thread producer([&] {
+        uint64_t seq = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            Entry e = Entry::Make(seq++);
+            SharedRingWrite(r.get(), &e, 1);
+        }
+    });
+
+    const int kReaders = 3;
+    std::vector<ReaderResult> results(kReaders);
+    std::vector<std::thread> readers;
+    for (int i = 0; i < kReaders; i++) {
+        readers.emplace_back([&, i] {
+            SharedRingCursor c = {};
+            uint64_t expected = 0;
+            for (int k = 0; k < 200000; k++) Consume(r.get(), &c, &expected, &results[i], 2 + i * 3);
+        });
+    }
+    for (auto& t : readers) t.join();
+    stop.store(true);
+    producer.join();
+
+    for (const ReaderResult& res : results) {
+        EXPECT_EQ(res.torn, 0);
+        EXPECT_EQ(res.gaps, 0);
+        EXPECT_GT(res.seen, 0u);
+    }
+}
@@ -0,0 +1,160 @@
+// ═══════════════════════════════════════════════════════════════════
+// Startup trace tests
+// ═══════════════════════════════════════════════════════════════════
+
+#include "startup_trace.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::string Format(const StartupTrace* t, int64_t frequency)
+{
+    std::vector<char> buf(STARTUP_TRACE_MAX_PHASES * 256);
+    size_t n = StartupTraceFormat(t, frequency, 7, buf.data(), buf.size());
+    return std::string(buf.data(), n);
+}
+
+size_t Count(const std::string& s, const std::string& what)
+{
+    size_t n = 0;
+    for (size_t at = s.find(what); at != std::string::npos; at = s.find(what, at + 1)) n++;
+    return n;
+}
+
+} // namespace
+
+TEST(StartupTrace, FormatsCompleteEventsInMicroseconds)
+{
+    auto t = std::make_unique<StartupTrace>();
+
+    // 1 MHz clock: ticks are microseconds
+    int outer = StartupTraceBegin(t.get(), "xrCreateApiLayerInstance", 11, 1000);
+    int inner = StartupTraceBegin(t.get(), "next xrCreateApiLayerInstance", 11, 1010);
+    StartupTraceEnd(t.get(), inner, 1040);
+    StartupTraceEnd(t.get(), outer, 1050);
+
+    EXPECT_EQ(Format(t.get(), 1000000),
+              "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"
+              "{\"name\":\"xrCreateApiLayerInstance\",\"cat\":\"startup\",\"ph\":\"X\","
+              "\"ts\":0.000,\"dur\":50.000,\"pid\":7,\"tid\":11},\n"
+              "{\"name\":\"next xrCreateApiLayerInstance\",\"cat\":\"startup\",\"ph\":\"X\","
+              "\"ts\":10.000,\"dur\":30.000,\"pid\":7,\"tid\":11}\n"
+              "]}\n");
+}
+
+TEST(StartupTrace, ScalesByClockFrequency)
+{
+    auto t = std::make_unique<StartupTrace>();
+    StartupTraceEnd(t.get(), StartupTraceBegin(t.get(), "a", 1, 500), 500 + 25);   // 25 ns at 1 GHz
+
+    std::string json = Format(t.get(), 1000000000);
+    EXPECT_NE(json.find("\"dur\":0.025"), std::string::npos) << json;
+}
+
+TEST(StartupTrace, SkipsOpenPhases)
+{
+    auto t = std::make_unique<StartupTrace>();
+    int open   = StartupTraceBegin(t.get(), "open", 1, 100);
+    int closed = StartupTraceBegin(t.get(), "closed", 1, 200);
+    StartupTraceEnd(t.get(), closed, 300);
+
+    std::string json = Format(t.get(), 1000000);
+    EXPECT_EQ(json.find("\"open\""), std::string::npos);
+    EXPECT_NE(json.find("\"closed\",\"cat\":\"startup\",\"ph\":\"X\",\"ts\":0.000"), std::string::npos) << json;
+
+    EXPECT_EQ(StartupTraceDuration(t.get(), "open"), -1);
+    EXPECT_EQ(StartupTraceDuration(t.get(), "closed"), 100);
+    EXPECT_EQ(StartupTraceDuration(t.get(), "missing"), -1);
+    StartupTraceEnd(t.get(), open, 400);
+    EXPECT_EQ(StartupTraceDuration(t.get(), "open"), 300);
+}
+
+TEST(StartupTrace, EmptyTraceIsValid)
+{
+    auto t = std::make_unique<StartupTrace>();
+    EXPECT_EQ(Format(t.get(), 1000000), "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n]}\n");
+}
+
+TEST(StartupTrace, DropsPhasesWhenFull)
+{
+    auto t = std::make_unique<StartupTrace>();
+    for (int i = 0; i < STARTUP_TRACE_MAX_PHASES; i++)
+        StartupTraceEnd(t.get(), StartupTraceBegin(t.get(), "p", 1, 10 + i), 20 + i);
+
+    int extra = StartupTraceBegin(t.get(), "extra", 1, 100);
+    EXPECT_EQ(extra, -1);
+    StartupTraceEnd(t.get(), extra, 200);       // ignored
+    EXPECT_EQ(Count(Format(t.get(), 1000000), "\"ph\":\"X\""), (size_t)STARTUP_TRACE_MAX_PHASES);
+}
+
+TEST(StartupTrace, FailsOnShortBuffer)
+{
+    auto t = std::make_unique<StartupTrace>();
+    StartupTraceEnd(t.get(), StartupTraceBegin(t.get(), "phase", 1, 0), 10);
+
+    std::string full = Format(t.get(), 1000000);
+    std::vector<char> buf(full.size());         // no room for the NUL
+    EXPECT_EQ(StartupTraceFormat(t.get(), 1000000, 7, buf.data(), buf.size()), 0u);
+    buf.resize(full.size() + 1);
+    EXPECT_EQ(StartupTraceFormat(t.get(), 1000000, 7, buf.data(), buf.size()), full.size());
+}
+
+TEST(StartupTrace, ResetForgetsPhases)
+{
+    auto t = std::make_unique<StartupTrace>();
+    StartupTraceEnd(t.get(), StartupTraceBegin(t.get(), "first instance", 1, 10), 20);
+    StartupTraceBegin(t.get(), "never closed", 1, 30);
+    StartupTraceReset(t.get(), 0);
+
+    StartupTraceBegin(t.get(), "second instance", 1, 40);     // reuses slot 0, still open
+    std::string json = Format(t.get(), 1000000);
+    EXPECT_EQ(json.find("first instance"), std::string::npos);
+    EXPECT_EQ(json.find("second instance"), std::string::npos);
+    EXPECT_EQ(json.find("never closed"), std::string::npos);
+}
+
+TEST(StartupTrace, ResetKeepsLeadingPhases)
+{
+    auto t = std::make_unique<StartupTrace>();
+    StartupTraceEnd(t.get(), StartupTraceBegin(t.get(), "negotiate", 1, 10), 20);
+    StartupTraceEnd(t.get(), StartupTraceBegin(t.get(), "first instance", 1, 30), 40);
+    StartupTraceReset(t.get(), 1);
+
+    StartupTraceEnd(t.get(), StartupTraceBegin(t.get(), "second instance", 1, 50), 60);
+    std::string json = Format(t.get(), 1000000);
+    EXPECT_NE(json.find("\"negotiate\",\"cat\":\"startup\",\"ph\":\"X\",\"ts\":0.000"), std::string::npos) << json;
+    EXPECT_EQ(json.find("first instance"), std::string::npos);
+    EXPECT_NE(json.find("\"second instance\",\"cat\":\"startup\",\"ph\":\"X\",\"ts\":40.000"), std::string::npos) << json;
+
+    StartupTraceReset(t.get(), 5);              // more than recorded: keeps what there is
+    EXPECT_EQ(t->count.load(), 2u);
+}
+
+TEST(StartupTrace, ConcurrentPhasesGetDistinctSlots)
+{
+    auto t = std::make_unique<StartupTrace>();
+    const int kThreads = 4, kPerThread = STARTUP_TRACE_MAX_PHASES / kThreads;
+
+    std::vector<std::thread> threads;
+    for (int k = 0; k < kThreads; k++) {
+        threads.emplace_back([&, k] {
+            for (int i = 0; i < kPerThread; i++) {
+                int idx = StartupTraceBegin(t.get(), "worker", (uint32_t)k, 100);
+                ASSERT_GE(idx, 0);
+                StartupTraceEnd(t.get(), idx, 200);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    std::string json = Format(t.get(), 1000000);
+    EXPECT_EQ(Count(json, "\"ph\":\"X\""), (size_t)STARTUP_TRACE_MAX_PHASES);
+    for (int k = 0; k < kThreads; k++)
+        EXPECT_EQ(Count(json, "\"tid\":" + std::to_string(k) + "}"), (size_t)kPerThread);
+}
@@ -0,0 +1,147 @@
+// ═══════════════════════════════════════════════════════════════════
+// Tracked action snapshot — publication, reclamation and stress tests
+// ═══════════════════════════════════════════════════════════════════
+
+#include "tracked_actions.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+uintptr_t Key(uint32_t writer, uint32_t i) { return 0x10000u * (writer + 1) + i + 1; }
+
+} // namespace
+
+TEST(TrackedActions, EmptyStateFallsBack)
+{
+    TrackedActionsState s = {};
+    const TrackedActions* t = TrackedActionsAcquire(&s);
+    EXPECT_EQ(t, nullptr);
+    EXPECT_TRUE(TrackedActionsFallback(t));
+    EXPECT_FALSE(TrackedActionsHasVec2f(t, 1));
+    EXPECT_FALSE(TrackedActionsHasFloat(t, 1));
+}
+
+TEST(TrackedActions, PublishGrowsTheUnion)
+{
+    TrackedActionsState s = {};
+    TrackedBinding a[] = { { 1, 0x21 }, { 2, 0x21 } };
+    TrackedBinding b[] = { { 3, 0x103 } };
+    ASSERT_TRUE(TrackedActionsPublish(&s, a, 2, NULL, 0, true));
+    const TrackedActions* first = TrackedActionsAcquire(&s);
+
+    ASSERT_TRUE(TrackedActionsPublish(&s, b, 1, b, 1, false));
+    const TrackedActions* t = TrackedActionsAcquire(&s);
+
+    EXPECT_NE(t, first);
+    EXPECT_TRUE(TrackedActionsHasVec2f(t, 1));
+    EXPECT_TRUE(TrackedActionsHasVec2f(t, 3));
+    EXPECT_TRUE(TrackedActionsHasFloat(t, 3));
+    EXPECT_FALSE(TrackedActionsHasFloat(t, 1));
+    EXPECT_FALSE(TrackedActionsFallback(t));    // sticky once matched
+
+    // Targets survive the copy into the grown set
+    EXPECT_EQ(TrackedActionsVec2fTarget(t, 1), 0x21u);
+    EXPECT_EQ(TrackedActionsVec2fTarget(t, 3), 0x103u);
+    EXPECT_EQ(TrackedActionsFloatTarget(t, 3), 0x103u);
+    EXPECT_EQ(TrackedActionsFloatTarget(t, 1), 0u);
+
+    // The replaced snapshot is untouched and still readable
+    EXPECT_TRUE(TrackedActionsHasVec2f(first, 2));
+    EXPECT_FALSE(TrackedActionsHasVec2f(first, 3));
+
+    TrackedActionsReclaimAll(&s);
+}
+
+TEST(TrackedActions, NothingToPublishKeepsSnapshot)
+{
+    TrackedActionsState s = {};
+    ASSERT_TRUE(TrackedActionsPublish(&s, NULL, 0, NULL, 0, false));
+    EXPECT_EQ(TrackedActionsAcquire(&s), nullptr);
+}
+
+TEST(TrackedActions, ClearDefersReclamationOneGeneration)
+{
+    TrackedActionsState s = {};
+    TrackedBinding a[] = { { 7, 1 } };
+    ASSERT_TRUE(TrackedActionsPublish(&s, a, 1, NULL, 0, true));
+    const TrackedActions* old = TrackedActionsAcquire(&s);
+
+    TrackedActionsClear(&s);
+    EXPECT_EQ(TrackedActionsAcquire(&s), nullptr);
+    ASSERT_NE(s.reclaimPending, nullptr);
+    EXPECT_TRUE(TrackedActionsHasVec2f(old, 7));    // straggler still valid
+
+    TrackedActionsClear(&s);                        // next generation frees it
+    EXPECT_EQ(s.reclaimPending, nullptr);
+    TrackedActionsReclaimAll(&s);
+}
+
+// Several writers publish disjoint keys one at a time while readers
+// check every snapshot they see: each writer's keys must appear as a
+// prefix (no snapshot ever loses an earlier publish), and nothing may
+// be lost once all writers finish.
+TEST(TrackedActions, StressConcurrentWritersAndReaders)
+{
+    const uint32_t kWriters = 4;
+    const uint32_t kKeys    = 300;
+    const int      kReaders = 6;
+
+    TrackedActionsState s = {};
+    std::atomic<bool> done{false};
+    std::atomic<int>  violations{0};
+    std::atomic<long> reads{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < kReaders; r++) {
+        readers.emplace_back([&, r] {
+            uint32_t probe = (uint32_t)r;
+            while (!done.load(std::memory_order_acquire)) {
+                const TrackedActions* t = TrackedActionsAcquire(&s);
+                for (uint32_t w = 0; w < kWriters; w++) {
+                    // Find the highest key from this writer, then require all below it
+                    uint32_t hi = 0;
+                    for (uint32_t i = kKeys; i > 0; i--) {
+                        if (TrackedActionsHasVec2f(t, Key(w, i - 1))) { hi = i; break; }
+                    }
+                    probe = probe * 1103515245u + 12345u;
+                    if (hi && !TrackedActionsHasVec2f(t, Key(w, probe % hi))) violations.fetch_add(1);
+                    if (hi && !TrackedActionsHasFloat(t, Key(w, probe % hi))) violations.fetch_add(1);
+                }
+                reads.fetch_add(1, std::memory_order_relaxed);
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    std::vector<std::thread> writers;
+    for (uint32_t w = 0; w < kWriters; w++) {
+        writers.emplace_back([&, w] {
+            for (uint32_t i = 0; i < kKeys; i++) {
+                TrackedBinding k = { Key(w, i), 1 };
+                EXPECT_TRUE(TrackedActionsPublish(&s, &k, 1, &k, 1, true));
+            }
+        });
+    }
+    for (auto& t : writers) t.join();
+    done.store(true, std::memory_order_release);
+    for (auto& t : readers) t.join();
+
+    EXPECT_EQ(violations.load(), 0);
+    EXPECT_GT(reads.load(), 0);
+
+    const TrackedActions* t = TrackedActionsAcquire(&s);
+    for (uint32_t w = 0; w < kWriters; w++) {
+        for (uint32_t i = 0; i < kKeys; i++) {
+            ASSERT_TRUE(TrackedActionsHasVec2f(t, Key(w, i))) << "lost update w=" << w << " i=" << i;
+            ASSERT_TRUE(TrackedActionsHasFloat(t, Key(w, i)));
+        }
+    }
+    EXPECT_EQ(t->vec2f->count, kWriters * kKeys);
+
+    TrackedActionsReclaimAll(&s);
+}
@@ -0,0 +1,162 @@
+// ═══════════════════════════════════════════════════════════════════
+// Unit tests for velocity_predictor.h
+// ═══════════════════════════════════════════════════════════════════
+
+#include "velocity_predictor.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+const int64_t kMs = 1000000;    // ns ticks, as on POSIX
+
+VelocityPredictor Predictor(int mode)
+{
+    VelocityPredictor p;
+    p.mode            = mode;
+    p.windowTicks     = 50 * kMs;
+    p.maxHorizonTicks = 50 * kMs;
+    return p;
+}
+
+// Samples of `f(t)` every `stepMs`, ending at t = 0
+template <typename F>
+VelocityHistory Sampled(F f, int count, int64_t stepMs)
+{
+    VelocityHistory h = {};
+    for (int i = count - 1; i >= 0; i--) {
+        int64_t t = -i * stepMs * kMs;
+        VelocityHistoryPush(&h, t, f(t));
+    }
+    return h;
+}
+
+float Ramp(int64_t t)      { return 0.3f + 5.0f * (float)t / 1e9f; }                  // 5 /s
+float Parabola(int64_t t)  { double s = (double)t / 1e9; return (float)(0.4 + 2.0 * s + 30.0 * s * s); }
+
+} // namespace
+
+TEST(VelocityPredictor, EmptyHistoryIsZero)
+{
+    VelocityHistory h = {};
+    VelocityPredictor p = Predictor(PREDICT_LINEAR);
+    EXPECT_EQ(VelocityPredict(&h, &p, 10 * kMs), 0.0f);
+    EXPECT_EQ(VelocityHistoryNewest(&h), 0.0f);
+}
+
+TEST(VelocityPredictor, SingleSampleIsHeld)
+{
+    VelocityHistory h = {};
+    VelocityHistoryPush(&h, 0, 0.4f);
+    VelocityPredictor p = Predictor(PREDICT_ACCEL);
+    EXPECT_FLOAT_EQ(VelocityPredict(&h, &p, 10 * kMs), 0.4f);
+}
+
+TEST(VelocityPredictor, OffReturnsNewest)
+{
+    VelocityHistory h = Sampled(Ramp, 4, 10);
+    VelocityPredictor p = Predictor(PREDICT_OFF);
+    EXPECT_FLOAT_EQ(VelocityPredict(&h, &p, 20 * kMs), Ramp(0));
+}
+
+TEST(VelocityPredictor, LinearIsExactOnRamp)
+{
+    VelocityHistory h = Sampled(Ramp, 5, 10);
+    VelocityPredictor p = Predictor(PREDICT_LINEAR);
+    EXPECT_NEAR(VelocityPredict(&h, &p, 20 * kMs), Ramp(20 * kMs), 1e-5);
+}
+
+TEST(VelocityPredictor, AccelIsExactOnParabola)
+{
+    VelocityHistory h = Sampled(Parabola, 5, 10);
+    VelocityPredictor p = Predictor(PREDICT_ACCEL);
+    EXPECT_NEAR(VelocityPredict(&h, &p, 20 * kMs), Parabola(20 * kMs), 1e-4);
+
+    // Linear lags behind the curve
+    VelocityPredictor lin = Predictor(PREDICT_LINEAR);
+    EXPECT_LT(VelocityPredict(&h, &lin, 20 * kMs), Parabola(20 * kMs) - 0.005f);
+}
+
+TEST(VelocityPredictor, AccelWithTwoSamplesFallsBackToLinear)
+{
+    VelocityHistory h = Sampled(Ramp, 2, 10);
+    VelocityPredictor p = Predictor(PREDICT_ACCEL);
+    EXPECT_NEAR(VelocityPredict(&h, &p, 10 * kMs), Ramp(10 * kMs), 1e-5);
+}
+
+TEST(VelocityPredictor, HorizonIsClamped)
+{
+    VelocityHistory h = Sampled(Ramp, 5, 10);
+    VelocityPredictor p = Predictor(PREDICT_LINEAR);
+    EXPECT_NEAR(VelocityPredict(&h, &p, 500 * kMs), Ramp(50 * kMs), 1e-5);
+}
+
+TEST(VelocityPredictor, PastTargetReturnsNewest)
+{
+    VelocityHistory h = Sampled(Ramp, 5, 10);
+    VelocityPredictor p = Predictor(PREDICT_LINEAR);
+    EXPECT_FLOAT_EQ(VelocityPredict(&h, &p, -5 * kMs), Ramp(0));
+}
+
+TEST(VelocityPredictor, ResultStaysInUnitRange)
+{
+    VelocityHistory h = Sampled([](int64_t t) { return 0.9f + 10.0f * (float)t / 1e9f; }, 4, 10);
+    VelocityPredictor p = Predictor(PREDICT_LINEAR);
+    EXPECT_EQ(VelocityPredict(&h, &p, 50 * kMs), 1.0f);
+}
+
+TEST(VelocityPredictor, NeverCrossesZero)
+{
+    VelocityPredictor p = Predictor(PREDICT_LINEAR);
+
+    VelocityHistory slowing = Sampled([](int64_t t) { return 0.05f - 10.0f * (float)t / 1e9f; }, 4, 10);
+    EXPECT_FLOAT_EQ(VelocityPredict(&slowing, &p, 30 * kMs), 0.0f);
+
+    VelocityHistory backing = Sampled([](int64_t t) { return -0.05f + 10.0f * (float)t / 1e9f; }, 4, 10);
+    EXPECT_FLOAT_EQ(VelocityPredict(&backing, &p, 30 * kMs), 0.0f);
+
+    // Starting from a standstill is extrapolated normally
+    VelocityHistory starting = {};
+    VelocityHistoryPush(&starting, -20 * kMs, 0.0f);
+    VelocityHistoryPush(&starting, -10 * kMs, 0.0f);
+    VelocityHistoryPush(&starting, 0, 0.1f);
+    EXPECT_GT(VelocityPredict(&starting, &p, 10 * kMs), 0.1f);
+}
+
+TEST(VelocityPredictor, WindowExcludesOldSamples)
+{
+    // A stale plateau followed by a fresh ramp: only the ramp is fitted
+    VelocityHistory h = {};
+    VelocityHistoryPush(&h, -200 * kMs, 0.9f);
+    VelocityHistoryPush(&h, -150 * kMs, 0.9f);
+    for (int64_t t = -30; t <= 0; t += 10) VelocityHistoryPush(&h, t * kMs, Ramp(t * kMs));
+
+    VelocityPredictor p = Predictor(PREDICT_LINEAR);
+    EXPECT_NEAR(VelocityPredict(&h, &p, 10 * kMs), Ramp(10 * kMs), 1e-5);
+}
+
+TEST(VelocityPredictor, PushIgnoresRepeatsAndReordering)
+{
+    VelocityHistory h = {};
+    VelocityHistoryPush(&h, 10, 0.1f);
+    VelocityHistoryPush(&h, 10, 0.2f);
+    VelocityHistoryPush(&h, 5, 0.3f);
+    EXPECT_EQ(h.count, 1u);
+    EXPECT_FLOAT_EQ(VelocityHistoryNewest(&h), 0.1f);
+
+    for (int i = 0; i < 3 * VELOCITY_HISTORY_SIZE; i++) VelocityHistoryPush(&h, 20 + i, (float)i);
+    EXPECT_EQ(h.count, (uint32_t)VELOCITY_HISTORY_SIZE);
+    EXPECT_FLOAT_EQ(VelocityHistoryNewest(&h), (float)(3 * VELOCITY_HISTORY_SIZE - 1));
+
+    VelocityHistoryReset(&h);
+    EXPECT_EQ(h.count, 0u);
+}
+
+TEST(VelocityPredictor, ParsesModes)
+{
+    EXPECT_EQ(VelocityPredictParseMode("off", PREDICT_LINEAR), PREDICT_OFF);
+    EXPECT_EQ(VelocityPredictParseMode("linear", PREDICT_OFF), PREDICT_LINEAR);
+    EXPECT_EQ(VelocityPredictParseMode("accel", PREDICT_OFF), PREDICT_ACCEL);
+    EXPECT_EQ(VelocityPredictParseMode("bogus", PREDICT_ACCEL), PREDICT_ACCEL);
+    EXPECT_EQ(VelocityPredictParseMode(NULL, PREDICT_LINEAR), PREDICT_LINEAR);
+}
@@ -0,0 +1,212 @@
+// ═══════════════════════════════════════════════════════════════════
+// Velocity trace format tests
+// ═══════════════════════════════════════════════════════════════════
+
+#include "velocity_trace.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace {
+
+// Encodes records into a growing buffer, as the writers do
+struct Writer {
+    std::vector<uint8_t>    data;
+    VelocityTraceEncoder    encoder = {};
+
+    explicit Writer(int64_t start = 1000)
+    {
+        data.resize(sizeof(VelocityTraceFileHeader));
+        EXPECT_EQ(VelocityTraceBegin(&encoder, data.data(), data.size(), 1000000, start, VELOCITY_TRACE_SOURCE_APP),
+                  sizeof(VelocityTraceFileHeader));
+    }
+
+    size_t Add(uint8_t type, uint8_t channel, int64_t timestamp, const void* payload = nullptr, size_t size = 0)
+    {
+        uint8_t record[VELOCITY_TRACE_RECORD_MAX];
+        size_t n = VelocityTraceEncode(&encoder, record, sizeof(record), type, channel, timestamp, payload, size);
+        data.insert(data.end(), record, record + n);
+        return n;
+    }
+};
+
+std::vector<VelocityTraceRecord> ReadAll(const std::vector<uint8_t>& data, bool* truncated = nullptr)
+{
+    VelocityTraceReader reader;
+    if (!VelocityTraceOpen(&reader, data.data(), data.size())) {
+        ADD_FAILURE() << "not a trace";
+        return {};
+    }
+    std::vector<VelocityTraceRecord> out;
+    VelocityTraceRecord rec;
+    while (VelocityTraceNext(&reader, &rec)) out.push_back(rec);
+    if (truncated) *truncated = VelocityTraceTruncated(&reader);
+    return out;
+}
+
+} // namespace
+
+TEST(VelocityTrace, RoundTripsRecords)
+{
+    Writer w;
+    VelocityTraceDelta  delta  = { -3, 17 };
+    VelocityTraceTick   tick   = { 1, -2, 3, 0, 0.5, -0.25, 0.125 };
+    VelocityTraceFrame  frame  = { 0.5f, -0.25f, 0.125f, 42, 123456789 };
+    EXPECT_EQ(w.Add(VELOCITY_TRACE_START, 0, 1000), 8u);
+    EXPECT_EQ(w.Add(VELOCITY_TRACE_DELTA, VELOCITY_TRACE_SENSOR_TURN, 1250, &delta, sizeof(delta)), 16u);
+    EXPECT_EQ(w.Add(VELOCITY_TRACE_TICK, 0, 3000, &tick, sizeof(tick)), 48u);
+    EXPECT_EQ(w.Add(VELOCITY_TRACE_FRAME, 0, 3100, &frame, sizeof(frame)), 32u);
+
+    bool truncated = true;
+    std::vector<VelocityTraceRecord> r = ReadAll(w.data, &truncated);
+    EXPECT_FALSE(truncated);
+    ASSERT_EQ(r.size(), 4u);
+
+    EXPECT_EQ(r[0].type, VELOCITY_TRACE_START);
+    EXPECT_EQ(r[0].timestamp, 1000);
+    EXPECT_EQ(r[0].payloadSize, 0u);
+
+    VelocityTraceDelta d;
+    EXPECT_EQ(r[1].channel, VELOCITY_TRACE_SENSOR_TURN);
+    EXPECT_EQ(r[1].timestamp, 1250);
+    ASSERT_TRUE(VelocityTracePayload(&r[1], &d));
+    EXPECT_EQ(d.dx, -3);
+    EXPECT_EQ(d.dy, 17);
+
+    VelocityTraceTick t;
+    ASSERT_TRUE(VelocityTracePayload(&r[2], &t));
+    EXPECT_EQ(memcmp(&t, &tick, sizeof(t)), 0);
+    EXPECT_EQ(r[2].timestamp, 3000);
+
+    VelocityTraceFrame f;
+    ASSERT_TRUE(VelocityTracePayload(&r[3], &f));
+    EXPECT_EQ(memcmp(&f, &frame, sizeof(f)), 0);
+}
+
+TEST(VelocityTrace, PadsPayloadsToEightBytes)
+{
+    Writer w;
+    uint8_t three[3] = { 1, 2, 3 };
+    EXPECT_EQ(w.Add(200, 0, 1000, three, sizeof(three)), 16u);
+    EXPECT_EQ(w.data.size() % 8, 0u);
+    EXPECT_EQ(w.data.back(), 0);
+}
+
+TEST(VelocityTrace, AcceptsOutOfOrderProducers)
+{
+    // The capture and processing threads may each be slightly behind the other
+    Writer w;
+    w.Add(VELOCITY_TRACE_TICK, 0, 5000);
+    w.Add(VELOCITY_TRACE_DELTA, 0, 4990);
+    w.Add(VELOCITY_TRACE_TICK, 0, 6000);
+
+    std::vector<VelocityTraceRecord> r = ReadAll(w.data);
+    ASSERT_EQ(r.size(), 3u);
+    EXPECT_EQ(r[0].timestamp, 5000);
+    EXPECT_EQ(r[1].timestamp, 4990);
+    EXPECT_EQ(r[2].timestamp, 6000);
+}
+
+TEST(VelocityTrace, BridgesLongGapsWithTimeRecords)
+{
+    Writer w;
+    int64_t far = 1000 + ((int64_t)1 << 40);
+    EXPECT_EQ(w.Add(VELOCITY_TRACE_START, 0, far), 24u);          // TIME + START
+    EXPECT_EQ(w.Add(VELOCITY_TRACE_STOP, 0, far + 7), 8u);
+    EXPECT_EQ(w.Add(VELOCITY_TRACE_STOP, 0, 0), 24u);              // far backwards too
+
+    std::vector<VelocityTraceRecord> r = ReadAll(w.data);
+    ASSERT_EQ(r.size(), 3u);
+    EXPECT_EQ(r[0].type, VELOCITY_TRACE_START);
+    EXPECT_EQ(r[0].timestamp, far);
+    EXPECT_EQ(r[1].timestamp, far + 7);
+    EXPECT_EQ(r[2].timestamp, 0);
+}
+
+TEST(VelocityTrace, EncodeFailsWithoutRoomAndKeepsTheClock)
+{
+    VelocityTraceEncoder e = { 100 };
+    VelocityTraceTick tick = {};
+    uint8_t small[16];
+    EXPECT_EQ(VelocityTraceEncode(&e, small, sizeof(small), VELOCITY_TRACE_TICK, 0, 200, &tick, sizeof(tick)), 0u);
+    EXPECT_EQ(e.last, 100);
+    EXPECT_EQ(VelocityTraceEncode(&e, small, sizeof(small), VELOCITY_TRACE_STOP, 0, 200, NULL, 0), 8u);
+    EXPECT_EQ(e.last, 200);
+}
+
+TEST(VelocityTrace, IgnoresPartialLastRecord)
+{
+    Writer w;
+    VelocityTraceTick tick = {};
+    w.Add(VELOCITY_TRACE_START, 0, 1000);
+    w.Add(VELOCITY_TRACE_TICK, 0, 2000, &tick, sizeof(tick));
+    w.data.resize(w.data.size() - 5);                              // a crash mid-write
+
+    bool truncated = false;
+    std::vector<VelocityTraceRecord> r = ReadAll(w.data, &truncated);
+    EXPECT_TRUE(truncated);
+    ASSERT_EQ(r.size(), 1u);
+    EXPECT_EQ(r[0].type, VELOCITY_TRACE_START);
+}
+
+TEST(VelocityTrace, SkipsUnknownTypesAndExtendsShortPayloads)
+{
+    Writer w;
+    uint64_t future[3] = { 1, 2, 3 };
+    int32_t  oldLoss   = 9;                                         // a payload without its later fields
+    w.Add(250, 4, 1000, future, sizeof(future));
+    w.Add(VELOCITY_TRACE_LOSS, 0, 1001, &oldLoss, sizeof(oldLoss));
+
+    std::vector<VelocityTraceRecord> r = ReadAll(w.data);
+    ASSERT_EQ(r.size(), 2u);
+    EXPECT_EQ(r[0].type, 250);
+    EXPECT_EQ(r[0].payloadSize, sizeof(future));
+
+    VelocityTraceConfig config;
+    ASSERT_TRUE(VelocityTracePayload(&r[1], &config));             // 8 bytes of 40
+    EXPECT_EQ(config.deadZone, 0.0);
+    EXPECT_EQ(config.enabled, 0u);
+
+    VelocityTraceLoss loss;
+    ASSERT_TRUE(VelocityTracePayload(&r[1], &loss));
+    EXPECT_EQ(loss.count, 9u);
+}
+
+TEST(VelocityTrace, RejectsForeignHeaders)
+{
+    Writer w;
+    VelocityTraceReader reader;
+    EXPECT_FALSE(VelocityTraceOpen(&reader, w.data.data(), w.data.size() - 1));
+
+    std::vector<uint8_t> bad = w.data;
+    bad[0] ^= 1;
+    EXPECT_FALSE(VelocityTraceOpen(&reader, bad.data(), bad.size()));
+
+    bad = w.data;
+    bad[4] = VELOCITY_TRACE_VERSION + 1;
+    EXPECT_FALSE(VelocityTraceOpen(&reader, bad.data(), bad.size()));
+
+    bad = w.data;
+    memset(&bad[8], 0, 8);                                          // no clock frequency
+    EXPECT_FALSE(VelocityTraceOpen(&reader, bad.data(), bad.size()));
+
+    EXPECT_TRUE(VelocityTraceOpen(&reader, w.data.data(), w.data.size()));
+    VelocityTraceRecord rec;
+    EXPECT_FALSE(VelocityTraceNext(&reader, &rec));
+    EXPECT_FALSE(VelocityTraceTruncated(&reader));
+}
+
+TEST(VelocityTrace, RejectsMalformedRecordSizes)
+{
+    Writer w;
+    w.Add(VELOCITY_TRACE_START, 0, 1000);
+    VelocityTraceRecordHeader h = { VELOCITY_TRACE_STOP, 0, 12, 0 };   // not a multiple of 8
+    const uint8_t* p = (const uint8_t*)&h;
+    w.data.insert(w.data.end(), p, p + sizeof(h));
+    w.data.insert(w.data.end(), 8, 0);
+
+    bool truncated = false;
+    EXPECT_EQ(ReadAll(w.data, &truncated).size(), 1u);
+    EXPECT_TRUE(truncated);
+}
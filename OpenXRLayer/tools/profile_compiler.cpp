@@ -0,0 +1,59 @@
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Profile Compiler
+// ═══════════════════════════════════════════════════════════════════
+// Compiles per-application profiles from JSON into the binary database
+// the layer maps at instance creation (app_profiles.h):
+//
+//   treadmill_profile_compiler profiles.json profiles.bin
+//
+// Install the output as "profiles.bin" in the layer's log directory,
+// or point TREADMILL_PROFILES at it. The format is documented in
+// profile_compiler.h.
+// ═══════════════════════════════════════════════════════════════════
+
+#include "profile_compiler.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+int main(int argc, char** argv)
+{
+    if (argc != 3) {
+        std::cerr << "usage: " << argv[0] << " <profiles.json> <profiles.bin>\n";
+        return 2;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in) {
+        std::cerr << argv[1] << ": cannot open\n";
+        return 1;
+    }
+    std::stringstream text;
+    text << in.rdbuf();
+
+    std::vector<uint8_t> db;
+    std::string error;
+    if (!profile_compiler::CompileProfiles(text.str(), &db, &error)) {
+        std::cerr << argv[1] << ": " << error << "\n";
+        return 1;
+    }
+
+    // Round-trip through the layer's own validation before writing anything
+    ProfileDb check;
+    if (!ProfileDbOpen(&check, db.data(), db.size())) {
+        std::cerr << "internal error: compiled database fails validation\n";
+        return 1;
+    }
+
+    std::ofstream out(argv[2], std::ios::binary | std::ios::trunc);
+    out.write((const char*)db.data(), (std::streamsize)db.size());
+    if (!out) {
+        std::cerr << argv[2] << ": write failed\n";
+        return 1;
+    }
+
+    std::cout << argv[2] << ": " << check.header->profileCount << " profiles, "
+              << check.header->bindingCount << " bindings, " << db.size() << " bytes\n";
+    return 0;
+}
@@ -0,0 +1,392 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Profile Compiler (JSON → app_profiles.h database)
+// ═══════════════════════════════════════════════════════════════════
+// Offline only: the layer never parses JSON. Used by the command-line
+// tool (profile_compiler.cpp) and by the tests, so both produce the
+// same bytes.
+//
+//   {
+//     "profiles": [
+//       {
+//         "application": "Example Title",          // or "engine": "…"
+//         "scale": { "forward": 1.0, "strafe": 0.8, "turn": 0.5 },
+//         "builtinBindings": false,                 // default true
+//         "bindings": [
+//           { "path": "/user/hand/left/input/trackpad",
+//             "x": "strafe", "y": "forward", "combine": "max" },
+//           { "path": "/user/hand/right/input/trackpad/x", "value": "turn" }
+//         ]
+//       }
+//     ]
+//   }
+//
+// A binding with "x"/"y" applies when the action is queried as a
+// vector2f, one with "value" when it is queried as a float; both may be
+// given. The hand comes from the path. "combine" is "add" (default:
+// add, then clamp) or "max" (the stronger of runtime and treadmill).
+// ═══════════════════════════════════════════════════════════════════
+
+#include "app_profiles.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace profile_compiler {
+
+// ─── JSON ───────────────────────────────────────────────────────
+// Just enough for the profile format: no \u escapes beyond ASCII.
+
+struct Json {
+    enum Type { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT } type = NUL;
+    bool                                        boolean = false;
+    double                                      number  = 0;
+    std::string                                 string;
+    std::vector<Json>                           items;
+    std::vector<std::pair<std::string, Json>>   members;
+
+    const Json* Find(const char* key) const
+    {
+        for (const auto& m : members)
+            if (m.first == key) return &m.second;
+        return nullptr;
+    }
+};
+
+class JsonParser {
+public:
+    JsonParser(const std::string& text) : m_text(text) {}
+
+    bool Parse(Json* out, std::string* error)
+    {
+        if (!Value(out, 0)) {
+            *error = m_error + " at offset " + std::to_string(m_pos);
+            return false;
+        }
+        Skip();
+        if (m_pos != m_text.size()) {
+            *error = "trailing characters at offset " + std::to_string(m_pos);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    bool Fail(const char* what) { m_error = what; return false; }
+
+    void Skip()
+    {
+        while (m_pos < m_text.size()) {
+            char c = m_text[m_pos];
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r') m_pos++;
+            else if (m_text.compare(m_pos, 2, "//") == 0) {         // comments, for hand-written files
+                while (m_pos < m_text.size() && m_text[m_pos] != '\n') m_pos++;
+            }
+            else break;
+        }
+    }
+
+    bool Literal(const char* word)
+    {
+        size_t n = strlen(word);
+        if (m_text.compare(m_pos, n, word) != 0) return false;
+        m_pos += n;
+        return true;
+    }
+
+    bool String(std::string* out)
+    {
+        if (m_text[m_pos] != '"') return Fail("expected string");
+        m_pos++;
+        while (m_pos < m_text.size() && m_text[m_pos] != '"') {
+            char c = m_text[m_pos++];
+            if (c == '\\') {
+                if (m_pos >= m_text.size()) break;
+                char e = m_text[m_pos++];
+                switch (e) {
+                case '"': case '\\': case '/': out->push_back(e); break;
+                case 'n': out->push_back('\n'); break;
+                case 't': out->push_back('\t'); break;
+                case 'u': {
+                    if (m_pos + 4 > m_text.size()) return Fail("bad escape");
+                    long code = strtol(m_text.substr(m_pos, 4).c_str(), nullptr, 16);
+                    if (code <= 0 || code > 0x7F) return Fail("only ASCII \\u escapes are supported");
+                    out->push_back((char)code);
+                    m_pos += 4;
+                    break;
+                }
+                default: return Fail("bad escape");
+                }
+            } else {
+                out->push_back(c);
+            }
+        }
+        if (m_pos >= m_text.size()) return Fail("unterminated string");
+        m_pos++;
+        return true;
+    }
+
+    bool Value(Json* out, int depth)
+    {
+        if (depth > 16) return Fail("nested too deeply");
+        Skip();
+        if (m_pos >= m_text.size()) return Fail("unexpected end");
+
+        char c = m_text[m_pos];
+        if (c == '{') {
+            out->type = Json::OBJECT;
+            m_pos++;
+            Skip();
+            if (m_pos < m_text.size() && m_text[m_pos] == '}') { m_pos++; return true; }
+            for (;;) {
+                Skip();
+                std::pair<std::string, Json> member;
+                if (m_pos >= m_text.size() || !String(&member.first)) return Fail("expected key");
+                Skip();
+                if (m_pos >= m_text.size() || m_text[m_pos] != ':') return Fail("expected ':'");
+                m_pos++;
+                if (!Value(&member.second, depth + 1)) return false;
+                out->members.push_back(std::move(member));
+                Skip();
+                if (m_pos < m_text.size() && m_text[m_pos] == ',') { m_pos++; continue; }
+                if (m_pos < m_text.size() && m_text[m_pos] == '}') { m_pos++; return true; }
+                return Fail("expected ',' or '}'");
+            }
+        }
+        if (c == '[') {
+            out->type = Json::ARRAY;
+            m_pos++;
+            Skip();
+            if (m_pos < m_text.size() && m_text[m_pos] == ']') { m_pos++; return true; }
+            for (;;) {
+                out->items.emplace_back();
+                if (!Value(&out->items.back(), depth + 1)) return false;
+                Skip();
+                if (m_pos < m_text.size() && m_text[m_pos] == ',') { m_pos++; continue; }
+                if (m_pos < m_text.size() && m_text[m_pos] == ']') { m_pos++; return true; }
+                return Fail("expected ',' or ']'");
+            }
+        }
+        if (c == '"') {
+            out->type = Json::STRING;
+            return String(&out->string);
+        }
+        if (Literal("true"))  { out->type = Json::BOOL; out->boolean = true;  return true; }
+        if (Literal("false")) { out->type = Json::BOOL; out->boolean = false; return true; }
+        if (Literal("null"))  { out->type = Json::NUL; return true; }
+
+        const char* begin = m_text.c_str() + m_pos;
+        char* end = nullptr;
+        out->number = strtod(begin, &end);
+        if (end == begin) return Fail("unexpected character");
+        out->type = Json::NUMBER;
+        m_pos += (size_t)(end - begin);
+        return true;
+    }
+
+    const std::string&  m_text;
+    size_t              m_pos = 0;
+    std::string         m_error;
+};
+
+// ─── Compiler ───────────────────────────────────────────────────
+
+inline int AxisByName(const std::string& name)
+{
+    if (name == "forward") return INJECT_AXIS_FORWARD;
+    if (name == "strafe")  return INJECT_AXIS_STRAFE;
+    if (name == "turn")    return INJECT_AXIS_TURN;
+    return -2;
+}
+
+class Compiler {
+public:
+    bool Compile(const std::string& json, std::vector<uint8_t>* out, std::string* error)
+    {
+        Json root;
+        if (!JsonParser(json).Parse(&root, error)) return false;
+
+        const Json* profiles = root.Find("profiles");
+        if (root.type != Json::OBJECT || !profiles || profiles->type != Json::ARRAY)
+            return Fail(error, "top level must be an object with a \"profiles\" array");
+
+        for (size_t i = 0; i < profiles->items.size(); i++) {
+            m_where = "profiles[" + std::to_string(i) + "]";
+            if (!AddProfile(profiles->items[i], error)) return false;
+        }
+
+        // Sorted for ProfileDbFind's binary search; stable so duplicates are reported in file order
+        std::stable_sort(m_profiles.begin(), m_profiles.end(),
+            [](const ProfileDbProfile& a, const ProfileDbProfile& b) {
+                return a.nameHash != b.nameHash ? a.nameHash < b.nameHash : a.matchKind < b.matchKind;
+            });
+        for (size_t i = 1; i < m_profiles.size(); i++) {
+            const ProfileDbProfile& a = m_profiles[i - 1];
+            const ProfileDbProfile& b = m_profiles[i];
+            if (a.nameHash == b.nameHash && a.matchKind == b.matchKind &&
+                ProfileNameEquals(&m_strings[a.name], &m_strings[b.name]))
+                return Fail(error, "duplicate profile \"" + std::string(&m_strings[b.name]) + "\"");
+        }
+
+        m_where.clear();
+        Emit(out);
+        if (out->size() > PROFILE_DB_MAX_SIZE) return Fail(error, "database larger than the layer accepts (1 MiB)");
+        return true;
+    }
+
+private:
+    bool Fail(std::string* error, const std::string& what)
+    {
+        *error = m_where.empty() ? what : m_where + ": " + what;
+        return false;
+    }
+
+    uint32_t Intern(const std::string& s)
+    {
+        auto it = m_stringOffsets.find(s);
+        if (it != m_stringOffsets.end()) return it->second;
+        uint32_t offset = (uint32_t)m_strings.size();
+        m_strings.insert(m_strings.end(), s.begin(), s.end());
+        m_strings.push_back(0);
+        m_stringOffsets.emplace(s, offset);
+        return offset;
+    }
+
+    bool AddProfile(const Json& p, std::string* error)
+    {
+        if (p.type != Json::OBJECT) return Fail(error, "must be an object");
+
+        ProfileDbProfile profile = {};
+        const Json* application = p.Find("application");
+        const Json* engine      = p.Find("engine");
+        const Json* name        = application ? application : engine;
+        if (!name || (application && engine) || name->type != Json::STRING || name->string.empty())
+            return Fail(error, "needs exactly one of \"application\" or \"engine\" (a non-empty string)");
+        if (name->string.size() >= XR_MAX_APPLICATION_NAME_SIZE)
+            return Fail(error, "name longer than an XrApplicationInfo name");
+
+        profile.matchKind = application ? PROFILE_MATCH_APPLICATION : PROFILE_MATCH_ENGINE;
+        profile.nameHash  = ProfileNameHash(name->string.c_str());
+        profile.name      = Intern(name->string);
+        m_where += " \"" + name->string + "\"";
+
+        for (int axis = 0; axis < INJECT_AXIS_COUNT; axis++) profile.scale[axis] = 1.0f;
+        if (const Json* scale = p.Find("scale")) {
+            if (scale->type != Json::OBJECT) return Fail(error, "\"scale\" must be an object");
+            for (const auto& m : scale->members) {
+                int axis = AxisByName(m.first);
+                if (axis < 0) return Fail(error, "unknown scale axis \"" + m.first + "\"");
+                if (m.second.type != Json::NUMBER || !(std::fabs(m.second.number) <= PROFILE_MAX_SCALE))
+                    return Fail(error, "scale \"" + m.first + "\" must be a number within ±10");
+                profile.scale[axis] = (float)m.second.number;
+            }
+        }
+
+        profile.flags = PROFILE_FLAG_BUILTIN;
+        if (const Json* builtin = p.Find("builtinBindings")) {
+            if (builtin->type != Json::BOOL) return Fail(error, "\"builtinBindings\" must be true or false");
+            if (!builtin->boolean) profile.flags = 0;
+        }
+
+        profile.firstBinding = (uint32_t)m_bindings.size();
+        if (const Json* bindings = p.Find("bindings")) {
+            if (bindings->type != Json::ARRAY) return Fail(error, "\"bindings\" must be an array");
+            for (const Json& b : bindings->items)
+                if (!AddBinding(b, error)) return false;
+        }
+        profile.bindingCount = (uint32_t)m_bindings.size() - profile.firstBinding;
+
+        m_profiles.push_back(profile);
+        return true;
+    }
+
+    bool Axis(const Json& b, const char* key, int* axis, std::string* error)
+    {
+        *axis = INJECT_AXIS_NONE;
+        const Json* v = b.Find(key);
+        if (!v) return true;
+        if (v->type != Json::STRING || AxisByName(v->string) < 0)
+            return Fail(error, std::string("\"") + key + "\" must be \"forward\", \"strafe\" or \"turn\"");
+        *axis = AxisByName(v->string);
+        return true;
+    }
+
+    bool AddBinding(const Json& b, std::string* error)
+    {
+        const Json* path = b.Find("path");
+        if (b.type != Json::OBJECT || !path || path->type != Json::STRING)
+            return Fail(error, "each binding needs a \"path\" string");
+
+        int hand;
+        if (path->string.rfind("/user/hand/left/", 0) == 0)       hand = INJECT_HAND_LEFT;
+        else if (path->string.rfind("/user/hand/right/", 0) == 0) hand = INJECT_HAND_RIGHT;
+        else return Fail(error, "path \"" + path->string + "\" is not under /user/hand/left or /user/hand/right");
+
+        int x, y, value;
+        if (!Axis(b, "x", &x, error) || !Axis(b, "y", &y, error) || !Axis(b, "value", &value, error)) return false;
+        if (x == INJECT_AXIS_NONE && y == INJECT_AXIS_NONE && value == INJECT_AXIS_NONE)
+            return Fail(error, "binding \"" + path->string + "\" selects no axis");
+
+        InjectTarget combine = 0;
+        if (const Json* c = b.Find("combine")) {
+            if (c->type != Json::STRING || (c->string != "add" && c->string != "max"))
+                return Fail(error, "\"combine\" must be \"add\" or \"max\"");
+            if (c->string == "max") combine = INJECT_TARGET_COMBINE_MAX;
+        }
+
+        ProfileDbBinding binding = {};
+        binding.path = Intern(path->string);
+        if (x != INJECT_AXIS_NONE || y != INJECT_AXIS_NONE)
+            binding.vec2f = InjectTargetMake(x, y, hand) | combine;
+        if (value != INJECT_AXIS_NONE)
+            binding.floatValue = InjectTargetMake(value, INJECT_AXIS_NONE, hand) | combine;
+        m_bindings.push_back(binding);
+        return true;
+    }
+
+    static size_t Align4(size_t n) { return (n + 3) & ~(size_t)3; }
+
+    void Emit(std::vector<uint8_t>* out)
+    {
+        ProfileDbHeader h = {};
+        h.magic          = PROFILE_DB_MAGIC;
+        h.version        = PROFILE_DB_VERSION;
+        h.headerSize     = sizeof(ProfileDbHeader);
+        h.profileCount   = (uint32_t)m_profiles.size();
+        h.profilesOffset = sizeof(ProfileDbHeader);
+        h.bindingCount   = (uint32_t)m_bindings.size();
+        h.bindingsOffset = h.profilesOffset + h.profileCount * (uint32_t)sizeof(ProfileDbProfile);
+        h.stringsOffset  = h.bindingsOffset + h.bindingCount * (uint32_t)sizeof(ProfileDbBinding);
+        h.stringsSize    = (uint32_t)m_strings.size();
+        h.totalSize      = (uint32_t)Align4(h.stringsOffset + h.stringsSize);
+
+        out->assign(h.totalSize, 0);
+        memcpy(out->data(), &h, sizeof(h));
+        if (!m_profiles.empty())
+            memcpy(out->data() + h.profilesOffset, m_profiles.data(), m_profiles.size() * sizeof(ProfileDbProfile));
+        if (!m_bindings.empty())
+            memcpy(out->data() + h.bindingsOffset, m_bindings.data(), m_bindings.size() * sizeof(ProfileDbBinding));
+        if (!m_strings.empty())
+            memcpy(out->data() + h.stringsOffset, m_strings.data(), m_strings.size());
+    }
+
+    std::vector<ProfileDbProfile>       m_profiles;
+    std::vector<ProfileDbBinding>       m_bindings;
+    std::vector<char>                   m_strings;
+    std::map<std::string, uint32_t>     m_stringOffsets;
+    std::string                         m_where;
+};
+
+// Compiles profile JSON into a database ProfileDbOpen accepts.
+// On failure `error` names the offending profile or JSON offset.
+inline bool CompileProfiles(const std::string& json, std::vector<uint8_t>* out, std::string* error)
+{
+    return Compiler().Compile(json, out, error);
+}
+
+} // namespace profile_compiler
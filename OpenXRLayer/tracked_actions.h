@@ -0,0 +1,171 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Tracked Action Snapshot
+// ═══════════════════════════════════════════════════════════════════
+// Everything xrGetActionState* needs to decide whether and what to
+// inject lives in one immutable TrackedActions snapshot behind a single
+// atomic pointer: each tracked action maps to its InjectTarget
+// (axis_injection.h). Readers do one acquire load and never write shared memory,
+// so any number of game/render threads query without contending.
+//
+// Writers (xrSuggestInteractionProfileBindings) build a grown copy in a
+// private arena and publish it with a compare-exchange, retrying if
+// another writer got there first — no lock on either side. Replaced
+// snapshots are never freed while the instance lives: their arena
+// chunks go onto a retired list.
+//
+// Reclamation: xrDestroyInstance unpublishes the snapshot, but the
+// retired memory is only freed one generation later (next clear, or
+// module unload), so a thread that loaded the pointer just before the
+// destroy still reads valid memory.
+// ═══════════════════════════════════════════════════════════════════
+
+#include "action_set.h"
+
+#include <atomic>
+
+struct TrackedActions {
+    const ActionSet*    vec2f;              // thumbstick vector2f actions → target
+    const ActionSet*    floats;             // thumbstick/x|y float actions → target
+    uint32_t            bindingsReceived;   // any left-thumbstick binding seen
+};
+
+// One action to track and the target stored with it.
+struct TrackedBinding {
+    uintptr_t   action;
+    uint32_t    target;
+};
+
+struct TrackedActionsState {
+    std::atomic<const TrackedActions*>  current;
+    std::atomic<LayerArenaChunk*>       retired;        // backing memory of every published snapshot
+    LayerArenaChunk*                    reclaimPending; // retired by the previous clear
+};
+
+// ─── Readers ────────────────────────────────────────────────────
+
+static inline const TrackedActions* TrackedActionsAcquire(const TrackedActionsState* s)
+{
+    return s->current.load(std::memory_order_acquire);
+}
+
+static inline bool TrackedActionsHasVec2f(const TrackedActions* t, uintptr_t key)
+{
+    return t && ActionSetContains(t->vec2f, key);
+}
+
+static inline bool TrackedActionsHasFloat(const TrackedActions* t, uintptr_t key)
+{
+    return t && ActionSetContains(t->floats, key);
+}
+
+// Target of a tracked action; 0 if untracked.
+static inline uint32_t TrackedActionsVec2fTarget(const TrackedActions* t, uintptr_t key)
+{
+    return t ? ActionSetValue(t->vec2f, key) : 0;
+}
+
+static inline uint32_t TrackedActionsFloatTarget(const TrackedActions* t, uintptr_t key)
+{
+    return t ? ActionSetValue(t->floats, key) : 0;
+}
+
+// Before any left-thumbstick binding has been suggested the layer
+// injects into every left-hand vector2f query.
+static inline bool TrackedActionsFallback(const TrackedActions* t)
+{
+    return !t || !t->bindingsReceived;
+}
+
+// ─── Arena Chunk Lists ──────────────────────────────────────────
+
+static inline void TrackedActionsFreeChunks(LayerArenaChunk* c)
+{
+    while (c) {
+        LayerArenaChunk* next = c->next;
+        free(c);
+        c = next;
+    }
+}
+
+// Moves every chunk of `arena` onto the lock-free `list`.
+static inline void TrackedActionsRetireArena(LayerArena* arena, std::atomic<LayerArenaChunk*>* list)
+{
+    LayerArenaChunk* head = arena->head;
+    if (!head) return;
+
+    LayerArenaChunk* tail = head;
+    while (tail->next) tail = tail->next;
+
+    LayerArenaChunk* old = list->load(std::memory_order_relaxed);
+    do {
+        tail->next = old;
+    } while (!list->compare_exchange_weak(old, head, std::memory_order_release, std::memory_order_relaxed));
+
+    arena->head       = NULL;
+    arena->totalBytes = 0;
+}
+
+// ─── Writers ────────────────────────────────────────────────────
+
+// Publishes a snapshot that adds `vec2f` / `floats` to the current
+// one (an action already tracked keeps its first target); `matched`
+// sets bindingsReceived. Safe to call from several threads at once.
+// Returns false only if out of memory.
+static inline bool TrackedActionsPublish(TrackedActionsState* s,
+                                         const TrackedBinding* vec2f, uint32_t vec2fCount,
+                                         const TrackedBinding* floats, uint32_t floatCount,
+                                         bool matched)
+{
+    if (!vec2fCount && !floatCount && !matched) return true;
+
+    const TrackedActions* cur = s->current.load(std::memory_order_acquire);
+    for (;;) {
+        LayerArena arena = {};
+        TrackedActions* next = (TrackedActions*)LayerArenaAlloc(&arena, sizeof(TrackedActions));
+        if (!next) return false;
+
+        const ActionSet* curVec2f  = cur ? cur->vec2f  : NULL;
+        const ActionSet* curFloats = cur ? cur->floats : NULL;
+
+        next->vec2f  = curVec2f;
+        next->floats = curFloats;
+        if (vec2fCount) {
+            ActionSet* set = ActionSetCreate(&arena, (curVec2f ? curVec2f->count : 0) + vec2fCount, curVec2f);
+            if (!set) { LayerArenaReset(&arena); return false; }
+            for (uint32_t i = 0; i < vec2fCount; i++) ActionSetInsert(set, vec2f[i].action, vec2f[i].target);
+            next->vec2f = set;
+        }
+        if (floatCount) {
+            ActionSet* set = ActionSetCreate(&arena, (curFloats ? curFloats->count : 0) + floatCount, curFloats);
+            if (!set) { LayerArenaReset(&arena); return false; }
+            for (uint32_t i = 0; i < floatCount; i++) ActionSetInsert(set, floats[i].action, floats[i].target);
+            next->floats = set;
+        }
+        next->bindingsReceived = (cur && cur->bindingsReceived) || matched;
+
+        if (s->current.compare_exchange_strong(cur, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            TrackedActionsRetireArena(&arena, &s->retired);
+            return true;
+        }
+        LayerArenaReset(&arena);    // lost the race; `cur` now holds the winner
+    }
+}
+
+// Unpublishes the snapshot (xrDestroyInstance). Memory retired before
+// the *previous* clear is freed now; this generation's is kept until
+// the next clear or TrackedActionsReclaimAll. Not concurrent with writers.
+static inline void TrackedActionsClear(TrackedActionsState* s)
+{
+    s->current.store(NULL, std::memory_order_release);
+    TrackedActionsFreeChunks(s->reclaimPending);
+    s->reclaimPending = s->retired.exchange(NULL, std::memory_order_acq_rel);
+}
+
+// Frees everything (module unload — no reader can be running).
+static inline void TrackedActionsReclaimAll(TrackedActionsState* s)
+{
+    TrackedActionsClear(s);
+    TrackedActionsFreeChunks(s->reclaimPending);
+    s->reclaimPending = NULL;
+}
@@ -1,18 +1,42 @@
 // ═══════════════════════════════════════════════════════════════════
 // Treadmill Driver — OpenXR Implicit API Layer
 // ═══════════════════════════════════════════════════════════════════
-// Intercepts OpenXR input calls and injects treadmill velocity
-// into the left thumbstick Y axis. Reads velocity from a named
+// Intercepts OpenXR input calls and injects treadmill velocity into
+// the thumbsticks: forward on left Y, strafe on left X, turn on right X
+// (axis_injection.h). Reads velocity from a named
 // memory-mapped file written by the WPF companion app.
 //
-// Pure C + Win32 — no STL, no static constructors. v3
+// Every XrInstance gets its own dispatch table, tracked actions and
+// frame state, found by handle (handle_map.h), so overlays and engines
+// that recreate their instance don't disturb each other. The log, the
+// startup trace, telemetry and the shared-memory watcher are
+// process-wide.
+//
+// C++17 without STL containers, strings or heap-allocating library
+// types: state lives in fixed pools and arrays. The lock-free parts use
+// std::atomic; there is a thread_local telemetry slot, small templates
+// (handle_map.h) and RAII scopes (TelemetryScope). Globals are zero-
+// or constant-initialised, so no static constructor does any work. OS
+// services come from layer_platform.h (Win32 or POSIX backend). Reads
+// shared memory protocol v5 (treadmill_shared.h).
 // ═══════════════════════════════════════════════════════════════════
 
 #include "openxr_defs.h"
-
-#define WIN32_LEAN_AND_MEAN
-#include <windows.h>
-#include <shlobj.h>
+#include "treadmill_shared.h"
+#include "tracked_actions.h"
+#include "handle_map.h"
+#include "axis_injection.h"
+#include "app_profiles.h"
+#include "path_cache.h"
+#include "frame_velocity.h"
+#include "layer_log.h"
+#include "startup_trace.h"
+#include "velocity_trace.h"
+#include "layer_telemetry.h"
+#include "proc_table.h"
+#include "layer_platform.h"
+
+#include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -21,198 +45,1214 @@
 #define LAYER_NAME "XR_APILAYER_TREADMILL_driver"
 
 // ─── Debug Log ──────────────────────────────────────────────────
+// Callers only format into the ring in layer_log.h; a background
+// thread writes batches to disk. Level comes from TREADMILL_LAYER_LOG_LEVEL
+// (off/error/warn/info/debug); "off" never opens the file or starts
+// the thread, and every LOG_* call is then a single load and branch.
+//
+// Startup only reads the level and starts buffering (LogStart). The
+// file and the drain thread come later, from the shared-memory watcher
+// (LogOpenFile), so a game's launch never waits on the disk; until
+// then messages wait in the ring.
+
+#define LOG_DRAIN_INTERVAL_MS   50
+
+static std::atomic<int> g_logLevel{LOG_LEVEL_OFF};
+static bool             g_logStarted    = false;    // level read (once per process)
+static PlatformFile     g_logFile       = NULL;
+static PlatformWorker   g_logWorker     = {};
+static LogRing          g_logRing;
+
+#define LAYER_LOG(level, ...) \
+    do { \
+        if ((level) <= LOG_MAX_LEVEL && (level) <= g_logLevel.load(std::memory_order_relaxed)) \
+            LogWrite((level), __VA_ARGS__); \
+    } while (0)
+
+#define LOG_ERROR(...)  LAYER_LOG(LOG_LEVEL_ERROR, __VA_ARGS__)
+#define LOG_WARN(...)   LAYER_LOG(LOG_LEVEL_WARN,  __VA_ARGS__)
+#define LOG_INFO(...)   LAYER_LOG(LOG_LEVEL_INFO,  __VA_ARGS__)
+#define LOG_DEBUG(...)  LAYER_LOG(LOG_LEVEL_DEBUG, __VA_ARGS__)
+
+static void LogWrite(int level, const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    LogRingPushV(&g_logRing, level, PlatformThreadId(), PlatformWallClockUs(), fmt, args);
+    va_end(args);
+}
+
+static void LogSinkFile(void* ctx, const char* data, size_t length)
+{
+    PlatformFileWrite((PlatformFile)ctx, data, length);
+}
+
+// Drain worker only (or after it has exited).
+static void LogDrain(void* ctx)
+{
+    (void)ctx;
+    static char buf[16 * 1024];
+    LogRingDrain(&g_logRing, buf, sizeof(buf), LogSinkFile, g_logFile);
+}
+
+// Negotiation / instance creation: no file system access.
+static void LogStart()
+{
+    if (g_logStarted) return;
+    g_logStarted = true;
+
+    char env[16];
+    bool hasEnv = PlatformGetEnv(LOG_LEVEL_ENV, env, sizeof(env));
+    int level = LogParseLevel(hasEnv ? env : NULL, LOG_LEVEL_DEFAULT);
+    if (level == LOG_LEVEL_OFF) return;
+
+    LogRingInit(&g_logRing);
+    g_logLevel.store(level, std::memory_order_release);
+}
+
+// Watcher thread, or xrDestroyInstance after it has stopped. Creates
+// the file on first use; `drain` also starts the drain worker.
+static void LogOpenFile(bool drain)
+{
+    if (g_logLevel.load(std::memory_order_relaxed) == LOG_LEVEL_OFF) return;
+
+    if (!g_logFile) {
+        char path[512];
+        bool ok = PlatformLogDirectory(path, sizeof(path));
+        if (ok) {
+            size_t dirLen = strlen(path);
+            snprintf(path + dirLen, sizeof(path) - dirLen, "layer_log.txt");
+            g_logFile = PlatformFileCreate(path);
+        }
+        if (!g_logFile) {
+            g_logLevel.store(LOG_LEVEL_OFF, std::memory_order_relaxed);     // nowhere to write
+            return;
+        }
+    }
+
+    // Without a worker the ring is still drained on LogFlush (drops if it overflows)
+    if (drain && !g_logWorker.thread)
+        PlatformWorkerStart(&g_logWorker, LOG_DRAIN_INTERVAL_MS, LogDrain, NULL);
+}
+
+// The last xrDestroyInstance, once the watcher has stopped (service
+// lock): everything so far reaches the file; logging stays on for a
+// later instance, whose watcher restarts the drain worker.
+static void LogFlush()
+{
+    PlatformWorkerStop(&g_logWorker, true);
+    LogOpenFile(false);
+    if (g_logFile) LogDrain(NULL);
+}
+
+// `joinThread` must be false at module unload (Win32 loader lock); by
+// then the drain worker has already exited because it pins the module.
+static void LogClose(bool joinThread)
+{
+    g_logLevel.store(LOG_LEVEL_OFF, std::memory_order_relaxed);
+
+    PlatformWorkerStop(&g_logWorker, joinThread);
+    if (g_logFile) {
+        LogDrain(NULL);
+        PlatformFileClose(g_logFile);
+        g_logFile = NULL;
+    }
+}
+
+// ─── Startup Trace (startup_trace.h) ────────────────────────────
+// Phases of negotiation, instance creation and first use. Written as
+// Chrome trace JSON to $TREADMILL_STARTUP_TRACE by the watcher's first
+// tick (or xrDestroyInstance if the watcher never ran), then reset
+// once the last instance is gone; negotiation happens once per process
+// and is kept at the front of every trace.
 
-static HANDLE g_logFile = INVALID_HANDLE_VALUE;
+#define STARTUP_TRACE_BUFFER    (8 * 1024)
+
+static StartupTrace     g_startupTrace;
+static bool             g_startupTraceWritten   = false;    // watcher, or the last destroy after it
+static uint32_t         g_startupTraceKeep      = 0;        // process-wide phases (negotiation)
+
+static int TraceBegin(const char* phase)
+{
+    return StartupTraceBegin(&g_startupTrace, phase, PlatformThreadId(), PlatformTimestamp());
+}
 
-static void LogOpen()
+static void TraceEnd(int phase)
 {
-    if (g_logFile != INVALID_HANDLE_VALUE) return;
+    StartupTraceEnd(&g_startupTrace, phase, PlatformTimestamp());
+}
 
-    char path[MAX_PATH];
-    if (SUCCEEDED(SHGetFolderPathA(NULL, CSIDL_LOCAL_APPDATA, NULL, 0, path))) {
-        strcat_s(path, "\\TreadmillDriver\\OpenXRLayer\\layer_log.txt");
-        g_logFile = CreateFileA(path, GENERIC_WRITE, FILE_SHARE_READ,
-                                NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+static void WriteStartupTrace()
+{
+    if (g_startupTraceWritten) return;
+    g_startupTraceWritten = true;
+
+    char path[512];
+    if (!PlatformGetEnv(STARTUP_TRACE_ENV, path, sizeof(path))) return;
+
+    static char buf[STARTUP_TRACE_BUFFER];
+    size_t n = StartupTraceFormat(&g_startupTrace, PlatformTimestampFrequency(), 1, buf, sizeof(buf));
+    PlatformFile f = n ? PlatformFileCreate(path) : NULL;
+    if (!f) {
+        LOG_WARN("Startup trace: cannot write %s", path);
+        return;
     }
+    PlatformFileWrite(f, buf, n);
+    PlatformFileClose(f);
+    LOG_INFO("Startup trace written to %s", path);
 }
 
-static void Log(const char* msg)
+// ─── Telemetry (layer_telemetry.h) ──────────────────────────────
+// Counters for the companion's live view. Every intercept counts itself
+// in the calling thread's slot with one relaxed increment; one call in
+// TREADMILL_TELEMETRY_TIME_SAMPLE also reads the clock around itself,
+// less its chained call, to measure the layer's own time. Until first
+// use maps the shared block (or while another game owns it) counts go
+// to a private one; a thread's slot index is kept across the move.
+// The slot index is initial-exec TLS on ELF: the default model for a
+// -fPIC module calls __tls_get_addr on every access, and one uint32_t
+// fits the static TLS glibc reserves for dlopen'd libraries
+// (tests/check_layer_tls.cmake keeps it that way).
+// The lean build (TREADMILL_TELEMETRY=0) compiles all of it out.
+
+#ifndef TREADMILL_TELEMETRY
+#define TREADMILL_TELEMETRY 1
+#endif
+
+#if TREADMILL_TELEMETRY
+
+#if defined(__ELF__)
+#define TELEMETRY_TLS_MODEL __attribute__((tls_model("initial-exec")))
+#else
+#define TELEMETRY_TLS_MODEL
+#endif
+
+static TreadmillTelemetry               g_telemetryPrivate;
+static std::atomic<TreadmillTelemetry*> g_telemetry{&g_telemetryPrivate};
+static std::atomic<uint32_t>            g_telemetryThreads{0};
+static PlatformSharedMemory             g_telemetryMem          = {};   // service lock; mapped until exit
+static thread_local uint32_t            t_telemetrySlot TELEMETRY_TLS_MODEL = 0;   // slot index + 1, 0 = none yet
+
+static TreadmillTelemetry* Telemetry()
 {
-    if (g_logFile == INVALID_HANDLE_VALUE) return;
-    DWORD written;
-    WriteFile(g_logFile, msg, (DWORD)strlen(msg), &written, NULL);
-    WriteFile(g_logFile, "\r\n", 2, &written, NULL);
-    FlushFileBuffers(g_logFile);
+    return g_telemetry.load(std::memory_order_acquire);
 }
 
-static void LogClose()
+// The calling thread's counters in `t`, claiming a slot on its first call.
+static TreadmillTelemetryThread* TelemetryThread(TreadmillTelemetry* t)
+{
+    uint32_t slot = t_telemetrySlot;
+    if (!slot) {
+        slot = g_telemetryThreads.fetch_add(1, std::memory_order_relaxed) % TREADMILL_TELEMETRY_THREADS + 1;
+        t_telemetrySlot = slot;
+        uint32_t none = 0;
+        t->threads[slot - 1].threadId.compare_exchange_strong(none, PlatformThreadId(), std::memory_order_relaxed);
+    }
+    return &t->threads[slot - 1];
+}
+
+// One per intercepted call, on the stack.
+struct TelemetryScope {
+    TreadmillTelemetryThread*   counters;
+    int64_t                     start;          // 0 = this call is not timed
+    int64_t                     paused;         // 0 = running
+
+    explicit TelemetryScope(uint32_t call) : counters(TelemetryThread(Telemetry())), start(0), paused(0)
+    {
+        uint64_t n = counters->calls[call].fetch_add(1, std::memory_order_relaxed);
+        if ((n & (TREADMILL_TELEMETRY_TIME_SAMPLE - 1)) == 0) start = PlatformTimestamp();
+    }
+
+    // A call that returns its chained call's result ends at the pause
+    ~TelemetryScope()
+    {
+        if (!start) return;
+        int64_t end = paused ? paused : PlatformTimestamp();
+        counters->timeTicks.fetch_add((uint64_t)(end - start), std::memory_order_relaxed);
+        counters->timedCalls.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // The chained call's time is the runtime's, not the layer's
+    void Pause()  { if (start) paused = PlatformTimestamp(); }
+    void Resume()
+    {
+        if (!start) return;
+        start += PlatformTimestamp() - paused;
+        paused = 0;
+    }
+};
+
+// First use of the instance that starts the watcher (service lock).
+static void TelemetryOpen()
 {
-    if (g_logFile != INVALID_HANDLE_VALUE) {
-        CloseHandle(g_logFile);
-        g_logFile = INVALID_HANDLE_VALUE;
+    if (g_telemetryMem.view) return;
+
+    PlatformSharedMemory shm = {};
+    if (!PlatformSharedMemoryCreate(&shm, TREADMILL_TELEMETRY_MEM_NAME, sizeof(TreadmillTelemetry))) {
+        LOG_WARN("  Telemetry: cannot create the shared block, counting privately");
+        return;
     }
+
+    TreadmillTelemetry* t    = (TreadmillTelemetry*)shm.view;
+    int64_t             freq = PlatformTimestampFrequency();
+    if (!TreadmillTelemetryClaim(t, PlatformProcessId(), freq, PlatformTimestamp(),
+                                 freq * TREADMILL_TELEMETRY_STALE_MS / 1000)) {
+        LOG_INFO("  Telemetry: block in use by process %u, counting privately", t->processId);
+        PlatformSharedMemoryClose(&shm);
+        return;
+    }
+    TreadmillTelemetryMerge(t, &g_telemetryPrivate);
+    g_telemetryMem = shm;
+    g_telemetry.store(t, std::memory_order_release);
+    LOG_INFO("  Telemetry: publishing to %s", TREADMILL_TELEMETRY_MEM_NAME);
+}
+
+// Once per latched frame.
+static void TelemetryFrame(int64_t now, const float axes[INJECT_AXIS_COUNT])
+{
+    TreadmillTelemetry* t = Telemetry();
+    for (int i = 0; i < INJECT_AXIS_COUNT; i++)
+        t->axisBits[i].store(TreadmillFloatBits(axes[i]), std::memory_order_relaxed);
+    t->updated.store(now, std::memory_order_relaxed);
 }
 
+#define TELEMETRY_SCOPE(call)               TelemetryScope telemetryScope(call)
+#define TELEMETRY_PAUSE()                   telemetryScope.Pause()
+#define TELEMETRY_RESUME()                  telemetryScope.Resume()
+#define TELEMETRY_COUNT(field)              telemetryScope.counters->field.fetch_add(1, std::memory_order_relaxed)
+#define TELEMETRY_OPEN()                    TelemetryOpen()
+#define TELEMETRY_FRAME(now, axes)          TelemetryFrame(now, axes)
+#define TELEMETRY_DISPLAY_PERIOD(ns)        Telemetry()->displayPeriodNs.store(ns, std::memory_order_relaxed)
+#define TELEMETRY_INSTANCES(n)              Telemetry()->liveInstances.store(n, std::memory_order_relaxed)
+
+#else
+
+#define TELEMETRY_SCOPE(call)               do {} while (0)
+#define TELEMETRY_PAUSE()                   do {} while (0)
+#define TELEMETRY_RESUME()                  do {} while (0)
+#define TELEMETRY_COUNT(field)              do {} while (0)
+#define TELEMETRY_OPEN()                    do {} while (0)
+#define TELEMETRY_FRAME(now, axes)          do {} while (0)
+#define TELEMETRY_DISPLAY_PERIOD(ns)        do {} while (0)
+#define TELEMETRY_INSTANCES(n)              do {} while (0)
+
+#endif
+
 // ─── Shared Memory Protocol ────────────────────────────────────
 
-#define SHARED_MEM_NAME     "TreadmillDriverVelocity"
-#define SHARED_MEM_RETRY_MS 2000
+// Layout and seqlock reader live in treadmill_shared.h.
+//
+// The input thread never opens, maps or closes anything. A watcher
+// worker does, every SHARED_MEM_WATCH_MS: it maps the block once the
+// companion creates it, and replaces a view whose writer has gone quiet
+// when the name now maps a live one (a companion that recreated the
+// object). Views are handed over through g_sharedPublished; an old one
+// stays mapped until every instance's input thread has moved off it
+// (LayerInstance::sharedInUse). A session that is destroyed stops
+// announcing its view. One whose game stops syncing keeps announcing
+// it, so up to SHARED_MEM_RETIRED_MAX replaced views can wait at once
+// and later restarts are still followed. A companion restart into the
+// same object bumps its generation, and each input thread starts over
+// from that. The watcher runs while any instance that has been used
+// lives.
+
+#define SHARED_MEM_WATCH_MS 25      // pickup delay after the companion starts
+#define SHARED_MEM_STALE_MS FRAME_VELOCITY_STALE_MS
+#define SHARED_MEM_RETIRED_MAX 4    // replaced views still announced by some instance
+
+// ─── Frame Velocity (frame_velocity.h) ──────────────────────────
+// Each xrSyncActions reads the block once: the published sample and
+// velocity ring, or the raw delta ring run through the input core, then
+// prediction to the display time of the latest xrWaitFrame.
+
+// ─── Action Tracking (published snapshot, no locks) ─────────────
+// xrSuggestInteractionProfileBindings publishes a new TrackedActions
+// snapshot (tracked_actions.h); xrGetActionState* does one acquire load.
+
+// ─── Per-Frame Snapshot (latched in xrSyncActions) ──────────────
+// xrGetActionState* calls read only this, so every query in a frame
+// sees the same axes and never touches shared memory.
+//
+// `frameLatest` is the sync counter of the newest snapshot (0 = no
+// xrSyncActions yet). Snapshot n lives in frames[n & 1], so the one
+// readers use is not rewritten until two syncs later; its `frame`
+// field doubles as a seqlock for a reader that stalls that long.
+
+struct FrameSnapshot {
+    std::atomic<uint32_t>   frame;                      // 0 while being rewritten
+    std::atomic<uint32_t>   axisBits[INJECT_AXIS_COUNT];
+};
 
-#pragma pack(push, 1)
-struct TreadmillSharedData {
-    float       velocity;
-    uint32_t    active;
+// ─── Layer Instances (handle_map.h) ─────────────────────────────
+// Everything an XrInstance owns lives in its LayerInstance: the next
+// layer's functions, tracked actions, binding path cache, profile, and
+// its session's frame state (an instance has at most one session).
+// Instance-level intercepts find it in g_instanceMap, session-level
+// ones in g_sessionMap — one lock-free lookup each.
+//
+// LayerInstances come from a static pool and are never freed, so a
+// thread racing xrDestroyInstance (an application bug) still reads
+// valid memory; slots are handed out round-robin so a freed one is
+// reused as late as possible. Creation and destruction take the
+// registry lock, a spin lock held for a few stores. Starting and
+// stopping what the instances share (trace file, telemetry and shared
+// memory mappings, the watcher thread) blocks, so it has a lock of its
+// own, the service lock, taken without the registry lock by the first
+// use that starts the watcher and the last xrDestroyInstance that stops
+// it. A first use that arrives while the old watcher is being joined
+// waits for it, then starts a new one. Waiters on either lock spin
+// briefly and then yield. Instances beyond the pool are passed through
+// without treadmill input, created as the app asked.
+
+#define LAYER_MAX_INSTANCES     32
+#define LAYER_SPIN_LIMIT        64      // lock and first-use waits: spins before yielding
+#define LAYER_HANDLE_MAP_SIZE   (2 * LAYER_MAX_INSTANCES)
+
+// The next layer's (or the runtime's) entry points for one instance.
+struct LayerDispatch {
+    PFN_xrGetInstanceProcAddr                   GetInstanceProcAddr;
+    PFN_xrDestroyInstance                       DestroyInstance;
+    PFN_xrPathToString                          PathToString;
+    PFN_xrStringToPath                          StringToPath;
+    PFN_xrSuggestInteractionProfileBindings     SuggestInteractionProfileBindings;
+    PFN_xrCreateSession                         CreateSession;
+    PFN_xrDestroySession                        DestroySession;
+    PFN_xrSyncActions                           SyncActions;
+    PFN_xrGetActionStateFloat                   GetActionStateFloat;
+    PFN_xrGetActionStateVector2f                GetActionStateVector2f;
+    PFN_xrWaitFrame                             WaitFrame;
+    PFN_xrVoidFunction                          ConvertTime;        // NULL without kPlatformXrTimeExtension
 };
-#pragma pack(pop)
 
-// ─── Action Tracking (fixed-size, no STL) ───────────────────────
+struct LayerInstance {
+    XrInstance              handle;                 // XR_NULL_HANDLE = free slot (registry lock)
+    XrSession               session;                // registry lock
+    LayerDispatch           next;
+
+    XrPath                  leftHandPath;
+    XrPath                  rightHandPath;
+    TrackedActionsState     tracked;                // published snapshot, no locks
+    PathCache               pathCache;              // seeded on the first suggest
+
+    // Application profile (app_profiles.h), selected on first use and
+    // fixed for the instance's lifetime. The file stays mapped while a
+    // profile is selected: `profile` points into it.
+    PlatformSharedMemory    profileMap;
+    ProfileDb               profileDb;
+    const ProfileDbProfile* profile;
+    float                   axisScale[INJECT_AXIS_COUNT];
+
+    std::atomic<uint32_t>   lazyState;              // LAZY_*
+    char                    applicationName[XR_MAX_APPLICATION_NAME_SIZE];  // copied at creation
+    char                    engineName[XR_MAX_ENGINE_NAME_SIZE];
+    int                     predictMode;
+
+    FrameSnapshot           frames[2];
+    std::atomic<uint32_t>   frameLatest;
+
+    // Predicted display time of the session's latest frame in
+    // PlatformTimestamp ticks (written by xrWaitFrame, any thread); 0 = unknown.
+    std::atomic<int64_t>    displayTimestamp;
+
+    std::atomic<TreadmillSharedData*> sharedInUse; // input thread -> watcher
+
+    // Input thread (xrSyncActions) only
+    TreadmillSharedData*    sharedData;
+    bool                    sharedAdopted;
+    uint32_t                sharedGeneration;
+    FrameVelocity           frameVelocity;
+    uint64_t                deltaLostLogged;
+};
 
-#define MAX_TRACKED_ACTIONS 64
+static LayerInstance        g_instances[LAYER_MAX_INSTANCES];
+static HandleMap<LayerInstance, LAYER_HANDLE_MAP_SIZE> g_instanceMap;
+static HandleMap<LayerInstance, LAYER_HANDLE_MAP_SIZE> g_sessionMap;
 
-struct TrackedActions {
-    uintptr_t   vec2f[MAX_TRACKED_ACTIONS];
-    int         vec2fCount;
-    uintptr_t   floatY[MAX_TRACKED_ACTIONS];
-    int         floatYCount;
-    BOOL        bindingsReceived;
+// Registry lock
+static std::atomic<bool>    g_registryBusy{false};
+static uint32_t             g_instanceCount         = 0;
+static uint32_t             g_instanceNextSlot      = 0;
+
+// Service lock: the watcher's start and stop
+static std::atomic<bool>    g_serviceBusy{false};
+
+// Every instance chains to the same next layer, so this is what an
+// instance the layer does not track passes through to.
+static PFN_xrGetInstanceProcAddr g_nextGetInstanceProcAddr = NULL;
+
+static void SpinLock(std::atomic<bool>* busy)
+{
+    uint32_t spins = 0;
+    while (busy->exchange(true, std::memory_order_acquire)) {
+        while (busy->load(std::memory_order_relaxed)) {
+            if (++spins > LAYER_SPIN_LIMIT) PlatformYield();
+        }
+    }
+}
+
+static void RegistryLock()      { SpinLock(&g_registryBusy); }
+static void RegistryUnlock()    { g_registryBusy.store(false, std::memory_order_release); }
+static void ServiceLock()       { SpinLock(&g_serviceBusy); }
+static void ServiceUnlock()     { g_serviceBusy.store(false, std::memory_order_release); }
+
+static LayerInstance* FindInstance(XrInstance instance)
+{
+    return HandleMapFind(&g_instanceMap, HandleKey(instance));
+}
+
+static LayerInstance* FindSession(XrSession session)
+{
+    return HandleMapFind(&g_sessionMap, HandleKey(session));
+}
+
+// ─── Shared Memory (watcher state) ──────────────────────────────
+
+// Watcher only (and, under the service lock, the first use that starts
+// it and the last destroy that stops it)
+static PlatformWorker       g_sharedWatcher         = {};
+static PlatformSharedMemory g_sharedMem             = {};
+static PlatformSharedMemory g_sharedRetired[SHARED_MEM_RETIRED_MAX] = {};   // replaced, still mapped
+static bool                 g_sharedMissingLogged   = false;
+static bool                 g_sharedBadLogged       = false;
+static bool                 g_sharedWatcherTicked   = false;
+
+static std::atomic<TreadmillSharedData*> g_sharedPublished{NULL};  // watcher -> input threads
+
+// ─── Velocity Trace (velocity_trace.h) ──────────────────────────
+// With $TREADMILL_VELOCITY_TRACE set, every latched frame is recorded
+// for the trace replay. xrSyncActions only pushes an entry into an
+// in-process ring; the watcher creates the file on its first tick and
+// appends what the ring holds on every tick, and the last
+// xrDestroyInstance writes the rest. Frames the watcher fell a ring
+// behind on are recorded as a LOSS. The ring has one producer, so only
+// the instance that started the watcher is recorded, until it is
+// destroyed; each watcher run rewrites the file.
+
+#define VELOCITY_TRACE_RING_SIZE    1024            // 7 s of frames at 144 Hz
+#define VELOCITY_TRACE_BATCH        64
+#define VELOCITY_TRACE_BUFFER       (16 * 1024)
+
+struct VelocityTraceEntry {
+    int64_t             timestamp;
+    VelocityTraceFrame  frame;
 };
 
-// ─── Global State (all POD — no static constructors) ────────────
+static SharedRing<VelocityTraceEntry, VELOCITY_TRACE_RING_SIZE> g_velocityTraceRing;   // input thread -> watcher
+static bool                 g_velocityTraceOn       = false;    // set before the watcher starts (service lock)
+static char                 g_velocityTracePath[512];
+static VelocityTraceLayer   g_velocityTraceLayer    = {};
+static std::atomic<LayerInstance*> g_velocityTraceInstance{NULL};  // the one being recorded
+
+// Watcher only (and xrDestroyInstance after it has stopped)
+static PlatformFile         g_velocityTraceFile     = NULL;
+static bool                 g_velocityTraceFailed   = false;
+static VelocityTraceEncoder g_velocityTraceEncoder  = {};
+static SharedRingCursor     g_velocityTraceCursor   = {};
+static uint64_t             g_velocityTraceLost     = 0;
+
+// First use of the instance that starts the watcher: reads the path;
+// the ring starts empty.
+static void VelocityTraceStart(LayerInstance* inst)
+{
+    if (g_velocityTraceOn) return;
+    g_velocityTraceOn = PlatformGetEnv(VELOCITY_TRACE_ENV, g_velocityTracePath, sizeof(g_velocityTracePath));
+    if (!g_velocityTraceOn) return;
+
+    SharedRingReset(&g_velocityTraceRing);
+    SharedRingCursorInit(&g_velocityTraceRing, &g_velocityTraceCursor);
+    g_velocityTraceLost = 0;
+
+    // What the replay needs to reproduce this instance's frames
+    for (int i = 0; i < INJECT_AXIS_COUNT; i++) g_velocityTraceLayer.scale[i] = inst->axisScale[i];
+    g_velocityTraceLayer.predictMode = inst->predictMode;
+    g_velocityTraceInstance.store(inst, std::memory_order_relaxed);
+}
+
+// Input thread, once per latched frame.
+static void VelocityTraceRecordFrame(int64_t timestamp, int64_t display, const float axes[INJECT_AXIS_COUNT],
+                                     uint32_t frame)
+{
+    VelocityTraceEntry e;
+    e.timestamp     = timestamp;
+    e.frame.forward = axes[INJECT_AXIS_FORWARD];
+    e.frame.strafe  = axes[INJECT_AXIS_STRAFE];
+    e.frame.turn    = axes[INJECT_AXIS_TURN];
+    e.frame.frame   = frame;
+    e.frame.display = display;
+    SharedRingWrite(&g_velocityTraceRing, &e, 1);
+}
+
+// Appends one record to `buf`, writing the buffer out first if it is full.
+static void VelocityTraceAppend(uint8_t* buf, size_t* n, uint8_t type, int64_t timestamp,
+                                const void* payload, size_t size)
+{
+    if (VELOCITY_TRACE_BUFFER - *n < VELOCITY_TRACE_RECORD_MAX) {
+        PlatformFileWrite(g_velocityTraceFile, buf, *n);
+        *n = 0;
+    }
+    *n += VelocityTraceEncode(&g_velocityTraceEncoder, buf + *n, VELOCITY_TRACE_BUFFER - *n,
+                              type, 0, timestamp, payload, size);
+}
+
+// Watcher tick, or the last xrDestroyInstance after the watcher has stopped.
+static void VelocityTraceDrain()
+{
+    if (!g_velocityTraceOn || g_velocityTraceFailed) return;
 
-static XrInstance                   g_instance                          = XR_NULL_HANDLE;
-static PFN_xrGetInstanceProcAddr    g_nextGetInstanceProcAddr           = NULL;
+    static uint8_t buf[VELOCITY_TRACE_BUFFER];
+    size_t n = 0;
 
-static PFN_xrDestroyInstance                        g_xrDestroyInstance                     = NULL;
-static PFN_xrPathToString                           g_xrPathToString                        = NULL;
-static PFN_xrStringToPath                           g_xrStringToPath                        = NULL;
-static PFN_xrSuggestInteractionProfileBindings      g_xrSuggestInteractionProfileBindings   = NULL;
-static PFN_xrGetActionStateFloat                    g_xrGetActionStateFloat                 = NULL;
-static PFN_xrGetActionStateVector2f                 g_xrGetActionStateVector2f              = NULL;
+    if (!g_velocityTraceFile) {
+        g_velocityTraceFile = PlatformFileCreate(g_velocityTracePath);
+        if (!g_velocityTraceFile) {
+            LOG_WARN("Velocity trace: cannot write %s", g_velocityTracePath);
+            g_velocityTraceFailed = true;
+            return;
+        }
+        int64_t now = PlatformTimestamp();
+        n = VelocityTraceBegin(&g_velocityTraceEncoder, buf, sizeof(buf), PlatformTimestampFrequency(), now,
+                               VELOCITY_TRACE_SOURCE_LAYER);
 
-static XrPath                                       g_leftHandPath                          = XR_NULL_PATH;
+        VelocityTraceAppend(buf, &n, VELOCITY_TRACE_LAYER, now, &g_velocityTraceLayer, sizeof(g_velocityTraceLayer));
+        LOG_INFO("Velocity trace: recording to %s", g_velocityTracePath);
+    }
+
+    VelocityTraceEntry entries[VELOCITY_TRACE_BATCH];
+    uint32_t count;
+    do {
+        count = SharedRingRead(&g_velocityTraceRing, &g_velocityTraceCursor, entries, VELOCITY_TRACE_BATCH);
+        if (g_velocityTraceCursor.lost != g_velocityTraceLost) {
+            VelocityTraceLoss loss = { (uint32_t)(g_velocityTraceCursor.lost - g_velocityTraceLost), 0 };
+            int64_t at = count ? entries[0].timestamp : g_velocityTraceEncoder.last;
+            VelocityTraceAppend(buf, &n, VELOCITY_TRACE_LOSS, at, &loss, sizeof(loss));
+            g_velocityTraceLost = g_velocityTraceCursor.lost;
+        }
+        for (uint32_t i = 0; i < count; i++)
+            VelocityTraceAppend(buf, &n, VELOCITY_TRACE_FRAME, entries[i].timestamp,
+                                &entries[i].frame, sizeof(entries[i].frame));
+    } while (count == VELOCITY_TRACE_BATCH);
 
-static CRITICAL_SECTION     g_cs;
-static BOOL                 g_csInitialized = FALSE;
-static TrackedActions       g_tracked       = {};
+    if (n) PlatformFileWrite(g_velocityTraceFile, buf, n);
+}
 
-static HANDLE               g_sharedMemHandle       = NULL;
-static TreadmillSharedData* g_sharedData            = NULL;
-static ULONGLONG            g_lastSharedMemAttempt   = 0;
+// The last xrDestroyInstance after the watcher has stopped, or module unload.
+static void VelocityTraceClose()
+{
+    g_velocityTraceInstance.store(NULL, std::memory_order_relaxed);
+    VelocityTraceDrain();
+    if (g_velocityTraceFile) {
+        PlatformFileClose(g_velocityTraceFile);
+        g_velocityTraceFile = NULL;
+    }
+    g_velocityTraceOn     = false;
+    g_velocityTraceFailed = false;
+}
 
 // ─── Helpers ────────────────────────────────────────────────────
 
-static void EnsureCritSec()
+// Maps the block and checks its header; logs each failure once per outage.
+static bool OpenSharedMemory(PlatformSharedMemory* shm)
 {
-    if (!g_csInitialized) {
-        InitializeCriticalSection(&g_cs);
-        g_csInitialized = TRUE;
+    // An older companion creates a smaller object, which fails to map at v5 size
+    if (!PlatformSharedMemoryOpen(shm, TREADMILL_SHARED_MEM_NAME, sizeof(TreadmillSharedData))) {
+        if (!g_sharedMissingLogged) LOG_INFO("SharedMem: not available (companion app not running, or too old?)");
+        g_sharedMissingLogged = true;
+        return false;
+    }
+
+    const TreadmillSharedData* d = (const TreadmillSharedData*)shm->view;
+    if (!TreadmillSharedValidate(d)) {
+        if (!g_sharedBadLogged) LOG_WARN("SharedMem: bad header (magic=0x%08X version=%u), ignoring",
+                                         d->header.magic, (unsigned)d->header.version);
+        g_sharedBadLogged = true;
+        PlatformSharedMemoryClose(shm);
+        return false;
     }
+
+    g_sharedMissingLogged = false;
+    g_sharedBadLogged     = false;
+    return true;
 }
 
-static void OpenSharedMemory()
+static bool SharedMemoryIsLive(const PlatformSharedMemory* shm)
 {
-    if (g_sharedMemHandle) return;
+    const TreadmillSharedData* d = (const TreadmillSharedData*)shm->view;
+    return TreadmillSharedIsLive(d, PlatformTimestamp(), d->header.timestampFrequency * SHARED_MEM_STALE_MS / 1000);
+}
 
-    g_sharedMemHandle = OpenFileMappingA(FILE_MAP_READ, FALSE, SHARED_MEM_NAME);
-    if (g_sharedMemHandle) {
-        g_sharedData = (TreadmillSharedData*)MapViewOfFile(
-            g_sharedMemHandle, FILE_MAP_READ, 0, 0, sizeof(TreadmillSharedData));
-        Log(g_sharedData ? "SharedMem: mapped OK" : "SharedMem: MapViewOfFile failed");
-    } else {
-        Log("SharedMem: not available (WPF app not running?)");
+// Whether any instance's input thread still announces `view`. Free
+// pool slots announce nothing.
+static bool SharedViewInUse(const void* view)
+{
+    for (uint32_t i = 0; i < LAYER_MAX_INSTANCES; i++) {
+        if (g_instances[i].sharedInUse.load(std::memory_order_seq_cst) == view) return true;
     }
+    return false;
 }
 
+// Watcher tick (also run once on first use, before the worker starts).
+static void WatchSharedMemory(void* ctx)
+{
+    (void)ctx;
+
+    uint32_t retiredFree = SHARED_MEM_RETIRED_MAX;
+    for (uint32_t i = 0; i < SHARED_MEM_RETIRED_MAX; i++) {
+        if (g_sharedRetired[i].view && !SharedViewInUse(g_sharedRetired[i].view))
+            PlatformSharedMemoryClose(&g_sharedRetired[i]);
+        if (!g_sharedRetired[i].view) retiredFree = i;
+    }
+
+    if (!g_sharedMem.view) {
+        if (OpenSharedMemory(&g_sharedMem))
+            g_sharedPublished.store((TreadmillSharedData*)g_sharedMem.view, std::memory_order_seq_cst);
+        return;
+    }
+
+    // A quiet writer may have recreated the object under the same name
+    // (our view then keeps the orphaned one). With every retired slot
+    // still announced, wait for an instance to move on
+    if (retiredFree == SHARED_MEM_RETIRED_MAX || SharedMemoryIsLive(&g_sharedMem)) return;
+
+    PlatformSharedMemory fresh = {};
+    if (!OpenSharedMemory(&fresh)) return;
+    if (!SharedMemoryIsLive(&fresh)) {
+        PlatformSharedMemoryClose(&fresh);
+        return;
+    }
+
+    LOG_INFO("SharedMem: companion recreated the block, remapped");
+    g_sharedRetired[retiredFree] = g_sharedMem;
+    g_sharedMem                  = fresh;
+    g_sharedPublished.store((TreadmillSharedData*)g_sharedMem.view, std::memory_order_seq_cst);
+}
+
+// The watcher worker. Its first tick also does the startup work that
+// touches the disk, off the application's threads.
+static void SharedWatcherTick(void* ctx)
+{
+    if (!g_sharedWatcherTicked) {
+        g_sharedWatcherTicked = true;
+        int phase = TraceBegin("open log file");
+        LogOpenFile(true);
+        TraceEnd(phase);
+        WriteStartupTrace();
+    }
+    WatchSharedMemory(ctx);
+    VelocityTraceDrain();
+}
+
+// After the watcher has stopped and the last instance let go.
 static void CloseSharedMemory()
 {
-    if (g_sharedData)    { UnmapViewOfFile(g_sharedData); g_sharedData = NULL; }
-    if (g_sharedMemHandle) { CloseHandle(g_sharedMemHandle); g_sharedMemHandle = NULL; }
+    g_sharedPublished.store(NULL, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < SHARED_MEM_RETIRED_MAX; i++) PlatformSharedMemoryClose(&g_sharedRetired[i]);
+    PlatformSharedMemoryClose(&g_sharedMem);
+    g_sharedMissingLogged = false;
+    g_sharedBadLogged     = false;
+    g_sharedWatcherTicked = false;
 }
 
-static float ReadTreadmillVelocity()
+// Input thread: takes the watcher's latest view, and starts over on a
+// new view or a new writer generation. Loads only — no system calls.
+static bool SyncSharedData(LayerInstance* inst)
 {
-    if (!g_sharedData) {
-        ULONGLONG now = GetTickCount64();
-        if (now - g_lastSharedMemAttempt >= SHARED_MEM_RETRY_MS) {
-            g_lastSharedMemAttempt = now;
-            OpenSharedMemory();
-        }
+    TreadmillSharedData* d = g_sharedPublished.load(std::memory_order_acquire);
+    if (d != inst->sharedData) {
+        // Announce before use, then re-check: the watcher unmaps a view
+        // only after seeing it is no longer announced
+        inst->sharedInUse.store(d, std::memory_order_seq_cst);
+        inst->sharedData    = NULL;
+        inst->sharedAdopted = false;
+        if (g_sharedPublished.load(std::memory_order_seq_cst) != d) return false;
+        inst->sharedData = d;
+    }
+    if (!d) return false;
+
+    uint32_t generation = d->generation.load(std::memory_order_acquire);
+    if (inst->sharedAdopted && generation == inst->sharedGeneration) return true;
+
+    // A restarting writer rewrites the header; try again next frame
+    if (!TreadmillSharedValidate(d)) return false;
+
+    FrameVelocityAdopt(&inst->frameVelocity, d, inst->predictMode);
+
+    inst->sharedGeneration = generation;
+    inst->sharedAdopted    = true;
+    LOG_INFO("SharedMem: mapped OK (protocol v5, generation %u, prediction %s)",
+             generation, VelocityPredictModeName(inst->predictMode));
+    return true;
+}
+
+// Forward velocity, predicted to `display`; strafe and turn are left in
+// inst->frameVelocity as published (not extrapolated).
+static float ReadTreadmillVelocity(LayerInstance* inst, int64_t now, int64_t display)
+{
+    FrameVelocity* f = &inst->frameVelocity;
+    if (!SyncSharedData(inst)) {
+        f->strafe = f->turn = 0.0f;
+        return 0.0f;
+    }
+
+    bool    wasRaw   = f->rawActive;
+    float   velocity = FrameVelocityRead(f, inst->sharedData, now, display);
+
+    if (f->rawActive && !wasRaw) {
+        LOG_INFO("SharedMem: raw delta streaming");
+        inst->deltaLostLogged = 0;
+    } else if (wasRaw && !f->rawActive && f->streamMode == TREADMILL_STREAM_VELOCITY) {
+        LOG_INFO("SharedMem: velocity streaming");
+    }
+    if (f->rawActive && f->deltaCursor.lost != inst->deltaLostLogged) {
+        LOG_WARN("SharedMem: delta ring overrun, %llu events lost",
+                 (unsigned long long)(f->deltaCursor.lost - inst->deltaLostLogged));
+        inst->deltaLostLogged = f->deltaCursor.lost;
+    }
+    return velocity;
+}
+
+// Called once per xrSyncActions on the game's input thread.
+static void LatchFrameSnapshot(LayerInstance* inst)
+{
+    int64_t now     = PlatformTimestamp();
+    int64_t display = inst->displayTimestamp.load(std::memory_order_relaxed);
+    float axes[INJECT_AXIS_COUNT];
+    axes[INJECT_AXIS_FORWARD] = ReadTreadmillVelocity(inst, now, display);
+    axes[INJECT_AXIS_STRAFE]  = inst->frameVelocity.strafe;
+    axes[INJECT_AXIS_TURN]    = inst->frameVelocity.turn;
+    for (int i = 0; i < INJECT_AXIS_COUNT; i++) axes[i] *= inst->axisScale[i];
+
+    uint32_t frame = inst->frameLatest.load(std::memory_order_relaxed) + 1;
+    if (frame == 0) frame = 1;
+
+    FrameSnapshot* snap = &inst->frames[frame & 1];
+    snap->frame.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (int i = 0; i < INJECT_AXIS_COUNT; i++)
+        snap->axisBits[i].store(TreadmillFloatBits(axes[i]), std::memory_order_relaxed);
+    snap->frame.store(frame, std::memory_order_release);
+    inst->frameLatest.store(frame, std::memory_order_release);
+    TELEMETRY_FRAME(now, axes);
+
+    if (g_velocityTraceOn && g_velocityTraceInstance.load(std::memory_order_relaxed) == inst)
+        VelocityTraceRecordFrame(now, display, axes, frame);
+}
+
+// Any thread. False before the session's first xrSyncActions.
+static bool ReadFrameSnapshot(const LayerInstance* inst, float axes[INJECT_AXIS_COUNT])
+{
+    for (;;) {
+        uint32_t frame = inst->frameLatest.load(std::memory_order_acquire);
+        if (frame == 0) return false;
+
+        // A mismatch means a newer frame has been latched; start over from it
+        const FrameSnapshot* snap = &inst->frames[frame & 1];
+        if (snap->frame.load(std::memory_order_acquire) != frame) continue;
+        uint32_t bits[INJECT_AXIS_COUNT];
+        for (int i = 0; i < INJECT_AXIS_COUNT; i++) bits[i] = snap->axisBits[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (snap->frame.load(std::memory_order_relaxed) != frame) continue;
+
+        for (int i = 0; i < INJECT_AXIS_COUNT; i++) axes[i] = TreadmillBitsFloat(bits[i]);
+        return true;
+    }
+}
+
+// ─── Application Profile ────────────────────────────────────────
+
+static void UnloadProfile(LayerInstance* inst)
+{
+    inst->profile = NULL;
+    memset(&inst->profileDb, 0, sizeof(inst->profileDb));
+    PlatformSharedMemoryClose(&inst->profileMap);
+    for (int i = 0; i < INJECT_AXIS_COUNT; i++) inst->axisScale[i] = 1.0f;
+}
+
+// Maps the profile database and selects this application's profile.
+// Missing or invalid databases leave the built-in bindings in place.
+static void LoadProfile(LayerInstance* inst, const char* application, const char* engine)
+{
+    UnloadProfile(inst);
+
+    char path[512];
+    if (!PlatformGetEnv(PROFILE_DB_ENV, path, sizeof(path))) {
+        if (!PlatformLogDirectory(path, sizeof(path))) return;
+        size_t n = strlen(path);
+        if (n + sizeof(PROFILE_DB_FILE_NAME) > sizeof(path)) return;
+        memcpy(path + n, PROFILE_DB_FILE_NAME, sizeof(PROFILE_DB_FILE_NAME));
+    }
+
+    if (!PlatformFileMapRead(&inst->profileMap, path, PROFILE_DB_MAX_SIZE)) {
+        LOG_INFO("  Profiles: no database at %s", path);
+        return;
+    }
+    if (!ProfileDbOpen(&inst->profileDb, inst->profileMap.view, inst->profileMap.size)) {
+        LOG_WARN("  Profiles: %s is not a valid v%d profile database, ignored", path, PROFILE_DB_VERSION);
+        UnloadProfile(inst);
+        return;
+    }
+
+    const ProfileDbProfile* profile = ProfileDbSelect(&inst->profileDb, application, engine);
+    if (!profile) {
+        LOG_INFO("  Profiles: none for \"%s\" (engine \"%s\"), built-in bindings", application, engine);
+        UnloadProfile(inst);
+        return;
+    }
+
+    inst->profile = profile;
+    for (int i = 0; i < INJECT_AXIS_COUNT; i++) inst->axisScale[i] = profile->scale[i];
+    LOG_INFO("  Profile: %s \"%s\", %u bindings, scale %.2f/%.2f/%.2f",
+             profile->matchKind == PROFILE_MATCH_ENGINE ? "engine" : "application",
+             ProfileDbString(&inst->profileDb, profile->name), profile->bindingCount,
+             inst->axisScale[INJECT_AXIS_FORWARD], inst->axisScale[INJECT_AXIS_STRAFE],
+             inst->axisScale[INJECT_AXIS_TURN]);
+}
+
+// ─── Deferred Initialisation ────────────────────────────────────
+// xrCreateApiLayerInstance only chains and resolves function pointers,
+// because its time adds to every title's launch. The rest — profile,
+// hand paths, and for the first instance shared memory and its
+// watcher — runs once per instance, on its first
+// xrSuggestInteractionProfileBindings or xrSyncActions. Later calls
+// pay one acquire load. A thread that arrives while another is
+// initialising the same instance spins: this takes well under a
+// millisecond and a collision needs two threads on their first input
+// call at once.
+
+#define LAZY_PENDING    0
+#define LAZY_RUNNING    1
+#define LAZY_DONE       2
+
+// Copies a fixed-size XrApplicationInfo name, terminating it even if the app didn't.
+static void CopyAppName(char* dst, const char* src, size_t capacity)
+{
+    memcpy(dst, src, capacity);
+    dst[capacity - 1] = 0;
+}
+
+static void InitializeOnFirstUse(LayerInstance* inst)
+{
+    int all = TraceBegin("first use");
+
+    int phase = TraceBegin("load profile");
+    LoadProfile(inst, inst->applicationName, inst->engineName);
+    TraceEnd(phase);
+
+    // Hand paths for subaction filtering
+    phase = TraceBegin("resolve hand paths");
+    if (inst->next.StringToPath) {
+        inst->next.StringToPath(inst->handle, "/user/hand/left", &inst->leftHandPath);
+        inst->next.StringToPath(inst->handle, "/user/hand/right", &inst->rightHandPath);
+        LOG_INFO("  Hand paths resolved: left %llu, right %llu",
+                 (unsigned long long)inst->leftHandPath, (unsigned long long)inst->rightHandPath);
+    }
+    TraceEnd(phase);
+
+    // The first instance starts the watcher; later ones share it
+    ServiceLock();
+    if (!g_sharedWatcher.thread) {
+        VelocityTraceStart(inst);
+
+        phase = TraceBegin("open telemetry");
+        TELEMETRY_OPEN();
+        TraceEnd(phase);
+
+        // Pick up a running companion now; the watcher handles later starts
+        phase = TraceBegin("open shared memory");
+        WatchSharedMemory(NULL);
+        TraceEnd(phase);
+
+        phase = TraceBegin("start watcher");
+        if (!PlatformWorkerStart(&g_sharedWatcher, SHARED_MEM_WATCH_MS, SharedWatcherTick, NULL))
+            LOG_WARN("  SharedMem watcher failed to start; no reconnect after a companion restart");
+        TraceEnd(phase);
     }
-    if (g_sharedData && g_sharedData->active) {
-        return g_sharedData->velocity;
+    ServiceUnlock();
+
+    TraceEnd(all);
+    LOG_INFO("Layer ready (first input call)");
+}
+
+static void EnsureInitialized(LayerInstance* inst)
+{
+    if (inst->lazyState.load(std::memory_order_acquire) == LAZY_DONE) return;
+
+    uint32_t expected = LAZY_PENDING;
+    if (!inst->lazyState.compare_exchange_strong(expected, LAZY_RUNNING, std::memory_order_acq_rel)) {
+        for (uint32_t spins = 0; inst->lazyState.load(std::memory_order_acquire) != LAZY_DONE;) {
+            if (++spins > LAYER_SPIN_LIMIT) PlatformYield();
+        }
+        return;
     }
-    return 0.0f;
+    InitializeOnFirstUse(inst);
+    inst->lazyState.store(LAZY_DONE, std::memory_order_release);
 }
 
-static BOOL ContainsAction(const uintptr_t* arr, int count, uintptr_t key)
+// ─── Instance Registry ──────────────────────────────────────────
+
+// Registry lock held. Takes a free pool slot for `handle` and makes it
+// findable; NULL if the pool or the map is full.
+static LayerInstance* RegisterInstance(XrInstance handle)
 {
-    for (int i = 0; i < count; i++) {
-        if (arr[i] == key) return TRUE;
+    for (uint32_t n = 0; n < LAYER_MAX_INSTANCES; n++) {
+        uint32_t       slot = (g_instanceNextSlot + n) % LAYER_MAX_INSTANCES;
+        LayerInstance* inst = &g_instances[slot];
+        if (inst->handle) continue;
+
+        if (!HandleMapInsert(&g_instanceMap, HandleKey(handle), inst)) return NULL;
+        inst->handle       = handle;
+        g_instanceNextSlot = (slot + 1) % LAYER_MAX_INSTANCES;
+        g_instanceCount++;
+        TELEMETRY_INSTANCES(g_instanceCount);
+        return inst;
     }
-    return FALSE;
+    return NULL;
 }
 
-static void AddAction(uintptr_t* arr, int* count, uintptr_t key)
+// Registry lock held, after the handle has been unmapped. Returns the
+// slot to the pool. The dispatch table is left as it was for a thread
+// still racing the destroy.
+static void ReleaseInstance(LayerInstance* inst)
 {
-    if (*count >= MAX_TRACKED_ACTIONS) return;
-    if (!ContainsAction(arr, *count, key)) {
-        arr[*count] = key;
-        (*count)++;
+    if (g_velocityTraceInstance.load(std::memory_order_relaxed) == inst)
+        g_velocityTraceInstance.store(NULL, std::memory_order_relaxed);
+
+    // Readers racing the destroy (an app bug) may still hold the old
+    // snapshot; its memory is only freed at the slot's next clear or unload.
+    inst->frameLatest.store(0, std::memory_order_release);
+    inst->displayTimestamp.store(0, std::memory_order_relaxed);
+    TrackedActionsClear(&inst->tracked);
+    PathCacheClear(&inst->pathCache);
+    UnloadProfile(inst);
+    inst->leftHandPath  = XR_NULL_PATH;
+    inst->rightHandPath = XR_NULL_PATH;
+
+    inst->sharedInUse.store(NULL, std::memory_order_seq_cst);
+    inst->sharedData    = NULL;
+    inst->sharedAdopted = false;
+
+    inst->session = XR_NULL_HANDLE;
+    inst->handle  = XR_NULL_HANDLE;
+    g_instanceCount--;
+    TELEMETRY_INSTANCES(g_instanceCount);
+}
+
+// ─── Intercepted: xrCreateSession / xrDestroySession ────────────
+// The session is what xrSyncActions and xrGetActionState* are called
+// with, so it is mapped to its instance here. OpenXR allows one
+// session per instance at a time; a second is refused as the spec
+// says a runtime must.
+
+static XrResult XRAPI_CALL
+TreadmillLayer_xrCreateSession(
+    XrInstance instance,
+    const XrSessionCreateInfo* createInfo,
+    XrSession* session)
+{
+    TELEMETRY_SCOPE(TELEMETRY_CALL_CREATE_SESSION);
+    LayerInstance* inst = FindInstance(instance);
+    if (!inst) return XR_ERROR_HANDLE_INVALID;
+
+    TELEMETRY_PAUSE();
+    XrResult result = inst->next.CreateSession(instance, createInfo, session);
+    TELEMETRY_RESUME();
+    if (XR_FAILED(result)) return result;
+
+    RegistryLock();
+    bool hasSession = inst->session != XR_NULL_HANDLE;
+    bool mapped     = !hasSession && HandleMapInsert(&g_sessionMap, HandleKey(*session), inst);
+    if (mapped) inst->session = *session;
+    RegistryUnlock();
+
+    if (!mapped) {
+        if (hasSession)
+            LOG_WARN("xrCreateSession: instance already has a session, refused");
+        else
+            LOG_WARN("xrCreateSession: session map full or handle already mapped, refused");
+        inst->next.DestroySession(*session);
+        *session = XR_NULL_HANDLE;
+        return XR_ERROR_LIMIT_REACHED;
     }
+    LOG_INFO("xrCreateSession");
+    return result;
+}
+
+static XrResult XRAPI_CALL
+TreadmillLayer_xrDestroySession(XrSession session)
+{
+    TELEMETRY_SCOPE(TELEMETRY_CALL_DESTROY_SESSION);
+    LayerInstance* inst = FindSession(session);
+    if (!inst) return XR_ERROR_HANDLE_INVALID;
+
+    LOG_INFO("xrDestroySession");
+    RegistryLock();
+    HandleMapRemove(&g_sessionMap, HandleKey(session));
+    inst->session = XR_NULL_HANDLE;
+    RegistryUnlock();
+
+    // Nothing syncs until the next session, so let the watcher unmap the
+    // view; that session adopts the current one
+    inst->sharedInUse.store(NULL, std::memory_order_seq_cst);
+    inst->sharedData    = NULL;
+    inst->sharedAdopted = false;
+
+    // A later session starts without this one's frames
+    inst->frameLatest.store(0, std::memory_order_release);
+    inst->displayTimestamp.store(0, std::memory_order_relaxed);
+    TELEMETRY_PAUSE();
+    return inst->next.DestroySession(session);
+}
+
+// ─── Intercepted: xrWaitFrame ───────────────────────────────────
+
+static XrResult XRAPI_CALL
+TreadmillLayer_xrWaitFrame(
+    XrSession session,
+    const XrFrameWaitInfo* frameWaitInfo,
+    XrFrameState* frameState)
+{
+    TELEMETRY_SCOPE(TELEMETRY_CALL_WAIT_FRAME);
+    LayerInstance* inst = FindSession(session);
+    if (!inst) return XR_ERROR_HANDLE_INVALID;
+
+    TELEMETRY_PAUSE();
+    XrResult result = inst->next.WaitFrame(session, frameWaitInfo, frameState);
+    TELEMETRY_RESUME();
+    if (XR_FAILED(result)) return result;
+
+    TELEMETRY_DISPLAY_PERIOD(frameState->predictedDisplayPeriod);
+    if (!inst->next.ConvertTime) return result;
+
+    int64_t display;
+    if (PlatformXrTimeToTimestamp(inst->next.ConvertTime, inst->handle, frameState->predictedDisplayTime, &display))
+        inst->displayTimestamp.store(display, std::memory_order_relaxed);
+    return result;
 }
 
 // ─── Intercepted: xrSuggestInteractionProfileBindings ───────────
 
+// Caches the XrPaths of every path a binding can be tracked on, so
+// suggestions using them never go through xrPathToString. Called once
+// per instance, under the path cache lock.
+static void SeedPathCache(LayerInstance* inst)
+{
+    inst->pathCache.seeded = true;
+    if (!inst->next.StringToPath) return;
+
+    const ProfileDb*        db      = &inst->profileDb;
+    const ProfileDbProfile* profile = inst->profile;
+    for (size_t i = 0; i < sizeof(kInjectBuiltinPaths) / sizeof(kInjectBuiltinPaths[0]); i++) {
+        XrPath path = XR_NULL_PATH;
+        if (XR_SUCCEEDED(inst->next.StringToPath(inst->handle, kInjectBuiltinPaths[i], &path)))
+            PathCacheInsert(&inst->pathCache, path, ProfileClassifyBinding(db, profile, kInjectBuiltinPaths[i]));
+    }
+    for (uint32_t i = 0; profile && i < profile->bindingCount; i++) {
+        const char* str  = ProfileDbString(db, db->bindings[profile->firstBinding + i].path);
+        XrPath      path = XR_NULL_PATH;
+        if (XR_SUCCEEDED(inst->next.StringToPath(inst->handle, str, &path)))
+            PathCacheInsert(&inst->pathCache, path, ProfileClassifyBinding(db, profile, str));
+    }
+}
+
 static XrResult XRAPI_CALL
 TreadmillLayer_xrSuggestInteractionProfileBindings(
     XrInstance instance,
     const XrInteractionProfileSuggestedBinding* suggestedBindings)
 {
-    Log("xrSuggestInteractionProfileBindings called");
+    TELEMETRY_SCOPE(TELEMETRY_CALL_SUGGEST_BINDINGS);
+    LayerInstance* inst = FindInstance(instance);
+    if (!inst) return XR_ERROR_HANDLE_INVALID;
+
+    LOG_INFO("xrSuggestInteractionProfileBindings called (%u bindings)",
+             suggestedBindings->countSuggestedBindings);
 
-    XrResult result = g_xrSuggestInteractionProfileBindings(instance, suggestedBindings);
+    TELEMETRY_PAUSE();
+    XrResult result = inst->next.SuggestInteractionProfileBindings(instance, suggestedBindings);
+    TELEMETRY_RESUME();
     if (XR_FAILED(result)) {
-        Log("  -> chained call FAILED");
+        LOG_WARN("  -> chained call FAILED: %d", (int)result);
         return result;
     }
+    EnsureInitialized(inst);    // the profile decides the classification
 
-    if (!g_xrPathToString) {
-        Log("  -> no xrPathToString, skipping binding scan");
+    if (!inst->next.PathToString) {
+        LOG_WARN("  -> no xrPathToString, skipping binding scan");
         return result;
     }
 
-    EnterCriticalSection(&g_cs);
+    // Scan into scratch arrays, then publish one snapshot for the call
+    uint32_t        count       = suggestedBindings->countSuggestedBindings;
+    LayerArena      scratch     = {};
+    TrackedBinding* vec2f       = (TrackedBinding*)LayerArenaAlloc(&scratch, (count + 1) * sizeof(TrackedBinding));
+    TrackedBinding* floats      = (TrackedBinding*)LayerArenaAlloc(&scratch, (count + 1) * sizeof(TrackedBinding));
+    uint32_t        vec2fCount  = 0;
+    uint32_t        floatCount  = 0;
+    bool            matched     = false;
+
+    if (!vec2f || !floats) {
+        LOG_ERROR("  ERROR: out of memory scanning bindings");
+        LayerArenaReset(&scratch);
+        return result;
+    }
+
+    // Busy only if another thread is suggesting right now: classify uncached rather than wait
+    PathCache* cache    = &inst->pathCache;
+    bool       cached   = PathCacheTryLock(cache);
+    uint32_t   resolved = 0;
+    if (cached && !cache->seeded) SeedPathCache(inst);
+
+    for (uint32_t i = 0; i < count; i++) {
+        XrPath        path = suggestedBindings->suggestedBindings[i].binding;
+        InjectBinding binding;
+        if (!cached || !PathCacheFind(cache, path, &binding)) {
+            char pathStr[256] = {0};
+            uint32_t pathLen = 0;
+            XrResult pr = inst->next.PathToString(instance, path, sizeof(pathStr), &pathLen, pathStr);
+            if (XR_FAILED(pr) || pathLen == 0) continue;
+
+            binding = ProfileClassifyBinding(&inst->profileDb, inst->profile, pathStr);
+            if (cached) PathCacheInsert(cache, path, binding);
+            resolved++;
+            if (binding.vec2f || binding.floatValue || binding.leftStick)
+                LOG_INFO("  Tracked path: %s", pathStr);
+        }
+        if (!binding.vec2f && !binding.floatValue && !binding.leftStick) continue;
 
-    for (uint32_t i = 0; i < suggestedBindings->countSuggestedBindings; i++) {
-        char pathStr[256] = {0};
-        uint32_t pathLen = 0;
-        XrResult pr = g_xrPathToString(
-            instance,
-            suggestedBindings->suggestedBindings[i].binding,
-            sizeof(pathStr), &pathLen, pathStr);
+        uintptr_t key = (uintptr_t)suggestedBindings->suggestedBindings[i].action;
+        if (binding.vec2f)      vec2f[vec2fCount++]   = { key, binding.vec2f };
+        if (binding.floatValue) floats[floatCount++]  = { key, binding.floatValue };
+        matched |= binding.leftStick;
+    }
+    if (cached) PathCacheUnlock(cache);
 
-        if (XR_FAILED(pr) || pathLen == 0) continue;
+    LOG_INFO("  -> %u vector2f / %u float actions tracked, %u paths resolved",
+             vec2fCount, floatCount, resolved);
 
-        BOOL isLeft       = strstr(pathStr, "/user/hand/left") != NULL;
-        BOOL isThumbstick = strstr(pathStr, "thumbstick")      != NULL;
+    if (!TrackedActionsPublish(&inst->tracked, vec2f, vec2fCount, floats, floatCount, matched)) {
+        LOG_ERROR("  ERROR: out of memory growing action set");
+    }
 
-        if (isLeft && isThumbstick) {
-            uintptr_t key = (uintptr_t)suggestedBindings->suggestedBindings[i].action;
+    LayerArenaReset(&scratch);
+    return result;
+}
 
-            char logBuf[320];
-            sprintf_s(logBuf, "  Tracked binding: %s (action=%p)", pathStr, (void*)key);
-            Log(logBuf);
+// ─── Intercepted: xrSyncActions ─────────────────────────────────
 
-            if (strstr(pathStr, "thumbstick/y")) {
-                AddAction(g_tracked.floatY, &g_tracked.floatYCount, key);
-            } else if (!strstr(pathStr, "thumbstick/x")) {
-                AddAction(g_tracked.vec2f, &g_tracked.vec2fCount, key);
-            }
-            g_tracked.bindingsReceived = TRUE;
-        }
-    }
+static XrResult XRAPI_CALL
+TreadmillLayer_xrSyncActions(
+    XrSession session,
+    const XrActionsSyncInfo* syncInfo)
+{
+    TELEMETRY_SCOPE(TELEMETRY_CALL_SYNC_ACTIONS);
+    LayerInstance* inst = FindSession(session);
+    if (!inst) return XR_ERROR_HANDLE_INVALID;
 
-    LeaveCriticalSection(&g_cs);
+    TELEMETRY_PAUSE();
+    XrResult result = inst->next.SyncActions(session, syncInfo);
+    TELEMETRY_RESUME();
+    if (XR_FAILED(result)) return result;
+
+    EnsureInitialized(inst);
+    LatchFrameSnapshot(inst);
     return result;
 }
 
@@ -224,34 +1264,35 @@ TreadmillLayer_xrGetActionStateVector2f(
     const XrActionStateGetInfo* getInfo,
     XrActionStateVector2f* state)
 {
-    XrResult result = g_xrGetActionStateVector2f(session, getInfo, state);
-    if (XR_FAILED(result)) return result;
+    TELEMETRY_SCOPE(TELEMETRY_CALL_GET_ACTION_STATE_VECTOR2F);
+    const LayerInstance* inst = FindSession(session);
+    if (!inst) return XR_ERROR_HANDLE_INVALID;
 
-    // Only inject on left hand subaction (or XR_NULL_PATH which means "any")
-    if (getInfo->subactionPath != XR_NULL_PATH && getInfo->subactionPath != g_leftHandPath)
-        return result;
+    TELEMETRY_PAUSE();
+    XrResult result = inst->next.GetActionStateVector2f(session, getInfo, state);
+    TELEMETRY_RESUME();
+    if (XR_FAILED(result)) return result;
 
-    float velocity = ReadTreadmillVelocity();
-    if (velocity == 0.0f) return result;
+    // Fallback before any left-thumbstick binding: treat every vector2f as the left stick
+    const TrackedActions* tracked = TrackedActionsAcquire(&inst->tracked);
+    InjectTarget target = TrackedActionsVec2fTarget(tracked, (uintptr_t)getInfo->action);
+    if (!target && TrackedActionsFallback(tracked)) target = kInjectLeftStick;
+    if (!target) return result;
 
-    BOOL shouldInject = FALSE;
-    EnterCriticalSection(&g_cs);
-    {
-        uintptr_t key = (uintptr_t)getInfo->action;
-        if (ContainsAction(g_tracked.vec2f, g_tracked.vec2fCount, key)) {
-            shouldInject = TRUE;
-        } else if (!g_tracked.bindingsReceived) {
-            shouldInject = TRUE;   // fallback: inject all left-hand
-        }
+    // Only the target's hand (or XR_NULL_PATH, which means "any")
+    if (!InjectSubactionMatches(target, getInfo->subactionPath, inst->leftHandPath, inst->rightHandPath)) {
+        TELEMETRY_COUNT(skippedSubaction);
+        return result;
     }
-    LeaveCriticalSection(&g_cs);
 
-    if (shouldInject) {
-        state->currentState.y += velocity;
-        if (state->currentState.y >  1.0f) state->currentState.y =  1.0f;
-        if (state->currentState.y < -1.0f) state->currentState.y = -1.0f;
+    // Nothing to inject before the first xrSyncActions (states are inactive anyway)
+    float axes[INJECT_AXIS_COUNT];
+    if (!ReadFrameSnapshot(inst, axes)) return result;
+
+    if (InjectVector2f(&state->currentState, target, axes)) {
         state->isActive = XR_TRUE;
         state->changedSinceLastSync = XR_TRUE;
+        TELEMETRY_COUNT(injected);
     }
 
     return result;
@@ -265,30 +1306,31 @@ TreadmillLayer_xrGetActionStateFloat(
     const XrActionStateGetInfo* getInfo,
     XrActionStateFloat* state)
 {
-    XrResult result = g_xrGetActionStateFloat(session, getInfo, state);
-    if (XR_FAILED(result)) return result;
+    TELEMETRY_SCOPE(TELEMETRY_CALL_GET_ACTION_STATE_FLOAT);
+    const LayerInstance* inst = FindSession(session);
+    if (!inst) return XR_ERROR_HANDLE_INVALID;
 
-    // Only inject on left hand subaction (or XR_NULL_PATH which means "any")
-    if (getInfo->subactionPath != XR_NULL_PATH && getInfo->subactionPath != g_leftHandPath)
-        return result;
+    TELEMETRY_PAUSE();
+    XrResult result = inst->next.GetActionStateFloat(session, getInfo, state);
+    TELEMETRY_RESUME();
+    if (XR_FAILED(result)) return result;
 
-    float velocity = ReadTreadmillVelocity();
-    if (velocity == 0.0f) return result;
+    const TrackedActions* tracked = TrackedActionsAcquire(&inst->tracked);
+    InjectTarget target = TrackedActionsFloatTarget(tracked, (uintptr_t)getInfo->action);
+    if (!target) return result;
 
-    BOOL shouldInject = FALSE;
-    EnterCriticalSection(&g_cs);
-    {
-        uintptr_t key = (uintptr_t)getInfo->action;
-        shouldInject = ContainsAction(g_tracked.floatY, g_tracked.floatYCount, key);
+    if (!InjectSubactionMatches(target, getInfo->subactionPath, inst->leftHandPath, inst->rightHandPath)) {
+        TELEMETRY_COUNT(skippedSubaction);
+        return result;
     }
-    LeaveCriticalSection(&g_cs);
 
-    if (shouldInject) {
-        state->currentState += velocity;
-        if (state->currentState >  1.0f) state->currentState =  1.0f;
-        if (state->currentState < -1.0f) state->currentState = -1.0f;
+    float axes[INJECT_AXIS_COUNT];
+    if (!ReadFrameSnapshot(inst, axes)) return result;
+
+    if (InjectFloat(&state->currentState, target, axes)) {
         state->isActive = XR_TRUE;
         state->changedSinceLastSync = XR_TRUE;
+        TELEMETRY_COUNT(injected);
     }
 
     return result;
@@ -296,19 +1338,54 @@ TreadmillLayer_xrGetActionStateFloat(
 
 // ─── Intercepted: xrDestroyInstance ─────────────────────────────
 
+// After the last instance's destroy has let go of the registry lock: the
+// process-wide state goes with it, unless an instance was created
+// meanwhile (it keeps the watcher).
+static void StopServices()
+{
+    ServiceLock();
+    RegistryLock();
+    bool idle = g_instanceCount == 0;
+    RegistryUnlock();
+    if (idle) {
+        PlatformWorkerStop(&g_sharedWatcher, true);
+        CloseSharedMemory();
+        VelocityTraceClose();
+
+        // An instance that never reached the watcher still gets its trace
+        WriteStartupTrace();
+        StartupTraceReset(&g_startupTrace, g_startupTraceKeep);
+        g_startupTraceWritten = false;
+
+        // Before a new watcher can reopen the log
+        LogFlush();
+    }
+    ServiceUnlock();
+}
+
 static XrResult XRAPI_CALL
 TreadmillLayer_xrDestroyInstance(XrInstance instance)
 {
-    Log("xrDestroyInstance");
-    CloseSharedMemory();
-
-    EnterCriticalSection(&g_cs);
-    memset(&g_tracked, 0, sizeof(g_tracked));
-    LeaveCriticalSection(&g_cs);
-
-    g_instance = XR_NULL_HANDLE;
-    XrResult r = g_xrDestroyInstance(instance);
-    LogClose();
+    TELEMETRY_SCOPE(TELEMETRY_CALL_DESTROY_INSTANCE);
+    LayerInstance* inst = FindInstance(instance);
+    if (!inst) return XR_ERROR_HANDLE_INVALID;
+
+    LOG_INFO("xrDestroyInstance");
+    PFN_xrDestroyInstance destroy = inst->next.DestroyInstance;
+
+    // Its session goes with it
+    RegistryLock();
+    if (inst->session) HandleMapRemove(&g_sessionMap, HandleKey(inst->session));
+    HandleMapRemove(&g_instanceMap, HandleKey(instance));
+    ReleaseInstance(inst);
+    bool last = g_instanceCount == 0;
+    RegistryUnlock();
+
+    if (last) StopServices();
+
+    TELEMETRY_PAUSE();
+    XrResult r = destroy(instance);
+    TELEMETRY_RESUME();
     return r;
 }
 
@@ -320,44 +1397,60 @@ TreadmillLayer_xrGetInstanceProcAddr(
     const char* name,
     PFN_xrVoidFunction* function)
 {
-    if (strcmp(name, "xrGetInstanceProcAddr") == 0) {
-        *function = (PFN_xrVoidFunction)TreadmillLayer_xrGetInstanceProcAddr;
-        return XR_SUCCESS;
-    }
-    if (strcmp(name, "xrDestroyInstance") == 0) {
-        *function = (PFN_xrVoidFunction)TreadmillLayer_xrDestroyInstance;
-        return XR_SUCCESS;
-    }
-    if (strcmp(name, "xrSuggestInteractionProfileBindings") == 0) {
-        *function = (PFN_xrVoidFunction)TreadmillLayer_xrSuggestInteractionProfileBindings;
-        return XR_SUCCESS;
-    }
-    if (strcmp(name, "xrGetActionStateVector2f") == 0) {
-        *function = (PFN_xrVoidFunction)TreadmillLayer_xrGetActionStateVector2f;
-        return XR_SUCCESS;
+    TELEMETRY_SCOPE(TELEMETRY_CALL_GET_INSTANCE_PROC_ADDR);
+
+    // Thunks in TREADMILL_INTERCEPTS order (see proc_table.h)
+#define TREADMILL_INTERCEPT_PROC(fn) (PFN_xrVoidFunction)TreadmillLayer_##fn,
+    static const PFN_xrVoidFunction procs[] = { TREADMILL_INTERCEPTS(TREADMILL_INTERCEPT_PROC) };
+#undef TREADMILL_INTERCEPT_PROC
+
+    // An instance the layer could not register is passed through untouched
+    const LayerInstance* inst = instance ? FindInstance(instance) : NULL;
+    if (instance && !inst) {
+        TELEMETRY_PAUSE();
+        return g_nextGetInstanceProcAddr(instance, name, function);
     }
-    if (strcmp(name, "xrGetActionStateFloat") == 0) {
-        *function = (PFN_xrVoidFunction)TreadmillLayer_xrGetActionStateFloat;
+
+    int idx = ProcTableFind(kInterceptTable, kInterceptNames, name);
+    if (idx >= 0) {
+        *function = procs[idx];
         return XR_SUCCESS;
     }
 
-    return g_nextGetInstanceProcAddr(instance, name, function);
+    TELEMETRY_PAUSE();
+    return (inst ? inst->next.GetInstanceProcAddr : g_nextGetInstanceProcAddr)(instance, name, function);
 }
 
 // ─── CreateApiLayerInstance (loader chain) ───────────────────────
 
+static XrResult CreateApiLayerInstance(const XrInstanceCreateInfo*, const XrApiLayerCreateInfo*, XrInstance*);
+
+// The whole of creation is one startup phase; the body is below.
 static XrResult XRAPI_CALL
 TreadmillLayer_xrCreateApiLayerInstance(
     const XrInstanceCreateInfo* info,
     const XrApiLayerCreateInfo* layerInfo,
     XrInstance* instance)
 {
-    Log("xrCreateApiLayerInstance entered");
+    TELEMETRY_SCOPE(TELEMETRY_CALL_CREATE_API_LAYER_INSTANCE);
+    LogStart();
+    int phase = TraceBegin("xrCreateApiLayerInstance");
+    XrResult result = CreateApiLayerInstance(info, layerInfo, instance);
+    TraceEnd(phase);
+    return result;
+}
+
+static XrResult CreateApiLayerInstance(
+    const XrInstanceCreateInfo* info,
+    const XrApiLayerCreateInfo* layerInfo,
+    XrInstance* instance)
+{
+    LOG_INFO("xrCreateApiLayerInstance entered");
 
     // Grab next pointers from chain
     XrApiLayerNextInfo* nextInfo = layerInfo->nextInfo;
     if (!nextInfo) {
-        Log("  ERROR: nextInfo is NULL");
+        LOG_ERROR("  ERROR: nextInfo is NULL");
         return XR_ERROR_INITIALIZATION_FAILED;
     }
 
@@ -365,7 +1458,7 @@ TreadmillLayer_xrCreateApiLayerInstance(
     PFN_xrCreateApiLayerInstance    nextCreate  = nextInfo->nextCreateApiLayerInstance;
 
     if (!nextGIPA || !nextCreate) {
-        Log("  ERROR: next function pointers are NULL");
+        LOG_ERROR("  ERROR: next function pointers are NULL");
         return XR_ERROR_INITIALIZATION_FAILED;
     }
 
@@ -373,119 +1466,172 @@ TreadmillLayer_xrCreateApiLayerInstance(
     XrApiLayerCreateInfo nextLayerInfo = *layerInfo;
     nextLayerInfo.nextInfo = nextInfo->next;
 
-    Log("  Chaining to next layer/runtime...");
-    XrResult result = nextCreate(info, &nextLayerInfo, instance);
+    char predictEnv[16];
+    bool hasPredictEnv = PlatformGetEnv(PREDICTION_MODE_ENV, predictEnv, sizeof(predictEnv));
+    int  predictMode   = VelocityPredictParseMode(hasPredictEnv ? predictEnv : NULL, PREDICT_MODE_DEFAULT);
+
+    // Prediction needs xrWaitFrame's display time on the sample clock, so
+    // ask for the runtime's XrTime conversion extension if the app didn't.
+    // A runtime without it fails with EXTENSION_NOT_PRESENT; retry as-is.
+    // Not for an instance the full pool will pass through: it is created
+    // as the app asked (unless the pool fills up during this call).
+    RegistryLock();
+    bool poolFull = g_instanceCount >= LAYER_MAX_INSTANCES;
+    RegistryUnlock();
+
+    bool        timeExtEnabled  = false;
+    bool        timeExtAdded    = false;
+    LayerArena  scratch         = {};
+    XrInstanceCreateInfo withTimeExt = *info;
+    for (uint32_t i = 0; i < info->enabledExtensionCount; i++) {
+        if (strcmp(info->enabledExtensionNames[i], kPlatformXrTimeExtension) == 0) timeExtEnabled = true;
+    }
+    if (!timeExtEnabled && predictMode != PREDICT_OFF && !poolFull) {
+        uint32_t n = info->enabledExtensionCount;
+        const char** names = (const char**)LayerArenaAlloc(&scratch, (n + 1) * sizeof(const char*));
+        if (names) {
+            for (uint32_t i = 0; i < n; i++) names[i] = info->enabledExtensionNames[i];
+            names[n] = kPlatformXrTimeExtension;
+            withTimeExt.enabledExtensionCount = n + 1;
+            withTimeExt.enabledExtensionNames = names;
+            timeExtEnabled = timeExtAdded = true;
+        }
+    }
+
+    LOG_INFO("  Chaining to next layer/runtime...");
+    int phase = TraceBegin("next xrCreateApiLayerInstance");
+    XrResult result = nextCreate(&withTimeExt, &nextLayerInfo, instance);
+    if (result == XR_ERROR_EXTENSION_NOT_PRESENT && timeExtAdded) {
+        LOG_INFO("  Runtime lacks %s, retrying without it", kPlatformXrTimeExtension);
+        timeExtEnabled = false;
+        result = nextCreate(info, &nextLayerInfo, instance);
+    }
+    TraceEnd(phase);
+    LayerArenaReset(&scratch);
     if (XR_FAILED(result)) {
-        char buf[64];
-        sprintf_s(buf, "  Chain returned error: %d", (int)result);
-        Log(buf);
+        LOG_ERROR("  Chain returned error: %d", (int)result);
         return result;
     }
 
-    Log("  Instance created successfully");
-
-    g_instance               = *instance;
+    LOG_INFO("  Instance created successfully");
     g_nextGetInstanceProcAddr = nextGIPA;
 
     // Resolve chained function pointers
-    PFN_xrVoidFunction pfn = NULL;
-
-    g_nextGetInstanceProcAddr(*instance, "xrDestroyInstance", &pfn);
-    g_xrDestroyInstance = (PFN_xrDestroyInstance)pfn;
+    phase = TraceBegin("resolve next functions");
+    LayerDispatch next = {};
+    next.GetInstanceProcAddr = nextGIPA;
+#define RESOLVE_NEXT(fn) \
+    do { \
+        PFN_xrVoidFunction pfn = NULL; \
+        nextGIPA(*instance, "xr" #fn, &pfn); \
+        next.fn = (PFN_xr##fn)pfn; \
+    } while (0)
+    RESOLVE_NEXT(DestroyInstance);
+    RESOLVE_NEXT(PathToString);
+    RESOLVE_NEXT(StringToPath);
+    RESOLVE_NEXT(SuggestInteractionProfileBindings);
+    RESOLVE_NEXT(CreateSession);
+    RESOLVE_NEXT(DestroySession);
+    RESOLVE_NEXT(SyncActions);
+    RESOLVE_NEXT(GetActionStateVector2f);
+    RESOLVE_NEXT(GetActionStateFloat);
+    RESOLVE_NEXT(WaitFrame);
+#undef RESOLVE_NEXT
 
-    g_nextGetInstanceProcAddr(*instance, "xrPathToString", &pfn);
-    g_xrPathToString = (PFN_xrPathToString)pfn;
-
-    g_nextGetInstanceProcAddr(*instance, "xrStringToPath", &pfn);
-    g_xrStringToPath = (PFN_xrStringToPath)pfn;
-
-    // Resolve left hand path for subaction filtering
-    if (g_xrStringToPath) {
-        g_xrStringToPath(*instance, "/user/hand/left", &g_leftHandPath);
-        char buf[64];
-        sprintf_s(buf, "  Left hand path resolved: %llu", (unsigned long long)g_leftHandPath);
-        Log(buf);
+    PFN_xrVoidFunction pfn = NULL;
+    if (timeExtEnabled && XR_SUCCEEDED(nextGIPA(*instance, kPlatformXrTimeConvertFn, &pfn)))
+        next.ConvertTime = pfn;
+    TraceEnd(phase);
+    LOG_INFO("  Prediction: %s (display time %s)", VelocityPredictModeName(predictMode),
+             next.ConvertTime ? "available" : "unavailable");
+
+    // Profile, paths and shared memory wait for the first input call
+    RegistryLock();
+    LayerInstance* inst = RegisterInstance(*instance);
+    if (inst) {
+        inst->next        = next;
+        inst->predictMode = predictMode;
+        CopyAppName(inst->applicationName, info->applicationInfo.applicationName, sizeof(inst->applicationName));
+        CopyAppName(inst->engineName, info->applicationInfo.engineName, sizeof(inst->engineName));
+        inst->lazyState.store(LAZY_PENDING, std::memory_order_release);
     }
+    uint32_t live = g_instanceCount;
+    RegistryUnlock();
 
-    g_nextGetInstanceProcAddr(*instance, "xrSuggestInteractionProfileBindings", &pfn);
-    g_xrSuggestInteractionProfileBindings = (PFN_xrSuggestInteractionProfileBindings)pfn;
-
-    g_nextGetInstanceProcAddr(*instance, "xrGetActionStateVector2f", &pfn);
-    g_xrGetActionStateVector2f = (PFN_xrGetActionStateVector2f)pfn;
-
-    g_nextGetInstanceProcAddr(*instance, "xrGetActionStateFloat", &pfn);
-    g_xrGetActionStateFloat = (PFN_xrGetActionStateFloat)pfn;
-
-    Log("  Function pointers resolved");
+    if (!inst) {
+        LOG_WARN("  %u instances already live; this one is passed through without treadmill input", live);
+        if (timeExtAdded && timeExtEnabled)
+            LOG_WARN("  It was created with %s added, as the pool filled up meanwhile", kPlatformXrTimeExtension);
+        return XR_SUCCESS;
+    }
+    LOG_INFO("  Instance ready (%u live); profile, paths and shared memory deferred to first use", live);
+    return XR_SUCCESS;
+}
 
-    OpenSharedMemory();
+// ─── Module Unload (DllMain detach / ELF destructor) ────────────
 
-    Log("  Layer initialization complete");
-    return XR_SUCCESS;
+static void LayerOnUnload()
+{
+    PlatformWorkerStop(&g_sharedWatcher, false);
+    for (uint32_t i = 0; i < LAYER_MAX_INSTANCES; i++) TrackedActionsReclaimAll(&g_instances[i].tracked);
+    VelocityTraceClose();
+    LogClose(false);
 }
 
 // ─── Loader Negotiation (exported entry point) ──────────────────
 
+static XrResult NegotiateLoaderApiLayerInterface(const XrNegotiateLoaderInfo*, const char*,
+                                                 XrNegotiateApiLayerRequest*);
+
 extern "C" XR_LAYER_EXPORT XrResult XRAPI_CALL
 xrNegotiateLoaderApiLayerInterface(
     const XrNegotiateLoaderInfo*     loaderInfo,
     const char*                      layerName,
     XrNegotiateApiLayerRequest*      apiLayerRequest)
 {
-    LogOpen();
-    Log("=== Treadmill OpenXR Layer loaded ===");
+    LogStart();
+    int phase = TraceBegin("xrNegotiateLoaderApiLayerInterface");
+    XrResult result = NegotiateLoaderApiLayerInterface(loaderInfo, layerName, apiLayerRequest);
+    TraceEnd(phase);
+    if (phase >= 0) g_startupTraceKeep = (uint32_t)phase + 1;
+    return result;
+}
+
+static XrResult NegotiateLoaderApiLayerInterface(
+    const XrNegotiateLoaderInfo*     loaderInfo,
+    const char*                      layerName,
+    XrNegotiateApiLayerRequest*      apiLayerRequest)
+{
+    LOG_INFO("=== Treadmill OpenXR Layer loaded ===");
 
     if (!loaderInfo || !layerName || !apiLayerRequest) {
-        Log("ERROR: null parameter");
+        LOG_ERROR("ERROR: null parameter");
         return XR_ERROR_INITIALIZATION_FAILED;
     }
 
-    char buf[384];
-    sprintf_s(buf, "Loader info: structType=%d minIface=%u maxIface=%u",
-              (int)loaderInfo->structType,
-              loaderInfo->minInterfaceVersion,
-              loaderInfo->maxInterfaceVersion);
-    Log(buf);
+    LOG_INFO("Loader info: structType=%d minIface=%u maxIface=%u",
+             (int)loaderInfo->structType,
+             loaderInfo->minInterfaceVersion,
+             loaderInfo->maxInterfaceVersion);
 
     if (loaderInfo->structType != XR_LOADER_INTERFACE_STRUCT_LOADER_INFO) {
-        Log("ERROR: wrong structType");
+        LOG_ERROR("ERROR: wrong structType");
         return XR_ERROR_INITIALIZATION_FAILED;
     }
 
     if (loaderInfo->minInterfaceVersion > 1 || loaderInfo->maxInterfaceVersion < 1) {
-        Log("ERROR: interface version mismatch");
+        LOG_ERROR("ERROR: interface version mismatch");
         return XR_ERROR_INITIALIZATION_FAILED;
     }
 
-    EnsureCritSec();
+    PlatformSetUnloadHandler(LayerOnUnload);
 
     apiLayerRequest->layerInterfaceVersion  = 1;
     apiLayerRequest->layerApiVersion        = XR_CURRENT_API_VERSION;
     apiLayerRequest->getInstanceProcAddr    = TreadmillLayer_xrGetInstanceProcAddr;
     apiLayerRequest->createApiLayerInstance = TreadmillLayer_xrCreateApiLayerInstance;
 
-    sprintf_s(buf, "Negotiation OK for layer '%s'", layerName);
-    Log(buf);
+    LOG_INFO("Negotiation OK for layer '%s'", layerName);
 
     return XR_SUCCESS;
 }
-
-// ─── DllMain (minimal — just ensure we don't do anything unsafe) ─
-
-BOOL APIENTRY DllMain(HMODULE hModule, DWORD reason, LPVOID lpReserved)
-{
-    (void)hModule; (void)lpReserved;
-    switch (reason) {
-    case DLL_PROCESS_ATTACH:
-        DisableThreadLibraryCalls(hModule);
-        break;
-    case DLL_PROCESS_DETACH:
-        if (g_csInitialized) {
-            DeleteCriticalSection(&g_cs);
-            g_csInitialized = FALSE;
-        }
-        LogClose();
-        break;
-    }
-    return TRUE;
-}
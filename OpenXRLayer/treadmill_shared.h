@@ -0,0 +1,468 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Shared Memory Protocol (v5)
+// ═══════════════════════════════════════════════════════════════════
+// Layout of the named memory-mapped file written by the WPF companion
+// app (SharedMemoryService.cs) and read by the OpenXR layer.
+//
+// The sample is guarded by a seqlock: the writer bumps `sequence` to
+// an odd value, stores the payload, then bumps it back to even. The
+// reader retries a bounded number of times, so a read is wait-free and
+// never observes a torn {velocity, timestamp, active} triple.
+//
+// v3 adds raw delta streaming: in TREADMILL_STREAM_RAW_DELTAS mode the
+// app also pushes every raw, timestamped treadmill delta into a ring
+// and publishes its filter settings, and the layer runs the input core
+// (input_core.h) itself over exactly the events of each frame interval.
+// The seqlocked sample still carries `active` and the heartbeat.
+//
+// v4 adds a history ring: every sample the app publishes is also
+// appended to an SPMC ring (shared_ring.h), so a reader that samples
+// late still sees each tick's velocity rather than only the newest.
+// `generation` (in what was reserved space, so still v4) is bumped by
+// every writer start: a reader that kept the mapping across a companion
+// restart sees the new generation and starts over. The two secondary
+// axes — strafe and turn — ride in the seqlocked sample the same way
+// (0 from a writer that does not produce them). The config's `filter`
+// and `adaptivity` likewise took reserved space: an older writer leaves
+// them 0, which is the EMA filter it ran.
+//
+// v5 appends the calibration: counts per meter and the baked response
+// curve (input_core.h), under a seqlock of its own. 0 counts per meter
+// is uncalibrated.
+//
+// Everything here is header-only and platform-neutral so the protocol
+// can be unit-tested on Linux. Keep the offsets in sync with the C#
+// writer — they are part of the wire format.
+// ═══════════════════════════════════════════════════════════════════
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+
+#include "shared_ring.h"
+
+// ─── Constants ──────────────────────────────────────────────────
+
+#define TREADMILL_SHARED_MEM_NAME       "TreadmillDriverVelocity"
+#define TREADMILL_SHARED_MAGIC          0x32564D54u     // "TMV2"
+#define TREADMILL_SHARED_VERSION        5
+#define TREADMILL_SHARED_SIZE           49728
+#define TREADMILL_SEQLOCK_MAX_RETRIES   4
+
+#define TREADMILL_STREAM_VELOCITY       0               // layer uses the app's filtered velocity
+#define TREADMILL_STREAM_RAW_DELTAS     1               // layer filters the delta ring per frame
+
+#define TREADMILL_DELTA_RING_SIZE       2048            // entries, power of two (256 ms at 8 kHz)
+#define TREADMILL_VELOCITY_RING_SIZE    1024            // entries, power of two (1 s at the 1 kHz max tick)
+#define TREADMILL_CURVE_SIZE            64              // TREADMILL_INPUT_CURVE_SIZE
+
+// ─── Layout ─────────────────────────────────────────────────────
+//
+//  off  size  field
+//    0     4  magic               TREADMILL_SHARED_MAGIC
+//    4     2  version             TREADMILL_SHARED_VERSION
+//    6     2  headerSize          sizeof(TreadmillSharedHeader)
+//    8     4  totalSize           TREADMILL_SHARED_SIZE
+//   12     4  reserved
+//   16     8  timestampFrequency  writer clock ticks per second
+//   24     4  sequence            seqlock counter (odd = write in progress)
+//   28     4  heartbeat           incremented on every writer tick
+//   32     8  timestamp           writer clock ticks of this sample
+//   40     4  velocity            float, -1 … 1
+//   44     4  active              non-zero while the app is capturing
+//   48     4  streamMode          TREADMILL_STREAM_*
+//   52     4  generation          bumped each time a writer starts
+//   56     4  strafe              float, -1 … 1 (seqlocked with the sample)
+//   60     4  turn                float, -1 … 1 (seqlocked with the sample)
+//
+//   64     4  configSequence      seqlock counter of the filter config
+//   68     4  invertDirection
+//   72     8  sensitivity         double bits (TreadmillInputConfig)
+//   80     8  deadZone
+//   88     8  smoothing
+//   96     8  maxSpeed
+//  104     4  filter              TREADMILL_INPUT_FILTER_*
+//  108     4  reserved
+//  112     8  adaptivity          double bits
+//  120     8  reserved
+//
+//  128  32832 deltaRing           SharedRing of 2048 TreadmillDelta
+//                                 {int64 timestamp, int32 dx, int32 dy}:
+//                                 head at 128, slots from 192
+//
+// 32960  16448 velocityRing       SharedRing of 1024 TreadmillVelocitySample
+//                                 {int64 timestamp, float velocity, uint32 heartbeat}:
+//                                 head at 32960, slots from 33024
+//
+// 49408     4  calibrationSequence seqlock counter of the calibration
+// 49412     4  reserved
+// 49416     8  countsPerMeter      double bits; 0 = uncalibrated
+// 49424     8  topSpeed            double bits, m/s
+// 49432   256  curve               64 float bits, output at i × topSpeed / 63
+// 49688    40  reserved
+
+struct TreadmillSharedHeader {
+    uint32_t    magic;
+    uint16_t    version;
+    uint16_t    headerSize;
+    uint32_t    totalSize;
+    uint32_t    reserved;
+    int64_t     timestampFrequency;
+};
+
+// One raw delta (delta ring entry).
+struct TreadmillDelta {
+    int64_t     timestamp;      // writer clock ticks
+    int32_t     dx;
+    int32_t     dy;
+};
+
+// One published sample (velocity ring entry); forward axis only.
+struct TreadmillVelocitySample {
+    int64_t     timestamp;      // writer clock ticks
+    float       velocity;
+    uint32_t    heartbeat;
+};
+
+typedef SharedRing<TreadmillDelta, TREADMILL_DELTA_RING_SIZE>               TreadmillDeltaRing;
+typedef SharedRing<TreadmillVelocitySample, TREADMILL_VELOCITY_RING_SIZE>   TreadmillVelocityRing;
+
+struct TreadmillSharedData {
+    TreadmillSharedHeader   header;
+    std::atomic<uint32_t>   sequence;
+    std::atomic<uint32_t>   heartbeat;
+    std::atomic<int64_t>    timestamp;
+    std::atomic<uint32_t>   velocityBits;
+    std::atomic<uint32_t>   active;
+    std::atomic<uint32_t>   streamMode;
+    std::atomic<uint32_t>   generation;
+    std::atomic<uint32_t>   strafeBits;
+    std::atomic<uint32_t>   turnBits;
+
+    std::atomic<uint32_t>   configSequence;
+    std::atomic<uint32_t>   configInvert;
+    std::atomic<uint64_t>   configSensitivity;
+    std::atomic<uint64_t>   configDeadZone;
+    std::atomic<uint64_t>   configSmoothing;
+    std::atomic<uint64_t>   configMaxSpeed;
+    std::atomic<uint32_t>   configFilter;
+    uint32_t                configPadding;
+    std::atomic<uint64_t>   configAdaptivity;
+    uint8_t                 configReserved[8];
+
+    TreadmillDeltaRing      deltaRing;
+    TreadmillVelocityRing   velocityRing;
+
+    std::atomic<uint32_t>   calibrationSequence;
+    uint32_t                calibrationPadding;
+    std::atomic<uint64_t>   calibrationCountsPerMeter;
+    std::atomic<uint64_t>   calibrationTopSpeed;
+    std::atomic<uint32_t>   calibrationCurve[TREADMILL_CURVE_SIZE];
+    uint8_t                 calibrationReserved[40];
+};
+
+static_assert(sizeof(TreadmillSharedHeader) == 24, "header layout is part of the wire format");
+static_assert(sizeof(TreadmillSharedData) == TREADMILL_SHARED_SIZE, "shared layout is part of the wire format");
+static_assert(offsetof(TreadmillSharedData, sequence)     == 24, "wire format");
+static_assert(offsetof(TreadmillSharedData, timestamp)    == 32, "wire format");
+static_assert(offsetof(TreadmillSharedData, velocityBits) == 40, "wire format");
+static_assert(offsetof(TreadmillSharedData, active)       == 44, "wire format");
+static_assert(offsetof(TreadmillSharedData, streamMode)   == 48, "wire format");
+static_assert(offsetof(TreadmillSharedData, generation)   == 52, "wire format");
+static_assert(offsetof(TreadmillSharedData, turnBits)     == 60, "wire format");
+static_assert(offsetof(TreadmillSharedData, configSequence)    == 64,  "wire format");
+static_assert(offsetof(TreadmillSharedData, configSensitivity) == 72,  "wire format");
+static_assert(offsetof(TreadmillSharedData, configMaxSpeed)    == 96,  "wire format");
+static_assert(offsetof(TreadmillSharedData, configFilter)      == 104, "wire format");
+static_assert(offsetof(TreadmillSharedData, configAdaptivity)  == 112, "wire format");
+static_assert(offsetof(TreadmillSharedData, deltaRing)         == 128,   "wire format");
+static_assert(offsetof(TreadmillSharedData, velocityRing)      == 32960, "wire format");
+static_assert(offsetof(TreadmillSharedData, calibrationSequence) == 49408, "wire format");
+static_assert(offsetof(TreadmillSharedData, calibrationCurve)    == 49432, "wire format");
+static_assert(offsetof(TreadmillDeltaRing, slots)              == 64,    "wire format");
+static_assert(sizeof(TreadmillDelta) == 16 && sizeof(TreadmillVelocitySample) == 16, "wire format");
+
+// One consistent snapshot of the shared sample.
+struct TreadmillSample {
+    int64_t     timestamp;
+    float       velocity;       // forward
+    float       strafe;
+    float       turn;
+    uint32_t    heartbeat;
+    uint32_t    active;
+};
+
+// Filter settings as published by the app; same fields as TreadmillInputConfig.
+struct TreadmillFilterConfig {
+    double      sensitivity;
+    double      deadZone;
+    double      smoothing;
+    double      maxSpeed;
+    uint32_t    invertDirection;
+    uint32_t    filter;
+    double      adaptivity;
+};
+
+// Calibration as published by the app; same fields as TreadmillInputCalibration.
+struct TreadmillCalibrationConfig {
+    double      countsPerMeter;
+    double      topSpeed;
+    float       curve[TREADMILL_CURVE_SIZE];
+};
+
+// ─── Helpers ────────────────────────────────────────────────────
+
+static inline uint32_t TreadmillFloatBits(float f)
+{
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static inline float TreadmillBitsFloat(uint32_t u)
+{
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+static inline uint64_t TreadmillDoubleBits(double d)
+{
+    uint64_t u;
+    memcpy(&u, &d, sizeof(u));
+    return u;
+}
+
+static inline double TreadmillBitsDouble(uint64_t u)
+{
+    double d;
+    memcpy(&d, &u, sizeof(d));
+    return d;
+}
+
+// Returns true if the mapping carries a v5 header we understand.
+static inline bool TreadmillSharedValidate(const TreadmillSharedData* d)
+{
+    return d->header.magic      == TREADMILL_SHARED_MAGIC
+        && d->header.version    == TREADMILL_SHARED_VERSION
+        && d->header.headerSize == sizeof(TreadmillSharedHeader)
+        && d->header.totalSize  >= TREADMILL_SHARED_SIZE
+        && d->header.timestampFrequency > 0;
+}
+
+// ─── Reader ─────────────────────────────────────────────────────
+
+// Wait-free seqlock read. Returns false if the writer kept the
+// sequence odd or changed it under us on every attempt; callers
+// should then fall back to their previous sample.
+static inline bool TreadmillSharedRead(const TreadmillSharedData* d, TreadmillSample* out)
+{
+    for (int attempt = 0; attempt < TREADMILL_SEQLOCK_MAX_RETRIES; attempt++) {
+        uint32_t s0 = d->sequence.load(std::memory_order_acquire);
+        if (s0 & 1) continue;
+
+        int64_t  ts     = d->timestamp.load(std::memory_order_relaxed);
+        uint32_t vbits  = d->velocityBits.load(std::memory_order_relaxed);
+        uint32_t sbits  = d->strafeBits.load(std::memory_order_relaxed);
+        uint32_t tbits  = d->turnBits.load(std::memory_order_relaxed);
+        uint32_t active = d->active.load(std::memory_order_relaxed);
+        uint32_t beat   = d->heartbeat.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (d->sequence.load(std::memory_order_relaxed) != s0) continue;
+
+        out->timestamp = ts;
+        out->velocity  = TreadmillBitsFloat(vbits);
+        out->strafe    = TreadmillBitsFloat(sbits);
+        out->turn      = TreadmillBitsFloat(tbits);
+        out->heartbeat = beat;
+        out->active    = active;
+        return true;
+    }
+    return false;
+}
+
+// Returns true if `sample` is older than `maxAgeTicks` at time `now`.
+static inline bool TreadmillSampleIsStale(const TreadmillSample* sample, int64_t now, int64_t maxAgeTicks)
+{
+    return now - sample->timestamp > maxAgeTicks;
+}
+
+// True while a writer is publishing: active, and its newest sample no
+// older than `maxAgeTicks`. A writer mid-update counts as live.
+static inline bool TreadmillSharedIsLive(const TreadmillSharedData* d, int64_t now, int64_t maxAgeTicks)
+{
+    TreadmillSample sample;
+    if (!TreadmillSharedRead(d, &sample)) return true;
+    return sample.active && !TreadmillSampleIsStale(&sample, now, maxAgeTicks);
+}
+
+// Seqlocked read of the filter config, same retry policy as the sample.
+static inline bool TreadmillConfigRead(const TreadmillSharedData* d, TreadmillFilterConfig* out)
+{
+    for (int attempt = 0; attempt < TREADMILL_SEQLOCK_MAX_RETRIES; attempt++) {
+        uint32_t s0 = d->configSequence.load(std::memory_order_acquire);
+        if (s0 & 1) continue;
+
+        uint64_t sensitivity = d->configSensitivity.load(std::memory_order_relaxed);
+        uint64_t deadZone    = d->configDeadZone.load(std::memory_order_relaxed);
+        uint64_t smoothing   = d->configSmoothing.load(std::memory_order_relaxed);
+        uint64_t maxSpeed    = d->configMaxSpeed.load(std::memory_order_relaxed);
+        uint32_t invert      = d->configInvert.load(std::memory_order_relaxed);
+        uint32_t filter      = d->configFilter.load(std::memory_order_relaxed);
+        uint64_t adaptivity  = d->configAdaptivity.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (d->configSequence.load(std::memory_order_relaxed) != s0) continue;
+
+        out->sensitivity     = TreadmillBitsDouble(sensitivity);
+        out->deadZone        = TreadmillBitsDouble(deadZone);
+        out->smoothing       = TreadmillBitsDouble(smoothing);
+        out->maxSpeed        = TreadmillBitsDouble(maxSpeed);
+        out->invertDirection = invert;
+        out->filter          = filter;
+        out->adaptivity      = TreadmillBitsDouble(adaptivity);
+        return true;
+    }
+    return false;
+}
+
+// Seqlocked read of the calibration, same retry policy.
+static inline bool TreadmillCalibrationRead(const TreadmillSharedData* d, TreadmillCalibrationConfig* out)
+{
+    for (int attempt = 0; attempt < TREADMILL_SEQLOCK_MAX_RETRIES; attempt++) {
+        uint32_t s0 = d->calibrationSequence.load(std::memory_order_acquire);
+        if (s0 & 1) continue;
+
+        uint64_t countsPerMeter = d->calibrationCountsPerMeter.load(std::memory_order_relaxed);
+        uint64_t topSpeed       = d->calibrationTopSpeed.load(std::memory_order_relaxed);
+        uint32_t curve[TREADMILL_CURVE_SIZE];
+        for (int i = 0; i < TREADMILL_CURVE_SIZE; i++) curve[i] = d->calibrationCurve[i].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (d->calibrationSequence.load(std::memory_order_relaxed) != s0) continue;
+
+        out->countsPerMeter = TreadmillBitsDouble(countsPerMeter);
+        out->topSpeed       = TreadmillBitsDouble(topSpeed);
+        for (int i = 0; i < TREADMILL_CURVE_SIZE; i++) out->curve[i] = TreadmillBitsFloat(curve[i]);
+        return true;
+    }
+    return false;
+}
+
+// Raw deltas (delta ring); a cursor per reader, see shared_ring.h.
+static inline void TreadmillDeltaCursorInit(const TreadmillSharedData* d, SharedRingCursor* cursor)
+{
+    SharedRingCursorInit(&d->deltaRing, cursor);
+}
+
+static inline uint32_t TreadmillDeltaRead(const TreadmillSharedData* d, SharedRingCursor* cursor,
+                                          TreadmillDelta* out, uint32_t max)
+{
+    return SharedRingRead(&d->deltaRing, cursor, out, max);
+}
+
+// Every published sample since the cursor (velocity ring).
+static inline void TreadmillVelocityCursorInit(const TreadmillSharedData* d, SharedRingCursor* cursor)
+{
+    SharedRingCursorInit(&d->velocityRing, cursor);
+}
+
+static inline uint32_t TreadmillVelocityRead(const TreadmillSharedData* d, SharedRingCursor* cursor,
+                                             TreadmillVelocitySample* out, uint32_t max)
+{
+    return SharedRingRead(&d->velocityRing, cursor, out, max);
+}
+
+// ─── Writer ─────────────────────────────────────────────────────
+// Native counterpart of SharedMemoryService.cs. One writer per block:
+// the sample (with the velocity ring), the config and the delta ring
+// may each have their own.
+
+static inline void TreadmillSharedInit(TreadmillSharedData* d, int64_t timestampFrequency)
+{
+    d->header.magic              = TREADMILL_SHARED_MAGIC;
+    d->header.version            = TREADMILL_SHARED_VERSION;
+    d->header.headerSize         = sizeof(TreadmillSharedHeader);
+    d->header.totalSize          = TREADMILL_SHARED_SIZE;
+    d->header.reserved           = 0;
+    d->header.timestampFrequency = timestampFrequency;
+    d->sequence.store(0, std::memory_order_relaxed);
+    d->heartbeat.store(0, std::memory_order_relaxed);
+    d->timestamp.store(0, std::memory_order_relaxed);
+    d->velocityBits.store(0, std::memory_order_relaxed);
+    d->strafeBits.store(0, std::memory_order_relaxed);
+    d->turnBits.store(0, std::memory_order_relaxed);
+    d->streamMode.store(TREADMILL_STREAM_VELOCITY, std::memory_order_relaxed);
+    d->configSequence.store(0, std::memory_order_relaxed);
+    d->calibrationSequence.store(0, std::memory_order_relaxed);
+    SharedRingReset(&d->deltaRing);
+    SharedRingReset(&d->velocityRing);
+    d->generation.fetch_add(1, std::memory_order_relaxed);
+    d->active.store(0, std::memory_order_release);
+}
+
+static inline void TreadmillSharedWriteMotion(TreadmillSharedData* d, float velocity, float strafe, float turn,
+                                              uint32_t active, int64_t timestamp)
+{
+    uint32_t s = d->sequence.load(std::memory_order_relaxed);
+    d->sequence.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    d->timestamp.store(timestamp, std::memory_order_relaxed);
+    d->velocityBits.store(TreadmillFloatBits(velocity), std::memory_order_relaxed);
+    d->strafeBits.store(TreadmillFloatBits(strafe), std::memory_order_relaxed);
+    d->turnBits.store(TreadmillFloatBits(turn), std::memory_order_relaxed);
+    d->active.store(active, std::memory_order_relaxed);
+    uint32_t beat = d->heartbeat.load(std::memory_order_relaxed) + 1;
+    d->heartbeat.store(beat, std::memory_order_relaxed);
+
+    d->sequence.store(s + 2, std::memory_order_release);
+
+    TreadmillVelocitySample sample = { timestamp, velocity, beat };
+    SharedRingWrite(&d->velocityRing, &sample, 1);
+}
+
+// Forward only (strafe and turn 0).
+static inline void TreadmillSharedWrite(TreadmillSharedData* d, float velocity, uint32_t active, int64_t timestamp)
+{
+    TreadmillSharedWriteMotion(d, velocity, 0.0f, 0.0f, active, timestamp);
+}
+
+static inline void TreadmillConfigWrite(TreadmillSharedData* d, const TreadmillFilterConfig* config)
+{
+    uint32_t s = d->configSequence.load(std::memory_order_relaxed);
+    d->configSequence.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    d->configSensitivity.store(TreadmillDoubleBits(config->sensitivity), std::memory_order_relaxed);
+    d->configDeadZone.store(TreadmillDoubleBits(config->deadZone), std::memory_order_relaxed);
+    d->configSmoothing.store(TreadmillDoubleBits(config->smoothing), std::memory_order_relaxed);
+    d->configMaxSpeed.store(TreadmillDoubleBits(config->maxSpeed), std::memory_order_relaxed);
+    d->configInvert.store(config->invertDirection, std::memory_order_relaxed);
+    d->configFilter.store(config->filter, std::memory_order_relaxed);
+    d->configAdaptivity.store(TreadmillDoubleBits(config->adaptivity), std::memory_order_relaxed);
+
+    d->configSequence.store(s + 2, std::memory_order_release);
+}
+
+static inline void TreadmillCalibrationWrite(TreadmillSharedData* d, const TreadmillCalibrationConfig* config)
+{
+    uint32_t s = d->calibrationSequence.load(std::memory_order_relaxed);
+    d->calibrationSequence.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    d->calibrationCountsPerMeter.store(TreadmillDoubleBits(config->countsPerMeter), std::memory_order_relaxed);
+    d->calibrationTopSpeed.store(TreadmillDoubleBits(config->topSpeed), std::memory_order_relaxed);
+    for (int i = 0; i < TREADMILL_CURVE_SIZE; i++)
+        d->calibrationCurve[i].store(TreadmillFloatBits(config->curve[i]), std::memory_order_relaxed);
+
+    d->calibrationSequence.store(s + 2, std::memory_order_release);
+}
+
+static inline void TreadmillDeltaWrite(TreadmillSharedData* d, const TreadmillDelta* deltas, uint32_t count)
+{
+    SharedRingWrite(&d->deltaRing, deltas, count);
+}
@@ -0,0 +1,172 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Velocity Prediction
+// ═══════════════════════════════════════════════════════════════════
+// The newest shared-memory sample is already some milliseconds old when
+// xrSyncActions latches it, and the frame it feeds is displayed one or
+// two frame periods later still. The layer keeps a short history of the
+// samples it has seen and extrapolates to the predicted display time
+// (xrWaitFrame) instead:
+//
+//   linear — least-squares slope over the window, anchored at the
+//            newest sample
+//   accel  — least-squares quadratic (constant acceleration); needs
+//            three samples, otherwise linear
+//
+// Clamping keeps a bad fit harmless: the horizon is capped, the result
+// stays in -1 … 1, and a prediction never crosses zero — stopping on
+// the treadmill must not turn into a step backwards.
+//
+// Header-only and clock-agnostic (timestamps are writer ticks), so the
+// layer, the unit tests and the Linux replay harness share it.
+// ═══════════════════════════════════════════════════════════════════
+
+#include <stdint.h>
+#include <string.h>
+
+// ─── Constants ──────────────────────────────────────────────────
+
+#define VELOCITY_HISTORY_SIZE       16      // 32 ms of the default 500 Hz tick
+#define PREDICTION_MODE_ENV         "TREADMILL_LAYER_PREDICTION"
+
+enum VelocityPredictMode {
+    PREDICT_OFF     = 0,    // newest sample as-is
+    PREDICT_LINEAR  = 1,
+    PREDICT_ACCEL   = 2,
+};
+
+#define PREDICT_MODE_DEFAULT        PREDICT_LINEAR
+
+// ─── State ──────────────────────────────────────────────────────
+
+struct VelocityHistory {
+    int64_t     timestamps[VELOCITY_HISTORY_SIZE];
+    float       velocities[VELOCITY_HISTORY_SIZE];
+    uint32_t    head;       // slot of the next push
+    uint32_t    count;
+};
+
+struct VelocityPredictor {
+    int         mode;               // VelocityPredictMode
+    int64_t     windowTicks;        // fit only samples this close to the newest
+    int64_t     maxHorizonTicks;    // never extrapolate further past the newest
+};
+
+// ─── History ────────────────────────────────────────────────────
+
+static inline void VelocityHistoryReset(VelocityHistory* h)
+{
+    h->head  = 0;
+    h->count = 0;
+}
+
+// i = 0 is the newest sample.
+static inline uint32_t VelocityHistorySlot(const VelocityHistory* h, uint32_t i)
+{
+    return (h->head + VELOCITY_HISTORY_SIZE - 1 - i) % VELOCITY_HISTORY_SIZE;
+}
+
+// Adds a sample. Repeats of the newest timestamp (the writer has not
+// ticked since the last read) and out-of-order samples are ignored.
+static inline void VelocityHistoryPush(VelocityHistory* h, int64_t timestamp, float velocity)
+{
+    if (h->count && timestamp <= h->timestamps[VelocityHistorySlot(h, 0)]) return;
+
+    h->timestamps[h->head] = timestamp;
+    h->velocities[h->head] = velocity;
+    h->head = (h->head + 1) % VELOCITY_HISTORY_SIZE;
+    if (h->count < VELOCITY_HISTORY_SIZE) h->count++;
+}
+
+// Newest velocity, 0 with an empty history.
+static inline float VelocityHistoryNewest(const VelocityHistory* h)
+{
+    return h->count ? h->velocities[VelocityHistorySlot(h, 0)] : 0.0f;
+}
+
+// ─── Configuration ──────────────────────────────────────────────
+
+// "off" / "linear" / "accel" (case-sensitive); anything else → fallback.
+static inline int VelocityPredictParseMode(const char* s, int fallback)
+{
+    if (!s) return fallback;
+    if (strcmp(s, "off") == 0)    return PREDICT_OFF;
+    if (strcmp(s, "linear") == 0) return PREDICT_LINEAR;
+    if (strcmp(s, "accel") == 0)  return PREDICT_ACCEL;
+    return fallback;
+}
+
+static inline const char* VelocityPredictModeName(int mode)
+{
+    switch (mode) {
+    case PREDICT_LINEAR: return "linear";
+    case PREDICT_ACCEL:  return "accel";
+    default:             return "off";
+    }
+}
+
+// ─── Prediction ─────────────────────────────────────────────────
+
+static inline float VelocityPredictClamp(float newest, double predicted)
+{
+    if (newest > 0.0f && predicted < 0.0) return 0.0f;
+    if (newest < 0.0f && predicted > 0.0) return 0.0f;
+    if (predicted >  1.0) return  1.0f;
+    if (predicted < -1.0) return -1.0f;
+    return (float)predicted;
+}
+
+// Velocity expected at writer time `target`. 0 with an empty history.
+static inline float VelocityPredict(const VelocityHistory* h, const VelocityPredictor* p, int64_t target)
+{
+    if (!h->count) return 0.0f;
+
+    uint32_t newestSlot = VelocityHistorySlot(h, 0);
+    int64_t  t0         = h->timestamps[newestSlot];
+    float    v0         = h->velocities[newestSlot];
+
+    int64_t horizon = target - t0;
+    if (horizon > p->maxHorizonTicks) horizon = p->maxHorizonTicks;
+    if (p->mode == PREDICT_OFF || h->count < 2 || horizon <= 0 || p->windowTicks <= 0) return v0;
+
+    // Fit in window units (x ∈ [-1, 0], newest at 0) to keep the sums well conditioned
+    double scale = 1.0 / (double)p->windowTicks;
+    double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0, sx3 = 0, sx4 = 0, sx2y = 0;
+    for (uint32_t i = 0; i < h->count; i++) {
+        uint32_t slot = VelocityHistorySlot(h, i);
+        int64_t  age  = t0 - h->timestamps[slot];
+        if (age > p->windowTicks) break;
+
+        double x = -(double)age * scale;
+        double y = h->velocities[slot];
+        double xx = x * x;
+        n    += 1;
+        sx   += x;
+        sy   += y;
+        sxx  += xx;
+        sxy  += x * y;
+        sx3  += xx * x;
+        sx4  += xx * xx;
+        sx2y += xx * y;
+    }
+    if (n < 2) return v0;
+
+    double hx = (double)horizon * scale;
+
+    if (p->mode == PREDICT_ACCEL && n >= 3) {
+        // Normal equations for y = a + b·x + c·x², solved by Cramer's rule
+        double d = n * (sxx * sx4 - sx3 * sx3) - sx * (sx * sx4 - sx3 * sxx) + sxx * (sx * sx3 - sxx * sxx);
+        if (d > 1e-12 || d < -1e-12) {
+            double db = n * (sxy * sx4 - sx3 * sx2y) - sy * (sx * sx4 - sx3 * sxx) + sxx * (sx * sx2y - sxy * sxx);
+            double dc = n * (sxx * sx2y - sxy * sx3) - sx * (sx * sx2y - sxy * sxx) + sy * (sx * sx3 - sxx * sxx);
+            double b = db / d;
+            double c = dc / d;
+            return VelocityPredictClamp(v0, v0 + b * hx + c * hx * hx);
+        }
+    }
+
+    double varx = n * sxx - sx * sx;
+    if (varx <= 1e-12) return v0;
+    double slope = (n * sxy - sx * sy) / varx;
+    return VelocityPredictClamp(v0, v0 + slope * hx);
+}
@@ -0,0 +1,325 @@
+#pragma once
+// ═══════════════════════════════════════════════════════════════════
+// Treadmill Driver — Velocity Trace Format
+// ═══════════════════════════════════════════════════════════════════
+// A compact, append-only binary record of what the treadmill did: the
+// raw sensor deltas, what the app's filter made of them each tick, and
+// what the layer latched for each frame. The app
+// (VelocityTraceWriter.cs) and the layer ($TREADMILL_VELOCITY_TRACE)
+// each write their own file on the same clock; the replay engine
+// (harness/trace_replay.cpp) merges them by timestamp and feeds them
+// back through the input core and frame_velocity.h.
+//
+// A file is a header followed by records. Each record starts with an
+// 8-byte header whose `dt` is the signed tick difference to the
+// previous record, so most records carry no absolute time. Producers on
+// different threads may be slightly out of order — readers that need
+// order sort by timestamp. A gap that does not fit 32 bits is bridged
+// by a TIME record. Records are multiples of 8 bytes, and readers skip
+// types they do not know and payload bytes beyond what they know, so
+// both may grow without a version bump. A crash leaves at most a
+// partial last record, which readers ignore.
+//
+//  off  size  file header
+//    0     4  magic               VELOCITY_TRACE_MAGIC
+//    4     2  version             VELOCITY_TRACE_VERSION
+//    6     2  headerSize          sizeof(VelocityTraceFileHeader)
+//    8     8  timestampFrequency  clock ticks per second
+//   16     8  startTimestamp      the first record's dt counts from here
+//   24     4  source              VELOCITY_TRACE_SOURCE_*
+//   28     4  reserved
+//
+//  type         channel    payload              meaning
+//  TIME         -          int64 timestamp      absolute time (dt is 0)
+//  START        -          -                    app filters reset, ticks start
+//  STOP         -          -                    app stopped; published inactive
+//  CONFIG       axis       VelocityTraceConfig  app filter settings from here on
+//  STREAM_MODE  mode       -                    app switched TREADMILL_STREAM_*
+//  DELTA        sensor     VelocityTraceDelta   one raw report (capture time)
+//  TICK         -          VelocityTraceTick    one app filter step
+//  FRAME        -          VelocityTraceFrame   one layer xrSyncActions
+//  LAYER        -          VelocityTraceLayer   layer profile scale, prediction mode
+//  LOSS         -          VelocityTraceLoss    records the writer had to drop
+//  CALIBRATION  axis       VelocityTraceCalibration  app counts per meter and curve from here on
+//
+// Little-endian, like the shared-memory protocol. Header-only and
+// allocation-free: the layer encodes into a static buffer.
+// ═══════════════════════════════════════════════════════════════════
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define VELOCITY_TRACE_MAGIC        0x54564D54u     // "TMVT"
+#define VELOCITY_TRACE_VERSION      1
+#define VELOCITY_TRACE_ENV          "TREADMILL_VELOCITY_TRACE"
+
+#define VELOCITY_TRACE_SOURCE_APP   1
+#define VELOCITY_TRACE_SOURCE_LAYER 2
+
+enum VelocityTraceType {
+    VELOCITY_TRACE_TIME         = 1,
+    VELOCITY_TRACE_START        = 2,
+    VELOCITY_TRACE_STOP         = 3,
+    VELOCITY_TRACE_CONFIG       = 4,
+    VELOCITY_TRACE_STREAM_MODE  = 5,
+    VELOCITY_TRACE_DELTA        = 6,
+    VELOCITY_TRACE_TICK         = 7,
+    VELOCITY_TRACE_FRAME        = 8,
+    VELOCITY_TRACE_LAYER        = 9,
+    VELOCITY_TRACE_LOSS         = 10,
+    VELOCITY_TRACE_CALIBRATION  = 11,
+};
+
+// CONFIG channels, as INJECT_AXIS_*
+#define VELOCITY_TRACE_AXIS_FORWARD 0
+#define VELOCITY_TRACE_AXIS_STRAFE  1
+#define VELOCITY_TRACE_AXIS_TURN    2
+#define VELOCITY_TRACE_AXIS_COUNT   3
+
+// DELTA channels
+#define VELOCITY_TRACE_SENSOR_PRIMARY   0       // forward (Y) and strafe (X)
+#define VELOCITY_TRACE_SENSOR_TURN      1       // turn (X)
+
+// Largest record the encoder may emit, including a TIME record before it
+#define VELOCITY_TRACE_RECORD_MAX   (2 * sizeof(VelocityTraceRecordHeader) + 8 + sizeof(VelocityTraceCalibration))
+
+// ─── Layout ─────────────────────────────────────────────────────
+
+struct VelocityTraceFileHeader {
+    uint32_t    magic;
+    uint16_t    version;
+    uint16_t    headerSize;
+    int64_t     timestampFrequency;
+    int64_t     startTimestamp;
+    uint32_t    source;
+    uint32_t    reserved;
+};
+
+struct VelocityTraceRecordHeader {
+    uint8_t     type;
+    uint8_t     channel;
+    uint16_t    size;           // whole record in bytes, a multiple of 8
+    int32_t     dt;             // ticks since the previous record
+};
+
+struct VelocityTraceDelta {
+    int32_t     dx;
+    int32_t     dy;
+};
+
+// input_core.h's TreadmillInputConfig, plus whether the axis is on
+// (a disabled axis outputs 0 and its filter is reset every tick). The
+// filter and adaptivity came later; older traces read as EMA.
+struct VelocityTraceConfig {
+    double      sensitivity;
+    double      deadZone;
+    double      smoothing;
+    double      maxSpeed;
+    int32_t     invertDirection;
+    uint32_t    enabled;
+    int32_t     filter;
+    uint32_t    reserved;
+    double      adaptivity;
+};
+
+// The counts the tick drained and fed to the filters, and their outputs
+// (the elapsed time is the gap to the previous TICK or START). An
+// adaptive forward filter takes the drained events themselves: the
+// next `primaryEvents` primary DELTA records.
+struct VelocityTraceTick {
+    int32_t     primaryDx;
+    int32_t     primaryDy;
+    int32_t     turnDx;
+    int32_t     primaryEvents;
+    double      forward;
+    double      strafe;
+    double      turn;
+};
+
+// What xrSyncActions latched (profile scale applied), at the time it
+// read the block, and the display time it predicted to (0 = none).
+struct VelocityTraceFrame {
+    float       forward;
+    float       strafe;
+    float       turn;
+    uint32_t    frame;
+    int64_t     display;
+};
+
+// The layer's settings for this instance: the profile's scale per
+// axis and PREDICT_* (velocity_predictor.h).
+struct VelocityTraceLayer {
+    float       scale[VELOCITY_TRACE_AXIS_COUNT];
+    int32_t     predictMode;
+};
+
+// input_core.h's TreadmillInputCalibration: counts per meter (0 =
+// uncalibrated) and the baked response curve. Traces without one are
+// uncalibrated.
+struct VelocityTraceCalibration {
+    double      countsPerMeter;
+    double      topSpeed;
+    float       curve[64];
+};
+
+struct VelocityTraceLoss {
+    uint32_t    count;
+    uint32_t    reserved;
+};
+
+static_assert(sizeof(VelocityTraceFileHeader) == 32, "trace format");
+static_assert(sizeof(VelocityTraceRecordHeader) == 8, "trace format");
+static_assert(sizeof(VelocityTraceConfig) == 56 && sizeof(VelocityTraceTick) == 40, "trace format");
+static_assert(sizeof(VelocityTraceFrame) == 24 && sizeof(VelocityTraceLayer) == 16, "trace format");
+static_assert(sizeof(VelocityTraceDelta) == 8 && sizeof(VelocityTraceLoss) == 8, "trace format");
+static_assert(sizeof(VelocityTraceCalibration) == 272, "trace format");
+
+// ─── Writer ─────────────────────────────────────────────────────
+
+struct VelocityTraceEncoder {
+    int64_t     last;           // timestamp the next dt counts from
+};
+
+// Writes the file header and starts `e` at `start`. Returns the bytes
+// written, or 0 if `capacity` is too small.
+static inline size_t VelocityTraceBegin(VelocityTraceEncoder* e, uint8_t* out, size_t capacity,
+                                        int64_t frequency, int64_t start, uint32_t source)
+{
+    if (capacity < sizeof(VelocityTraceFileHeader)) return 0;
+
+    VelocityTraceFileHeader h = {};
+    h.magic              = VELOCITY_TRACE_MAGIC;
+    h.version            = VELOCITY_TRACE_VERSION;
+    h.headerSize         = sizeof(VelocityTraceFileHeader);
+    h.timestampFrequency = frequency;
+    h.startTimestamp     = start;
+    h.source             = source;
+    memcpy(out, &h, sizeof(h));
+    e->last = start;
+    return sizeof(h);
+}
+
+// Appends one record (`payloadSize` is rounded up to 8 with zeros).
+// Returns the bytes written, or 0 if `capacity` is too small — the
+// encoder is then unchanged, so the caller can flush and retry.
+static inline size_t VelocityTraceEncode(VelocityTraceEncoder* e, uint8_t* out, size_t capacity,
+                                         uint8_t type, uint8_t channel, int64_t timestamp,
+                                         const void* payload, size_t payloadSize)
+{
+    size_t padded = (payloadSize + 7) & ~(size_t)7;
+    int64_t dt    = timestamp - e->last;
+    bool    far   = dt > INT32_MAX || dt < INT32_MIN;
+    size_t  need  = (far ? sizeof(VelocityTraceRecordHeader) + 8 : 0) + sizeof(VelocityTraceRecordHeader) + padded;
+    if (padded > UINT16_MAX - sizeof(VelocityTraceRecordHeader) || need > capacity) return 0;
+
+    size_t n = 0;
+    if (far) {
+        VelocityTraceRecordHeader t = { VELOCITY_TRACE_TIME, 0, (uint16_t)(sizeof(t) + 8), 0 };
+        memcpy(out, &t, sizeof(t));
+        memcpy(out + sizeof(t), &timestamp, 8);
+        n  = sizeof(t) + 8;
+        dt = 0;
+    }
+
+    VelocityTraceRecordHeader r = { type, channel, (uint16_t)(sizeof(r) + padded), (int32_t)dt };
+    memcpy(out + n, &r, sizeof(r));
+    n += sizeof(r);
+    if (payloadSize) memcpy(out + n, payload, payloadSize);
+    memset(out + n + payloadSize, 0, padded - payloadSize);
+
+    e->last = timestamp;
+    return n + padded;
+}
+
+// ─── Reader ─────────────────────────────────────────────────────
+
+struct VelocityTraceReader {
+    const uint8_t*          data;
+    size_t                  size;
+    size_t                  offset;
+    int64_t                 timestamp;      // of the last record returned
+    VelocityTraceFileHeader header;
+};
+
+struct VelocityTraceRecord {
+    uint8_t         type;
+    uint8_t         channel;
+    int64_t         timestamp;
+    const uint8_t*  payload;
+    size_t          payloadSize;
+};
+
+// Checks the file header. False if `data` is not a trace this reader
+// understands; the reader is then empty, and VelocityTraceNext returns
+// false.
+static inline bool VelocityTraceOpen(VelocityTraceReader* r, const void* data, size_t size)
+{
+    r->data      = NULL;
+    r->size      = 0;
+    r->offset    = 0;
+    r->timestamp = 0;
+    if (size < sizeof(VelocityTraceFileHeader)) return false;
+    memcpy(&r->header, data, sizeof(r->header));
+    if (r->header.magic != VELOCITY_TRACE_MAGIC || r->header.version != VELOCITY_TRACE_VERSION) return false;
+    if (r->header.headerSize < sizeof(VelocityTraceFileHeader) || r->header.headerSize > size) return false;
+    if (r->header.timestampFrequency <= 0) return false;
+
+    r->data      = (const uint8_t*)data;
+    r->size      = size;
+    r->offset    = r->header.headerSize;
+    r->timestamp = r->header.startTimestamp;
+    return true;
+}
+
+// The next record, with its absolute timestamp; TIME records are
+// applied, not returned. False at the end — or at a partial or
+// malformed record, after which VelocityTraceTruncated is true.
+static inline bool VelocityTraceNext(VelocityTraceReader* r, VelocityTraceRecord* out)
+{
+    for (;;) {
+        if (r->size - r->offset < sizeof(VelocityTraceRecordHeader)) return false;
+
+        VelocityTraceRecordHeader h;
+        memcpy(&h, r->data + r->offset, sizeof(h));
+        if (h.size < sizeof(h) || (h.size & 7) || h.size > r->size - r->offset) return false;
+
+        const uint8_t* payload = r->data + r->offset + sizeof(h);
+        r->offset    += h.size;
+        r->timestamp += h.dt;
+
+        if (h.type == VELOCITY_TRACE_TIME) {
+            if (h.size < sizeof(h) + 8) {
+                r->offset -= h.size;
+                return false;
+            }
+            memcpy(&r->timestamp, payload, 8);
+            continue;
+        }
+
+        out->type        = h.type;
+        out->channel     = h.channel;
+        out->timestamp   = r->timestamp;
+        out->payload     = payload;
+        out->payloadSize = h.size - sizeof(h);
+        return true;
+    }
+}
+
+// True if VelocityTraceNext stopped before the end of the data.
+static inline bool VelocityTraceTruncated(const VelocityTraceReader* r)
+{
+    return r->offset != r->size;
+}
+
+// Copies the payload into `out`; fields a shorter (older) record lacks
+// are zeroed. False if the record carries none of it.
+template <typename T>
+static inline bool VelocityTracePayload(const VelocityTraceRecord* rec, T* out)
+{
+    if (rec->payloadSize == 0) return false;
+    size_t n = rec->payloadSize < sizeof(T) ? rec->payloadSize : sizeof(T);
+    memset(out, 0, sizeof(T));
+    memcpy(out, rec->payload, n);
+    return true;
+}
@@ -19,9 +19,7 @@ public partial class MainWindow : Window
 
     private void Window_Loaded(object sender, RoutedEventArgs e)
     {
-        var vm = new MainViewModel();
-        vm.SetWindow(this);
-        DataContext = vm;
+        DataContext = new MainViewModel();
     }
 
     private void Window_Closing(object sender, System.ComponentModel.CancelEventArgs e)
@@ -18,15 +18,52 @@ public class AppSettings
     /// <summary>Smoothing factor for input (0.05 to 1.0). Lower = smoother.</summary>
     public double Smoothing { get; set; } = 0.25;
 
-    /// <summary>Maximum output speed cap (percentage 1-100).</summary>
+    /// <summary>Smoothing filter of the forward axis.</summary>
+    [JsonConverter(typeof(JsonStringEnumConverter))]
+    public FilterKind Filter { get; set; } = FilterKind.Ema;
+
+    /// <summary>How readily the One-Euro and Kalman filters follow a change in speed (0 to 1).</summary>
+    public double Adaptivity { get; set; } = 0.5;
+
+    /// <summary>Maximum output speed cap (percentage 1-100). Only while uncalibrated.</summary>
     public double MaxSpeed { get; set; } = 100.0;
 
+    /// <summary>
+    /// Sensor counts per meter of belt, measured by calibration. 0 = uncalibrated:
+    /// <see cref="MaxSpeed"/> scales the output instead of <see cref="ResponseCurve"/>.
+    /// </summary>
+    public double CountsPerMeter { get; set; } = 0.0;
+
+    /// <summary>Belt speed the treadmill is set to while calibrating, km/h.</summary>
+    public double CalibrationSpeedKmh { get; set; } = 3.0;
+
+    /// <summary>Belt speed that gives full output once calibrated, km/h.</summary>
+    public double TopSpeedKmh { get; set; } = 6.0;
+
+    /// <summary>
+    /// Output (0 to 1) at belt speeds evenly spaced from standstill to <see cref="TopSpeedKmh"/>,
+    /// linear in between. The UI edits the three inner points of the default five.
+    /// </summary>
+    public double[] ResponseCurve { get; set; } = { 0.0, 0.25, 0.5, 0.75, 1.0 };
+
     /// <summary>Whether to invert the movement direction.</summary>
     public bool InvertDirection { get; set; } = false;
 
+    /// <summary>Input processing rate in Hz (30 to 1000).</summary>
+    public int TickRateHz { get; set; } = 500;
+
     /// <summary>Whether to block the captured mouse from moving the system cursor.</summary>
     public bool BlockCursor { get; set; } = true;
 
+    /// <summary>Stream raw deltas to the OpenXR layer, which filters them once per frame.</summary>
+    public bool RawDeltaStreaming { get; set; } = false;
+
+    /// <summary>
+    /// Record each session as a velocity trace in %LOCALAPPDATA%\TreadmillDriver\traces,
+    /// for replay with treadmill_trace_replay.
+    /// </summary>
+    public bool RecordTrace { get; set; } = false;
+
     /// <summary>Currently selected output mode.</summary>
     [JsonConverter(typeof(JsonStringEnumConverter))]
     public OutputMode SelectedOutputMode { get; set; } = OutputMode.Keyboard;
@@ -34,6 +71,17 @@ public class AppSettings
     /// <summary>Device path of the last selected mouse device.</summary>
     public string? LastDevicePath { get; set; }
 
+    // ─── Extra Axes ──────────────────────────────────────────────────
+
+    /// <summary>Sideways movement, from the X axis of the selected device.</summary>
+    public AxisSettings Strafe { get; set; } = new();
+
+    /// <summary>Turning, from the X axis of a second device (<see cref="TurnDevicePath"/>).</summary>
+    public AxisSettings Turn { get; set; } = new();
+
+    /// <summary>Device path of the second sensor used for turning, if any.</summary>
+    public string? TurnDevicePath { get; set; }
+
     // ─── Persistence ─────────────────────────────────────────────────
 
     private static readonly string SettingsDir = Path.Combine(
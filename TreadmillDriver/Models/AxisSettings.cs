@@ -0,0 +1,26 @@
+namespace TreadmillDriver.Models;
+
+/// <summary>
+/// Filter settings for one of the extra axes (strafe, turn). Same ranges and
+/// meaning as the forward settings in <see cref="AppSettings"/>.
+/// </summary>
+public class AxisSettings
+{
+    /// <summary>Whether the axis is processed at all; disabled axes output 0.</summary>
+    public bool Enabled { get; set; } = false;
+
+    /// <summary>Movement sensitivity multiplier (0.1 to 10.0).</summary>
+    public double Sensitivity { get; set; } = 2.0;
+
+    /// <summary>Minimum movement threshold to register input (0 to 50).</summary>
+    public double DeadZone { get; set; } = 5.0;
+
+    /// <summary>Smoothing factor for input (0.05 to 1.0). Lower = smoother.</summary>
+    public double Smoothing { get; set; } = 0.25;
+
+    /// <summary>Maximum output speed cap (percentage 1-100).</summary>
+    public double MaxSpeed { get; set; } = 100.0;
+
+    /// <summary>Whether to invert the axis direction.</summary>
+    public bool InvertDirection { get; set; } = false;
+}
@@ -0,0 +1,39 @@
+using TreadmillDriver.Native;
+
+namespace TreadmillDriver.Models;
+
+/// <summary>
+/// Physical-units calibration of the forward axis as the native input core uses it
+/// (TreadmillInputCalibration in OpenXRLayer/input_core.h): counts per meter of belt and
+/// the response curve baked into a lookup table. Immutable, so the processing thread,
+/// the shared memory writer and the trace writer can hold one while the UI replaces it.
+/// </summary>
+public sealed class BeltCalibration
+{
+    /// <summary>Uncalibrated: the Max Speed setting normalises the output instead.</summary>
+    public static readonly BeltCalibration None = new(default);
+
+    internal BeltCalibration(in NativeMethods.TreadmillInputCalibration native)
+    {
+        Native = native;
+        Curve = new float[NativeMethods.TREADMILL_INPUT_CURVE_SIZE];
+        for (int i = 0; i < Curve.Length; i++)
+            Curve[i] = ReadCurve(native, i);
+    }
+
+    /// <summary>Sensor counts per meter of belt; 0 = uncalibrated.</summary>
+    public double CountsPerMeter => Native.countsPerMeter;
+
+    /// <summary>Belt speed of the table's last entry, m/s.</summary>
+    public double TopSpeed => Native.topSpeed;
+
+    public bool IsCalibrated => Native.countsPerMeter > 0 && Native.topSpeed > 0;
+
+    /// <summary>The baked table: output 0 … 1 at speeds evenly spaced up to <see cref="TopSpeed"/>. Do not modify.</summary>
+    public float[] Curve { get; }
+
+    /// <summary>As passed to the input core in <see cref="NativeMethods.TreadmillInputConfig.calibration"/>.</summary>
+    internal NativeMethods.TreadmillInputCalibration Native { get; }
+
+    private static unsafe float ReadCurve(NativeMethods.TreadmillInputCalibration native, int i) => native.curve[i];
+}
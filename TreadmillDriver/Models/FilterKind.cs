@@ -0,0 +1,17 @@
+namespace TreadmillDriver.Models;
+
+/// <summary>
+/// The smoothing filter the input core runs on the forward axis
+/// (TREADMILL_INPUT_FILTER_* in OpenXRLayer/input_core.h; the values match).
+/// </summary>
+public enum FilterKind
+{
+    /// <summary>Fixed-factor exponential moving average, the original filter.</summary>
+    Ema = 0,
+
+    /// <summary>One-Euro: smooth at a steady walk, quick when starting and stopping.</summary>
+    OneEuro = 1,
+
+    /// <summary>Constant-velocity Kalman filter over belt position and speed.</summary>
+    Kalman = 2,
+}
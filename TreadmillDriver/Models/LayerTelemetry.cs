@@ -0,0 +1,61 @@
+namespace TreadmillDriver.Models;
+
+/// <summary>
+/// One reading of the counters the OpenXR layer publishes about itself
+/// (OpenXRLayer/layer_telemetry.h), summed over its thread slots.
+/// </summary>
+public sealed class LayerTelemetry
+{
+    /// <summary>Counter index of xrSyncActions.</summary>
+    public const int CallSyncActions = 6;
+
+    /// <summary>Process the layer runs in (the game).</summary>
+    public uint ProcessId { get; init; }
+
+    /// <summary>Ticks per second of <see cref="Updated"/> and <see cref="TimeTicks"/>.</summary>
+    public long TimestampFrequency { get; init; }
+
+    /// <summary>XrInstances the layer is tracking.</summary>
+    public uint LiveInstances { get; init; }
+
+    public float Forward { get; init; }
+    public float Strafe { get; init; }
+    public float Turn { get; init; }
+
+    /// <summary>When the layer last latched motion for a sync (layer clock).</summary>
+    public long Updated { get; init; }
+
+    /// <summary>Predicted display period from the last xrWaitFrame, 0 before the first.</summary>
+    public long DisplayPeriodNs { get; init; }
+
+    /// <summary>Calls per intercepted function, by TELEMETRY_CALL_* index.</summary>
+    public ulong[] Calls { get; init; } = Array.Empty<ulong>();
+
+    /// <summary>Action state queries the layer wrote treadmill motion into.</summary>
+    public ulong Injected { get; init; }
+
+    /// <summary>Queries left alone because they asked for the other hand.</summary>
+    public ulong SkippedSubaction { get; init; }
+
+    /// <summary>Calls that were timed (one in 64) and the layer's own time in them.</summary>
+    public ulong TimedCalls { get; init; }
+    public ulong TimeTicks { get; init; }
+
+    /// <summary>Threads that have made an intercepted call.</summary>
+    public int Threads { get; init; }
+
+    public ulong TotalCalls => Calls.Aggregate(0ul, (sum, c) => sum + c);
+
+    /// <summary>Mean time spent in the layer per timed call, runtime excluded.</summary>
+    public double MicrosecondsPerCall =>
+        TimedCalls > 0 && TimestampFrequency > 0 ? TimeTicks * 1e6 / TimedCalls / TimestampFrequency : 0;
+
+    public double FramesPerSecond => DisplayPeriodNs > 0 ? 1e9 / DisplayPeriodNs : 0;
+
+    /// <summary>
+    /// False when no OpenXR application is running the layer: no instances, or
+    /// no sync for <paramref name="staleSeconds"/> (the game exited or crashed).
+    /// </summary>
+    public bool IsLive(long now, double staleSeconds) =>
+        LiveInstances > 0 && Updated != 0 && now - Updated < staleSeconds * TimestampFrequency;
+}
@@ -0,0 +1,8 @@
+namespace TreadmillDriver.Models;
+
+/// <summary>
+/// One tick of processed movement, each axis normalised to -1 … 1.
+/// Forward and strafe come from the primary sensor (Y and X), turn from the
+/// optional second sensor's X. Positive is forward, right and turn right.
+/// </summary>
+public readonly record struct MotionVector(double Forward, double Strafe, double Turn);
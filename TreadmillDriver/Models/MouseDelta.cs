@@ -0,0 +1,9 @@
+namespace TreadmillDriver.Models;
+
+/// <summary>
+/// Relative movement reported by the target mouse in one raw input event
+/// (or several, merged when the input queue was full), and when the capture
+/// thread read it (<see cref="System.Diagnostics.Stopwatch"/> ticks; the latest
+/// for merged events).
+/// </summary>
+public readonly record struct MouseDelta(int Dx, int Dy, long Timestamp);
@@ -0,0 +1,22 @@
+namespace TreadmillDriver.Models;
+
+/// <summary>
+/// One bucket of the tick-jitter histogram shown in the live monitor.
+/// </summary>
+public class TickHistogramBar
+{
+    /// <summary>Maximum bar width in pixels (bucket holding every tick).</summary>
+    public const double MaxBarWidth = 180;
+
+    /// <summary>Bucket label, e.g. "&lt;100µs".</summary>
+    public string Label { get; init; } = string.Empty;
+
+    /// <summary>Ticks whose interval deviated from the target by this much.</summary>
+    public long Count { get; init; }
+
+    /// <summary>Share of all ticks (0 to 1).</summary>
+    public double Fraction { get; init; }
+
+    public double BarWidth => Fraction * MaxBarWidth;
+    public string PercentText => $"{Fraction * 100:F1}%";
+}
@@ -154,6 +154,18 @@ internal static class NativeMethods
         ref uint pcbSize,
         uint cbSizeHeader);
 
+    /// <summary>
+    /// Buffered read of all pending raw input for the calling thread.
+    /// Returns the number of RAWINPUT structures written (0 when drained),
+    /// or (uint)-1 on error. With pData = 0, pcbSize receives the size of
+    /// the first pending structure.
+    /// </summary>
+    [DllImport("user32.dll", SetLastError = true)]
+    public static extern uint GetRawInputBuffer(
+        IntPtr pData,
+        ref uint pcbSize,
+        uint cbSizeHeader);
+
     [DllImport("user32.dll", SetLastError = true)]
     public static extern uint GetRawInputDeviceList(
         [Out] RAWINPUTDEVICELIST[]? pRawInputDeviceList,
@@ -223,4 +235,256 @@ internal static class NativeMethods
 
     [DllImport("kernel32.dll", CharSet = CharSet.Unicode, SetLastError = true)]
     public static extern IntPtr GetModuleHandle(string? lpModuleName);
+
+    // ─── Message-Only Windows ────────────────────────────────────────
+
+    /// <summary>Parent for CreateWindowEx that makes a message-only window.</summary>
+    public static readonly IntPtr HWND_MESSAGE = new(-3);
+
+    public const int WM_QUIT = 0x0012;
+    public const uint PM_REMOVE = 0x0001;
+    public const uint QS_RAWINPUT = 0x0400;
+    public const uint QS_POSTMESSAGE = 0x0008;
+    public const uint QS_SENDMESSAGE = 0x0040;
+    public const uint MWMO_INPUTAVAILABLE = 0x0004;
+    public const uint WAIT_FAILED = 0xFFFFFFFF;
+
+    public delegate IntPtr WndProc(IntPtr hWnd, uint msg, IntPtr wParam, IntPtr lParam);
+
+    [StructLayout(LayoutKind.Sequential, CharSet = CharSet.Unicode)]
+    public struct WNDCLASSEX
+    {
+        public uint cbSize;
+        public uint style;
+        public WndProc lpfnWndProc;
+        public int cbClsExtra;
+        public int cbWndExtra;
+        public IntPtr hInstance;
+        public IntPtr hIcon;
+        public IntPtr hCursor;
+        public IntPtr hbrBackground;
+        public string? lpszMenuName;
+        public string lpszClassName;
+        public IntPtr hIconSm;
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct MSG
+    {
+        public IntPtr hwnd;
+        public uint message;
+        public IntPtr wParam;
+        public IntPtr lParam;
+        public uint time;
+        public POINT pt;
+    }
+
+    [DllImport("user32.dll", CharSet = CharSet.Unicode, SetLastError = true)]
+    public static extern ushort RegisterClassExW(ref WNDCLASSEX lpwcx);
+
+    [DllImport("user32.dll", CharSet = CharSet.Unicode, SetLastError = true)]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static extern bool UnregisterClassW(string lpClassName, IntPtr hInstance);
+
+    [DllImport("user32.dll", CharSet = CharSet.Unicode, SetLastError = true)]
+    public static extern IntPtr CreateWindowExW(
+        uint dwExStyle,
+        string lpClassName,
+        string lpWindowName,
+        uint dwStyle,
+        int x, int y, int nWidth, int nHeight,
+        IntPtr hWndParent,
+        IntPtr hMenu,
+        IntPtr hInstance,
+        IntPtr lpParam);
+
+    [DllImport("user32.dll", SetLastError = true)]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static extern bool DestroyWindow(IntPtr hWnd);
+
+    [DllImport("user32.dll")]
+    public static extern IntPtr DefWindowProcW(IntPtr hWnd, uint msg, IntPtr wParam, IntPtr lParam);
+
+    [DllImport("user32.dll", SetLastError = true)]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static extern bool PostMessageW(IntPtr hWnd, uint msg, IntPtr wParam, IntPtr lParam);
+
+    [DllImport("user32.dll")]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static extern bool PeekMessageW(out MSG lpMsg, IntPtr hWnd, uint wMsgFilterMin, uint wMsgFilterMax, uint wRemoveMsg);
+
+    [DllImport("user32.dll")]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static extern bool TranslateMessage(ref MSG lpMsg);
+
+    [DllImport("user32.dll")]
+    public static extern IntPtr DispatchMessageW(ref MSG lpMsg);
+
+    [DllImport("user32.dll", SetLastError = true)]
+    public static extern uint MsgWaitForMultipleObjectsEx(
+        uint nCount,
+        IntPtr pHandles,
+        uint dwMilliseconds,
+        uint dwWakeMask,
+        uint dwFlags);
+
+    // ─── Input Core (treadmill_input.dll, OpenXRLayer/input_core.h) ──
+
+    public const string InputCoreDll = "treadmill_input";
+    public const int TREADMILL_INPUT_ABI_VERSION = 3;
+    public const int TREADMILL_INPUT_CURVE_SIZE = 64;
+
+    public const int TREADMILL_INPUT_FILTER_EMA = 0;
+    public const int TREADMILL_INPUT_FILTER_ONE_EURO = 1;
+    public const int TREADMILL_INPUT_FILTER_KALMAN = 2;
+
+    [StructLayout(LayoutKind.Sequential)]
+    public unsafe struct TreadmillInputCalibration
+    {
+        public double countsPerMeter;
+        public double topSpeed;
+        public fixed float curve[TREADMILL_INPUT_CURVE_SIZE];
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct TreadmillInputConfig
+    {
+        public double sensitivity;
+        public double deadZone;
+        public double smoothing;
+        public double maxSpeed;
+        public int invertDirection;
+        public int filter;
+        public double adaptivity;
+        public TreadmillInputCalibration calibration;
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct TreadmillInputState
+    {
+        public double smoothed;
+        public double pendingDeltaY;
+        public double velocity;
+        public long lastTimestamp;
+        public double trend;
+        public double offset;
+        public double covariance0;
+        public double covariance1;
+        public double covariance2;
+        public long lastEvent;
+        public double speed;
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct TreadmillInputEvent
+    {
+        public long timestamp;
+        public int dx;
+        public int dy;
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct TreadmillCalibrationRun
+    {
+        public long counts;
+        public long first;
+        public long last;
+        public uint events;
+        public uint reserved;
+    }
+
+    [DllImport(InputCoreDll)]
+    public static extern int TreadmillInput_AbiVersion();
+
+    [DllImport(InputCoreDll)]
+    public static extern void TreadmillInput_Reset(ref TreadmillInputState state, long timestamp);
+
+    /// <summary>Pure computation, no blocking: safe to call without a GC transition.</summary>
+    [DllImport(InputCoreDll), SuppressGCTransition]
+    public static extern double TreadmillInput_Step(
+        ref TreadmillInputState state,
+        in TreadmillInputConfig config,
+        double deltaY,
+        double elapsedSeconds);
+
+    /// <summary>
+    /// Pure computation, no blocking: safe to call without a GC transition.
+    /// <paramref name="events"/> is the first of <paramref name="count"/> consecutive events.
+    /// </summary>
+    [DllImport(InputCoreDll), SuppressGCTransition]
+    public static extern double TreadmillInput_ProcessEvents(
+        ref TreadmillInputState state,
+        in TreadmillInputConfig config,
+        in TreadmillInputEvent events,
+        uint count,
+        long now,
+        long frequency);
+
+    /// <param name="points">Outputs at speeds evenly spaced from 0 to <paramref name="topSpeed"/> m/s.</param>
+    [DllImport(InputCoreDll)]
+    public static extern void TreadmillInput_BakeCurve(
+        ref TreadmillInputCalibration calibration,
+        double topSpeed,
+        double[] points,
+        uint count);
+
+    [DllImport(InputCoreDll)]
+    public static extern double TreadmillInput_MapSpeed(in TreadmillInputCalibration calibration, double speed);
+
+    [DllImport(InputCoreDll)]
+    public static extern void TreadmillInput_CalibrationBegin(ref TreadmillCalibrationRun run);
+
+    /// <summary>Pure computation, no blocking: safe to call without a GC transition.</summary>
+    [DllImport(InputCoreDll), SuppressGCTransition]
+    public static extern void TreadmillInput_CalibrationAdd(
+        ref TreadmillCalibrationRun run,
+        in TreadmillInputEvent events,
+        uint count);
+
+    [DllImport(InputCoreDll)]
+    public static extern double TreadmillInput_CalibrationSeconds(in TreadmillCalibrationRun run, long frequency);
+
+    [DllImport(InputCoreDll)]
+    public static extern double TreadmillInput_CalibrationResult(
+        in TreadmillCalibrationRun run,
+        double beltSpeed,
+        long frequency);
+
+    // ─── Waitable Timers ─────────────────────────────────────────────
+
+    /// <summary>Windows 10 1803+: sub-millisecond timer that ignores the system timer resolution.</summary>
+    public const uint CREATE_WAITABLE_TIMER_HIGH_RESOLUTION = 0x00000002;
+    public const uint TIMER_ALL_ACCESS = 0x001F0003;
+    public const uint INFINITE = 0xFFFFFFFF;
+
+    [DllImport("kernel32.dll", CharSet = CharSet.Unicode, SetLastError = true)]
+    public static extern IntPtr CreateWaitableTimerExW(
+        IntPtr lpTimerAttributes,
+        string? lpTimerName,
+        uint dwFlags,
+        uint dwDesiredAccess);
+
+    /// <param name="lpDueTime">100 ns units; negative = relative to now.</param>
+    [DllImport("kernel32.dll", SetLastError = true)]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static extern bool SetWaitableTimer(
+        IntPtr hTimer,
+        ref long lpDueTime,
+        int lPeriod,
+        IntPtr pfnCompletionRoutine,
+        IntPtr lpArgToCompletionRoutine,
+        [MarshalAs(UnmanagedType.Bool)] bool fResume);
+
+    [DllImport("kernel32.dll", SetLastError = true)]
+    public static extern uint WaitForSingleObject(IntPtr hHandle, uint dwMilliseconds);
+
+    [DllImport("kernel32.dll", SetLastError = true)]
+    [return: MarshalAs(UnmanagedType.Bool)]
+    public static extern bool CloseHandle(IntPtr hObject);
+
+    [DllImport("winmm.dll")]
+    public static extern uint timeBeginPeriod(uint uPeriod);
+
+    [DllImport("winmm.dll")]
+    public static extern uint timeEndPeriod(uint uPeriod);
 }
@@ -0,0 +1,49 @@
+using System.Diagnostics;
+using System.IO;
+
+namespace TreadmillDriver.Services;
+
+/// <summary>
+/// Minimal diagnostics log for the companion app, written next to the
+/// OpenXR layer's logs: %LOCALAPPDATA%\TreadmillDriver\TreadmillDriver.log.
+/// Truncated at the first write of each run. Thread-safe; never throws.
+/// Keep calls off the processing thread — each write touches the disk.
+/// </summary>
+public static class AppLog
+{
+    private static readonly string LogDir = Path.Combine(
+        Environment.GetFolderPath(Environment.SpecialFolder.LocalApplicationData),
+        "TreadmillDriver");
+
+    private static readonly string LogFile = Path.Combine(LogDir, "TreadmillDriver.log");
+
+    private static readonly object Lock = new();
+    private static bool _truncated;
+
+    public static void Write(string message)
+    {
+        string line = $"[{DateTime.Now:HH:mm:ss.fff}] {message}";
+        Trace.WriteLine(line);
+
+        lock (Lock)
+        {
+            try
+            {
+                Directory.CreateDirectory(LogDir);
+                if (!_truncated)
+                {
+                    File.WriteAllText(LogFile, line + Environment.NewLine);
+                    _truncated = true;
+                }
+                else
+                {
+                    File.AppendAllText(LogFile, line + Environment.NewLine);
+                }
+            }
+            catch
+            {
+                // Logging is best-effort
+            }
+        }
+    }
+}
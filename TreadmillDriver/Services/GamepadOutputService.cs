@@ -8,7 +8,7 @@ namespace TreadmillDriver.Services;
 
 /// <summary>
 /// Emulates a virtual gamepad (Xbox 360 or DualShock 4) using ViGEmBus.
-/// Maps velocity to the left thumbstick Y axis.
+/// Maps forward velocity to the left thumbstick Y axis, strafe to left X and turn to right X.
 /// </summary>
 public class GamepadOutputService : IDisposable
 {
@@ -19,6 +19,9 @@ public class GamepadOutputService : IDisposable
     private bool _isConnected;
     private bool _disposed;
     private string? _lastError;
+    private short? _lastThumbY;
+    private short? _lastThumbX;
+    private short? _lastRightThumbX;
 
     /// <summary>Whether ViGEmBus is available on this system.</summary>
     public bool IsViGEmAvailable { get; private set; }
@@ -47,6 +50,9 @@ public class GamepadOutputService : IDisposable
             _xbox360.Connect();
 
             _isConnected = true;
+            _lastThumbY = null;
+            _lastThumbX = null;
+            _lastRightThumbX = null;
             _lastError = null;
             IsViGEmAvailable = true;
             return true;
@@ -76,10 +82,12 @@ public class GamepadOutputService : IDisposable
     }
 
     /// <summary>
-    /// Update the virtual controller's left thumbstick Y axis.
+    /// Update the virtual controller's thumbsticks.
+    /// Only submits a report for an axis whose value actually changed, so
+    /// calling this at the processing rate (up to 1 kHz) is cheap.
     /// </summary>
-    /// <param name="normalizedVelocity">-1.0 (backward) to 1.0 (forward)</param>
-    public void Update(double normalizedVelocity)
+    /// <param name="motion">Each axis -1.0 … 1.0; positive is forward, right and turn right.</param>
+    public void Update(MotionVector motion)
     {
         if (!_isConnected) return;
 
@@ -87,9 +95,9 @@ public class GamepadOutputService : IDisposable
         {
             if (_xbox360 != null)
             {
-                // Xbox 360 left thumb Y: short range -32768 to 32767
-                short value = (short)(normalizedVelocity * 32767);
-                _xbox360.SetAxisValue(Xbox360Axis.LeftThumbY, value);
+                SetAxis(Xbox360Axis.LeftThumbY, motion.Forward, ref _lastThumbY);
+                SetAxis(Xbox360Axis.LeftThumbX, motion.Strafe, ref _lastThumbX);
+                SetAxis(Xbox360Axis.RightThumbX, motion.Turn, ref _lastRightThumbX);
             }
         }
         catch (Exception ex)
@@ -98,10 +106,19 @@ public class GamepadOutputService : IDisposable
         }
     }
 
-    /// <summary>Reset the joystick to center position.</summary>
+    private void SetAxis(Xbox360Axis axis, double normalized, ref short? last)
+    {
+        // Xbox 360 thumbsticks: short range -32768 to 32767
+        short value = (short)(normalized * 32767);
+        if (value == last) return;
+        last = value;
+        _xbox360!.SetAxisValue(axis, value);
+    }
+
+    /// <summary>Reset the joysticks to center position.</summary>
     public void ResetAxis()
     {
-        Update(0.0);
+        Update(default);
     }
 
     public void Dispose()
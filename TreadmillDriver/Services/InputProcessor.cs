@@ -1,19 +1,64 @@
-using System.Windows.Threading;
+using System.Diagnostics;
+using TreadmillDriver.Models;
+using TreadmillDriver.Native;
 
 namespace TreadmillDriver.Services;
 
 /// <summary>
-/// Processes raw mouse deltas into a smoothed velocity value suitable for output.
-/// Uses exponential moving average and dead zone filtering.
+/// Processes raw mouse deltas into a smoothed <see cref="MotionVector"/> suitable for output:
+/// forward from the primary sensor's Y, strafe from its X, and turn from a second
+/// sensor's X. Each axis has its own filter state and settings.
+/// Uses exponential moving average and dead zone filtering — or, on the forward axis,
+/// the One-Euro or Kalman filter (<see cref="Filter"/>) — computed by the native
+/// input core (treadmill_input.dll, OpenXRLayer/input_core.h) so the app, the
+/// layer and the Linux tests share one bit-exact implementation. The adaptive
+/// filters take the tick's events with their capture timestamps rather than its sum.
+/// Once calibrated (<see cref="SetCalibration"/>), forward output follows the belt's
+/// speed in m/s through a response curve instead of <see cref="MaxSpeed"/>; a
+/// calibration run (<see cref="BeginCalibration"/>) measures the counts per meter.
+/// Deltas arrive through <see cref="Input"/> and <see cref="TurnInput"/>, lock-free
+/// queues fed by the raw input capture thread and drained once per tick.
+/// Runs on its own high-priority thread at <see cref="TickRateHz"/>, paced by a
+/// <see cref="PrecisionTimer"/>, independent of the WPF dispatcher.
 /// </summary>
 public class InputProcessor : IDisposable
 {
-    private readonly DispatcherTimer _timer;
-    private double _accumulatedDeltaY;
-    private double _smoothedVelocity;
-    private readonly object _lock = new();
+    public const int MinTickRateHz = 30;
+    public const int MaxTickRateHz = 1000;
+
+    /// <summary>Queued deltas; ~0.5 s of an 8 kHz mouse if processing stalls.</summary>
+    public const int InputQueueCapacity = 4096;
+
+    private static readonly long TimingReportTicks = Stopwatch.Frequency;   // 1 s
+
+    private NativeMethods.TreadmillInputState _filter;
+    private NativeMethods.TreadmillInputState _strafeFilter;
+    private NativeMethods.TreadmillInputState _turnFilter;
+    private readonly NativeMethods.TreadmillInputEvent[] _events = new NativeMethods.TreadmillInputEvent[InputQueueCapacity];
+    private Thread? _thread;
+    private volatile bool _running;
+    private readonly TickJitterHistogram _histogram = new();
+    private TickJitterStats? _timingStats;
     private bool _disposed;
 
+    // Processing thread only, while recording
+    private VelocityTraceWriter? _trace;
+    private readonly NativeMethods.TreadmillInputConfig[] _tracedConfig = new NativeMethods.TreadmillInputConfig[3];
+    private readonly bool[] _tracedEnabled = new bool[3];
+    private readonly bool[] _configTraced = new bool[3];
+    private BeltCalibration? _tracedCalibration;
+
+    // Forward axis calibration: the source as set, and the table baked from it
+    private double _countsPerMeter;
+    private double _topSpeed;
+    private double[] _curve = Array.Empty<double>();
+    private BeltCalibration _calibration = BeltCalibration.None;
+
+    // Calibration run, shared between the UI and processing threads under the lock
+    private readonly object _calibrationLock = new();
+    private NativeMethods.TreadmillCalibrationRun _calibrationRun;
+    private volatile bool _calibrating;
+
     // ─── Settings ────────────────────────────────────────────────────
 
     /// <summary>Sensitivity multiplier (0.1 to 10.0).</summary>
@@ -25,98 +70,365 @@ public class InputProcessor : IDisposable
     /// <summary>Smoothing factor (0.05 to 1.0). Lower = smoother but more latent.</summary>
     public double Smoothing { get; set; } = 0.25;
 
-    /// <summary>Maximum speed percentage (1 to 100).</summary>
+    /// <summary>Maximum speed percentage (1 to 100). Only while uncalibrated.</summary>
     public double MaxSpeed { get; set; } = 100.0;
 
+    /// <summary>Smoothing filter of the forward axis; strafe and turn always use the EMA.</summary>
+    public FilterKind Filter { get; set; } = FilterKind.Ema;
+
+    /// <summary>How readily the One-Euro and Kalman filters follow a change (0 to 1).</summary>
+    public double Adaptivity { get; set; } = 0.5;
+
     /// <summary>Whether to invert the movement direction.</summary>
     public bool InvertDirection { get; set; }
 
-    // ─── Output ──────────────────────────────────────────────────────
+    /// <summary>Strafe settings (primary sensor X). The instance is read on every tick.</summary>
+    public AxisSettings Strafe { get; set; } = new();
+
+    /// <summary>Turn settings (second sensor X). The instance is read on every tick.</summary>
+    public AxisSettings Turn { get; set; } = new();
+
+    private int _tickRateHz = 500;
+    /// <summary>Processing rate (30 to 1000 Hz). Takes effect on the next tick.</summary>
+    public int TickRateHz
+    {
+        get => _tickRateHz;
+        set => _tickRateHz = Math.Clamp(value, MinTickRateHz, MaxTickRateHz);
+    }
 
     /// <summary>
-    /// Fires on each tick with the processed velocity value.
-    /// Range: -1.0 (full backward) to 1.0 (full forward).
+    /// Records every tick (the counts it drained, the settings and the motion) while
+    /// set. Read by <see cref="Start"/>; set it before starting and keep it until after
+    /// <see cref="Stop"/>.
     /// </summary>
-    public event Action<double>? VelocityUpdated;
+    public VelocityTraceWriter? TraceWriter { get; set; }
+
+    // ─── Input / Output ──────────────────────────────────────────────────────
+
+    /// <summary>
+    /// Raw deltas from the capture thread (single producer); the processing
+    /// thread is the only consumer while running.
+    /// </summary>
+    public SpscQueue<MouseDelta> Input { get; } = new(InputQueueCapacity);
+
+    /// <summary>Raw deltas from the second (turn) sensor; same threading as <see cref="Input"/>.</summary>
+    public SpscQueue<MouseDelta> TurnInput { get; } = new(InputQueueCapacity);
+
+    /// <summary>
+    /// Fires on each tick with the processed motion, each axis -1.0 … 1.0.
+    /// Raised on the processing thread — handlers must not block and must
+    /// marshal to the dispatcher themselves for UI work.
+    /// </summary>
+    public event Action<MotionVector>? MotionUpdated;
 
     /// <summary>Current smoothed velocity (-1.0 to 1.0).</summary>
-    public double CurrentVelocity => _smoothedVelocity;
+    public double CurrentVelocity => Volatile.Read(ref _filter.velocity);
+
+    /// <summary>Current belt speed in m/s; 0 while uncalibrated.</summary>
+    public double CurrentSpeed => Volatile.Read(ref _filter.speed);
+
+    /// <summary>The forward axis calibration in force. Safe to read from any thread.</summary>
+    public BeltCalibration Calibration => Volatile.Read(ref _calibration);
 
-    // ─── Constructor ─────────────────────────────────────────────────
+    /// <summary>
+    /// Tick timing published by the processing thread about once per second
+    /// (null until the first report). Safe to read from any thread.
+    /// </summary>
+    public TickJitterStats? TimingStats => Volatile.Read(ref _timingStats);
 
-    public InputProcessor()
+    // ─── Control ─────────────────────────────────────────────────────
+
+    public void Start()
     {
-        _timer = new DispatcherTimer
+        if (_thread != null) return;
+
+        EnsureNativeCore();
+        Volatile.Write(ref _calibration, BakeCalibration(_countsPerMeter, _topSpeed, _curve));
+        NativeMethods.TreadmillInput_Reset(ref _filter, 0);
+        NativeMethods.TreadmillInput_Reset(ref _strafeFilter, 0);
+        NativeMethods.TreadmillInput_Reset(ref _turnFilter, 0);
+        DrainInput(Input);
+        DrainInput(TurnInput);
+        _histogram.Reset();
+        Volatile.Write(ref _timingStats, null);
+        _trace = TraceWriter;
+        Array.Clear(_configTraced);
+        _tracedCalibration = null;
+
+        _running = true;
+        _thread = new Thread(ProcessingLoop)
         {
-            Interval = TimeSpan.FromMilliseconds(16) // ~60 fps
+            Name = "Treadmill Input Processing",
+            IsBackground = true,
+            Priority = ThreadPriority.Highest,
         };
-        _timer.Tick += OnTick;
+        _thread.Start();
     }
 
-    // ─── Control ─────────────────────────────────────────────────────
+    public void Stop()
+    {
+        _running = false;
+        _thread?.Join();
+        _thread = null;
+        _calibrating = false;
 
-    public void Start()
+        _filter = default;
+        _strafeFilter = default;
+        _turnFilter = default;
+        DrainInput(Input);
+        DrainInput(TurnInput);
+        MotionUpdated?.Invoke(default);
+        _trace?.RecordStop();
+        _trace = null;
+    }
+
+    // ─── Calibration ─────────────────────────────────────────────────
+
+    /// <summary>
+    /// Sets the forward axis calibration: <paramref name="countsPerMeter"/> (0 = uncalibrated)
+    /// and <paramref name="curve"/>, outputs at speeds evenly spaced up to
+    /// <paramref name="topSpeed"/> m/s. Baked now if running, otherwise by <see cref="Start"/>.
+    /// UI thread only.
+    /// </summary>
+    public void SetCalibration(double countsPerMeter, double topSpeed, double[] curve)
     {
-        _smoothedVelocity = 0;
-        _accumulatedDeltaY = 0;
-        _timer.Start();
+        _countsPerMeter = countsPerMeter;
+        _topSpeed = topSpeed;
+        _curve = (double[])curve.Clone();
+        if (_thread != null)
+            Volatile.Write(ref _calibration, BakeCalibration(_countsPerMeter, _topSpeed, _curve));
     }
 
-    public void Stop()
+    private static BeltCalibration BakeCalibration(double countsPerMeter, double topSpeed, double[] curve)
+    {
+        if (!(countsPerMeter > 0) || !(topSpeed > 0))
+            return BeltCalibration.None;
+
+        var native = new NativeMethods.TreadmillInputCalibration { countsPerMeter = countsPerMeter };
+        NativeMethods.TreadmillInput_BakeCurve(ref native, topSpeed, curve, (uint)curve.Length);
+        return new BeltCalibration(native);
+    }
+
+    /// <summary>
+    /// Starts counting the primary sensor's forward counts; keep the belt at a steady,
+    /// known speed until <see cref="EndCalibration"/>. Requires a running processor.
+    /// </summary>
+    public void BeginCalibration()
+    {
+        lock (_calibrationLock)
+        {
+            NativeMethods.TreadmillInput_CalibrationBegin(ref _calibrationRun);
+            _calibrating = true;
+        }
+    }
+
+    /// <summary>
+    /// Seconds counted so far, and the counts per meter they give at
+    /// <paramref name="beltSpeed"/> m/s (0 until there is motion).
+    /// </summary>
+    public (double Seconds, double CountsPerMeter) CalibrationProgress(double beltSpeed)
     {
-        _timer.Stop();
-        _smoothedVelocity = 0;
-        _accumulatedDeltaY = 0;
-        VelocityUpdated?.Invoke(0);
+        lock (_calibrationLock)
+        {
+            return (NativeMethods.TreadmillInput_CalibrationSeconds(in _calibrationRun, Stopwatch.Frequency),
+                NativeMethods.TreadmillInput_CalibrationResult(in _calibrationRun, beltSpeed, Stopwatch.Frequency));
+        }
     }
 
     /// <summary>
-    /// Feed a raw mouse delta Y value into the processor.
-    /// Thread-safe: can be called from any thread.
+    /// Ends the run and returns the counts per meter at <paramref name="beltSpeed"/> m/s,
+    /// or 0 if it saw no motion. Does not apply them; see <see cref="SetCalibration"/>.
     /// </summary>
-    public void AddDelta(int deltaY)
+    public double EndCalibration(double beltSpeed)
     {
-        lock (_lock)
+        lock (_calibrationLock)
         {
-            _accumulatedDeltaY += deltaY;
+            _calibrating = false;
+            return NativeMethods.TreadmillInput_CalibrationResult(in _calibrationRun, beltSpeed, Stopwatch.Frequency);
         }
     }
 
+    /// <summary>
+    /// Sum of the primary deltas queued since the last call, each also kept in
+    /// <see cref="_events"/> (at most its length; the rest wait for the next tick).
+    /// Processing thread only.
+    /// </summary>
+    private (long Dx, long Dy, int Count) DrainPrimary()
+    {
+        long deltaX = 0;
+        long deltaY = 0;
+        int count = 0;
+        while (count < _events.Length && Input.TryDequeue(out var delta))
+        {
+            deltaX += delta.Dx;
+            deltaY += delta.Dy;
+            _events[count++] = new NativeMethods.TreadmillInputEvent
+            {
+                timestamp = delta.Timestamp, dx = delta.Dx, dy = delta.Dy,
+            };
+        }
+        return (deltaX, deltaY, count);
+    }
+
+    /// <summary>Sum of the deltas queued since the last call. Consumer side only.</summary>
+    private static (long Dx, long Dy) DrainInput(SpscQueue<MouseDelta> queue)
+    {
+        long deltaX = 0;
+        long deltaY = 0;
+        while (queue.TryDequeue(out var delta))
+        {
+            deltaX += delta.Dx;
+            deltaY += delta.Dy;
+        }
+        return (deltaX, deltaY);
+    }
+
     // ─── Processing ──────────────────────────────────────────────────
 
-    private void OnTick(object? sender, EventArgs e)
+    private void ProcessingLoop()
     {
-        double rawDelta;
-        lock (_lock)
+        using var timer = new PrecisionTimer();
+
+        long last = Stopwatch.GetTimestamp();
+        long deadline = last;
+        long nextReport = last + TimingReportTicks;
+        NativeMethods.TreadmillInput_Reset(ref _filter, last);     // the adaptive filters' event clock
+        _trace?.RecordStart(last);
+
+        while (_running)
         {
-            rawDelta = _accumulatedDeltaY;
-            _accumulatedDeltaY = 0;
+            int rateHz = TickRateHz;
+            long period = Stopwatch.Frequency / rateHz;
+
+            // Fixed-rate schedule; if we fell more than a tick behind (e.g. the
+            // thread was preempted), resynchronise instead of bursting to catch up
+            deadline += period;
+            if (Stopwatch.GetTimestamp() - deadline > period)
+                deadline = Stopwatch.GetTimestamp();
+
+            timer.WaitUntil(deadline);
+
+            long now = Stopwatch.GetTimestamp();
+            long interval = now - last;
+            last = now;
+
+            Tick(now, (double)interval / Stopwatch.Frequency);
+            _histogram.Record(interval, period);
+
+            if (now >= nextReport)
+            {
+                Volatile.Write(ref _timingStats, _histogram.Snapshot(rateHz, timer.IsHighResolution));
+                nextReport = now + TimingReportTicks;
+            }
         }
+    }
 
-        // Apply inversion (mouse Y: negative = move forward on surface)
-        // Default: negative deltaY means treadmill forward = positive velocity
-        double direction = InvertDirection ? 1.0 : -1.0;
-        double scaledDelta = rawDelta * direction * Sensitivity;
+    private void Tick(long now, double elapsedSeconds)
+    {
+        var calibration = Volatile.Read(ref _calibration);
+        var config = new NativeMethods.TreadmillInputConfig
+        {
+            sensitivity = Sensitivity,
+            deadZone = DeadZone,
+            smoothing = Smoothing,
+            maxSpeed = MaxSpeed,
+            invertDirection = InvertDirection ? 1 : 0,
+            filter = (int)Filter,
+            adaptivity = Adaptivity,
+            calibration = calibration.Native,
+        };
+
+        var (primaryX, primaryY, primaryEvents) = DrainPrimary();
+        var (turnX, _) = DrainInput(TurnInput);
+
+        if (_calibrating && primaryEvents > 0)
+        {
+            lock (_calibrationLock)
+            {
+                if (_calibrating)
+                    NativeMethods.TreadmillInput_CalibrationAdd(ref _calibrationRun, in _events[0], (uint)primaryEvents);
+            }
+        }
+
+        // Scaled to the 16 ms reference tick inside the core, so the feel
+        // does not change with the tick rate. The adaptive filters bin the
+        // events on their own timestamps instead (input_core.h)
+        double forward = config.filter == NativeMethods.TREADMILL_INPUT_FILTER_EMA
+            ? NativeMethods.TreadmillInput_Step(ref _filter, in config, primaryY, elapsedSeconds)
+            : NativeMethods.TreadmillInput_ProcessEvents(ref _filter, in config, in _events[0], (uint)primaryEvents,
+                now, Stopwatch.Frequency);
+
+        // The core treats a negative delta as positive output (mouse Y grows backwards);
+        // X grows to the right, so it is negated to make right positive
+        double strafe = StepAxis(ref _strafeFilter, Strafe, -primaryX, elapsedSeconds);
+        double turn = StepAxis(ref _turnFilter, Turn, -turnX, elapsedSeconds);
+
+        if (_trace != null)
+        {
+            if (!ReferenceEquals(calibration, _tracedCalibration))
+            {
+                _tracedCalibration = calibration;
+                _trace.RecordCalibration(VelocityTraceWriter.AxisForward, calibration.CountsPerMeter,
+                    calibration.TopSpeed, calibration.Curve, now);
+            }
+            TraceConfig(VelocityTraceWriter.AxisForward, config, true, now);
+            TraceConfig(VelocityTraceWriter.AxisStrafe, AxisConfig(Strafe), Strafe.Enabled, now);
+            TraceConfig(VelocityTraceWriter.AxisTurn, AxisConfig(Turn), Turn.Enabled, now);
+            _trace.RecordTick(now, primaryX, primaryY, turnX, primaryEvents, forward, strafe, turn);
+        }
 
-        // Exponential moving average smoothing
-        double smoothingFactor = Math.Clamp(Smoothing, 0.05, 1.0);
-        _smoothedVelocity = _smoothedVelocity * (1.0 - smoothingFactor) + scaledDelta * smoothingFactor;
+        MotionUpdated?.Invoke(new MotionVector(forward, strafe, turn));
+    }
+
+    /// <summary>Records an axis's settings when they differ from the last ones recorded.</summary>
+    private void TraceConfig(byte axis, in NativeMethods.TreadmillInputConfig config, bool enabled, long now)
+    {
+        ref var last = ref _tracedConfig[axis];
+        if (_configTraced[axis] && _tracedEnabled[axis] == enabled &&
+            last.sensitivity == config.sensitivity && last.deadZone == config.deadZone &&
+            last.smoothing == config.smoothing && last.maxSpeed == config.maxSpeed &&
+            last.invertDirection == config.invertDirection &&
+            last.filter == config.filter && last.adaptivity == config.adaptivity)
+            return;
+
+        last = config;
+        _tracedEnabled[axis] = enabled;
+        _configTraced[axis] = true;
+        _trace!.RecordConfig(axis, config, enabled, now);
+    }
+
+    private static NativeMethods.TreadmillInputConfig AxisConfig(AxisSettings settings) => new()
+    {
+        sensitivity = settings.Sensitivity,
+        deadZone = settings.DeadZone,
+        smoothing = settings.Smoothing,
+        maxSpeed = settings.MaxSpeed,
+        invertDirection = settings.InvertDirection ? 1 : 0,
+    };
 
-        // Apply dead zone
-        if (Math.Abs(_smoothedVelocity) < DeadZone)
+    private static double StepAxis(ref NativeMethods.TreadmillInputState filter, AxisSettings settings,
+        double delta, double elapsedSeconds)
+    {
+        if (!settings.Enabled)
         {
-            // Decay towards zero when in dead zone
-            _smoothedVelocity *= 0.8;
-            if (Math.Abs(_smoothedVelocity) < 0.5)
-                _smoothedVelocity = 0;
+            filter = default;
+            return 0;
         }
 
-        // Normalize to -1.0 to 1.0 range
-        // Assume a "reasonable max" raw speed of ~200 units per tick at sensitivity 1
-        double maxRawSpeed = 100.0 * (MaxSpeed / 100.0);
-        double normalizedVelocity = Math.Clamp(_smoothedVelocity / maxRawSpeed, -1.0, 1.0);
+        var config = AxisConfig(settings);
+        return NativeMethods.TreadmillInput_Step(ref filter, in config, delta, elapsedSeconds);
+    }
 
-        VelocityUpdated?.Invoke(normalizedVelocity);
+    /// <summary>
+    /// Throws if treadmill_input.dll is missing or from another build, so
+    /// <see cref="Start"/> fails on the caller's thread rather than the processing thread.
+    /// </summary>
+    private static void EnsureNativeCore()
+    {
+        int version = NativeMethods.TreadmillInput_AbiVersion();
+        if (version != NativeMethods.TREADMILL_INPUT_ABI_VERSION)
+            throw new InvalidOperationException(
+                $"{NativeMethods.InputCoreDll} ABI version {version}, expected {NativeMethods.TREADMILL_INPUT_ABI_VERSION}");
     }
 
     // ─── Dispose ─────────────────────────────────────────────────────
@@ -125,7 +437,9 @@ public class InputProcessor : IDisposable
     {
         if (_disposed) return;
         _disposed = true;
-        _timer.Stop();
+        _running = false;
+        _thread?.Join();
+        _thread = null;
         GC.SuppressFinalize(this);
     }
 }
@@ -1,6 +1,5 @@
+using System.Diagnostics;
 using System.Runtime.InteropServices;
-using System.Windows;
-using System.Windows.Interop;
 using TreadmillDriver.Models;
 using TreadmillDriver.Native;
 
@@ -8,20 +7,87 @@ namespace TreadmillDriver.Services;
 
 /// <summary>
 /// Captures raw input from a specific mouse device using the Windows Raw Input API.
-/// When BlockCursor is enabled, installs a low-level mouse hook that intercepts
-/// ALL mouse movement at the system level, then uses Raw Input to identify which
-/// device caused each move. Non-target devices get their movement re-injected.
-/// The target device's movement is consumed exclusively by this app.
+/// Input is received by a message-only window on a dedicated capture thread, which
+/// drains it in batches with GetRawInputBuffer into a buffer allocated once per
+/// capture, so a 1000–8000 Hz mouse never touches the WPF UI thread and costs no
+/// per-event allocation. Target-device deltas are handed to the consumer through
+/// a lock-free <see cref="SpscQueue{T}"/>, and in raw delta streaming mode also
+/// written to the OpenXR layer's shared-memory ring from this same thread.
+/// An optional second device (the turn sensor) is captured the same way into its
+/// own queue, <see cref="TurnOutput"/>.
+/// When BlockCursor is enabled, the target devices' cursor movement is undone by
+/// injecting the opposite move once per batch, so only this app sees it.
 /// </summary>
-public class MouseCaptureService : IDisposable
+public unsafe class MouseCaptureService : IDisposable
 {
+    private const string WindowClassName = "TreadmillDriverRawInput";
+    private const int RawBufferBytes = 64 * 1024;   // ~2000 mouse events per read
+    private const int ERROR_CLASS_ALREADY_EXISTS = 1410;
+    private const uint WM_WAKE = 0x8000;            // WM_APP: wakes the pump to see a stop request
+
+    // Kept alive for as long as the window class may be registered
+    private static readonly NativeMethods.WndProc DefaultWindowProc = NativeMethods.DefWindowProcW;
+
     private IntPtr _targetDeviceHandle = IntPtr.Zero;
-    private HwndSource? _hwndSource;
+    private IntPtr _turnDeviceHandle = IntPtr.Zero;
+    private Thread? _thread;
+    private IntPtr _hwnd;
+    private IntPtr _rawBuffer;
+    private volatile bool _running;
+    private bool _startSucceeded;
     private bool _isCapturing;
     private bool _disposed;
 
-    /// <summary>Fires when mouse movement is detected from the target device. Provides delta X, Y.</summary>
-    public event Action<int, int>? MouseMoved;
+    // Capture thread only
+    private readonly NativeMethods.INPUT[] _counterInput = new NativeMethods.INPUT[1];
+    private int _pendingDx;
+    private int _pendingDy;
+    private int _pendingTurnDx;
+    private int _pendingTurnDy;
+    private readonly MouseDelta[] _rawBatch = new MouseDelta[RawBufferBytes / 24];  // one per RAWINPUTHEADER at most
+    private int _rawBatchCount;
+    private long _batchTimestamp;
+    private volatile SharedMemoryService? _rawDeltaOutput;
+    private volatile VelocityTraceWriter? _traceWriter;
+
+    // Written by the capture thread, read anywhere
+    private long _eventCount;
+    private long _batchCount;
+    private long _mergedCount;
+    private int _maxBatch;
+
+    /// <summary>
+    /// Receives the target device's deltas. Set before <see cref="StartCapture"/>;
+    /// the capture thread is its only producer.
+    /// </summary>
+    public SpscQueue<MouseDelta>? Output { get; set; }
+
+    /// <summary>
+    /// Receives the turn device's deltas, if one was passed to <see cref="StartCapture"/>.
+    /// Same threading as <see cref="Output"/>; never fed into the raw delta ring.
+    /// </summary>
+    public SpscQueue<MouseDelta>? TurnOutput { get; set; }
+
+    /// <summary>
+    /// When set, every target delta is also pushed straight into the shared-memory
+    /// delta ring, stamped with the time its batch was read (raw delta streaming).
+    /// May be changed while capturing.
+    /// </summary>
+    public SharedMemoryService? RawDeltaOutput
+    {
+        get => _rawDeltaOutput;
+        set => _rawDeltaOutput = value;
+    }
+
+    /// <summary>
+    /// When set, every target and turn delta is recorded, stamped with the time its
+    /// batch was read. May be changed while capturing.
+    /// </summary>
+    public VelocityTraceWriter? TraceWriter
+    {
+        get => _traceWriter;
+        set => _traceWriter = value;
+    }
 
     /// <summary>Whether capture is currently active.</summary>
     public bool IsCapturing => _isCapturing;
@@ -32,6 +98,17 @@ public class MouseCaptureService : IDisposable
     /// </summary>
     public bool BlockCursor { get; set; } = true;
 
+    /// <summary>Capture counters since the last <see cref="StartCapture"/>. Safe to read from any thread.</summary>
+    public RawInputStats Stats => new()
+    {
+        Events = Volatile.Read(ref _eventCount),
+        Batches = Volatile.Read(ref _batchCount),
+        MaxBatch = Volatile.Read(ref _maxBatch),
+        Merged = Volatile.Read(ref _mergedCount),
+        QueueMaxDepth = Output?.MaxDepth ?? 0,
+        QueueCapacity = Output?.Capacity ?? 0,
+    };
+
     // ─── Device Enumeration ──────────────────────────────────────────
 
     /// <summary>
@@ -154,40 +231,49 @@ public class MouseCaptureService : IDisposable
     // ─── Capture Control ─────────────────────────────────────────────
 
     /// <summary>
-    /// Start capturing raw input from the specified device.
-    /// Must be called from the UI thread.
+    /// Start capturing raw input from the specified device, and from
+    /// <paramref name="turnDeviceHandle"/> as the turn sensor if it is non-zero.
+    /// Returns once the capture thread has registered for raw input (or failed to).
     /// </summary>
-    public bool StartCapture(IntPtr deviceHandle, Window window)
+    public bool StartCapture(IntPtr deviceHandle, IntPtr turnDeviceHandle = default)
     {
         if (_isCapturing)
             StopCapture();
 
         _targetDeviceHandle = deviceHandle;
-
-        var hwnd = new WindowInteropHelper(window).Handle;
-        if (hwnd == IntPtr.Zero) return false;
-
-        _hwndSource = HwndSource.FromHwnd(hwnd);
-        if (_hwndSource == null) return false;
-
-        // Register for raw mouse input
-        var rid = new NativeMethods.RAWINPUTDEVICE[]
+        _turnDeviceHandle = turnDeviceHandle == deviceHandle ? IntPtr.Zero : turnDeviceHandle;
+        _pendingDx = 0;
+        _pendingDy = 0;
+        _pendingTurnDx = 0;
+        _pendingTurnDy = 0;
+        _eventCount = 0;
+        _batchCount = 0;
+        _mergedCount = 0;
+        _maxBatch = 0;
+        Output?.ResetMaxDepth();
+
+        using var ready = new ManualResetEventSlim();
+        _running = true;
+        _thread = new Thread(() => CaptureThread(ready))
         {
-            new()
-            {
-                usUsagePage = 0x01,  // HID_USAGE_PAGE_GENERIC
-                usUsage = 0x02,      // HID_USAGE_GENERIC_MOUSE
-                dwFlags = NativeMethods.RIDEV_INPUTSINK,
-                hwndTarget = hwnd
-            }
+            Name = "Treadmill Raw Input",
+            IsBackground = true,
+            Priority = ThreadPriority.Highest,
         };
+        _thread.Start();
+        ready.Wait();
 
-        if (!NativeMethods.RegisterRawInputDevices(rid, 1, (uint)Marshal.SizeOf<NativeMethods.RAWINPUTDEVICE>()))
+        if (!_startSucceeded)
+        {
+            _running = false;
+            _thread.Join();
+            _thread = null;
+            _targetDeviceHandle = IntPtr.Zero;
+            _turnDeviceHandle = IntPtr.Zero;
             return false;
+        }
 
-        _hwndSource.AddHook(WndProc);
         _isCapturing = true;
-
         return true;
     }
 
@@ -198,11 +284,70 @@ public class MouseCaptureService : IDisposable
     {
         if (!_isCapturing) return;
 
-        _hwndSource?.RemoveHook(WndProc);
+        _running = false;
+        NativeMethods.PostMessageW(_hwnd, WM_WAKE, IntPtr.Zero, IntPtr.Zero);
+        _thread?.Join();
+        _thread = null;
+
+        _isCapturing = false;
+        _targetDeviceHandle = IntPtr.Zero;
+        _turnDeviceHandle = IntPtr.Zero;
+    }
+
+    // ─── Capture Thread ──────────────────────────────────────────────
+
+    private void CaptureThread(ManualResetEventSlim ready)
+    {
+        _startSucceeded = CreateCaptureWindow();
+        ready.Set();
+
+        if (_startSucceeded)
+            Pump();
+
+        DestroyCaptureWindow();
+    }
+
+    private bool CreateCaptureWindow()
+    {
+        _rawBuffer = Marshal.AllocHGlobal(RawBufferBytes);
+
+        var hInstance = NativeMethods.GetModuleHandle(null);
+        var wc = new NativeMethods.WNDCLASSEX
+        {
+            cbSize = (uint)Marshal.SizeOf<NativeMethods.WNDCLASSEX>(),
+            lpfnWndProc = DefaultWindowProc,
+            hInstance = hInstance,
+            lpszClassName = WindowClassName,
+        };
+        if (NativeMethods.RegisterClassExW(ref wc) == 0 &&
+            Marshal.GetLastWin32Error() != ERROR_CLASS_ALREADY_EXISTS)
+            return false;
+
+        // Message-only: never shown, receives no broadcasts, only our raw input
+        _hwnd = NativeMethods.CreateWindowExW(0, WindowClassName, string.Empty, 0, 0, 0, 0, 0,
+            NativeMethods.HWND_MESSAGE, IntPtr.Zero, hInstance, IntPtr.Zero);
+        if (_hwnd == IntPtr.Zero)
+            return false;
+
+        // Register for raw mouse input
+        var rid = new NativeMethods.RAWINPUTDEVICE[]
+        {
+            new()
+            {
+                usUsagePage = 0x01,  // HID_USAGE_PAGE_GENERIC
+                usUsage = 0x02,      // HID_USAGE_GENERIC_MOUSE
+                dwFlags = NativeMethods.RIDEV_INPUTSINK,
+                hwndTarget = _hwnd
+            }
+        };
+        return NativeMethods.RegisterRawInputDevices(rid, 1, (uint)Marshal.SizeOf<NativeMethods.RAWINPUTDEVICE>());
+    }
 
-        // Unregister raw input
-        if (_hwndSource != null)
+    private void DestroyCaptureWindow()
+    {
+        if (_hwnd != IntPtr.Zero)
         {
+            // Unregister raw input
             var rid = new NativeMethods.RAWINPUTDEVICE[]
             {
                 new()
@@ -214,117 +359,218 @@ public class MouseCaptureService : IDisposable
                 }
             };
             NativeMethods.RegisterRawInputDevices(rid, 1, (uint)Marshal.SizeOf<NativeMethods.RAWINPUTDEVICE>());
+
+            NativeMethods.DestroyWindow(_hwnd);
+            _hwnd = IntPtr.Zero;
         }
 
-        _hwndSource = null;
-        _isCapturing = false;
-        _targetDeviceHandle = IntPtr.Zero;
-    }
+        NativeMethods.UnregisterClassW(WindowClassName, NativeMethods.GetModuleHandle(null));
 
-    // ─── Cursor Counter-Injection ──────────────────────────────────
+        Marshal.FreeHGlobal(_rawBuffer);
+        _rawBuffer = IntPtr.Zero;
+    }
 
-    /// <summary>
-    /// Inject an opposite mouse move to undo the target device's cursor movement.
-    /// This lets all system interactions (window drag, resize, etc.) work normally
-    /// because we never block any mouse messages — we just counteract the target's delta.
-    /// </summary>
-    private static void CounterInjectMove(int dx, int dy)
+    private void Pump()
     {
-        var inputs = new NativeMethods.INPUT[]
+        while (_running)
         {
-            new()
+            // MWMO_INPUTAVAILABLE: also wake for input that arrived before the wait
+            uint result = NativeMethods.MsgWaitForMultipleObjectsEx(0, IntPtr.Zero, NativeMethods.INFINITE,
+                NativeMethods.QS_RAWINPUT | NativeMethods.QS_POSTMESSAGE | NativeMethods.QS_SENDMESSAGE,
+                NativeMethods.MWMO_INPUTAVAILABLE);
+            if (result == NativeMethods.WAIT_FAILED)
+                break;
+
+            DrainRawInput();
+
+            // Everything except WM_INPUT: those stay queued for the next buffered read,
+            // since removing one here would discard its data
+            while (NativeMethods.PeekMessageW(out var msg, IntPtr.Zero, 0, NativeMethods.WM_INPUT - 1, NativeMethods.PM_REMOVE) ||
+                   NativeMethods.PeekMessageW(out msg, IntPtr.Zero, NativeMethods.WM_INPUT + 1, 0xFFFF, NativeMethods.PM_REMOVE))
             {
-                type = NativeMethods.INPUT_MOUSE,
-                u = new NativeMethods.INPUT_UNION
-                {
-                    mi = new NativeMethods.MOUSEINPUT
-                    {
-                        dx = -dx,
-                        dy = -dy,
-                        mouseData = 0,
-                        dwFlags = NativeMethods.MOUSEEVENTF_MOVE,
-                        time = 0,
-                        dwExtraInfo = NativeMethods.REINJECT_MAGIC
-                    }
-                }
+                if (msg.message == NativeMethods.WM_QUIT)
+                    return;
+                NativeMethods.TranslateMessage(ref msg);
+                NativeMethods.DispatchMessageW(ref msg);
             }
-        };
-        NativeMethods.SendInput(1, inputs, Marshal.SizeOf<NativeMethods.INPUT>());
+        }
     }
 
-    // ─── Message Processing ──────────────────────────────────────────
+    // ─── Batch Processing ────────────────────────────────────────────
 
-    private IntPtr WndProc(IntPtr hwnd, int msg, IntPtr wParam, IntPtr lParam, ref bool handled)
+    private void DrainRawInput()
     {
-        if (msg == NativeMethods.WM_INPUT)
+        uint headerSize = (uint)sizeof(NativeMethods.RAWINPUTHEADER);
+
+        // A 32-bit process on 64-bit Windows gets 64-bit RAWINPUT layouts from
+        // GetRawInputBuffer (but not from GetRawInputData): the header is 8 bytes longer
+        int mouseOffset = (int)headerSize +
+            (Environment.Is64BitOperatingSystem && !Environment.Is64BitProcess ? 8 : 0);
+
+        int injectDx = 0;
+        int injectDy = 0;
+
+        while (true)
         {
-            ProcessRawInput(lParam);
+            uint size = RawBufferBytes;
+            uint count = NativeMethods.GetRawInputBuffer(_rawBuffer, ref size, headerSize);
+            if (count == 0 || count == unchecked((uint)-1))
+                break;
+
+            // Raw input carries no per-event time; the read is the tightest bound we have
+            long batchTimestamp = Stopwatch.GetTimestamp();
+            var rawOutput = _rawDeltaOutput;
+            _rawBatchCount = 0;
+            _batchTimestamp = batchTimestamp;
+
+            byte* entry = (byte*)_rawBuffer;
+            for (uint i = 0; i < count; i++)
+            {
+                var header = (NativeMethods.RAWINPUTHEADER*)entry;
+                if (header->dwType == NativeMethods.RIM_TYPEMOUSE)
+                    ProcessMouse(header->hDevice, (NativeMethods.RAWMOUSE*)(entry + mouseOffset), rawOutput != null, ref injectDx, ref injectDy);
+
+                // NEXTRAWINPUTBLOCK: entries are QWORD-aligned
+                entry += (header->dwSize + 7) & ~7u;
+            }
+
+            if (rawOutput != null && _rawBatchCount > 0)
+                rawOutput.PushDeltas(_rawBatch.AsSpan(0, _rawBatchCount), batchTimestamp);
+
+            Volatile.Write(ref _eventCount, _eventCount + count);
+            Volatile.Write(ref _batchCount, _batchCount + 1);
+            if (count > _maxBatch)
+                Volatile.Write(ref _maxBatch, (int)count);
         }
-        return IntPtr.Zero;
+
+        // If blocking, inject one opposite move to undo the whole batch's cursor displacement
+        if (BlockCursor && (injectDx != 0 || injectDy != 0))
+            CounterInjectMove(injectDx, injectDy);
     }
 
-    private void ProcessRawInput(IntPtr hRawInput)
+    private void ProcessMouse(IntPtr hDevice, NativeMethods.RAWMOUSE* mouse, bool streamRaw, ref int injectDx, ref int injectDy)
     {
-        uint headerSize = (uint)Marshal.SizeOf<NativeMethods.RAWINPUTHEADER>();
-        uint size = 0;
-
-        // Get required buffer size
-        NativeMethods.GetRawInputData(hRawInput, NativeMethods.RID_INPUT, IntPtr.Zero, ref size, headerSize);
-
-        if (size == 0) return;
+        // Skip synthetic input (generated by SendInput, e.g. our own re-injections).
+        // hDevice == 0 means it didn't come from a physical device.
+        if (hDevice == IntPtr.Zero)
+            return;
 
-        var buffer = Marshal.AllocHGlobal((int)size);
-        try
-        {
-            if (NativeMethods.GetRawInputData(hRawInput, NativeMethods.RID_INPUT, buffer, ref size, headerSize) == unchecked((uint)-1))
-                return;
+        bool isTarget = hDevice == _targetDeviceHandle;
+        if (!isTarget && hDevice != _turnDeviceHandle)
+            return;
 
-            // Read header
-            var header = Marshal.PtrToStructure<NativeMethods.RAWINPUTHEADER>(buffer);
+        if (mouse->usFlags != NativeMethods.MOUSE_MOVE_RELATIVE)
+            return;
 
-            if (header.dwType != NativeMethods.RIM_TYPEMOUSE)
-                return;
+        int dx = mouse->lLastX;
+        int dy = mouse->lLastY;
+        if (dx == 0 && dy == 0)
+            return;
 
-            // Skip synthetic input (generated by SendInput, e.g. our own re-injections).
-            // hDevice == 0 means it didn't come from a physical device.
-            if (header.hDevice == IntPtr.Zero)
-                return;
+        injectDx += dx;
+        injectDy += dy;
 
-            // Read mouse data
-            var mouseOffset = buffer + Marshal.SizeOf<NativeMethods.RAWINPUTHEADER>();
-            var mouse = Marshal.PtrToStructure<NativeMethods.RAWMOUSE>(mouseOffset);
+        _traceWriter?.RecordDelta(isTarget ? VelocityTraceWriter.SensorPrimary : VelocityTraceWriter.SensorTurn,
+            dx, dy, _batchTimestamp);
 
-            if (mouse.usFlags != NativeMethods.MOUSE_MOVE_RELATIVE)
-                return;
+        if (!isTarget)
+        {
+            Enqueue(TurnOutput, dx, dy, ref _pendingTurnDx, ref _pendingTurnDy);
+            return;
+        }
 
-            if (mouse.lLastX == 0 && mouse.lLastY == 0)
-                return;
+        if (streamRaw && _rawBatchCount < _rawBatch.Length)
+            _rawBatch[_rawBatchCount++] = new MouseDelta(dx, dy, _batchTimestamp);
 
-            bool isTargetDevice = (_targetDeviceHandle != IntPtr.Zero && header.hDevice == _targetDeviceHandle);
+        Enqueue(Output, dx, dy, ref _pendingDx, ref _pendingDy);
+    }
 
-            if (isTargetDevice)
-            {
-                // Target device: consume movement for treadmill processing
-                MouseMoved?.Invoke(mouse.lLastX, mouse.lLastY);
+    private void Enqueue(SpscQueue<MouseDelta>? output, int dx, int dy, ref int pendingDx, ref int pendingDy)
+    {
+        if (output == null)
+            return;
 
-                // If blocking, inject an opposite move to undo the cursor displacement
-                if (BlockCursor)
-                    CounterInjectMove(mouse.lLastX, mouse.lLastY);
-            }
+        // A full queue means the consumer stalled: merge into the next event rather than lose movement
+        dx += pendingDx;
+        dy += pendingDy;
+        if (output.TryEnqueue(new MouseDelta(dx, dy, _batchTimestamp)))
+        {
+            pendingDx = 0;
+            pendingDy = 0;
         }
-        finally
+        else
         {
-            Marshal.FreeHGlobal(buffer);
+            pendingDx = dx;
+            pendingDy = dy;
+            Volatile.Write(ref _mergedCount, _mergedCount + 1);
         }
     }
 
+    // ─── Cursor Counter-Injection ──────────────────────────────────
+
+    /// <summary>
+    /// Inject an opposite mouse move to undo the target devices' cursor movement.
+    /// This lets all system interactions (window drag, resize, etc.) work normally
+    /// because we never block any mouse messages — we just counteract the target's delta.
+    /// Capture thread only: reuses one preallocated INPUT.
+    /// </summary>
+    private void CounterInjectMove(int dx, int dy)
+    {
+        _counterInput[0] = new NativeMethods.INPUT
+        {
+            type = NativeMethods.INPUT_MOUSE,
+            u = new NativeMethods.INPUT_UNION
+            {
+                mi = new NativeMethods.MOUSEINPUT
+                {
+                    dx = -dx,
+                    dy = -dy,
+                    mouseData = 0,
+                    dwFlags = NativeMethods.MOUSEEVENTF_MOVE,
+                    time = 0,
+                    dwExtraInfo = NativeMethods.REINJECT_MAGIC
+                }
+            }
+        };
+        NativeMethods.SendInput(1, _counterInput, sizeof(NativeMethods.INPUT));
+    }
+
     // ─── Dispose ─────────────────────────────────────────────────────
 
     public void Dispose()
     {
         if (_disposed) return;
         _disposed = true;
-        StopCapture();  // also removes hook
+        StopCapture();
         GC.SuppressFinalize(this);
     }
 }
+
+/// <summary>
+/// Raw input capture counters, as reported by <see cref="MouseCaptureService.Stats"/>.
+/// </summary>
+public sealed class RawInputStats
+{
+    /// <summary>Raw input events read, all devices.</summary>
+    public long Events { get; init; }
+
+    /// <summary>GetRawInputBuffer reads that returned data.</summary>
+    public long Batches { get; init; }
+
+    /// <summary>Most events returned by one read.</summary>
+    public int MaxBatch { get; init; }
+
+    /// <summary>Target events merged into a later one because the queue was full.</summary>
+    public long Merged { get; init; }
+
+    public int QueueMaxDepth { get; init; }
+    public int QueueCapacity { get; init; }
+
+    /// <summary>Events per second between an earlier snapshot and this one.</summary>
+    public double EventsPerSecond(RawInputStats earlier, TimeSpan elapsed) =>
+        elapsed > TimeSpan.Zero ? (Events - earlier.Events) / elapsed.TotalSeconds : 0;
+
+    public string ToLogLine(double eventsPerSecond) =>
+        $"Raw input: {eventsPerSecond:F0} events/s, {Events} events in {Batches} batches " +
+        $"(max {MaxBatch}), queue max depth {QueueMaxDepth}/{QueueCapacity}, merged {Merged}";
+}
@@ -0,0 +1,76 @@
+using System.Diagnostics;
+using TreadmillDriver.Native;
+
+namespace TreadmillDriver.Services;
+
+/// <summary>
+/// Sleeps a thread until a <see cref="Stopwatch"/> deadline with
+/// sub-millisecond accuracy. Uses a high-resolution waitable timer for
+/// the bulk of the wait and spins the last few hundred microseconds.
+/// On systems without high-resolution timers (before Windows 10 1803)
+/// it falls back to 1 ms <c>Sleep</c> granularity plus a longer spin.
+/// Not thread-safe: one instance per waiting thread.
+/// </summary>
+public sealed class PrecisionTimer : IDisposable
+{
+    private static readonly long SpinMarginTicks = Stopwatch.Frequency / 5000;      // 200 µs
+    private static readonly long SleepMarginTicks = Stopwatch.Frequency / 500;       // 2 ms
+
+    private IntPtr _timer;
+    private readonly bool _raisedTimerResolution;
+    private bool _disposed;
+
+    /// <summary>Whether the high-resolution waitable timer is in use.</summary>
+    public bool IsHighResolution => _timer != IntPtr.Zero;
+
+    public PrecisionTimer()
+    {
+        _timer = NativeMethods.CreateWaitableTimerExW(
+            IntPtr.Zero, null,
+            NativeMethods.CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+            NativeMethods.TIMER_ALL_ACCESS);
+
+        if (_timer == IntPtr.Zero)
+            _raisedTimerResolution = NativeMethods.timeBeginPeriod(1) == 0;
+    }
+
+    /// <summary>
+    /// Blocks until <see cref="Stopwatch.GetTimestamp"/> reaches <paramref name="deadline"/>.
+    /// Returns immediately if the deadline has already passed.
+    /// </summary>
+    public void WaitUntil(long deadline)
+    {
+        if (_timer != IntPtr.Zero)
+        {
+            long sleepTicks = deadline - Stopwatch.GetTimestamp() - SpinMarginTicks;
+            if (sleepTicks > 0)
+            {
+                long dueTime = -Math.Max(1, sleepTicks * 10_000_000 / Stopwatch.Frequency);
+                if (NativeMethods.SetWaitableTimer(_timer, ref dueTime, 0, IntPtr.Zero, IntPtr.Zero, false))
+                    NativeMethods.WaitForSingleObject(_timer, NativeMethods.INFINITE);
+            }
+        }
+        else
+        {
+            while (deadline - Stopwatch.GetTimestamp() > SleepMarginTicks)
+                Thread.Sleep(1);
+        }
+
+        while (Stopwatch.GetTimestamp() < deadline)
+            Thread.SpinWait(16);
+    }
+
+    public void Dispose()
+    {
+        if (_disposed) return;
+        _disposed = true;
+
+        if (_timer != IntPtr.Zero)
+        {
+            NativeMethods.CloseHandle(_timer);
+            _timer = IntPtr.Zero;
+        }
+        if (_raisedTimerResolution)
+            NativeMethods.timeEndPeriod(1);
+    }
+}
@@ -1,20 +1,104 @@
 using System;
+using System.Diagnostics;
+using System.IO;
 using System.IO.MemoryMappedFiles;
-using System.Runtime.InteropServices;
+using System.Threading;
+using TreadmillDriver.Models;
 
 namespace TreadmillDriver.Services;
 
 /// <summary>
-/// Writes treadmill velocity to a named memory-mapped file so the
-/// native OpenXR API layer can read it and inject into VR input.
+/// Writes treadmill motion (forward velocity, strafe and turn) to a named memory-mapped
+/// file so the native OpenXR API layer can read it and inject into VR input.
+/// In raw delta mode it also streams every raw delta plus the filter settings,
+/// and the layer runs the filter itself once per frame. Every published velocity is also
+/// appended to a history ring, so a reader that samples late still sees each tick.
+/// Layout, seqlock and ring protocol (v5) are defined in OpenXRLayer/treadmill_shared.h
+/// and OpenXRLayer/shared_ring.h. The layer's own counters come back the other way, in
+/// a second mapping it creates (<see cref="TryReadLayerTelemetry"/>).
 /// </summary>
-public sealed class SharedMemoryService : IDisposable
+public sealed unsafe class SharedMemoryService : IDisposable
 {
     private const string SharedMemName = "TreadmillDriverVelocity";
-    private const int SharedMemSize = 8; // float velocity + uint32 active
+    private const int SharedMemSize = 49728;
+
+    // ─── Protocol v5 (keep in sync with treadmill_shared.h) ──────────
+
+    private const uint Magic = 0x32564D54; // "TMV2"
+    private const ushort Version = 5;
+    private const ushort HeaderSize = 24;
+
+    private const int OffMagic = 0;
+    private const int OffVersion = 4;
+    private const int OffHeaderSize = 6;
+    private const int OffTotalSize = 8;
+    private const int OffTimestampFrequency = 16;
+    private const int OffSequence = 24;
+    private const int OffHeartbeat = 28;
+    private const int OffTimestamp = 32;
+    private const int OffVelocity = 40;
+    private const int OffActive = 44;
+    private const int OffStreamMode = 48;
+    private const int OffGeneration = 52;
+    private const int OffStrafe = 56;
+    private const int OffTurn = 60;
+
+    private const int OffConfigSequence = 64;
+    private const int OffConfigInvert = 68;
+    private const int OffConfigSensitivity = 72;
+    private const int OffConfigDeadZone = 80;
+    private const int OffConfigSmoothing = 88;
+    private const int OffConfigMaxSpeed = 96;
+    private const int OffConfigFilter = 104;
+    private const int OffConfigAdaptivity = 112;
+
+    // Rings: head on its own cache line, slots from the next line
+    private const int OffDeltaHead = 128;
+    private const int OffDeltas = 192;
+    private const int DeltaRingSize = 2048;
+    private const int OffVelocityHead = 32960;
+    private const int OffVelocitySamples = 33024;
+    private const int VelocityRingSize = 1024;
+    private const int RingEntrySize = 16;
+
+    private const int OffCalibrationSequence = 49408;
+    private const int OffCalibrationCountsPerMeter = 49416;
+    private const int OffCalibrationTopSpeed = 49424;
+    private const int OffCalibrationCurve = 49432;
+    private const int CurveSize = 64;
+
+    private const uint StreamVelocity = 0;
+    private const uint StreamRawDeltas = 1;
+
+    // ─── Layer telemetry v1 (keep in sync with layer_telemetry.h) ────
+
+    private const string TelemetryMemName = "TreadmillDriverTelemetry";
+    private const int TelemetrySize = 4224;
+    private const uint TelemetryMagic = 0x4C544D54; // "TMTL"
+    private const ushort TelemetryVersion = 1;
+
+    private const int TelOffProcessId = 12;
+    private const int TelOffTimestampFrequency = 16;
+    private const int TelOffLiveInstances = 64;
+    private const int TelOffAxes = 68;
+    private const int TelOffUpdated = 80;
+    private const int TelOffDisplayPeriod = 88;
+    private const int TelOffThreads = 128;
+    private const int TelThreadSlots = 16;
+    private const int TelThreadSize = 256;
+    private const int TelCallCount = 10;
+    private const int TelSlotInjected = 128;
+    private const int TelSlotSkippedSubaction = 136;
+    private const int TelSlotTimedCalls = 144;
+    private const int TelSlotTimeTicks = 152;
+    private const int TelSlotThreadId = 160;
 
     private MemoryMappedFile? _mmf;
     private MemoryMappedViewAccessor? _accessor;
+    private byte* _view;
+    private MemoryMappedFile? _telemetryMmf;
+    private MemoryMappedViewAccessor? _telemetryAccessor;
+    private byte* _telemetryView;
     private bool _disposed;
 
     /// <summary>
@@ -31,19 +115,119 @@ public sealed class SharedMemoryService : IDisposable
 
         _accessor = _mmf.CreateViewAccessor(0, SharedMemSize, MemoryMappedFileAccess.ReadWrite);
 
-        // velocity = 0.0f
-        _accessor.Write(0, 0.0f);
-        // active = 1
-        _accessor.Write(4, (uint)1);
+        byte* ptr = null;
+        _accessor.SafeMemoryMappedViewHandle.AcquirePointer(ref ptr);
+        _view = ptr + _accessor.PointerOffset;
+
+        // Header first, magic last, so a reader never validates a half-written header
+        *(uint*)(_view + OffMagic) = 0;
+        *(ushort*)(_view + OffVersion) = Version;
+        *(ushort*)(_view + OffHeaderSize) = HeaderSize;
+        *(uint*)(_view + OffTotalSize) = SharedMemSize;
+        *(long*)(_view + OffTimestampFrequency) = Stopwatch.Frequency;
+
+        // A layer that kept the mapping from a previous run starts over on a new generation
+        Interlocked.Increment(ref *(int*)(_view + OffGeneration));
+        Volatile.Write(ref *(uint*)(_view + OffMagic), Magic);
+
+        // The ring heads are left alone: a layer that kept the mapping open
+        // holds cursors into them
+        Publish(0.0f, 0.0f, 0.0f, 1);
+    }
+
+    /// <summary>
+    /// Selects what the layer injects: the velocity from <see cref="UpdateVelocity"/>, or its
+    /// own per-frame filtering of the deltas from <see cref="PushDeltas"/>.
+    /// </summary>
+    public void SetRawDeltaStreaming(bool enabled)
+    {
+        if (_view == null) return;
+        Volatile.Write(ref *(uint*)(_view + OffStreamMode), enabled ? StreamRawDeltas : StreamVelocity);
+    }
+
+    /// <summary>
+    /// Publishes the filter settings the layer uses in raw delta mode.
+    /// Seqlocked like the sample; call from one thread only (the UI thread).
+    /// </summary>
+    public void WriteFilterConfig(double sensitivity, double deadZone, double smoothing, double maxSpeed, bool invertDirection,
+        int filter, double adaptivity)
+    {
+        if (_view == null) return;
+        ref uint sequence = ref *(uint*)(_view + OffConfigSequence);
+
+        Interlocked.Increment(ref *(int*)(_view + OffConfigSequence));
+
+        *(double*)(_view + OffConfigSensitivity) = sensitivity;
+        *(double*)(_view + OffConfigDeadZone) = deadZone;
+        *(double*)(_view + OffConfigSmoothing) = smoothing;
+        *(double*)(_view + OffConfigMaxSpeed) = maxSpeed;
+        *(uint*)(_view + OffConfigInvert) = invertDirection ? 1u : 0u;
+        *(uint*)(_view + OffConfigFilter) = (uint)filter;
+        *(double*)(_view + OffConfigAdaptivity) = adaptivity;
+
+        Volatile.Write(ref sequence, sequence + 1);
+    }
+
+    /// <summary>
+    /// Publishes the forward axis calibration (<see cref="BeltCalibration"/>) the layer
+    /// uses in raw delta mode. Seqlocked on its own counter; UI thread only.
+    /// </summary>
+    public void WriteCalibration(double countsPerMeter, double topSpeed, ReadOnlySpan<float> curve)
+    {
+        if (_view == null) return;
+        ref uint sequence = ref *(uint*)(_view + OffCalibrationSequence);
+
+        Interlocked.Increment(ref *(int*)(_view + OffCalibrationSequence));
+
+        *(double*)(_view + OffCalibrationCountsPerMeter) = countsPerMeter;
+        *(double*)(_view + OffCalibrationTopSpeed) = topSpeed;
+        var table = new Span<float>(_view + OffCalibrationCurve, CurveSize);
+        table.Clear();
+        curve[..Math.Min(curve.Length, CurveSize)].CopyTo(table);
+
+        Volatile.Write(ref sequence, sequence + 1);
+    }
+
+    /// <summary>
+    /// Appends raw deltas to the ring, all stamped with <paramref name="timestamp"/>
+    /// (<see cref="Stopwatch"/> ticks). Capture thread only — the ring has a single writer.
+    /// Never blocks: a layer that falls more than a ring behind loses the oldest entries.
+    /// </summary>
+    public void PushDeltas(ReadOnlySpan<MouseDelta> deltas, long timestamp)
+    {
+        byte* view = _view;
+        if (view == null) return;
+
+        ref long head = ref *(long*)(view + OffDeltaHead);
+        long next = head;
+        foreach (var delta in deltas)
+        {
+            byte* entry = view + OffDeltas + (int)(next & (DeltaRingSize - 1)) * RingEntrySize;
+            *(long*)entry = timestamp;
+            *(int*)(entry + 8) = delta.Dx;
+            *(int*)(entry + 12) = delta.Dy;
+
+            // Full fence per entry: this head must be visible before the next entry's
+            // stores, or the layer could not tell that a slot it copied was overwritten
+            Interlocked.Exchange(ref head, ++next);
+        }
     }
 
     /// <summary>
     /// Writes the current normalised velocity (-1 … 1) to shared memory.
-    /// Called on every processing tick (~60 fps).
+    /// Called from the processing thread on every tick (up to 1 kHz); each call also advances
+    /// the heartbeat and timestamp so the layer can detect a stalled app.
+    /// </summary>
+    public void UpdateVelocity(float velocity) => UpdateMotion(velocity, 0.0f, 0.0f);
+
+    /// <summary>
+    /// Writes all three axes (-1 … 1) in one seqlocked sample; same rules as <see cref="UpdateVelocity"/>.
+    /// Only the forward velocity goes into the history ring.
     /// </summary>
-    public void UpdateVelocity(float velocity)
+    public void UpdateMotion(float forward, float strafe, float turn)
     {
-        _accessor?.Write(0, velocity);
+        if (_view == null) return;
+        Publish(forward, strafe, turn, 1);
     }
 
     /// <summary>
@@ -51,10 +235,11 @@ public sealed class SharedMemoryService : IDisposable
     /// </summary>
     public void Stop()
     {
-        if (_accessor != null)
+        if (_view != null)
         {
-            _accessor.Write(0, 0.0f);   // velocity = 0
-            _accessor.Write(4, (uint)0); // active = 0
+            Publish(0.0f, 0.0f, 0.0f, 0);
+            _accessor!.SafeMemoryMappedViewHandle.ReleasePointer();
+            _view = null;
         }
 
         _accessor?.Dispose();
@@ -63,10 +248,130 @@ public sealed class SharedMemoryService : IDisposable
         _mmf = null;
     }
 
+    // ─── Layer telemetry ─────────────────────────────────────────────
+
+    /// <summary>
+    /// Reads the counters the OpenXR layer publishes. False while no layer has
+    /// created them yet (no OpenXR application has run since the last one exited)
+    /// or the block is from an incompatible layer. The mapping is opened read-only
+    /// on first success and kept, so a game started later reuses it. UI thread only.
+    /// </summary>
+    public bool TryReadLayerTelemetry(out LayerTelemetry telemetry)
+    {
+        telemetry = null!;
+        if (_telemetryView == null && !OpenTelemetry()) return false;
+
+        byte* t = _telemetryView;
+        if (Volatile.Read(ref *(uint*)t) != TelemetryMagic || *(ushort*)(t + 4) != TelemetryVersion)
+            return false;
+
+        var calls = new ulong[TelCallCount];
+        ulong injected = 0, skipped = 0, timedCalls = 0, timeTicks = 0;
+        int threads = 0;
+        for (int s = 0; s < TelThreadSlots; s++)
+        {
+            byte* slot = t + TelOffThreads + s * TelThreadSize;
+            for (int c = 0; c < TelCallCount; c++)
+                calls[c] += Volatile.Read(ref *(ulong*)(slot + c * 8));
+            injected += Volatile.Read(ref *(ulong*)(slot + TelSlotInjected));
+            skipped += Volatile.Read(ref *(ulong*)(slot + TelSlotSkippedSubaction));
+            timedCalls += Volatile.Read(ref *(ulong*)(slot + TelSlotTimedCalls));
+            timeTicks += Volatile.Read(ref *(ulong*)(slot + TelSlotTimeTicks));
+            if (Volatile.Read(ref *(uint*)(slot + TelSlotThreadId)) != 0) threads++;
+        }
+
+        telemetry = new LayerTelemetry
+        {
+            ProcessId = *(uint*)(t + TelOffProcessId),
+            TimestampFrequency = *(long*)(t + TelOffTimestampFrequency),
+            LiveInstances = Volatile.Read(ref *(uint*)(t + TelOffLiveInstances)),
+            Forward = *(float*)(t + TelOffAxes),
+            Strafe = *(float*)(t + TelOffAxes + 4),
+            Turn = *(float*)(t + TelOffAxes + 8),
+            Updated = Volatile.Read(ref *(long*)(t + TelOffUpdated)),
+            DisplayPeriodNs = Volatile.Read(ref *(long*)(t + TelOffDisplayPeriod)),
+            Calls = calls,
+            Injected = injected,
+            SkippedSubaction = skipped,
+            TimedCalls = timedCalls,
+            TimeTicks = timeTicks,
+            Threads = threads,
+        };
+        return true;
+    }
+
+    private bool OpenTelemetry()
+    {
+        try
+        {
+            _telemetryMmf = MemoryMappedFile.OpenExisting(TelemetryMemName, MemoryMappedFileRights.Read);
+            _telemetryAccessor = _telemetryMmf.CreateViewAccessor(0, TelemetrySize, MemoryMappedFileAccess.Read);
+        }
+        catch (Exception ex) when (ex is FileNotFoundException or UnauthorizedAccessException or IOException)
+        {
+            CloseTelemetry();
+            return false;
+        }
+
+        byte* ptr = null;
+        _telemetryAccessor.SafeMemoryMappedViewHandle.AcquirePointer(ref ptr);
+        _telemetryView = ptr + _telemetryAccessor.PointerOffset;
+        return true;
+    }
+
+    private void CloseTelemetry()
+    {
+        if (_telemetryView != null)
+        {
+            _telemetryAccessor!.SafeMemoryMappedViewHandle.ReleasePointer();
+            _telemetryView = null;
+        }
+        _telemetryAccessor?.Dispose();
+        _telemetryAccessor = null;
+        _telemetryMmf?.Dispose();
+        _telemetryMmf = null;
+    }
+
+    /// <summary>
+    /// Seqlock write: odd sequence while the payload is being written; the
+    /// sample is then appended to the velocity history ring.
+    /// </summary>
+    private void Publish(float velocity, float strafe, float turn, uint active)
+    {
+        ref uint sequence = ref *(uint*)(_view + OffSequence);
+
+        // Full fence: the odd sequence must be visible before any payload store
+        Interlocked.Increment(ref *(int*)(_view + OffSequence));
+
+        long timestamp = Stopwatch.GetTimestamp();
+        uint heartbeat = *(uint*)(_view + OffHeartbeat) + 1;
+        *(long*)(_view + OffTimestamp) = timestamp;
+        *(float*)(_view + OffVelocity) = velocity;
+        *(float*)(_view + OffStrafe) = strafe;
+        *(float*)(_view + OffTurn) = turn;
+        *(uint*)(_view + OffActive) = active;
+        *(uint*)(_view + OffHeartbeat) = heartbeat;
+
+        // Release: payload stores complete before the sequence turns even
+        Volatile.Write(ref sequence, sequence + 1);
+
+        // History ring entry {timestamp, velocity, heartbeat}; same writer, same thread
+        ref long head = ref *(long*)(_view + OffVelocityHead);
+        long next = head;
+        byte* entry = _view + OffVelocitySamples + (int)(next & (VelocityRingSize - 1)) * RingEntrySize;
+        *(long*)entry = timestamp;
+        *(float*)(entry + 8) = velocity;
+        *(uint*)(entry + 12) = heartbeat;
+
+        // Full fence: see PushDeltas
+        Interlocked.Exchange(ref head, next + 1);
+    }
+
     public void Dispose()
     {
         if (_disposed) return;
         _disposed = true;
         Stop();
+        CloseTelemetry();
     }
 }
@@ -0,0 +1,83 @@
+using System.Numerics;
+using System.Runtime.InteropServices;
+
+namespace TreadmillDriver.Services;
+
+/// <summary>
+/// Bounded lock-free single-producer / single-consumer ring.
+/// Exactly one thread may call <see cref="TryEnqueue"/> and exactly one
+/// (other) thread may call <see cref="TryDequeue"/>; neither ever blocks or
+/// allocates. Head and tail live on separate cache lines so the two sides
+/// do not false-share.
+/// </summary>
+public sealed class SpscQueue<T> where T : struct
+{
+    [StructLayout(LayoutKind.Explicit, Size = 3 * CacheLine)]
+    private struct Indices
+    {
+        /// <summary>Next slot to read. Written by the consumer only.</summary>
+        [FieldOffset(CacheLine)] public long Head;
+
+        /// <summary>Next slot to write. Written by the producer only.</summary>
+        [FieldOffset(2 * CacheLine)] public long Tail;
+    }
+
+    private const int CacheLine = 64;
+
+    private readonly T[] _items;
+    private readonly long _mask;
+    private Indices _indices;
+    private long _maxDepth;
+
+    /// <param name="capacity">Rounded up to a power of two.</param>
+    public SpscQueue(int capacity)
+    {
+        int size = (int)BitOperations.RoundUpToPowerOf2((uint)Math.Max(capacity, 2));
+        _items = new T[size];
+        _mask = size - 1;
+    }
+
+    public int Capacity => _items.Length;
+
+    /// <summary>Items currently queued (approximate while both sides run).</summary>
+    public int Count => (int)(Volatile.Read(ref _indices.Tail) - Volatile.Read(ref _indices.Head));
+
+    /// <summary>Deepest the queue has been since construction or <see cref="ResetMaxDepth"/>.</summary>
+    public int MaxDepth => (int)Volatile.Read(ref _maxDepth);
+
+    public void ResetMaxDepth() => Volatile.Write(ref _maxDepth, 0);
+
+    // ─── Producer ────────────────────────────────────────────────────
+
+    /// <summary>Appends an item; false if the queue is full.</summary>
+    public bool TryEnqueue(in T item)
+    {
+        long tail = _indices.Tail;
+        long depth = tail - Volatile.Read(ref _indices.Head);
+        if (depth >= _items.Length) return false;
+
+        _items[tail & _mask] = item;
+        Volatile.Write(ref _indices.Tail, tail + 1);   // publish after the item is written
+
+        if (depth + 1 > _maxDepth)
+            Volatile.Write(ref _maxDepth, depth + 1);
+        return true;
+    }
+
+    // ─── Consumer ────────────────────────────────────────────────────
+
+    /// <summary>Removes the oldest item; false if the queue is empty.</summary>
+    public bool TryDequeue(out T item)
+    {
+        long head = _indices.Head;
+        if (head == Volatile.Read(ref _indices.Tail))
+        {
+            item = default;
+            return false;
+        }
+
+        item = _items[head & _mask];
+        Volatile.Write(ref _indices.Head, head + 1);   // release the slot after it is read
+        return true;
+    }
+}
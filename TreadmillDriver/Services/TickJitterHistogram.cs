@@ -0,0 +1,147 @@
+using System.Diagnostics;
+using System.Text;
+
+namespace TreadmillDriver.Services;
+
+/// <summary>
+/// Immutable view of the processing loop's tick timing, published by
+/// <see cref="TickJitterHistogram.Snapshot"/>. Bucket counts cover every
+/// tick since the loop started; the interval statistics cover the last
+/// reporting window only.
+/// </summary>
+public sealed class TickJitterStats
+{
+    /// <summary>Upper bounds (µs) of the |interval − target| buckets; the last bucket is open-ended.</summary>
+    public static readonly int[] BucketLimitsUs = { 25, 50, 100, 250, 500, 1000, 2000, 5000 };
+
+    /// <summary>Display labels, one per bucket (BucketLimitsUs.Length + 1).</summary>
+    public static readonly string[] BucketLabels =
+        { "<25µs", "<50µs", "<100µs", "<250µs", "<500µs", "<1ms", "<2ms", "<5ms", "≥5ms" };
+
+    public required double TargetRateHz { get; init; }
+    public required bool HighResolutionTimer { get; init; }
+
+    public required long TotalTicks { get; init; }
+    public required long LateTicks { get; init; }
+    public required long[] BucketCounts { get; init; }
+
+    public required double WindowMeanIntervalMs { get; init; }
+    public required double WindowJitterMs { get; init; }
+    public required double WindowMaxIntervalMs { get; init; }
+
+    /// <summary>Achieved tick rate over the last window.</summary>
+    public double WindowRateHz => WindowMeanIntervalMs > 0 ? 1000.0 / WindowMeanIntervalMs : 0;
+
+    /// <summary>Smallest bucket limit (µs) that covers <paramref name="fraction"/> of all ticks.</summary>
+    public string DeviationPercentileLabel(double fraction)
+    {
+        long total = BucketCounts.Sum();
+        if (total == 0) return "—";
+
+        long threshold = (long)Math.Ceiling(total * fraction);
+        long running = 0;
+        for (int i = 0; i < BucketCounts.Length; i++)
+        {
+            running += BucketCounts[i];
+            if (running >= threshold) return BucketLabels[i];
+        }
+        return BucketLabels[^1];
+    }
+
+    /// <summary>One-line summary for the log.</summary>
+    public string ToLogLine()
+    {
+        var sb = new StringBuilder();
+        sb.Append($"tick {TargetRateHz:F0} Hz ({(HighResolutionTimer ? "hires" : "sleep")}) ");
+        sb.Append($"achieved {WindowRateHz:F1} Hz, jitter {WindowJitterMs:F3} ms, max {WindowMaxIntervalMs:F2} ms, ");
+        sb.Append($"late {LateTicks}/{TotalTicks} | |dev|");
+        for (int i = 0; i < BucketCounts.Length; i++)
+            sb.Append($" {BucketLabels[i]}:{BucketCounts[i]}");
+        return sb.ToString();
+    }
+}
+
+/// <summary>
+/// Histogram of processing-loop tick intervals. <see cref="Record"/> is
+/// called by the processing thread only and never allocates;
+/// <see cref="Snapshot"/> (same thread, about once per second) builds a
+/// <see cref="TickJitterStats"/> that other threads read.
+/// </summary>
+public sealed class TickJitterHistogram
+{
+    private readonly long[] _buckets = new long[TickJitterStats.BucketLimitsUs.Length + 1];
+    private readonly long[] _bucketLimitTicks;
+    private long _totalTicks;
+    private long _lateTicks;
+
+    // Current reporting window
+    private long _windowCount;
+    private double _windowSum;
+    private double _windowSumSquares;
+    private long _windowMax;
+
+    public TickJitterHistogram()
+    {
+        _bucketLimitTicks = TickJitterStats.BucketLimitsUs
+            .Select(us => us * Stopwatch.Frequency / 1_000_000)
+            .ToArray();
+    }
+
+    /// <summary>Records one tick that took <paramref name="interval"/> Stopwatch ticks against a <paramref name="target"/> period.</summary>
+    public void Record(long interval, long target)
+    {
+        long deviation = Math.Abs(interval - target);
+        int bucket = 0;
+        while (bucket < _bucketLimitTicks.Length && deviation >= _bucketLimitTicks[bucket])
+            bucket++;
+        _buckets[bucket]++;
+        _totalTicks++;
+
+        // A tick that arrives more than half a period late has effectively been skipped
+        if (interval > target + target / 2)
+            _lateTicks++;
+
+        _windowCount++;
+        _windowSum += interval;
+        _windowSumSquares += (double)interval * interval;
+        if (interval > _windowMax) _windowMax = interval;
+    }
+
+    /// <summary>Builds an immutable snapshot and starts a new reporting window.</summary>
+    public TickJitterStats Snapshot(double targetRateHz, bool highResolutionTimer)
+    {
+        double toMs = 1000.0 / Stopwatch.Frequency;
+        double mean = _windowCount > 0 ? _windowSum / _windowCount : 0;
+        double variance = _windowCount > 0 ? Math.Max(0, _windowSumSquares / _windowCount - mean * mean) : 0;
+
+        var stats = new TickJitterStats
+        {
+            TargetRateHz = targetRateHz,
+            HighResolutionTimer = highResolutionTimer,
+            TotalTicks = _totalTicks,
+            LateTicks = _lateTicks,
+            BucketCounts = (long[])_buckets.Clone(),
+            WindowMeanIntervalMs = mean * toMs,
+            WindowJitterMs = Math.Sqrt(variance) * toMs,
+            WindowMaxIntervalMs = _windowMax * toMs,
+        };
+
+        _windowCount = 0;
+        _windowSum = 0;
+        _windowSumSquares = 0;
+        _windowMax = 0;
+        return stats;
+    }
+
+    /// <summary>Clears all counts (processing thread not running).</summary>
+    public void Reset()
+    {
+        Array.Clear(_buckets);
+        _totalTicks = 0;
+        _lateTicks = 0;
+        _windowCount = 0;
+        _windowSum = 0;
+        _windowSumSquares = 0;
+        _windowMax = 0;
+    }
+}
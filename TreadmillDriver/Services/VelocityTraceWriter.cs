@@ -0,0 +1,335 @@
+using System.Buffers.Binary;
+using System.Diagnostics;
+using System.IO;
+using TreadmillDriver.Native;
+
+namespace TreadmillDriver.Services;
+
+/// <summary>
+/// Records a session in the binary velocity trace format (OpenXRLayer/velocity_trace.h):
+/// every raw delta, every filter step with the counts it drained and its outputs, and
+/// the settings in force, so a reported problem can be replayed offline with
+/// treadmill_trace_replay, together with the layer's own trace ($TREADMILL_VELOCITY_TRACE).
+/// Producers only enqueue into a lock-free <see cref="SpscQueue{T}"/> of their own —
+/// one per recording thread — and never block or allocate; a writer thread encodes
+/// and appends to the file about every <see cref="DrainIntervalMs"/> ms. Entries a full
+/// queue could not take are counted and recorded as a LOSS record.
+/// </summary>
+public sealed class VelocityTraceWriter : IDisposable
+{
+    public const int DrainIntervalMs = 50;
+
+    // ─── Format (keep in sync with velocity_trace.h) ─────────────────
+
+    private const uint Magic = 0x54564D54; // "TMVT"
+    private const ushort Version = 1;
+    private const ushort FileHeaderSize = 32;
+    private const uint SourceApp = 1;
+    private const int RecordHeaderSize = 8;
+
+    private const byte TypeTime = 1;
+    private const byte TypeStart = 2;
+    private const byte TypeStop = 3;
+    private const byte TypeConfig = 4;
+    private const byte TypeStreamMode = 5;
+    private const byte TypeDelta = 6;
+    private const byte TypeTick = 7;
+    private const byte TypeLoss = 10;
+    private const byte TypeCalibration = 11;
+    private const int CurveSize = 64;
+
+    public const byte AxisForward = 0;
+    public const byte AxisStrafe = 1;
+    public const byte AxisTurn = 2;
+
+    public const byte SensorPrimary = 0;
+    public const byte SensorTurn = 1;
+
+    /// <summary>
+    /// One queued record; which fields are used depends on <see cref="Type"/>
+    /// (DELTA: I0/I1; TICK: I0–I3 and D0–D2; CONFIG: D0–D3, I0 invert, I1 enabled,
+    /// I2 filter, D4 adaptivity; CALIBRATION: D0 counts per meter, D1 top speed and
+    /// <see cref="Curve"/>, the caller's immutable table).
+    /// </summary>
+    private struct Entry
+    {
+        public long Timestamp;
+        public byte Type;
+        public byte Channel;
+        public int I0, I1, I2, I3;
+        public double D0, D1, D2, D3, D4;
+        public float[]? Curve;
+    }
+
+    private readonly SpscQueue<Entry> _capture = new(16384);    // ~2 s of an 8 kHz mouse
+    private readonly SpscQueue<Entry> _processing = new(4096);
+    private readonly SpscQueue<Entry> _control = new(64);
+    private long _captureDropped;
+    private long _processingDropped;
+    private long _controlDropped;
+
+    // Writer thread only
+    private readonly FileStream _file;
+    private readonly byte[] _buffer = new byte[64 * 1024];
+    private int _length;
+    private long _last;
+    private long _lossRecorded;
+
+    private readonly Thread _thread;
+    private readonly ManualResetEventSlim _stop = new(false);
+    private bool _disposed;
+
+    /// <summary>The file being written.</summary>
+    public string Path { get; }
+
+    /// <summary>
+    /// Creates <paramref name="path"/> and starts the writer thread. Throws if the
+    /// file cannot be created.
+    /// </summary>
+    public VelocityTraceWriter(string path)
+    {
+        Path = path;
+        Directory.CreateDirectory(System.IO.Path.GetDirectoryName(path)!);
+        _file = new FileStream(path, FileMode.Create, FileAccess.Write, FileShare.Read, 1, FileOptions.SequentialScan);
+
+        _last = Stopwatch.GetTimestamp();
+        var header = _buffer.AsSpan(0, FileHeaderSize);
+        header.Clear();
+        BinaryPrimitives.WriteUInt32LittleEndian(header, Magic);
+        BinaryPrimitives.WriteUInt16LittleEndian(header[4..], Version);
+        BinaryPrimitives.WriteUInt16LittleEndian(header[6..], FileHeaderSize);
+        BinaryPrimitives.WriteInt64LittleEndian(header[8..], Stopwatch.Frequency);
+        BinaryPrimitives.WriteInt64LittleEndian(header[16..], _last);
+        BinaryPrimitives.WriteUInt32LittleEndian(header[24..], SourceApp);
+        _length = FileHeaderSize;
+        Flush();
+
+        _thread = new Thread(WriterLoop)
+        {
+            Name = "Treadmill Velocity Trace",
+            IsBackground = true,
+            Priority = ThreadPriority.BelowNormal,
+        };
+        _thread.Start();
+    }
+
+    /// <summary>
+    /// A trace file named after the current time in
+    /// %LOCALAPPDATA%\TreadmillDriver\traces.
+    /// </summary>
+    public static string DefaultPath() => System.IO.Path.Combine(
+        Environment.GetFolderPath(Environment.SpecialFolder.LocalApplicationData),
+        "TreadmillDriver", "traces", $"treadmill-{DateTime.Now:yyyyMMdd-HHmmss}.tmvt");
+
+    // ─── Producers ───────────────────────────────────────────────────
+
+    /// <summary>One raw report from <paramref name="sensor"/>. Capture thread only.</summary>
+    public void RecordDelta(byte sensor, int dx, int dy, long timestamp)
+    {
+        var e = new Entry { Timestamp = timestamp, Type = TypeDelta, Channel = sensor, I0 = dx, I1 = dy };
+        if (!_capture.TryEnqueue(e)) Volatile.Write(ref _captureDropped, _captureDropped + 1);
+    }
+
+    /// <summary>The processing loop started with reset filters. Processing thread only.</summary>
+    public void RecordStart(long timestamp) => Processing(new Entry { Timestamp = timestamp, Type = TypeStart });
+
+    /// <summary>The filter settings of <paramref name="axis"/> from now on. Processing thread only.</summary>
+    internal void RecordConfig(byte axis, in NativeMethods.TreadmillInputConfig config, bool enabled, long timestamp)
+    {
+        Processing(new Entry
+        {
+            Timestamp = timestamp, Type = TypeConfig, Channel = axis,
+            D0 = config.sensitivity, D1 = config.deadZone, D2 = config.smoothing, D3 = config.maxSpeed,
+            I0 = config.invertDirection, I1 = enabled ? 1 : 0, I2 = config.filter, D4 = config.adaptivity,
+        });
+    }
+
+    /// <summary>
+    /// The calibration of <paramref name="axis"/> from now on. <paramref name="curve"/> is
+    /// kept until written and must not change. Processing thread only.
+    /// </summary>
+    public void RecordCalibration(byte axis, double countsPerMeter, double topSpeed, float[] curve, long timestamp)
+    {
+        Processing(new Entry
+        {
+            Timestamp = timestamp, Type = TypeCalibration, Channel = axis,
+            D0 = countsPerMeter, D1 = topSpeed, Curve = curve,
+        });
+    }
+
+    /// <summary>
+    /// One filter step: the counts it drained (from <paramref name="primaryEvents"/> primary
+    /// sensor events) and the motion it produced. Processing thread only.
+    /// </summary>
+    public void RecordTick(long timestamp, long primaryDx, long primaryDy, long turnDx, int primaryEvents,
+        double forward, double strafe, double turn)
+    {
+        Processing(new Entry
+        {
+            Timestamp = timestamp, Type = TypeTick,
+            I0 = Saturate(primaryDx), I1 = Saturate(primaryDy), I2 = Saturate(turnDx), I3 = primaryEvents,
+            D0 = forward, D1 = strafe, D2 = turn,
+        });
+    }
+
+    /// <summary>Processing stopped and inactive motion was published. UI thread only.</summary>
+    public void RecordStop() => Control(new Entry { Timestamp = Stopwatch.GetTimestamp(), Type = TypeStop });
+
+    /// <summary>The layer was switched to raw delta or velocity streaming. UI thread only.</summary>
+    public void RecordStreamMode(bool rawDeltas) =>
+        Control(new Entry { Timestamp = Stopwatch.GetTimestamp(), Type = TypeStreamMode, Channel = rawDeltas ? (byte)1 : (byte)0 });
+
+    private void Processing(in Entry e)
+    {
+        if (!_processing.TryEnqueue(e)) Volatile.Write(ref _processingDropped, _processingDropped + 1);
+    }
+
+    private void Control(in Entry e)
+    {
+        if (!_control.TryEnqueue(e)) Volatile.Write(ref _controlDropped, _controlDropped + 1);
+    }
+
+    private static int Saturate(long v) => (int)Math.Clamp(v, int.MinValue, int.MaxValue);
+
+    // ─── Writer ──────────────────────────────────────────────────────
+
+    private void WriterLoop()
+    {
+        while (!_stop.Wait(DrainIntervalMs))
+            Drain();
+        Drain();
+    }
+
+    /// <summary>Writer thread (or Dispose after it has exited): appends everything queued.</summary>
+    private void Drain()
+    {
+        // The replay orders records by timestamp, so the queues need not be interleaved
+        DrainQueue(_control);
+        DrainQueue(_processing);
+        DrainQueue(_capture);
+
+        long lost = Volatile.Read(ref _captureDropped) + Volatile.Read(ref _processingDropped) +
+                    Volatile.Read(ref _controlDropped);
+        if (lost != _lossRecorded)
+        {
+            Span<byte> payload = stackalloc byte[8];
+            payload.Clear();
+            BinaryPrimitives.WriteUInt32LittleEndian(payload, (uint)(lost - _lossRecorded));
+            Append(TypeLoss, 0, Stopwatch.GetTimestamp(), payload);
+            _lossRecorded = lost;
+        }
+
+        Flush();
+    }
+
+    private void DrainQueue(SpscQueue<Entry> queue)
+    {
+        Span<byte> payload = stackalloc byte[16 + 4 * CurveSize];
+        while (queue.TryDequeue(out var e))
+        {
+            int size = 0;
+            switch (e.Type)
+            {
+                case TypeDelta:
+                    BinaryPrimitives.WriteInt32LittleEndian(payload, e.I0);
+                    BinaryPrimitives.WriteInt32LittleEndian(payload[4..], e.I1);
+                    size = 8;
+                    break;
+                case TypeTick:
+                    BinaryPrimitives.WriteInt32LittleEndian(payload, e.I0);
+                    BinaryPrimitives.WriteInt32LittleEndian(payload[4..], e.I1);
+                    BinaryPrimitives.WriteInt32LittleEndian(payload[8..], e.I2);
+                    BinaryPrimitives.WriteInt32LittleEndian(payload[12..], e.I3);
+                    BinaryPrimitives.WriteDoubleLittleEndian(payload[16..], e.D0);
+                    BinaryPrimitives.WriteDoubleLittleEndian(payload[24..], e.D1);
+                    BinaryPrimitives.WriteDoubleLittleEndian(payload[32..], e.D2);
+                    size = 40;
+                    break;
+                case TypeConfig:
+                    BinaryPrimitives.WriteDoubleLittleEndian(payload, e.D0);
+                    BinaryPrimitives.WriteDoubleLittleEndian(payload[8..], e.D1);
+                    BinaryPrimitives.WriteDoubleLittleEndian(payload[16..], e.D2);
+                    BinaryPrimitives.WriteDoubleLittleEndian(payload[24..], e.D3);
+                    BinaryPrimitives.WriteInt32LittleEndian(payload[32..], e.I0);
+                    BinaryPrimitives.WriteInt32LittleEndian(payload[36..], e.I1);
+                    BinaryPrimitives.WriteInt32LittleEndian(payload[40..], e.I2);
+                    BinaryPrimitives.WriteInt32LittleEndian(payload[44..], 0);
+                    BinaryPrimitives.WriteDoubleLittleEndian(payload[48..], e.D4);
+                    size = 56;
+                    break;
+                case TypeCalibration:
+                    BinaryPrimitives.WriteDoubleLittleEndian(payload, e.D0);
+                    BinaryPrimitives.WriteDoubleLittleEndian(payload[8..], e.D1);
+                    for (int i = 0; i < CurveSize; i++)
+                        BinaryPrimitives.WriteSingleLittleEndian(payload[(16 + 4 * i)..],
+                            i < e.Curve!.Length ? e.Curve[i] : 0f);
+                    size = 16 + 4 * CurveSize;
+                    break;
+            }
+            Append(e.Type, e.Channel, e.Timestamp, payload[..size]);
+        }
+    }
+
+    /// <summary>
+    /// Encodes one record (VelocityTraceEncode): the time is stored as a signed
+    /// difference to the previous record, bridged by a TIME record when it does
+    /// not fit 32 bits. Payloads are multiples of 8 bytes here.
+    /// </summary>
+    private void Append(byte type, byte channel, long timestamp, ReadOnlySpan<byte> payload)
+    {
+        if (_buffer.Length - _length < 2 * RecordHeaderSize + 8 + payload.Length)
+            Flush();
+
+        long dt = timestamp - _last;
+        if (dt > int.MaxValue || dt < int.MinValue)
+        {
+            WriteRecordHeader(TypeTime, 0, RecordHeaderSize + 8, 0);
+            BinaryPrimitives.WriteInt64LittleEndian(_buffer.AsSpan(_length), timestamp);
+            _length += 8;
+            dt = 0;
+        }
+
+        WriteRecordHeader(type, channel, RecordHeaderSize + payload.Length, (int)dt);
+        payload.CopyTo(_buffer.AsSpan(_length));
+        _length += payload.Length;
+        _last = timestamp;
+    }
+
+    private void WriteRecordHeader(byte type, byte channel, int size, int dt)
+    {
+        var h = _buffer.AsSpan(_length, RecordHeaderSize);
+        h[0] = type;
+        h[1] = channel;
+        BinaryPrimitives.WriteUInt16LittleEndian(h[2..], (ushort)size);
+        BinaryPrimitives.WriteInt32LittleEndian(h[4..], dt);
+        _length += RecordHeaderSize;
+    }
+
+    private void Flush()
+    {
+        if (_length == 0) return;
+        try
+        {
+            _file.Write(_buffer, 0, _length);
+            _file.Flush();
+        }
+        catch (IOException ex)
+        {
+            AppLog.Write($"Velocity trace write failed: {ex.Message}");
+        }
+        _length = 0;
+    }
+
+    // ─── Dispose ─────────────────────────────────────────────────────
+
+    /// <summary>Writes everything recorded so far and closes the file.</summary>
+    public void Dispose()
+    {
+        if (_disposed) return;
+        _disposed = true;
+        _stop.Set();
+        _thread.Join();
+        _file.Dispose();
+        _stop.Dispose();
+    }
+}
@@ -1,6 +1,10 @@
 using System.Collections.ObjectModel;
+using System.Diagnostics;
+using System.IO;
+using System.Runtime.CompilerServices;
 using System.Windows;
 using System.Windows.Input;
+using System.Windows.Threading;
 using TreadmillDriver.Models;
 using TreadmillDriver.Services;
 
@@ -18,8 +22,29 @@ public class MainViewModel : ViewModelBase, IDisposable
     private readonly SharedMemoryService _sharedMemory;
     private readonly OpenXRLayerManager _vrLayerManager;
     private readonly AppSettings _settings;
+    private VelocityTraceWriter? _traceWriter;
+    private readonly DispatcherTimer _monitorTimer;
+    private readonly object _outputLock = new();
+    private double _latestVelocity;
+    private MotionVector _latestMotion;
+    private TickJitterStats? _lastLoggedTiming;
+    private DateTime _nextTimingLog;
+    private RawInputStats? _lastRawInput;
+    private DateTime _lastRawInputTime;
+    private double _rawEventsPerSecond;
+    private LayerTelemetry? _lastLayerTelemetry;
+    private DateTime _lastLayerTelemetryTime;
     private bool _disposed;
 
+    private static readonly TimeSpan TimingLogInterval = TimeSpan.FromSeconds(10);
+
+    // Matches TREADMILL_TELEMETRY_STALE_MS: a layer that has not synced for this long is gone
+    private const double LayerTelemetryStaleSeconds = 5.0;
+
+    // Shorter calibration runs are dominated by where the first and last reports fell
+    private const double MinCalibrationSeconds = 3.0;
+    private const double KmhPerMeterPerSecond = 3.6;
+
     // ─── Constructor ─────────────────────────────────────────────────
 
     public MainViewModel()
@@ -32,11 +57,19 @@ public class MainViewModel : ViewModelBase, IDisposable
         _sharedMemory = new SharedMemoryService();
         _vrLayerManager = new OpenXRLayerManager();
 
-        // Wire up mouse movement to input processor
-        _mouseCapture.MouseMoved += (dx, dy) => _inputProcessor.AddDelta(dy);
+        // Wire up mouse movement to input processor (lock-free queue, capture thread → processing thread)
+        _mouseCapture.Output = _inputProcessor.Input;
+        _mouseCapture.TurnOutput = _inputProcessor.TurnInput;
+
+        // Wire up processed motion to output (runs on the processing thread)
+        _inputProcessor.MotionUpdated += OnMotionUpdated;
 
-        // Wire up processed velocity to output
-        _inputProcessor.VelocityUpdated += OnVelocityUpdated;
+        // The live monitor only needs display rate; it samples the processing thread's output
+        _monitorTimer = new DispatcherTimer
+        {
+            Interval = TimeSpan.FromMilliseconds(33)
+        };
+        _monitorTimer.Tick += OnMonitorTick;
 
         // Apply loaded settings
         ApplySettings();
@@ -46,6 +79,9 @@ public class MainViewModel : ViewModelBase, IDisposable
         ConnectCommand = new RelayCommand(ToggleConnection, () => SelectedDevice != null);
         SelectOutputModeCommand = new RelayCommand(OnSelectOutputMode);
         ToggleVRLayerCommand = new RelayCommand(ToggleVRLayer);
+        CalibrateCommand = new RelayCommand(ToggleCalibration, () => IsConnected);
+        ClearCalibrationCommand = new RelayCommand(ClearCalibration, () => IsCalibrated || IsCalibrating);
+        UpdateCalibrationText();
 
         // Initial device scan
         RefreshDevices();
@@ -71,6 +107,18 @@ public class MainViewModel : ViewModelBase, IDisposable
         }
     }
 
+    /// <summary>Second sensor for the turn axis; null = none. Applied on the next connect.</summary>
+    private MouseDeviceInfo? _selectedTurnDevice;
+    public MouseDeviceInfo? SelectedTurnDevice
+    {
+        get => _selectedTurnDevice;
+        set
+        {
+            if (SetProperty(ref _selectedTurnDevice, value))
+                _settings.TurnDevicePath = value?.DevicePath;
+        }
+    }
+
     private bool _isConnected;
     public bool IsConnected
     {
@@ -81,6 +129,7 @@ public class MainViewModel : ViewModelBase, IDisposable
             {
                 OnPropertyChanged(nameof(ConnectionStatusText));
                 OnPropertyChanged(nameof(ConnectButtonText));
+                ((RelayCommand)CalibrateCommand).RaiseCanExecuteChanged();
             }
         }
     }
@@ -129,6 +178,7 @@ public class MainViewModel : ViewModelBase, IDisposable
         {
             _settings.Sensitivity = value;
             _inputProcessor.Sensitivity = value;
+            PublishFilterConfig();
             OnPropertyChanged();
         }
     }
@@ -140,6 +190,7 @@ public class MainViewModel : ViewModelBase, IDisposable
         {
             _settings.DeadZone = value;
             _inputProcessor.DeadZone = value;
+            PublishFilterConfig();
             OnPropertyChanged();
         }
     }
@@ -151,10 +202,45 @@ public class MainViewModel : ViewModelBase, IDisposable
         {
             _settings.Smoothing = value;
             _inputProcessor.Smoothing = value;
+            PublishFilterConfig();
             OnPropertyChanged();
         }
     }
 
+    /// <summary>Display names of the forward filters, in <see cref="FilterKind"/> order.</summary>
+    public IReadOnlyList<string> FilterNames { get; } = new[] { "EMA", "One-Euro", "Kalman" };
+
+    public int FilterIndex
+    {
+        get => (int)_settings.Filter;
+        set
+        {
+            _settings.Filter = (FilterKind)value;
+            _inputProcessor.Filter = _settings.Filter;
+            PublishFilterConfig();
+            OnPropertyChanged();
+            OnPropertyChanged(nameof(IsAdaptiveFilter));
+        }
+    }
+
+    /// <summary>Adaptivity only applies to the One-Euro and Kalman filters.</summary>
+    public bool IsAdaptiveFilter => _settings.Filter != FilterKind.Ema;
+
+    public double Adaptivity
+    {
+        get => _settings.Adaptivity;
+        set
+        {
+            _settings.Adaptivity = value;
+            _inputProcessor.Adaptivity = value;
+            PublishFilterConfig();
+            OnPropertyChanged();
+        }
+    }
+
+    /// <summary>Max Speed only applies while the belt is uncalibrated.</summary>
+    public bool UsesMaxSpeed => !IsCalibrated;
+
     public double MaxSpeed
     {
         get => _settings.MaxSpeed;
@@ -162,6 +248,7 @@ public class MainViewModel : ViewModelBase, IDisposable
         {
             _settings.MaxSpeed = value;
             _inputProcessor.MaxSpeed = value;
+            PublishFilterConfig();
             OnPropertyChanged();
         }
     }
@@ -173,6 +260,18 @@ public class MainViewModel : ViewModelBase, IDisposable
         {
             _settings.InvertDirection = value;
             _inputProcessor.InvertDirection = value;
+            PublishFilterConfig();
+            OnPropertyChanged();
+        }
+    }
+
+    public int TickRateHz
+    {
+        get => _settings.TickRateHz;
+        set
+        {
+            _inputProcessor.TickRateHz = value;
+            _settings.TickRateHz = _inputProcessor.TickRateHz;
             OnPropertyChanged();
         }
     }
@@ -188,6 +287,154 @@ public class MainViewModel : ViewModelBase, IDisposable
         }
     }
 
+    public bool RawDeltaStreaming
+    {
+        get => _settings.RawDeltaStreaming;
+        set
+        {
+            _settings.RawDeltaStreaming = value;
+            ApplyStreamMode();
+            OnPropertyChanged();
+        }
+    }
+
+    /// <summary>Takes effect on the next connect.</summary>
+    public bool RecordTrace
+    {
+        get => _settings.RecordTrace;
+        set
+        {
+            _settings.RecordTrace = value;
+            OnPropertyChanged();
+        }
+    }
+
+    // ─── Extra Axes ──────────────────────────────────────────────────
+    // The processor reads the AxisSettings instances directly, so a change applies on the next tick
+
+    public bool StrafeEnabled
+    {
+        get => _settings.Strafe.Enabled;
+        set
+        {
+            _settings.Strafe.Enabled = value;
+            OnPropertyChanged();
+        }
+    }
+
+    public double StrafeSensitivity
+    {
+        get => _settings.Strafe.Sensitivity;
+        set
+        {
+            _settings.Strafe.Sensitivity = value;
+            OnPropertyChanged();
+        }
+    }
+
+    public bool TurnEnabled
+    {
+        get => _settings.Turn.Enabled;
+        set
+        {
+            _settings.Turn.Enabled = value;
+            OnPropertyChanged();
+        }
+    }
+
+    public double TurnSensitivity
+    {
+        get => _settings.Turn.Sensitivity;
+        set
+        {
+            _settings.Turn.Sensitivity = value;
+            OnPropertyChanged();
+        }
+    }
+
+    private string _extraAxesText = "—";
+    public string ExtraAxesText
+    {
+        get => _extraAxesText;
+        set => SetProperty(ref _extraAxesText, value);
+    }
+
+    // ─── Calibration ─────────────────────────────────────────────────
+
+    /// <summary>Speed the treadmill is set to while calibrating, km/h.</summary>
+    public double CalibrationSpeedKmh
+    {
+        get => _settings.CalibrationSpeedKmh;
+        set
+        {
+            _settings.CalibrationSpeedKmh = value;
+            OnPropertyChanged();
+        }
+    }
+
+    /// <summary>Belt speed that gives full output, km/h.</summary>
+    public double TopSpeedKmh
+    {
+        get => _settings.TopSpeedKmh;
+        set
+        {
+            _settings.TopSpeedKmh = value;
+            ApplyCalibration();
+            OnPropertyChanged();
+        }
+    }
+
+    /// <summary>Response curve output at a quarter, half and three quarters of the top speed.</summary>
+    public double Curve25
+    {
+        get => _settings.ResponseCurve[1];
+        set => SetCurvePoint(1, value);
+    }
+
+    public double Curve50
+    {
+        get => _settings.ResponseCurve[2];
+        set => SetCurvePoint(2, value);
+    }
+
+    public double Curve75
+    {
+        get => _settings.ResponseCurve[3];
+        set => SetCurvePoint(3, value);
+    }
+
+    private void SetCurvePoint(int index, double value, [CallerMemberName] string? name = null)
+    {
+        _settings.ResponseCurve[index] = value;
+        ApplyCalibration();
+        OnPropertyChanged(name);
+    }
+
+    public bool IsCalibrated => _settings.CountsPerMeter > 0;
+
+    private bool _isCalibrating;
+    public bool IsCalibrating
+    {
+        get => _isCalibrating;
+        set
+        {
+            if (SetProperty(ref _isCalibrating, value))
+            {
+                OnPropertyChanged(nameof(CalibrateButtonText));
+                ((RelayCommand)ClearCalibrationCommand).RaiseCanExecuteChanged();
+            }
+        }
+    }
+
+    public string CalibrateButtonText => IsCalibrating ? "Finish" : "Calibrate";
+
+    private string _calibrationText = "";
+    public string CalibrationText
+    {
+        get => _calibrationText;
+        set => SetProperty(ref _calibrationText, value);
+    }
+
     // ─── Live Monitor Properties ─────────────────────────────────────
 
     private double _currentVelocity;
@@ -213,6 +460,36 @@ public class MainViewModel : ViewModelBase, IDisposable
     public double ForwardBarHeight => Math.Max(0, CurrentVelocity) * 150;
     public double BackwardBarHeight => Math.Max(0, -CurrentVelocity) * 150;
 
+    // ─── Tick Timing ─────────────────────────────────────────────────
+
+    private string _tickTimingText = "—";
+    public string TickTimingText
+    {
+        get => _tickTimingText;
+        set => SetProperty(ref _tickTimingText, value);
+    }
+
+    private string _rawInputText = "—";
+    public string RawInputText
+    {
+        get => _rawInputText;
+        set => SetProperty(ref _rawInputText, value);
+    }
+
+    private string _layerTelemetryText = "—";
+    public string LayerTelemetryText
+    {
+        get => _layerTelemetryText;
+        set => SetProperty(ref _layerTelemetryText, value);
+    }
+
+    private IReadOnlyList<TickHistogramBar> _tickHistogram = Array.Empty<TickHistogramBar>();
+    public IReadOnlyList<TickHistogramBar> TickHistogram
+    {
+        get => _tickHistogram;
+        set => SetProperty(ref _tickHistogram, value);
+    }
+
     // ─── Status ──────────────────────────────────────────────────────
 
     private string _statusMessage = "Ready — Select a mouse device to begin";
@@ -235,6 +512,8 @@ public class MainViewModel : ViewModelBase, IDisposable
     public ICommand ConnectCommand { get; }
     public ICommand SelectOutputModeCommand { get; }
     public ICommand ToggleVRLayerCommand { get; }
+    public ICommand CalibrateCommand { get; }
+    public ICommand ClearCalibrationCommand { get; }
 
     // ─── VR OpenXR Layer Properties ──────────────────────────────────
 
@@ -274,8 +553,6 @@ public class MainViewModel : ViewModelBase, IDisposable
 
     // ─── Window reference (needed for raw input registration) ────────
 
-    private Window? _window;
-    public void SetWindow(Window window) => _window = window;
 
     // ─── Methods ─────────────────────────────────────────────────────
 
@@ -296,6 +573,11 @@ public class MainViewModel : ViewModelBase, IDisposable
             SelectedDevice = Devices.FirstOrDefault(d => d.IsBluetooth) ?? Devices[0];
         }
 
+        // The turn sensor is only ever restored, never guessed
+        string? turnPath = _settings.TurnDevicePath;
+        SelectedTurnDevice = string.IsNullOrEmpty(turnPath) ? null : Devices.FirstOrDefault(d => d.DevicePath == turnPath);
+        _settings.TurnDevicePath = turnPath;
+
         StatusMessage = $"Found {devices.Count} mouse device(s) — {devices.Count(d => d.IsBluetooth)} Bluetooth";
     }
 
@@ -313,12 +595,35 @@ public class MainViewModel : ViewModelBase, IDisposable
 
     private void Connect()
     {
-        if (SelectedDevice == null || _window == null) return;
+        if (SelectedDevice == null) return;
 
-        if (_mouseCapture.StartCapture(SelectedDevice.DeviceHandle, _window))
+        if (_mouseCapture.StartCapture(SelectedDevice.DeviceHandle, SelectedTurnDevice?.DeviceHandle ?? IntPtr.Zero))
         {
-            _inputProcessor.Start();
+            // Shared memory must be mapped before the processing thread starts writing to it
             _sharedMemory.Start();
+            StartTrace();
+            PublishFilterConfig();
+            ApplyStreamMode();
+            try
+            {
+                _inputProcessor.Start();
+            }
+            catch (Exception ex) when (ex is DllNotFoundException or EntryPointNotFoundException or InvalidOperationException)
+            {
+                _mouseCapture.StopCapture();
+                _mouseCapture.RawDeltaOutput = null;
+                _sharedMemory.Stop();
+                StopTrace();
+                StatusMessage = "⚠ treadmill_input.dll missing or outdated — build OpenXRLayer (build.bat).";
+                AppLog.Write($"Input core unavailable: {ex.Message}");
+                return;
+            }
+            // Baked by Start
+            PublishCalibration();
+            _monitorTimer.Start();
+            _nextTimingLog = DateTime.UtcNow + TimingLogInterval;
+            _lastRawInput = null;
+            _rawEventsPerSecond = 0;
             IsConnected = true;
             _settings.LastDevicePath = SelectedDevice.DevicePath;
 
@@ -329,6 +634,8 @@ public class MainViewModel : ViewModelBase, IDisposable
             }
 
             StatusMessage = $"Active — Capturing from {SelectedDevice.DisplayName}";
+            AppLog.Write($"Connected to {SelectedDevice.DisplayName}, processing at {_inputProcessor.TickRateHz} Hz" +
+                (_settings.RawDeltaStreaming ? ", raw deltas streamed to the OpenXR layer" : ""));
         }
         else
         {
@@ -339,29 +646,47 @@ public class MainViewModel : ViewModelBase, IDisposable
     private void Disconnect()
     {
         _inputProcessor.Stop();
+        IsCalibrating = false;
+        UpdateCalibrationText();
+        _monitorTimer.Stop();
+        LogTiming(_inputProcessor.TimingStats);
         _mouseCapture.StopCapture();
-        _keyboardOutput.ReleaseAll();
-        _gamepadOutput.ResetAxis();
-        _gamepadOutput.Disconnect();
+        _mouseCapture.RawDeltaOutput = null;
+        StopTrace();
+        AppLog.Write(_mouseCapture.Stats.ToLogLine(_rawEventsPerSecond));
+        lock (_outputLock)
+        {
+            _keyboardOutput.ReleaseAll();
+            _gamepadOutput.ResetAxis();
+            _gamepadOutput.Disconnect();
+        }
         _sharedMemory.Stop();
 
         IsConnected = false;
         CurrentVelocity = 0;
+        ExtraAxesText = "—";
         GamepadStatusMessage = "";
         StatusMessage = "Disconnected — Select a device to begin";
     }
 
     private void SwitchOutputMode(OutputMode mode)
     {
-        // Clean up current output
-        _keyboardOutput.ReleaseAll();
-        _gamepadOutput.ResetAxis();
-        _gamepadOutput.Disconnect();
+        // Clean up current output (the processing thread may be mid-update)
+        bool connected = false;
+        lock (_outputLock)
+        {
+            _keyboardOutput.ReleaseAll();
+            _gamepadOutput.ResetAxis();
+            _gamepadOutput.Disconnect();
+
+            if (mode != OutputMode.Keyboard && IsConnected)
+                connected = _gamepadOutput.Connect(mode);
+        }
         GamepadStatusMessage = "";
 
         if (mode != OutputMode.Keyboard && IsConnected)
         {
-            if (!_gamepadOutput.Connect(mode))
+            if (!connected)
             {
                 GamepadStatusMessage = _gamepadOutput.LastError ?? "Failed to create virtual controller";
             }
@@ -383,39 +708,308 @@ public class MainViewModel : ViewModelBase, IDisposable
         }
     }
 
-    private void OnVelocityUpdated(double normalizedVelocity)
+    /// <summary>
+    /// Called on the processing thread every tick (up to 1 kHz): writes the
+    /// motion straight into shared memory and drives the emulated outputs.
+    /// UI properties are refreshed separately by <see cref="OnMonitorTick"/>.
+    /// </summary>
+    private void OnMotionUpdated(MotionVector motion)
     {
-        CurrentVelocity = normalizedVelocity;
+        Volatile.Write(ref _latestVelocity, motion.Forward);
 
         // Always write to shared memory (OpenXR layer reads it)
-        _sharedMemory.UpdateVelocity((float)normalizedVelocity);
+        _sharedMemory.UpdateMotion((float)motion.Forward, (float)motion.Strafe, (float)motion.Turn);
+
+        lock (_outputLock)
+        {
+            _latestMotion = motion;
+            UpdateOutputs(motion);
+        }
+    }
 
-        switch (SelectedOutputMode)
+    private void UpdateOutputs(MotionVector motion)
+    {
+        switch (_selectedOutputMode)
         {
             case OutputMode.Keyboard:
-                _keyboardOutput.Update(normalizedVelocity);
+                // W / S only: there is no analog key for strafe or turn
+                _keyboardOutput.Update(motion.Forward);
                 break;
 
             case OutputMode.XboxController:
-                _gamepadOutput.Update(normalizedVelocity);
+                _gamepadOutput.Update(motion);
                 break;
 
             case OutputMode.VRController:
                 // VR mode: OpenXR layer handles thumbstick injection directly.
                 // Also send gamepad + keyboard as fallback for non-OpenXR games.
-                _gamepadOutput.Update(normalizedVelocity);
-                _keyboardOutput.Update(normalizedVelocity);
+                _gamepadOutput.Update(motion);
+                _keyboardOutput.Update(motion.Forward);
                 break;
         }
     }
 
+    private void OnMonitorTick(object? sender, EventArgs e)
+    {
+        CurrentVelocity = Volatile.Read(ref _latestVelocity);
+        MotionVector motion;
+        lock (_outputLock) motion = _latestMotion;
+        ExtraAxesText = $"strafe {motion.Strafe * 100:+0;-0;0}% · turn {motion.Turn * 100:+0;-0;0}%";
+        UpdateCalibrationProgress();
+        UpdateRawInputStats();
+        UpdateLayerTelemetry();
+
+        var stats = _inputProcessor.TimingStats;
+        if (stats == null) return;
+
+        TickTimingText = $"{stats.WindowRateHz:F0} / {stats.TargetRateHz:F0} Hz · " +
+                         $"jitter {stats.WindowJitterMs:F3} ms · max {stats.WindowMaxIntervalMs:F2} ms · " +
+                         $"p99 dev {stats.DeviationPercentileLabel(0.99)} · late {stats.LateTicks}" +
+                         (stats.HighResolutionTimer ? "" : " · low-res timer");
+
+        long total = Math.Max(1, stats.TotalTicks);
+        TickHistogram = stats.BucketCounts
+            .Select((count, i) => new TickHistogramBar
+            {
+                Label = TickJitterStats.BucketLabels[i],
+                Count = count,
+                Fraction = (double)count / total,
+            })
+            .ToList();
+
+        if (DateTime.UtcNow >= _nextTimingLog)
+        {
+            LogTiming(stats);
+            AppLog.Write(_mouseCapture.Stats.ToLogLine(_rawEventsPerSecond));
+            _nextTimingLog = DateTime.UtcNow + TimingLogInterval;
+        }
+    }
+
+    private void UpdateRawInputStats()
+    {
+        var now = DateTime.UtcNow;
+        if (_lastRawInput != null && now - _lastRawInputTime < TimeSpan.FromSeconds(1)) return;
+
+        var raw = _mouseCapture.Stats;
+        if (_lastRawInput != null)
+            _rawEventsPerSecond = raw.EventsPerSecond(_lastRawInput, now - _lastRawInputTime);
+        _lastRawInput = raw;
+        _lastRawInputTime = now;
+
+        RawInputText = $"{_rawEventsPerSecond:F0} events/s · batch max {raw.MaxBatch} · " +
+                       $"queue max {raw.QueueMaxDepth}/{raw.QueueCapacity}" +
+                       (raw.Merged > 0 ? $" · merged {raw.Merged}" : "");
+    }
+
+    /// <summary>
+    /// Once a second: rates from the OpenXR layer's own counters, which it
+    /// publishes whether or not this app is running the treadmill.
+    /// </summary>
+    private void UpdateLayerTelemetry()
+    {
+        var now = DateTime.UtcNow;
+        var elapsed = now - _lastLayerTelemetryTime;
+        if (_lastLayerTelemetry != null && elapsed < TimeSpan.FromSeconds(1)) return;
+        _lastLayerTelemetryTime = now;
+
+        if (!_sharedMemory.TryReadLayerTelemetry(out var t) ||
+            !t.IsLive(Stopwatch.GetTimestamp(), LayerTelemetryStaleSeconds))
+        {
+            _lastLayerTelemetry = null;
+            LayerTelemetryText = "no OpenXR app";
+            return;
+        }
+
+        // A new owner (another game) restarts the counters: skip one interval
+        var last = _lastLayerTelemetry;
+        _lastLayerTelemetry = t;
+        if (last == null || last.ProcessId != t.ProcessId || t.TotalCalls < last.TotalCalls)
+        {
+            LayerTelemetryText = $"pid {t.ProcessId} · measuring…";
+            return;
+        }
+
+        double seconds = elapsed.TotalSeconds;
+        LayerTelemetryText = $"{(t.TotalCalls - last.TotalCalls) / seconds:F0} calls/s · " +
+                             $"{(t.Injected - last.Injected) / seconds:F0} injected/s · " +
+                             $"{t.MicrosecondsPerCall:F2} µs/call · {t.FramesPerSecond:F0} fps · " +
+                             $"axes {t.Forward:+0.00;-0.00;0.00} {t.Strafe:+0.00;-0.00;0.00} {t.Turn:+0.00;-0.00;0.00}" +
+                             (t.SkippedSubaction > 0 ? $" · other hand {t.SkippedSubaction}" : "");
+    }
+
+    /// <summary>
+    /// Mirrors the filter settings into shared memory, where the OpenXR layer
+    /// reads them in raw delta mode. A no-op while disconnected.
+    /// </summary>
+    private void PublishFilterConfig()
+    {
+        _sharedMemory.WriteFilterConfig(_settings.Sensitivity, _settings.DeadZone, _settings.Smoothing,
+            _settings.MaxSpeed, _settings.InvertDirection, (int)_settings.Filter, _settings.Adaptivity);
+    }
+
+    /// <summary>
+    /// Mirrors the baked calibration into shared memory for the layer's raw delta
+    /// mode. A no-op while disconnected; <see cref="Connect"/> publishes it again.
+    /// </summary>
+    private void PublishCalibration()
+    {
+        var calibration = _inputProcessor.Calibration;
+        _sharedMemory.WriteCalibration(calibration.CountsPerMeter, calibration.TopSpeed, calibration.Curve);
+    }
+
+    /// <summary>Hands the calibration settings to the processor and, if connected, the layer.</summary>
+    private void ApplyCalibration()
+    {
+        _inputProcessor.SetCalibration(_settings.CountsPerMeter, _settings.TopSpeedKmh / KmhPerMeterPerSecond,
+            _settings.ResponseCurve);
+        if (IsConnected)
+            PublishCalibration();
+        OnPropertyChanged(nameof(IsCalibrated));
+        OnPropertyChanged(nameof(UsesMaxSpeed));
+        ((RelayCommand)ClearCalibrationCommand).RaiseCanExecuteChanged();
+        if (!IsCalibrating)
+            UpdateCalibrationText();
+    }
+
+    /// <summary>
+    /// Starts a calibration run with the belt at <see cref="CalibrationSpeedKmh"/>, or
+    /// finishes it and applies the counts per meter it measured.
+    /// </summary>
+    private void ToggleCalibration()
+    {
+        if (!IsCalibrating)
+        {
+            _inputProcessor.BeginCalibration();
+            IsCalibrating = true;
+            CalibrationText = $"Counting — keep the belt at {CalibrationSpeedKmh:F1} km/h";
+            return;
+        }
+
+        double beltSpeed = CalibrationSpeedKmh / KmhPerMeterPerSecond;
+        double countsPerMeter = _inputProcessor.EndCalibration(beltSpeed);
+        var (seconds, _) = _inputProcessor.CalibrationProgress(beltSpeed);
+        IsCalibrating = false;
+
+        if (seconds < MinCalibrationSeconds || !(countsPerMeter > 0))
+        {
+            UpdateCalibrationText();
+            StatusMessage = $"⚠ Calibration too short or no movement — run the belt for at least {MinCalibrationSeconds:F0} s";
+            return;
+        }
+
+        _settings.CountsPerMeter = countsPerMeter;
+        ApplyCalibration();
+        AppLog.Write($"Calibrated: {countsPerMeter:F1} counts/m over {seconds:F1} s at {CalibrationSpeedKmh:F1} km/h");
+    }
+
+    private void ClearCalibration()
+    {
+        if (IsCalibrating)
+        {
+            _inputProcessor.EndCalibration(0);
+            IsCalibrating = false;
+        }
+        _settings.CountsPerMeter = 0;
+        ApplyCalibration();
+    }
+
+    private void UpdateCalibrationText()
+    {
+        CalibrationText = IsCalibrated
+            ? $"{_settings.CountsPerMeter:F0} counts/m"
+            : "Not calibrated — Max Speed scales the output";
+    }
+
+    /// <summary>Monitor tick: the running count, or the belt speed once calibrated.</summary>
+    private void UpdateCalibrationProgress()
+    {
+        if (IsCalibrating)
+        {
+            var (seconds, countsPerMeter) = _inputProcessor.CalibrationProgress(CalibrationSpeedKmh / KmhPerMeterPerSecond);
+            CalibrationText = $"Counting — {seconds:F1} s" +
+                              (countsPerMeter > 0 ? $" · {countsPerMeter:F0} counts/m so far" : " · waiting for movement");
+        }
+        else if (IsCalibrated)
+        {
+            CalibrationText = $"{_settings.CountsPerMeter:F0} counts/m · belt " +
+                              $"{Math.Abs(_inputProcessor.CurrentSpeed) * KmhPerMeterPerSecond:F1} km/h";
+        }
+    }
+
+    /// <summary>
+    /// Raw delta streaming: the capture thread feeds the layer's ring directly and the
+    /// layer filters per frame. The ring is fed before the layer is told to read it.
+    /// Both calls are no-ops on unmapped shared memory, so this is safe while disconnected.
+    /// </summary>
+    private void ApplyStreamMode()
+    {
+        _traceWriter?.RecordStreamMode(_settings.RawDeltaStreaming);
+        if (_settings.RawDeltaStreaming)
+        {
+            _mouseCapture.RawDeltaOutput = _sharedMemory;
+            _sharedMemory.SetRawDeltaStreaming(true);
+        }
+        else
+        {
+            _sharedMemory.SetRawDeltaStreaming(false);
+            _mouseCapture.RawDeltaOutput = null;
+        }
+    }
+
+    /// <summary>
+    /// Starts recording a velocity trace of this session if enabled. Before the capture
+    /// and processing threads start: both read their writer when they start.
+    /// </summary>
+    private void StartTrace()
+    {
+        if (!_settings.RecordTrace) return;
+        try
+        {
+            _traceWriter = new VelocityTraceWriter(VelocityTraceWriter.DefaultPath());
+        }
+        catch (Exception ex) when (ex is IOException or UnauthorizedAccessException)
+        {
+            AppLog.Write($"Velocity trace unavailable: {ex.Message}");
+            return;
+        }
+        _mouseCapture.TraceWriter = _traceWriter;
+        _inputProcessor.TraceWriter = _traceWriter;
+        AppLog.Write($"Recording velocity trace to {_traceWriter.Path}");
+    }
+
+    /// <summary>After the processing thread has stopped: writes the rest and closes the file.</summary>
+    private void StopTrace()
+    {
+        if (_traceWriter == null) return;
+        _mouseCapture.TraceWriter = null;
+        _inputProcessor.TraceWriter = null;
+        _traceWriter.Dispose();
+        _traceWriter = null;
+    }
+
+    private void LogTiming(TickJitterStats? stats)
+    {
+        if (stats == null || ReferenceEquals(stats, _lastLoggedTiming)) return;
+        _lastLoggedTiming = stats;
+        AppLog.Write(stats.ToLogLine());
+    }
+
     private void ApplySettings()
     {
         _inputProcessor.Sensitivity = _settings.Sensitivity;
         _inputProcessor.DeadZone = _settings.DeadZone;
         _inputProcessor.Smoothing = _settings.Smoothing;
         _inputProcessor.MaxSpeed = _settings.MaxSpeed;
+        _inputProcessor.Filter = _settings.Filter;
+        _inputProcessor.Adaptivity = _settings.Adaptivity;
         _inputProcessor.InvertDirection = _settings.InvertDirection;
+        _inputProcessor.TickRateHz = _settings.TickRateHz;
+        _inputProcessor.Strafe = _settings.Strafe;
+        _inputProcessor.Turn = _settings.Turn;
+        if (_settings.ResponseCurve is not { Length: 5 })
+            _settings.ResponseCurve = new AppSettings().ResponseCurve;
+        _inputProcessor.SetCalibration(_settings.CountsPerMeter, _settings.TopSpeedKmh / KmhPerMeterPerSecond,
+            _settings.ResponseCurve);
         _mouseCapture.BlockCursor = _settings.BlockCursor;
         _selectedOutputMode = _settings.SelectedOutputMode;
     }
@@ -430,8 +1024,10 @@ public class MainViewModel : ViewModelBase, IDisposable
         _disposed = true;
 
         SaveSettings();
+        _monitorTimer.Stop();
         _inputProcessor.Stop();
         _mouseCapture.Dispose();
+        StopTrace();
         _inputProcessor.Dispose();
         _keyboardOutput.Dispose();
         _gamepadOutput.Dispose();